@@ -21,6 +21,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "application.hpp"
 
+#include <cstdlib>
+
 #include <ruis/standard_widgets.hpp>
 #include <utki/config.hpp>
 
@@ -41,12 +43,14 @@ constexpr auto screen_height = 600;
 
 application::application(
 	bool windowed, //
-	std::string_view res_path
+	std::string_view res_path,
+	std::string_view cache_path
 ) :
 	ruisapp::application({
 		.name = std::string(app_name) //
 	}),
-	res_path(fsif::as_dir(res_path))
+	res_path(fsif::as_dir(res_path)),
+	cache_path(cache_path)
 {
 	auto& win = this->make_window({
 		.dims = {screen_width, screen_height},
@@ -92,6 +96,9 @@ std::unique_ptr<application> carcockpit::make_application(
 #if CFG_OS_NAME == CFG_OS_NAME_EMSCRIPTEN
 	bool windowed = true;
 	std::string res_path = "res/"s;
+
+	// no persistent file system to cache to
+	std::string cache_path;
 #else
 	bool windowed = false;
 
@@ -102,6 +109,16 @@ std::unique_ptr<application> carcockpit::make_application(
 	);
 	// std::string res_path = "res/"s;
 
+	std::string cache_path = [&]() -> std::string {
+		if (auto xdg_cache_home = std::getenv("XDG_CACHE_HOME"); xdg_cache_home && *xdg_cache_home) {
+			return utki::cat(fsif::as_dir(xdg_cache_home), application::app_name);
+		}
+		if (auto home = std::getenv("HOME"); home && *home) {
+			return utki::cat(fsif::as_dir(home), ".cache/"sv, application::app_name);
+		}
+		return {};
+	}();
+
 	clargs::parser p;
 
 	p.add("window", "run in window mode", [&]() {
@@ -119,11 +136,23 @@ std::unique_ptr<application> carcockpit::make_application(
 		}
 	);
 
+	p.add(
+		"cache-path",
+		utki::cat(
+			"cache files path, empty value disables caching, default = $XDG_CACHE_HOME/"sv, //
+			application::app_name
+		),
+		[&](std::string_view v) {
+			cache_path = v;
+		}
+	);
+
 	p.parse(args);
 #endif
 
 	return std::make_unique<application>(
 		windowed, //
-		res_path
+		res_path,
+		cache_path
 	);
 }
@@ -24,6 +24,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ruisapp/application.hpp>
 
 #include "shaders/shader_pbr.hpp"
+#include "shaders/shader_pbr_instanced.hpp"
 #include "shaders/shader_phong.hpp"
 #include "shaders/shader_skybox.hpp"
 
@@ -36,9 +37,16 @@ class application : public ruisapp::application
 public:
 	const std::string res_path;
 
+	/**
+	 * @brief Directory for cache files.
+	 * Empty if caching is disabled.
+	 */
+	const std::string cache_path;
+
 	application(
 		bool window, //
-		std::string_view res_path
+		std::string_view res_path,
+		std::string_view cache_path
 	);
 
 	static constexpr std::string_view app_name = "carcockpit"sv;
@@ -52,6 +60,7 @@ public:
 	ruis::render::shader_skybox shader_skybox_v;
 	ruis::render::shader_phong shader_phong_v;
 	ruis::render::shader_pbr shader_pbr_v;
+	ruis::render::shader_pbr_instanced shader_pbr_instanced_v;
 };
 
 std::unique_ptr<application> make_application(
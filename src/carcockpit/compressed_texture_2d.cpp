@@ -0,0 +1,155 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "compressed_texture_2d.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include <ruis/render/opengles/util.hpp>
+
+using namespace carcockpit;
+
+namespace {
+// ETC2 formats are core in OpenGL ES 3.0, the headers are OpenGL ES 2.0
+constexpr GLenum gl_compressed_rgb8_etc2 = 0x9274;
+constexpr GLenum gl_compressed_rgba8_etc2_eac = 0x9278;
+
+GLenum to_gl_format(ruis::render::compressed_image::format f)
+{
+	switch (f) {
+		case ruis::render::compressed_image::format::etc2_rgb8:
+			return gl_compressed_rgb8_etc2;
+		case ruis::render::compressed_image::format::etc2_rgba8:
+		default:
+			return gl_compressed_rgba8_etc2_eac;
+	}
+}
+
+GLint to_gl_filter(ruis::render::texture_2d::filter f)
+{
+	switch (f) {
+		case ruis::render::texture_2d::filter::nearest:
+			return GL_NEAREST;
+		case ruis::render::texture_2d::filter::linear:
+		default:
+			return GL_LINEAR;
+	}
+}
+
+GLint to_gl_min_filter(
+	ruis::render::texture_2d::filter f, //
+	ruis::render::texture_2d::mipmap m
+)
+{
+	switch (m) {
+		case ruis::render::texture_2d::mipmap::none:
+			return to_gl_filter(f);
+		case ruis::render::texture_2d::mipmap::nearest:
+			return f == ruis::render::texture_2d::filter::nearest ? GL_NEAREST_MIPMAP_NEAREST
+																	: GL_LINEAR_MIPMAP_NEAREST;
+		case ruis::render::texture_2d::mipmap::linear:
+		default:
+			return f == ruis::render::texture_2d::filter::nearest ? GL_NEAREST_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_LINEAR;
+	}
+}
+} // namespace
+
+compressed_texture_2d::compressed_texture_2d(
+	utki::shared_ref<ruis::render::context> rendering_context,
+	const ruis::render::compressed_image& image,
+	const ruis::render::context::texture_2d_parameters& params
+) :
+	ruis::render::texture_2d(std::move(rendering_context), image.dims)
+{
+	glGenTextures(1, &this->tex);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	this->bind(0);
+
+	auto format = to_gl_format(image.format_v);
+
+	auto dims = image.dims;
+	for (size_t i = 0; i != image.levels.size(); ++i) {
+		const auto& level = image.levels[i];
+		glCompressedTexImage2D(
+			GL_TEXTURE_2D, //
+			GLint(i),
+			format,
+			GLsizei(dims.x()),
+			GLsizei(dims.y()),
+			0,
+			GLsizei(image.get_level_size(dims)),
+			level.data()
+		);
+		ruis::render::opengles::assert_opengl_no_error();
+
+		dims = {std::max(dims.x() / 2, uint32_t(1)), std::max(dims.y() / 2, uint32_t(1))};
+	}
+
+	// OpenGL ES 2.0 has no GL_TEXTURE_MAX_LEVEL, so mipmapped filtering needs the full mipmap chain,
+	// compressed mipmaps cannot be generated on GPU
+	auto full_chain_size = size_t(std::bit_width(std::max(image.dims.x(), image.dims.y())));
+	auto mipmap = image.levels.size() == full_chain_size ? params.mipmap : ruis::render::texture_2d::mipmap::none;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, to_gl_min_filter(params.min_filter, mipmap));
+	ruis::render::opengles::assert_opengl_no_error();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, to_gl_filter(params.mag_filter));
+	ruis::render::opengles::assert_opengl_no_error();
+}
+
+compressed_texture_2d::~compressed_texture_2d()
+{
+	glDeleteTextures(1, &this->tex);
+}
+
+void compressed_texture_2d::bind(unsigned unit_num) const
+{
+	glActiveTexture(GL_TEXTURE0 + unit_num);
+	ruis::render::opengles::assert_opengl_no_error();
+	glBindTexture(GL_TEXTURE_2D, this->tex);
+	ruis::render::opengles::assert_opengl_no_error();
+}
+
+ruis::render::compressed_texture_factory compressed_texture_2d::make_factory(
+	utki::shared_ref<ruis::render::context> rendering_context
+)
+{
+	GLint num_formats = 0;
+	glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &num_formats);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	std::vector<GLint> formats(num_formats);
+	if (num_formats > 0) {
+		glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		ruis::render::opengles::assert_opengl_no_error();
+	}
+
+	return [rendering_context = std::move(rendering_context),
+			formats = std::move(formats)](const ruis::render::compressed_image& image, const auto& params)
+			   -> std::shared_ptr<ruis::render::texture_2d> {
+		if (std::find(formats.begin(), formats.end(), GLint(to_gl_format(image.format_v))) == formats.end()) {
+			return nullptr;
+		}
+		return std::make_shared<compressed_texture_2d>(rendering_context, image, params);
+	};
+}
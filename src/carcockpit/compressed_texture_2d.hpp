@@ -0,0 +1,68 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <ruis/render/context.hpp>
+#include <ruis/render/texture_2d.hpp>
+
+#include "../ruis/render/scene/compressed_image.hxx"
+
+namespace carcockpit {
+
+/**
+ * @brief OpenGL ES texture with block-compressed image data.
+ * The rendering context does not support compressed textures, so those are created directly with OpenGL ES.
+ */
+class compressed_texture_2d : public ruis::render::texture_2d
+{
+	GLuint tex = 0;
+
+public:
+	compressed_texture_2d(
+		utki::shared_ref<ruis::render::context> rendering_context,
+		const ruis::render::compressed_image& image,
+		const ruis::render::context::texture_2d_parameters& params
+	);
+
+	compressed_texture_2d(const compressed_texture_2d&) = delete;
+	compressed_texture_2d& operator=(const compressed_texture_2d&) = delete;
+
+	compressed_texture_2d(compressed_texture_2d&&) = delete;
+	compressed_texture_2d& operator=(compressed_texture_2d&&) = delete;
+
+	~compressed_texture_2d() override;
+
+	void bind(unsigned unit_num) const;
+
+	/**
+	 * @brief Create compressed texture factory for the current OpenGL ES context.
+	 * Must be called on the rendering thread.
+	 * @param rendering_context - rendering context to create textures for.
+	 * @return Factory which creates textures in formats supported by the GPU and returns null for other formats.
+	 */
+	static ruis::render::compressed_texture_factory make_factory(
+		utki::shared_ref<ruis::render::context> rendering_context
+	);
+};
+
+} // namespace carcockpit
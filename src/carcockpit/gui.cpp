@@ -179,7 +179,8 @@ root_widget_info carcockpit::make_root_widget(utki::shared_ref<ruis::context> c)
                                 .smooth_navigation_zoom = true,
                                 .orbit_angle_upper_limit = ruis::real(utki::pi) / 4,
 		                        .orbit_angle_lower_limit = ruis::real(utki::pi) / 4,
-                                .environment_cube = c.get().loader().load<ruis::res::texture_cube>("tex_cube_env_castle").to_shared_ptr()                               
+                                .environment_cube = c.get().loader().load<ruis::res::texture_cube>("tex_cube_env_castle").to_shared_ptr(),
+                                .cache_dir = carcockpit::application::inst().cache_path
                             }
                         }
                     ),
@@ -203,6 +204,7 @@ root_widget_info carcockpit::make_root_widget(utki::shared_ref<ruis::context> c)
                                 .camera_target = ruis::vec3(-1, -1, -1),
                                 .smooth_navigation_orbit = false,
                                 .smooth_navigation_zoom = false,
+                                .cache_dir = carcockpit::application::inst().cache_path
                             }
                         }
                     )
@@ -21,6 +21,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "scene_view.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 #include <ratio>
 
 #include <GLES2/gl2.h>
@@ -29,14 +32,33 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <fsif/native_file.hpp>
 #include <ruis/render/opengles/texture_2d.hpp>
 #include <ruis/res/texture_cube.hpp>
+#include <utki/config.hpp>
+#include <utki/util.hpp>
 
 #include "../ruis/render/scene/gltf_loader.hxx"
+#include "../ruis/render/scene/scene_cache.hxx"
 
 #include "application.hpp"
+#include "compressed_texture_2d.hpp"
 
 using namespace carcockpit;
 using namespace ruis::render;
 
+struct scene_view::loading_state {
+	ruis::render::load_progress progress;
+
+	// set by the loading thread when it has finished, the fields below are only accessed
+	// by the loading thread until then
+	std::atomic<bool> done{false};
+
+	std::optional<ruis::render::scene_data> data;
+	std::exception_ptr error;
+	ruis::render::scene_cache::statistics cache_stats;
+	std::vector<ruis::render::image_load_timing> image_timings;
+	ruis::render::index_optimization_statistics index_stats;
+	ruis::render::load_statistics load_stats;
+};
+
 scene_view::scene_view(utki::shared_ref<ruis::context> context, all_parameters params) :
 	ruis::widget( //
 		std::move(context),
@@ -44,27 +66,209 @@ scene_view::scene_view(utki::shared_ref<ruis::context> context, all_parameters p
 		std::move(params.widget_params)
 	),
 	params(std::move(params.scene_params))
+{
+	scene_renderer_v = std::make_shared<ruis::render::scene_renderer>(this->context);
+
+	camera_v = std::make_shared<ruis::render::camera>();
+	scene_renderer_v->set_external_camera(camera_v);
+	scene_renderer_v->set_scene_scaling_factor(this->params.scaling_factor);
+	scene_renderer_v->set_environment_cube(this->params.environment_cube);
+	scene_renderer_v->set_lod_thresholds(this->params.lod_thresholds);
+
+	this->progress_track_tex = this->context.get().loader().load<ruis::res::texture_2d>("texture_default_black");
+	this->progress_bar_tex = this->context.get().loader().load<ruis::res::texture_2d>("texture_default_white");
+
+	this->start_loading();
+}
+
+scene_view::~scene_view()
+{
+	if (this->loading) {
+		this->loading->progress.cancel();
+	}
+	if (this->loading_thread.joinable()) {
+		this->loading_thread.join();
+	}
+}
+
+float scene_view::get_loading_progress() const noexcept
+{
+	if (this->loading) {
+		return std::min(this->loading->progress.get(), 0.99f); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+	return 1;
+}
+
+void scene_view::start_loading()
 {
 	utki::log_debug([&](auto& o) {
 		o << "[LOAD GLTF] " << this->params.file << std::endl;
 	});
 
-	ruis::render::gltf_loader l(this->context.get().ren().rendering_context.get());
+	this->loading = std::make_shared<loading_state>();
+
+	// Reading the scene data does not need the rendering context, so it is done on a separate thread,
+	// the GPU objects are created later on the UI thread, see finish_loading().
+	auto read_scene = [loading = this->loading,
+					   rendering_context = this->context.get().ren().rendering_context,
+					   file = this->params.file,
+					   cache_dir = this->params.cache_dir,
+					   num_lods = this->params.num_lods]() {
+		try {
+			ruis::render::gltf_loader l(
+				rendering_context.get(),
+				{
+					// shader_pbr supports rendering interleaved vertex buffers
+					.interleave_vertex_attributes = true,
+					.optimize_indices = true,
+					.num_lods = num_lods
+				}
+			);
+
+			const fsif::native_file fi(file);
+
+			if (cache_dir.empty()) {
+				auto start = std::chrono::steady_clock::now();
+				loading->data = l.read(fi, &loading->progress, &loading->load_stats);
+				loading->cache_stats.read_time = std::chrono::steady_clock::now() - start;
+			} else {
+				loading->data = ruis::render::scene_cache(cache_dir).read(
+					fi, //
+					l,
+					&loading->cache_stats,
+					&loading->progress
+				);
+			}
+
+			loading->image_timings = l.get_image_timings();
+			loading->index_stats = l.get_index_optimization_statistics();
+		} catch (ruis::render::load_cancelled&) {
+			// the widget is being destroyed, nothing to do
+		} catch (...) {
+			loading->error = std::current_exception();
+		}
 
-	scene_v = l.load(fsif::native_file(this->params.file)).to_shared_ptr();
+		loading->done.store(true, std::memory_order_release);
+	};
 
-	scene_renderer_v = std::make_shared<ruis::render::scene_renderer>(this->context);
+#if CFG_OS_NAME == CFG_OS_NAME_EMSCRIPTEN
+	// no pthreads in emscripten build
+	read_scene();
+#else
+	this->loading_thread = std::thread(std::move(read_scene));
+#endif
+}
+
+void scene_view::finish_loading()
+{
+	ASSERT(this->loading)
+	ASSERT(this->loading->done)
+
+	if (this->loading_thread.joinable()) {
+		this->loading_thread.join();
+	}
+
+	auto loading = std::move(this->loading);
+
+	if (loading->error) {
+		try {
+			std::rethrow_exception(loading->error);
+		} catch (std::exception& e) {
+			std::cerr << "[LOAD GLTF] failed to load " << this->params.file << ": " << e.what() << std::endl;
+		}
+		return;
+	}
+
+	ASSERT(loading->data.has_value())
+	const auto& sd = loading->data.value();
+
+	std::vector<std::chrono::nanoseconds> upload_times(sd.images.size());
+
+	// picking tests the triangles, the scene data is dropped after the scene is made, so keep a copy of those
+	ruis::render::bvh::primitive_triangles triangles;
+
+	auto upload_start = std::chrono::steady_clock::now();
+	auto new_scene = ruis::render::make_scene(
+		this->context.get().ren().rendering_context.get(), //
+		sd,
+		upload_times,
+		// same models, or their parts, can be shown by several scene views, share their GPU resources
+		&ruis::render::gpu_resource_cache::inst(),
+		compressed_texture_2d::make_factory(this->context.get().ren().rendering_context),
+		&triangles
+	);
+	auto upload_time = std::chrono::steady_clock::now() - upload_start;
+
+	scene_v = new_scene.to_shared_ptr();
 	scene_renderer_v->set_scene(scene_v);
 
-	camera_v = std::make_shared<ruis::render::camera>();
-	scene_renderer_v->set_external_camera(camera_v);
-	scene_renderer_v->set_scene_scaling_factor(this->params.scaling_factor);
-	scene_renderer_v->set_environment_cube(this->params.environment_cube);
+	this->bvh_v.build(
+		*scene_v, //
+		std::move(triangles)
+	);
+
+	utki::log_debug([&](auto& o) {
+		using std::chrono::duration_cast;
+		using std::chrono::microseconds;
+		o << "[LOAD GLTF] " << this->params.file << (loading->cache_stats.hit ? " warm (from cache)" : " cold")
+		  << " read = " << duration_cast<microseconds>(loading->cache_stats.read_time).count()
+		  << " us, upload = " << duration_cast<microseconds>(upload_time).count() << " us" << std::endl;
+		for (const auto& t : loading->image_timings) {
+			o << "[LOAD GLTF]   image '" << t.name << "': " << t.encoded_size
+			  << " bytes, decode = " << duration_cast<microseconds>(t.decode_time).count() << " us" << std::endl;
+		}
+		for (size_t i = 0; i != upload_times.size(); ++i) {
+			o << "[LOAD GLTF]   image #" << i
+			  << " upload = " << duration_cast<microseconds>(upload_times[i]).count() << " us" << std::endl;
+		}
+
+		// only collected when the scene cache is not used
+		if (const auto& ls = loading->load_stats; ls.get_total_time().count() != 0) {
+			using stage = ruis::render::load_statistics::stage;
+			auto us = [&](stage st) {
+				return duration_cast<microseconds>(ls.get_time(st)).count();
+			};
+			o << "[LOAD GLTF]   stages: file read = " << us(stage::file_read) << " us, JSON = " << us(stage::json_parse)
+			  << " us, buffers = " << us(stage::buffer_decode) << " us, images = " << us(stage::image_decode)
+			  << " us, accessors = " << us(stage::accessor_decode)
+			  << " us, tangents = " << us(stage::tangent_generation)
+			  << " us, indices = " << us(stage::index_optimization) << " us, LODs = " << us(stage::lod_generation)
+			  << " us, build = " << us(stage::scene_build) << " us" << std::endl;
+			o << "[LOAD GLTF]   " << ls.bytes_read << " bytes read, " << ls.bytes_decoded << " bytes decoded, "
+			  << ls.retained_memory << " bytes retained, " << ls.peak_temporary_memory << " bytes peak, "
+			  << ls.num_vertices << " vertices, " << ls.num_triangles << " triangles, " << ls.num_primitives
+			  << " primitives, " << ls.num_textures << " textures, " << ls.num_lod_triangles << " LOD triangles"
+			  << std::endl;
+		}
+
+		// statistics are empty when the scene data comes from the cache
+		if (const auto& is = loading->index_stats; is.num_triangles != 0) {
+			o << "[LOAD GLTF]   index optimization: " << is.num_primitives << " primitives, " << is.num_triangles
+			  << " triangles, ACMR " << is.get_acmr_before() << " -> " << is.get_acmr_after() << ", "
+			  << is.num_downconverted << " index buffers converted to 16-bit" << std::endl;
+		}
+
+		auto stats = ruis::render::gpu_resource_cache::inst().get_statistics();
+		auto print = [&](std::string_view name, const ruis::render::gpu_resource_cache::counters& c) {
+			o << "[LOAD GLTF]   GPU cache " << name << ": hits = " << c.hits << ", misses = " << c.misses
+			  << ", saved = " << c.saved_bytes << " bytes, live = " << c.live_entries << " (" << c.live_bytes
+			  << " bytes)" << std::endl;
+		};
+		print("textures", stats.textures);
+		print("vertex buffers", stats.vertex_buffers);
+		print("index buffers", stats.index_buffers);
+	});
 }
 
 void scene_view::update(uint32_t dt)
 {
-	scene_v->update(dt);
+	if (this->loading && this->loading->done.load(std::memory_order_acquire)) {
+		this->finish_loading();
+	}
+
+	if (scene_v) {
+		scene_v->update(dt);
+	}
 
 	this->fps_sec_counter += dt;
 	this->time += dt;
@@ -72,7 +276,7 @@ void scene_view::update(uint32_t dt)
 	float dt_sec = float(dt) / std::milli::den;
 	++this->fps;
 
-	auto light = scene_v->get_primary_light();
+	auto light = scene_v ? scene_v->get_primary_light() : nullptr;
 	if (light) {
 		// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
 		float light_x = 3 * cosf(time_sec / 2);
@@ -131,11 +335,57 @@ ruis::event_status scene_view::on_mouse_button(const ruis::mouse_button_event& e
 		if (e.action == ruis::button_action::press) {
 			mouse_changeview_start = e.pos;
 			camera_changeview_start = camera_position;
+
+			if (const auto* n = this->pick(e.pos)) {
+				utki::log_debug([&](auto& o) {
+					o << "[PICK] node '" << n->name << "'" << std::endl;
+				});
+				if (this->pick_handler) {
+					this->pick_handler(*this, *n);
+				}
+			}
 		}
 	}
 	return ruis::event_status::consumed;
 }
 
+const ruis::render::node* scene_view::pick(const ruis::vec2& pos)
+{
+	if (!scene_v) {
+		return nullptr;
+	}
+
+	// node transformations could have been changed since the hierarchy was built
+	this->bvh_v.refit(*scene_v);
+
+	auto dims = this->rect().d;
+
+	// the point in normalized device coordinates, y axis of the widget goes down
+	ruis::vec2 ndc{pos.x() / dims.x() * 2 - 1, 1 - pos.y() / dims.y() * 2};
+
+	auto forward = (camera_v->target - camera_v->pos).normalize();
+	auto right = forward.cross(camera_v->up).normalize();
+	auto up = right.cross(forward);
+
+	auto tan_half_fovy = std::tan(camera_v->fovy / 2);
+	auto aspect = dims.x() / dims.y();
+
+	ruis::vec3 direction = forward + right * (ndc.x() * tan_half_fovy * aspect) + up * (ndc.y() * tan_half_fovy);
+
+	// the scene is scaled when rendered, see scene_renderer::set_scene_scaling_factor()
+	const ruis::render::ray r{
+		.origin = camera_v->pos / this->params.scaling_factor,
+		.direction = direction / this->params.scaling_factor
+	};
+
+	auto hit = this->bvh_v.find_closest_hit(r);
+	if (!hit) {
+		return nullptr;
+	}
+
+	return scene_v->get_flat_nodes()[this->bvh_v.get_items()[hit->item_index].node_index];
+}
+
 ruis::event_status scene_view::on_mouse_move(const ruis::mouse_move_event& e)
 {
 	constexpr float mouse_orbit_speed_multiplier = 2.0f;
@@ -200,4 +450,47 @@ void scene_view::render(const ruis::mat4& matrix) const
 	camera_v->fovy = ruis::real(utki::pi) / 4;
 
 	this->scene_renderer_v->render(rect().d, viewport_matrix);
+
+	if (this->loading) {
+		this->render_loading_progress(matrix);
+	}
+}
+
+void scene_view::render_loading_progress(const ruis::mat4& matrix) const
+{
+	// the bar is horizontally centered near the bottom of the view
+	constexpr auto bar_width = ruis::real(0.5);
+	constexpr auto bar_height = ruis::real(0.02);
+	constexpr auto bar_bottom_margin = ruis::real(0.1);
+	constexpr auto min_bar_height = ruis::real(2);
+
+	ruis::vec2 bar_dims{
+		this->rect().d.x() * bar_width, //
+		std::max(this->rect().d.y() * bar_height, min_bar_height)
+	};
+	ruis::vec2 bar_pos{
+		(this->rect().d.x() - bar_dims.x()) / 2, //
+		this->rect().d.y() * (1 - bar_bottom_margin) - bar_dims.y()
+	};
+
+	auto& r = this->context.get().ren().rendering_context.get();
+	bool depth = r.is_depth_enabled();
+	r.enable_depth(false);
+	utki::scope_exit scope_exit([&r, depth]() {
+		r.enable_depth(depth);
+	});
+
+	ruis::mat4 m(matrix);
+	m.translate(bar_pos);
+	m.scale(bar_dims);
+	this->context.get().ren().render(
+		m, //
+		this->progress_track_tex->tex()
+	);
+
+	m.scale(this->get_loading_progress(), 1);
+	this->context.get().ren().render(
+		m, //
+		this->progress_bar_tex->tex()
+	);
 }
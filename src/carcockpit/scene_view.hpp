@@ -21,12 +21,16 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <functional>
+#include <thread>
+
 #include <ruis/res/texture_2d.hpp>
 #include <ruis/res/texture_cube.hpp>
 #include <ruis/updateable.hpp>
 #include <ruis/widget/base/fraction_widget.hpp>
 #include <ruis/widget/widget.hpp>
 
+#include "../ruis/render/scene/bvh.hpp"
 #include "../ruis/render/scene/scene.hpp"
 #include "../ruis/render/scene/scene_renderer.hxx"
 
@@ -48,6 +52,13 @@ class scene_view :
 	std::shared_ptr<ruis::render::scene_renderer> scene_renderer_v;
 	std::shared_ptr<ruis::render::camera> camera_v;
 
+	// loading progress bar is drawn with plain black and white textures
+	std::shared_ptr<const ruis::res::texture_2d> progress_track_tex;
+	std::shared_ptr<const ruis::res::texture_2d> progress_bar_tex;
+
+	// spatial index of the scene primitives for picking, built when the scene is loaded
+	ruis::render::bvh bvh_v;
+
 	ruis::vec3 camera_position = default_camera_position_top;
 
 	// camera attractor is a mechanism to provide smooth camra movement. On update() camera always moves a bit
@@ -70,6 +81,21 @@ class scene_view :
 	uint32_t fps_sec_counter = 0;
 	uint32_t time = 0;
 
+	// scene is loaded in background, the state is shared with the loading thread
+	struct loading_state;
+	std::shared_ptr<loading_state> loading;
+	std::thread loading_thread;
+
+	void start_loading();
+
+	// creates GPU objects of the loaded scene, called on UI thread when loading thread has finished
+	void finish_loading();
+
+	void render_loading_progress(const ruis::mat4& matrix) const;
+
+	// finds the node whose primitive triangles are hit first by the camera ray through the point in widget coordinates
+	const ruis::render::node* pick(const ruis::vec2& pos);
+
 public:
 	struct parameters {
 		std::string file;
@@ -80,6 +106,25 @@ public:
 		ruis::real orbit_angle_upper_limit = ruis::real(utki::pi) / 2;
 		ruis::real orbit_angle_lower_limit = ruis::real(utki::pi) / 2;
 		std::shared_ptr<const ruis::res::texture_cube> environment_cube;
+
+		/**
+		 * @brief Directory for the scene cache files.
+		 * If empty, the scene cache is not used.
+		 */
+		std::string cache_dir;
+
+		/**
+		 * @brief Number of levels of detail to generate for each mesh primitive when loading the scene.
+		 * Scene views are often small, so simplified meshes are drawn when the model is small on screen.
+		 */
+		unsigned num_lods = 3;
+
+		/**
+		 * @brief Screen coverage thresholds of the levels of detail.
+		 * See ruis::render::scene_renderer::set_lod_thresholds().
+		 */
+		// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+		std::vector<ruis::real> lod_thresholds = {0.5, 0.25, 0.125};
 	};
 
 private:
@@ -92,11 +137,41 @@ public:
 		parameters scene_params;
 	};
 
+	/**
+	 * @brief Create scene view.
+	 * The scene file is loaded in background, until the scene is loaded the view renders
+	 * the environment and the loading progress bar.
+	 */
 	scene_view(
 		utki::shared_ref<ruis::context> context, //
 		all_parameters params
 	);
 
+	scene_view(const scene_view&) = delete;
+	scene_view& operator=(const scene_view&) = delete;
+
+	scene_view(scene_view&&) = delete;
+	scene_view& operator=(scene_view&&) = delete;
+
+	/**
+	 * @brief Destroy scene view.
+	 * Cancels the scene loading if it is still in progress.
+	 */
+	~scene_view() override;
+
+	/**
+	 * @brief Scene node tap handler.
+	 * Called when a scene node is clicked or tapped, i.e. the node whose primitive triangles are hit
+	 * first by the ray from the camera through the tapped point.
+	 */
+	std::function<void(scene_view& v, const ruis::render::node& n)> pick_handler;
+
+	/**
+	 * @brief Get scene loading progress.
+	 * @return Value from 0 to 1, 1 means the scene is loaded and is being rendered.
+	 */
+	float get_loading_progress() const noexcept;
+
 	void render(const ruis::mat4& matrix) const override;
 	void update(uint32_t dt) override;
 
@@ -28,6 +28,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ruis/render/opengles/vertex_array.hpp>
 #include <ruis/render/opengles/vertex_buffer.hpp>
 
+#include "../compressed_texture_2d.hpp"
+
 using namespace ruis::render;
 
 constexpr ruis::vec3 default_light_position{5.0f, 5.0f, 5.0f};
@@ -82,7 +84,20 @@ shader_pbr::shader_pbr() :
 							gl_Position = matrix * a0;
 						}
 	)qwertyuiop",
-		R"qwertyuiop(
+		fragment_shader_code
+	),
+	sampler_normal_map(this->get_uniform("texture1")),
+	sampler_roughness_map(this->get_uniform("texture2")),
+	sampler_cube(this->get_uniform("texture3")),
+	mat4_mvp(this->get_uniform("matrix")),
+	mat4_modelview(this->get_uniform("mat4_mv")),
+	mat3_normal(this->get_uniform("mat3_n")),
+	vec3_light_position(this->get_uniform("light_position")),
+	vec3_light_intensity(this->get_uniform("light_intensity"))
+{}
+
+const char* const shader_pbr::fragment_shader_code =
+	R"qwertyuiop(
 						precision highp float;
 
 						varying highp vec3 light_dir;
@@ -138,16 +153,7 @@ shader_pbr::shader_pbr() :
 							gl_FragColor = vec4( phong_model( normal, tex_color.rgb, arm.x, gloss, arm.z), 1.0 );
 						}
 
-	)qwertyuiop"
-	),
-	sampler_normal_map(this->get_uniform("texture1")),
-	sampler_roughness_map(this->get_uniform("texture2")),
-	sampler_cube(this->get_uniform("texture3")),
-	mat4_modelview(this->get_uniform("mat4_mv")),
-	mat3_normal(this->get_uniform("mat3_n")),
-	vec3_light_position(this->get_uniform("light_position")),
-	vec3_light_intensity(this->get_uniform("light_intensity"))
-{}
+	)qwertyuiop";
 
 void shader_pbr::render(
 	const ruis::render::vertex_array& va,
@@ -159,7 +165,9 @@ void shader_pbr::render(
 	const ruis::render::texture_2d& tex_roughness,
 	const ruis::render::texture_cube& tex_cube_env,
 	const ruis::vec4& light_pos = default_light_position,
-	const ruis::vec3& light_int = default_light_intensity
+	const ruis::vec3& light_int = default_light_intensity,
+	const ruis::render::vertex_layout* interleaved_layout,
+	const std::array<ruis::render::texture_wrapping, 3>& wrapping
 ) const
 {
 	this->bind();
@@ -168,15 +176,12 @@ void shader_pbr::render(
 	this->set_uniform_sampler(sampler_roughness_map, 2);
 	this->set_uniform_sampler(sampler_cube, 3);
 
-	ASSERT(dynamic_cast<const ruis::render::opengles::texture_2d*>(&tex_color));
-	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
-	static_cast<const ruis::render::opengles::texture_2d&>(tex_color).bind(0);
-	ASSERT(dynamic_cast<const ruis::render::opengles::texture_2d*>(&tex_normal));
-	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
-	static_cast<const ruis::render::opengles::texture_2d&>(tex_normal).bind(1);
-	ASSERT(dynamic_cast<const ruis::render::opengles::texture_2d*>(&tex_roughness));
-	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
-	static_cast<const ruis::render::opengles::texture_2d&>(tex_roughness).bind(2);
+	bind_texture(tex_color, 0);
+	apply_wrapping(wrapping[0]);
+	bind_texture(tex_normal, 1);
+	apply_wrapping(wrapping[1]);
+	bind_texture(tex_roughness, 2);
+	apply_wrapping(wrapping[2]);
 	ASSERT(dynamic_cast<const ruis::render::opengles::texture_2d*>(&tex_roughness));
 	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
 	static_cast<const ruis::render::opengles::texture_cube&>(tex_cube_env).bind(3);
@@ -190,5 +195,123 @@ void shader_pbr::render(
 	this->set_uniform_matrix4f(this->mat4_modelview, modelview);
 	this->set_uniform_matrix3f(mat3_normal, normal);
 
-	this->shader_base::render(mvp, va);
-}
\ No newline at end of file
+	if (interleaved_layout) {
+		this->render_interleaved(mvp, va, *interleaved_layout);
+	} else {
+		this->shader_base::render(mvp, va);
+	}
+}
+
+void shader_pbr::bind_texture(const ruis::render::texture_2d& tex, unsigned unit_num)
+{
+	if (const auto* compressed = dynamic_cast<const carcockpit::compressed_texture_2d*>(&tex)) {
+		compressed->bind(unit_num);
+		return;
+	}
+
+	ASSERT(dynamic_cast<const ruis::render::opengles::texture_2d*>(&tex));
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
+	static_cast<const ruis::render::opengles::texture_2d&>(tex).bind(unit_num);
+}
+
+void shader_pbr::apply_wrapping(const ruis::render::texture_wrapping& wrapping)
+{
+	auto to_gl = [](ruis::render::texture_wrapping::mode m) -> GLint {
+		switch (m) {
+			case ruis::render::texture_wrapping::mode::clamp_to_edge:
+				return GL_CLAMP_TO_EDGE;
+			case ruis::render::texture_wrapping::mode::mirrored_repeat:
+				return GL_MIRRORED_REPEAT;
+			case ruis::render::texture_wrapping::mode::repeat:
+			default:
+				return GL_REPEAT;
+		}
+	};
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, to_gl(wrapping.s));
+	ruis::render::opengles::assert_opengl_no_error();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, to_gl(wrapping.t));
+	ruis::render::opengles::assert_opengl_no_error();
+}
+
+void shader_pbr::render_interleaved(
+	const r4::matrix4<float>& mvp,
+	const ruis::render::vertex_array& va,
+	const ruis::render::vertex_layout& layout
+) const
+{
+	// The generic vertex array binding assumes one vertex buffer per attribute,
+	// so bind the single interleaved buffer with attribute offsets and stride here.
+
+	ASSERT(dynamic_cast<const ruis::render::opengles::index_buffer*>(&va.indices.get()))
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
+	const auto& ibo = static_cast<const ruis::render::opengles::index_buffer&>(va.indices.get());
+
+	this->set_uniform_matrix4f(this->mat4_mvp, mvp);
+
+	enable_interleaved_attributes(va, layout);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo.buffer);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	ASSERT(va.rendering_mode == ruis::render::vertex_array::mode::triangles)
+	glDrawElements(GL_TRIANGLES, ibo.elements_count, ibo.element_type, nullptr);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	disable_interleaved_attributes(layout);
+}
+
+void shader_pbr::enable_interleaved_attributes(
+	const ruis::render::vertex_array& va, //
+	const ruis::render::vertex_layout& layout
+)
+{
+	ASSERT(va.buffers.size() == 1)
+	ASSERT(dynamic_cast<const ruis::render::opengles::vertex_buffer*>(&va.buffers.front().get()))
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
+	const auto& vbo = static_cast<const ruis::render::opengles::vertex_buffer&>(va.buffers.front().get());
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo.buffer);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	auto to_gl_type = [](ruis::render::vertex_layout::component_type t) -> GLenum {
+		switch (t) {
+			case ruis::render::vertex_layout::component_type::int8:
+				return GL_BYTE;
+			case ruis::render::vertex_layout::component_type::uint8:
+				return GL_UNSIGNED_BYTE;
+			case ruis::render::vertex_layout::component_type::int16:
+				return GL_SHORT;
+			case ruis::render::vertex_layout::component_type::uint16:
+				return GL_UNSIGNED_SHORT;
+			case ruis::render::vertex_layout::component_type::float32:
+			default:
+				return GL_FLOAT;
+		}
+	};
+
+	for (GLuint i = 0; i != layout.attributes.size(); ++i) {
+		const auto& a = layout.attributes[i];
+		glEnableVertexAttribArray(i);
+		ruis::render::opengles::assert_opengl_no_error();
+		// quantized attributes are converted to float by GPU during vertex fetch
+		glVertexAttribPointer(
+			i,
+			GLint(a.num_components),
+			to_gl_type(a.type),
+			a.normalized ? GL_TRUE : GL_FALSE,
+			GLsizei(layout.stride),
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+			reinterpret_cast<const GLvoid*>(uintptr_t(a.offset))
+		);
+		ruis::render::opengles::assert_opengl_no_error();
+	}
+}
+
+void shader_pbr::disable_interleaved_attributes(const ruis::render::vertex_layout& layout)
+{
+	for (GLuint i = 0; i != layout.attributes.size(); ++i) {
+		glDisableVertexAttribArray(i);
+		ruis::render::opengles::assert_opengl_no_error();
+	}
+}
@@ -21,11 +21,15 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <array>
+
 #include <ruis/config.hpp>
 #include <ruis/render/opengles/shader_base.hpp>
 #include <ruis/render/texture_2d.hpp>
 #include <ruis/render/texture_cube.hpp>
 
+#include "../../ruis/render/scene/mesh.hpp"
+
 namespace ruis::render {
 
 /**
@@ -41,11 +45,54 @@ namespace ruis::render {
  */
 class shader_pbr : public ruis::render::opengles::shader_base
 {
+	void render_interleaved(
+		const r4::matrix4<float>& mvp,
+		const ruis::render::vertex_array& va,
+		const ruis::render::vertex_layout& layout
+	) const;
+
 public:
+	/**
+	 * @brief Fragment shader code.
+	 * Shared with the instanced variant of the shader, see shader_pbr_instanced.
+	 */
+	static const char* const fragment_shader_code;
+
+	/**
+	 * @brief Set wrapping of the texture bound to the active texture unit.
+	 * @param wrapping - texture wrapping.
+	 */
+	static void apply_wrapping(const ruis::render::texture_wrapping& wrapping);
+
+	/**
+	 * @brief Bind texture to texture unit.
+	 * @param tex - either rendering context texture or compressed texture.
+	 * @param unit_num - texture unit number.
+	 */
+	static void bind_texture(const ruis::render::texture_2d& tex, unsigned unit_num);
+
+	/**
+	 * @brief Bind interleaved vertex data to vertex attributes.
+	 * The vertex array's single vertex buffer is bound to attributes 0 to number of layout attributes.
+	 * @param va - vertex array with single interleaved vertex buffer.
+	 * @param layout - layout of the interleaved vertex data.
+	 */
+	static void enable_interleaved_attributes(
+		const ruis::render::vertex_array& va, //
+		const ruis::render::vertex_layout& layout
+	);
+
+	/**
+	 * @brief Unbind vertex attributes bound by enable_interleaved_attributes().
+	 * @param layout - layout of the interleaved vertex data.
+	 */
+	static void disable_interleaved_attributes(const ruis::render::vertex_layout& layout);
+
 	GLint sampler_normal_map;
 	GLint sampler_roughness_map;
 	GLint sampler_cube;
 
+	GLint mat4_mvp;
 	GLint mat4_modelview;
 	GLint mat3_normal;
 
@@ -64,7 +111,9 @@ public:
 		const ruis::render::texture_2d& tex_roughness,
 		const ruis::render::texture_cube& tex_cube_env,
 		const ruis::vec4& light_pos,
-		const ruis::vec3& light_int
+		const ruis::vec3& light_int,
+		const ruis::render::vertex_layout* interleaved_layout = nullptr,
+		const std::array<ruis::render::texture_wrapping, 3>& wrapping = {}
 	) const;
 };
 
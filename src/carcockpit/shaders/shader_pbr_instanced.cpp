@@ -0,0 +1,272 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "shader_pbr_instanced.hpp"
+
+#include <string_view>
+
+#include <GLES3/gl3.h>
+#include <ruis/render/opengles/index_buffer.hpp>
+#include <ruis/render/opengles/texture_cube.hpp>
+#include <ruis/render/opengles/util.hpp>
+
+#include "shader_pbr.hpp"
+
+using namespace ruis::render;
+
+namespace {
+// Per-instance attributes follow the per-vertex attributes a0 to a4. The mat4 attribute
+// takes 4 consecutive attribute locations, one per column, and mat3 attribute takes 3 locations.
+constexpr GLuint modelview_attribute = 5;
+constexpr GLuint normal_attribute = 9;
+constexpr GLuint num_attributes = 12;
+
+constexpr size_t modelview_size = 16;
+constexpr size_t normal_size = 9;
+constexpr size_t instance_size = modelview_size + normal_size;
+} // namespace
+
+shader_pbr_instanced::shader_pbr_instanced() :
+	shader_base(
+		R"qwertyuiop(
+						attribute highp vec4 a0; // position
+						attribute highp vec2 a1; // texture coordinate
+						attribute highp vec3 a2; // normal
+						attribute highp vec3 a3; // tangent
+						attribute highp vec3 a4; // bitangent
+
+						attribute highp mat4 a5; // per-instance modelview matrix, takes locations 5 to 8
+						attribute highp mat3 a9; // per-instance normal matrix, takes locations 9 to 11
+
+						uniform highp mat4 matrix; // projection matrix
+
+						uniform vec3 light_position;
+						uniform vec3 light_intensity;
+
+						varying highp vec3 light_dir;
+						varying highp vec3 view_dir;
+						varying highp vec2 tc;
+
+						void main()
+						{
+							// Transform normal and tangent to eye space
+							vec3 normal = normalize(a9 * a2);
+							vec3 tangent = normalize(a9 * a3);
+							vec3 bitangent = normalize(a9 * a4);
+
+							// matrix for transformation to tangent space
+							mat3 mat3_to_tangent = mat3(
+								tangent.x, bitangent.x, normal.x,
+								tangent.y, bitangent.y, normal.y,
+								tangent.z, bitangent.z, normal.z
+							);
+
+							// get the position in eye coordinates
+							vec4 pos4 = a5 * a0;
+							vec3 pos = vec3(pos4);
+
+							// Transform light direction and view direction to tangent space
+							light_dir = normalize( mat3_to_tangent * (light_position - pos) );
+							view_dir = mat3_to_tangent * normalize(-pos);
+
+							tc = vec2(a1.x, 1.0 - a1.y);
+							gl_Position = matrix * pos4;
+						}
+	)qwertyuiop",
+		shader_pbr::fragment_shader_code
+	),
+	sampler_normal_map(this->get_uniform("texture1")),
+	sampler_roughness_map(this->get_uniform("texture2")),
+	sampler_cube(this->get_uniform("texture3")),
+	mat4_projection(this->get_uniform("matrix")),
+	vec3_light_position(this->get_uniform("light_position")),
+	vec3_light_intensity(this->get_uniform("light_intensity"))
+{
+	glGenBuffers(1, &this->instance_buffer);
+	ruis::render::opengles::assert_opengl_no_error();
+}
+
+shader_pbr_instanced::~shader_pbr_instanced()
+{
+	glDeleteBuffers(1, &this->instance_buffer);
+}
+
+bool shader_pbr_instanced::is_supported()
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	const auto* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	ruis::render::opengles::assert_opengl_no_error();
+	if (!version) {
+		return false;
+	}
+
+	// version string format is "OpenGL ES <major>.<minor> <vendor specific info>"
+	constexpr std::string_view prefix = "OpenGL ES ";
+	std::string_view v(version);
+	if (!v.starts_with(prefix) || v.size() == prefix.size()) {
+		return false;
+	}
+
+	constexpr char min_major_version = '3';
+	if (v[prefix.size()] < min_major_version) {
+		return false;
+	}
+
+	GLint max_attributes = 0;
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attributes);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	return max_attributes >= GLint(num_attributes);
+}
+
+void shader_pbr_instanced::render(
+	const ruis::render::vertex_array& va,
+	const ruis::render::vertex_layout& layout,
+	utki::span<const ruis::mat4> model_matrices,
+	const r4::matrix4<float>& view,
+	const r4::matrix4<float>& projection,
+	const ruis::render::texture_2d& tex_color,
+	const ruis::render::texture_2d& tex_normal,
+	const ruis::render::texture_2d& tex_roughness,
+	const ruis::render::texture_cube& tex_cube_env,
+	const ruis::vec4& light_pos,
+	const ruis::vec3& light_int,
+	const std::array<ruis::render::texture_wrapping, 3>& wrapping
+) const
+{
+	ASSERT(layout.attributes.size() <= modelview_attribute)
+
+	if (model_matrices.empty()) {
+		return;
+	}
+
+	this->bind();
+
+	this->set_uniform_sampler(sampler_normal_map, 1);
+	this->set_uniform_sampler(sampler_roughness_map, 2);
+	this->set_uniform_sampler(sampler_cube, 3);
+
+	shader_pbr::bind_texture(tex_color, 0);
+	shader_pbr::apply_wrapping(wrapping[0]);
+	shader_pbr::bind_texture(tex_normal, 1);
+	shader_pbr::apply_wrapping(wrapping[1]);
+	shader_pbr::bind_texture(tex_roughness, 2);
+	shader_pbr::apply_wrapping(wrapping[2]);
+	ASSERT(dynamic_cast<const ruis::render::opengles::texture_cube*>(&tex_cube_env))
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
+	static_cast<const ruis::render::opengles::texture_cube&>(tex_cube_env).bind(3);
+
+	this->set_uniform3f(this->vec3_light_position, light_pos[0], light_pos[1], light_pos[2]);
+	this->set_uniform3f(this->vec3_light_intensity, light_int[0], light_int[1], light_int[2]);
+	this->set_uniform_matrix4f(this->mat4_projection, projection);
+
+	// matrix vertex attributes are read by columns
+	this->instance_data.resize(model_matrices.size() * instance_size);
+	auto* dst = this->instance_data.data();
+	for (const auto& model : model_matrices) {
+		ruis::mat4 modelview = view * model;
+
+		ruis::mat3 normal = modelview.submatrix<0, 0, 3, 3>();
+		normal.invert();
+		normal.transpose();
+
+		for (size_t c = 0; c != 4; ++c) {
+			for (size_t r = 0; r != 4; ++r) {
+				*dst = modelview[r][c];
+				++dst;
+			}
+		}
+		for (size_t c = 0; c != 3; ++c) {
+			for (size_t r = 0; r != 3; ++r) {
+				*dst = normal[r][c];
+				++dst;
+			}
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->instance_buffer);
+	ruis::render::opengles::assert_opengl_no_error();
+	// orphan the previous buffer storage, so that the driver does not need to wait until
+	// previous draw calls using it are finished
+	glBufferData(
+		GL_ARRAY_BUFFER,
+		GLsizeiptr(this->instance_data.size() * sizeof(float)),
+		this->instance_data.data(),
+		GL_STREAM_DRAW
+	);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	constexpr auto stride = GLsizei(instance_size * sizeof(float));
+
+	auto enable_instance_attribute = [&](GLuint index, GLint num_components, size_t offset) {
+		glEnableVertexAttribArray(index);
+		ruis::render::opengles::assert_opengl_no_error();
+		glVertexAttribPointer(
+			index,
+			num_components,
+			GL_FLOAT,
+			GL_FALSE,
+			stride,
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+			reinterpret_cast<const GLvoid*>(offset * sizeof(float))
+		);
+		ruis::render::opengles::assert_opengl_no_error();
+		glVertexAttribDivisor(index, 1);
+		ruis::render::opengles::assert_opengl_no_error();
+	};
+
+	for (GLuint c = 0; c != 4; ++c) {
+		enable_instance_attribute(modelview_attribute + c, 4, c * 4);
+	}
+	for (GLuint c = 0; c != 3; ++c) {
+		enable_instance_attribute(normal_attribute + c, 3, modelview_size + c * 3);
+	}
+
+	shader_pbr::enable_interleaved_attributes(va, layout);
+
+	ASSERT(dynamic_cast<const ruis::render::opengles::index_buffer*>(&va.indices.get()))
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast)
+	const auto& ibo = static_cast<const ruis::render::opengles::index_buffer&>(va.indices.get());
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo.buffer);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	ASSERT(va.rendering_mode == ruis::render::vertex_array::mode::triangles)
+	glDrawElementsInstanced(
+		GL_TRIANGLES, //
+		ibo.elements_count,
+		ibo.element_type,
+		nullptr,
+		GLsizei(model_matrices.size())
+	);
+	ruis::render::opengles::assert_opengl_no_error();
+
+	shader_pbr::disable_interleaved_attributes(layout);
+
+	// attribute divisors are part of the vertex array state, reset those so that
+	// other shaders using same attribute locations are not affected
+	for (GLuint i = modelview_attribute; i != num_attributes; ++i) {
+		glVertexAttribDivisor(i, 0);
+		ruis::render::opengles::assert_opengl_no_error();
+		glDisableVertexAttribArray(i);
+		ruis::render::opengles::assert_opengl_no_error();
+	}
+}
@@ -0,0 +1,104 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <ruis/config.hpp>
+#include <ruis/render/opengles/shader_base.hpp>
+#include <ruis/render/texture_2d.hpp>
+#include <ruis/render/texture_cube.hpp>
+#include <utki/span.hpp>
+
+#include "../../ruis/render/scene/mesh.hpp"
+
+namespace ruis::render {
+
+/**
+ * @brief Instanced variant of the PBR shader.
+ * Draws many instances of a primitive with a single draw call. Per-instance modelview and normal matrices
+ * are passed to the shader as vertex attributes with attribute divisor of 1, the rest of the
+ * shader is same as the shader_pbr.
+ * Instanced drawing needs OpenGL ES 3.0, see is_supported().
+ */
+class shader_pbr_instanced : public ruis::render::opengles::shader_base
+{
+	// buffer for per-instance vertex attributes
+	GLuint instance_buffer = 0;
+
+	// per-instance vertex attributes data, kept to avoid memory allocations on every frame
+	mutable std::vector<float> instance_data;
+
+public:
+	GLint sampler_normal_map;
+	GLint sampler_roughness_map;
+	GLint sampler_cube;
+
+	GLint mat4_projection;
+
+	GLint vec3_light_position;
+	GLint vec3_light_intensity;
+
+	shader_pbr_instanced();
+
+	shader_pbr_instanced(const shader_pbr_instanced&) = delete;
+	shader_pbr_instanced& operator=(const shader_pbr_instanced&) = delete;
+
+	shader_pbr_instanced(shader_pbr_instanced&&) = delete;
+	shader_pbr_instanced& operator=(shader_pbr_instanced&&) = delete;
+
+	~shader_pbr_instanced();
+
+	/**
+	 * @brief Check if instanced drawing is supported by the current OpenGL context.
+	 * @return true if the context is OpenGL ES 3.0 or higher and has enough vertex attributes.
+	 * @return false otherwise.
+	 */
+	static bool is_supported();
+
+	/**
+	 * @brief Draw instances of a primitive.
+	 * Only interleaved vertex data is supported.
+	 * @param va - vertex array with single interleaved vertex buffer.
+	 * @param layout - layout of the interleaved vertex data.
+	 * @param model_matrices - model matrix of each instance.
+	 * @param view - view matrix.
+	 * @param projection - projection matrix.
+	 */
+	void render(
+		const ruis::render::vertex_array& va,
+		const ruis::render::vertex_layout& layout,
+		utki::span<const ruis::mat4> model_matrices,
+		const r4::matrix4<float>& view,
+		const r4::matrix4<float>& projection,
+		const ruis::render::texture_2d& tex_color,
+		const ruis::render::texture_2d& tex_normal,
+		const ruis::render::texture_2d& tex_roughness,
+		const ruis::render::texture_cube& tex_cube_env,
+		const ruis::vec4& light_pos,
+		const ruis::vec3& light_int,
+		const std::array<ruis::render::texture_wrapping, 3>& wrapping = {}
+	) const;
+};
+
+} // namespace ruis::render
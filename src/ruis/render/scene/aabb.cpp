@@ -0,0 +1,94 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "aabb.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace ruis::render;
+
+aabb aabb::transform(const ruis::mat4& m) const noexcept
+{
+	if (this->is_empty()) {
+		return {};
+	}
+
+	auto center = this->get_center();
+	auto extent = this->get_extent();
+
+	ruis::vec3 new_center;
+	ruis::vec3 new_extent;
+	for (size_t r = 0; r != 3; ++r) {
+		new_center[r] = m[r][3];
+		new_extent[r] = 0;
+		for (size_t c = 0; c != 3; ++c) {
+			new_center[r] += m[r][c] * center[c];
+			new_extent[r] += std::abs(m[r][c]) * extent[c];
+		}
+	}
+
+	return {
+		.min = new_center - new_extent, //
+		.max = new_center + new_extent
+	};
+}
+
+aabb aabb::from_points(utki::span<const ruis::vec3> points) noexcept
+{
+	static_assert(sizeof(ruis::vec3) == 3 * sizeof(ruis::real), "vec3 must be tightly packed");
+
+	// Four points are processed per iteration as twelve independent lanes of scalars, so that
+	// the compiler can vectorize the loop: with 4-wide SIMD each of the three registers holds
+	// components of different axes, those are separated after the loop.
+	constexpr size_t points_per_iteration = 4;
+	constexpr size_t num_lanes = points_per_iteration * 3;
+
+	std::array<ruis::real, num_lanes> min{};
+	std::array<ruis::real, num_lanes> max{};
+	min.fill(std::numeric_limits<ruis::real>::max());
+	max.fill(std::numeric_limits<ruis::real>::lowest());
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	const auto* data = reinterpret_cast<const ruis::real*>(points.data());
+	size_t num_full = points.size() / points_per_iteration * points_per_iteration;
+
+	for (const auto* p = data, *end = data + num_full * 3; p != end; p += num_lanes) {
+		for (size_t i = 0; i != num_lanes; ++i) {
+			min[i] = std::min(min[i], p[i]);
+			max[i] = std::max(max[i], p[i]);
+		}
+	}
+
+	aabb ret;
+	for (size_t i = 0; i != num_lanes; ++i) {
+		auto axis = i % 3;
+		ret.min[axis] = std::min(ret.min[axis], min[i]);
+		ret.max[axis] = std::max(ret.max[axis], max[i]);
+	}
+
+	for (const auto& p : points.subspan(num_full)) {
+		ret.extend(p);
+	}
+
+	return ret;
+}
@@ -0,0 +1,95 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <limits>
+
+#include <ruis/config.hpp>
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Axis-aligned bounding box.
+ * Default constructed box is empty, i.e. it contains no points.
+ */
+struct aabb {
+	ruis::vec3 min{std::numeric_limits<ruis::real>::max()};
+	ruis::vec3 max{std::numeric_limits<ruis::real>::lowest()};
+
+	bool is_empty() const noexcept
+	{
+		return this->min.x() > this->max.x() || this->min.y() > this->max.y() || this->min.z() > this->max.z();
+	}
+
+	ruis::vec3 get_center() const noexcept
+	{
+		return (this->min + this->max) / 2;
+	}
+
+	/**
+	 * @brief Get half of the box size along each axis.
+	 */
+	ruis::vec3 get_extent() const noexcept
+	{
+		return (this->max - this->min) / 2;
+	}
+
+	/**
+	 * @brief Extend the box to contain the point.
+	 */
+	void extend(const ruis::vec3& p) noexcept
+	{
+		this->min = r4::min(this->min, p);
+		this->max = r4::max(this->max, p);
+	}
+
+	/**
+	 * @brief Extend the box to contain another box.
+	 */
+	void extend(const aabb& b) noexcept
+	{
+		if (b.is_empty()) {
+			return;
+		}
+		this->extend(b.min);
+		this->extend(b.max);
+	}
+
+	/**
+	 * @brief Get bounding box of this box transformed by the matrix.
+	 * The result is the smallest axis-aligned box containing the transformed box,
+	 * see "Transforming Axis-Aligned Bounding Boxes" by James Arvo.
+	 * @param m - transformation matrix, projective part is ignored.
+	 * @return Transformed box, empty if this box is empty.
+	 */
+	aabb transform(const ruis::mat4& m) const noexcept;
+
+	/**
+	 * @brief Calculate bounding box of points.
+	 * @param points - points to calculate bounding box of.
+	 * @return Bounding box of the points, empty if there are no points.
+	 */
+	static aabb from_points(utki::span<const ruis::vec3> points) noexcept;
+};
+
+} // namespace ruis::render
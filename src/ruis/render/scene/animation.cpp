@@ -0,0 +1,446 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+
+#include "animation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+using namespace ruis::render;
+
+namespace {
+uint32_t get_num_components(animation::path p)
+{
+	return p == animation::path::rotation ? 4 : 3;
+}
+
+// cubic spline key consists of in-tangent, value and out-tangent
+constexpr uint32_t num_cubic_spline_key_values = 3;
+
+struct key_position {
+	uint32_t index;
+	uint32_t next;
+
+	// interpolation parameter between the keys, from 0 to 1
+	float t;
+
+	// time between the keys
+	float interval;
+};
+
+key_position find_key(
+	utki::span<const float> key_times, //
+	float time,
+	uint32_t& cursor
+)
+{
+	ASSERT(!key_times.empty())
+
+	auto last = uint32_t(key_times.size() - 1);
+
+	if (time <= key_times.front()) {
+		return {.index = 0, .next = 0, .t = 0, .interval = 0};
+	}
+	if (time >= key_times.back()) {
+		return {.index = last, .next = last, .t = 0, .interval = 0};
+	}
+
+	// the time is between the first and the last keys, so there are at least two keys
+	auto is_within = [&](uint32_t k) {
+		return k < last && key_times[k] <= time && time < key_times[k + 1];
+	};
+
+	if (!is_within(cursor)) {
+		if (is_within(cursor + 1)) {
+			++cursor;
+		} else {
+			auto i = std::upper_bound(key_times.begin(), key_times.end(), time);
+			cursor = uint32_t(std::distance(key_times.begin(), i) - 1);
+		}
+	}
+	ASSERT(is_within(cursor))
+
+	auto interval = key_times[cursor + 1] - key_times[cursor];
+	return {
+		.index = cursor, //
+		.next = cursor + 1,
+		.t = (time - key_times[cursor]) / interval,
+		.interval = interval
+	};
+}
+
+// Lanes are processed in blocks of fixed size. Loops over the lanes of a block have constant trip count
+// and work on local copies of the lane data, so the compiler vectorizes those without runtime checks
+// for the remainder or for the arrays' aliasing. Lane arrays are padded to a whole number of blocks.
+constexpr size_t lane_block_size = 8;
+
+using lane_block = std::array<float, lane_block_size>;
+
+size_t pad_to_lane_blocks(size_t size)
+{
+	return (size + lane_block_size - 1) / lane_block_size * lane_block_size;
+}
+
+lane_block load_lane_block(
+	const std::vector<float>& lanes, //
+	size_t first
+)
+{
+	ASSERT(first + lane_block_size <= lanes.size())
+	lane_block ret{};
+	std::copy_n(std::next(lanes.begin(), ptrdiff_t(first)), lane_block_size, ret.begin());
+	return ret;
+}
+
+void store_lane_block(
+	const lane_block& block, //
+	std::vector<float>& lanes,
+	size_t first
+)
+{
+	ASSERT(first + lane_block_size <= lanes.size())
+	std::copy(block.begin(), block.end(), std::next(lanes.begin(), ptrdiff_t(first)));
+}
+} // namespace
+
+void animation::batch::resize(size_t num_channels)
+{
+	auto padded_size = pad_to_lane_blocks(num_channels);
+
+	this->t.resize(padded_size);
+	this->interval.resize(padded_size);
+	for (uint32_t p = 0; p != this->num_points; ++p) {
+		for (uint32_t c = 0; c != this->num_components; ++c) {
+			this->points[p][c].resize(padded_size);
+		}
+	}
+	for (uint32_t c = 0; c != this->num_components; ++c) {
+		this->result[c].resize(padded_size);
+	}
+}
+
+void animation::batch::interpolate_linear()
+{
+	ASSERT(this->num_points == 2)
+
+	for (size_t i = 0; i != this->t.size(); i += lane_block_size) {
+		auto t = load_lane_block(this->t, i);
+
+		for (uint32_t c = 0; c != this->num_components; ++c) {
+			auto p0 = load_lane_block(this->points[0][c], i);
+			auto p1 = load_lane_block(this->points[1][c], i);
+
+			lane_block r{};
+			for (size_t j = 0; j != lane_block_size; ++j) {
+				r[j] = p0[j] + (p1[j] - p0[j]) * t[j];
+			}
+			store_lane_block(r, this->result[c], i);
+		}
+	}
+}
+
+void animation::batch::interpolate_linear_rotations()
+{
+	ASSERT(this->num_components == 4)
+	ASSERT(this->num_points == 2)
+
+	for (size_t i = 0; i != this->t.size(); i += lane_block_size) {
+		std::array<lane_block, 4> q0{};
+		std::array<lane_block, 4> q1{};
+		for (size_t c = 0; c != 4; ++c) {
+			q0[c] = load_lane_block(this->points[0][c], i);
+			q1[c] = load_lane_block(this->points[1][c], i);
+		}
+
+		lane_block dot{};
+		for (size_t c = 0; c != 4; ++c) {
+			for (size_t j = 0; j != lane_block_size; ++j) {
+				dot[j] += q0[c][j] * q1[c][j];
+			}
+		}
+
+		auto t = load_lane_block(this->t, i);
+
+		lane_block w0{};
+		lane_block w1{};
+		for (size_t j = 0; j != lane_block_size; ++j) {
+			// Linear interpolation of quaternions with normalization moves faster in the middle of the arc than at
+			// its ends. Adjust the interpolation parameter to approximate constant speed of spherical
+			// interpolation, see "Approximating slerp" by Arseny Kapoulkine. Unlike slerp, this needs no
+			// trigonometric functions, so the loop is vectorized.
+			auto d = std::abs(dot[j]);
+
+			// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+			auto a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+			// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+			auto b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+
+			auto h = t[j] - 0.5f; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			auto k = a * h * h + b;
+			auto u = t[j] + t[j] * h * (t[j] - 1) * k;
+
+			// q and -q are the same rotation, interpolate towards the one closer to the first key
+			w0[j] = 1 - u;
+			w1[j] = dot[j] < 0 ? -u : u;
+		}
+
+		std::array<lane_block, 4> r{};
+		for (size_t c = 0; c != 4; ++c) {
+			for (size_t j = 0; j != lane_block_size; ++j) {
+				r[c][j] = q0[c][j] * w0[j] + q1[c][j] * w1[j];
+			}
+			store_lane_block(r[c], this->result[c], i);
+		}
+	}
+
+	this->normalize_result();
+}
+
+void animation::batch::interpolate_cubic()
+{
+	ASSERT(this->num_points == 4)
+
+	for (size_t i = 0; i != this->t.size(); i += lane_block_size) {
+		auto t = load_lane_block(this->t, i);
+		auto dt = load_lane_block(this->interval, i);
+
+		// Hermite basis functions, tangents are scaled by the key interval, see glTF spec
+		std::array<lane_block, 4> w{};
+		for (size_t j = 0; j != lane_block_size; ++j) {
+			auto t2 = t[j] * t[j];
+			auto t3 = t2 * t[j];
+
+			w[0][j] = 2 * t3 - 3 * t2 + 1;
+			w[1][j] = (t3 - 2 * t2 + t[j]) * dt[j];
+			w[2][j] = -2 * t3 + 3 * t2;
+			w[3][j] = (t3 - t2) * dt[j];
+		}
+
+		for (uint32_t c = 0; c != this->num_components; ++c) {
+			auto p0 = load_lane_block(this->points[0][c], i);
+			auto p1 = load_lane_block(this->points[1][c], i);
+			auto p2 = load_lane_block(this->points[2][c], i);
+			auto p3 = load_lane_block(this->points[3][c], i);
+
+			lane_block r{};
+			for (size_t j = 0; j != lane_block_size; ++j) {
+				r[j] = w[0][j] * p0[j] + w[1][j] * p1[j] + w[2][j] * p2[j] + w[3][j] * p3[j];
+			}
+			store_lane_block(r, this->result[c], i);
+		}
+	}
+}
+
+void animation::batch::normalize_result()
+{
+	ASSERT(this->num_components == 4)
+
+	for (size_t i = 0; i != this->t.size(); i += lane_block_size) {
+		std::array<lane_block, 4> r{};
+		for (size_t c = 0; c != 4; ++c) {
+			r[c] = load_lane_block(this->result[c], i);
+		}
+
+		lane_block length_squared{};
+		for (size_t c = 0; c != 4; ++c) {
+			for (size_t j = 0; j != lane_block_size; ++j) {
+				length_squared[j] += r[c][j] * r[c][j];
+			}
+		}
+
+		// padding lanes are zero
+		lane_block scale{};
+		for (size_t j = 0; j != lane_block_size; ++j) {
+			scale[j] = length_squared[j] > 0 ? 1 / std::sqrt(length_squared[j]) : 1.0f;
+		}
+
+		for (size_t c = 0; c != 4; ++c) {
+			for (size_t j = 0; j != lane_block_size; ++j) {
+				r[c][j] *= scale[j];
+			}
+			store_lane_block(r[c], this->result[c], i);
+		}
+	}
+}
+
+void animation::add_channel(
+	uint32_t node_index, //
+	path path_v,
+	interpolation interpolation_v,
+	utki::span<const float> key_times,
+	utki::span<const float> key_values
+)
+{
+	if (key_times.empty()) {
+		throw std::invalid_argument("animation::add_channel(): channel has no keys");
+	}
+
+	for (size_t i = 1; i != key_times.size(); ++i) {
+		// also rejects NaN
+		if (!(key_times[i - 1] < key_times[i])) {
+			throw std::invalid_argument("animation::add_channel(): key times are not strictly increasing");
+		}
+	}
+
+	bool is_cubic = interpolation_v == interpolation::cubic_spline;
+
+	auto num_components = get_num_components(path_v);
+	auto num_values_per_key = num_components * (is_cubic ? num_cubic_spline_key_values : 1);
+
+	if (key_values.size() != key_times.size() * num_values_per_key) {
+		throw std::invalid_argument("animation::add_channel(): number of key values does not match number of keys");
+	}
+
+	auto channel_index = uint32_t(this->channels.size());
+
+	this->channels.push_back({
+		.node_index = node_index, //
+		.path_v = path_v,
+		.interpolation_v = interpolation_v,
+		.first_key = uint32_t(this->times.size()),
+		.num_keys = uint32_t(key_times.size()),
+		.first_value = uint32_t(this->values.size())
+	});
+	this->cursors.push_back(0);
+
+	this->times.insert(this->times.end(), key_times.begin(), key_times.end());
+	this->values.insert(this->values.end(), key_values.begin(), key_values.end());
+
+	this->duration = std::max(this->duration, key_times.back());
+
+	bool is_rotation = path_v == path::rotation;
+	auto kind = is_cubic ? (is_rotation ? batch_kind::rotation_cubic : batch_kind::vector_cubic)
+						 : (is_rotation ? batch_kind::rotation_linear : batch_kind::vector_linear);
+
+	auto& b = this->batches[size_t(kind)];
+	b.channels.push_back(channel_index);
+	b.resize(b.channels.size());
+}
+
+void animation::set_target(
+	size_t channel_index, //
+	uint32_t node_index
+)
+{
+	ASSERT(channel_index < this->channels.size())
+	this->channels[channel_index].node_index = node_index;
+}
+
+void animation::gather(
+	batch& b, //
+	float time
+)
+{
+	auto num_components = b.num_components;
+	auto key_stride = num_components * (b.num_points == 4 ? num_cubic_spline_key_values : 1);
+
+	for (size_t lane = 0; lane != b.channels.size(); ++lane) {
+		auto ci = b.channels[lane];
+		const auto& c = this->channels[ci];
+
+		auto key = find_key(
+			utki::make_span(this->times).subspan(c.first_key, c.num_keys), //
+			time,
+			this->cursors[ci]
+		);
+
+		std::array<uint32_t, 4> offsets{};
+		if (b.num_points == 2) {
+			if (c.interpolation_v == interpolation::step) {
+				key.t = 0;
+			}
+			offsets[0] = key.index * key_stride;
+			offsets[1] = key.next * key_stride;
+		} else {
+			// the value and the out-tangent of the key, the value and the in-tangent of the next key
+			offsets[0] = key.index * key_stride + num_components;
+			offsets[1] = key.index * key_stride + 2 * num_components;
+			offsets[2] = key.next * key_stride + num_components;
+			offsets[3] = key.next * key_stride;
+		}
+
+		b.t[lane] = key.t;
+		b.interval[lane] = key.interval;
+
+		auto channel_values = utki::make_span(this->values).subspan(c.first_value);
+		for (uint32_t p = 0; p != b.num_points; ++p) {
+			for (uint32_t i = 0; i != num_components; ++i) {
+				b.points[p][i][lane] = channel_values[offsets[p] + i];
+			}
+		}
+	}
+}
+
+void animation::apply(
+	float time, //
+	transform_hierarchy& h
+)
+{
+	for (auto& b : this->batches) {
+		if (b.channels.empty()) {
+			continue;
+		}
+
+		this->gather(b, time);
+
+		bool is_rotation = b.num_components == 4;
+
+		if (b.num_points == 2) {
+			if (is_rotation) {
+				b.interpolate_linear_rotations();
+			} else {
+				b.interpolate_linear();
+			}
+		} else {
+			b.interpolate_cubic();
+
+			// interpolated quaternions are not unit
+			if (is_rotation) {
+				b.normalize_result();
+			}
+		}
+
+		const auto& r = b.result;
+		for (size_t lane = 0; lane != b.channels.size(); ++lane) {
+			const auto& c = this->channels[b.channels[lane]];
+			if (c.node_index == no_node) {
+				continue;
+			}
+			ASSERT(c.node_index < h.size())
+
+			switch (c.path_v) {
+				case path::translation:
+					h.set_translation(c.node_index, ruis::vec3(r[0][lane], r[1][lane], r[2][lane]));
+					break;
+				case path::rotation:
+					h.set_rotation(c.node_index, ruis::quat(r[0][lane], r[1][lane], r[2][lane], r[3][lane]));
+					break;
+				case path::scale:
+					h.set_scale(c.node_index, ruis::vec3(r[0][lane], r[1][lane], r[2][lane]));
+					break;
+			}
+		}
+	}
+}
@@ -0,0 +1,213 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <utki/span.hpp>
+
+#include "transform_hierarchy.hpp"
+
+namespace ruis::render {
+
+/**
+ * @brief Keyframe animation of node transformations.
+ * The animation consists of channels, each channel animates translation, rotation or scale of one node.
+ * Key times and values of all the channels are stored in two contiguous arrays.
+ *
+ * Channels are evaluated in batches, one batch per kind of channel values and interpolation.
+ * For each batch, the keys surrounding the current time are first gathered into structure-of-arrays buffers,
+ * then the values are interpolated by simple loops over those buffers, which the compiler vectorizes,
+ * and finally the results are written to the transform hierarchy. See apply().
+ */
+class animation
+{
+public:
+	/**
+	 * @brief Animated property of a node.
+	 */
+	enum class path {
+		translation,
+		rotation,
+		scale
+	};
+
+	enum class interpolation {
+		linear,
+		step,
+		cubic_spline
+	};
+
+	/**
+	 * @brief Node index of a channel which does not target any node.
+	 */
+	constexpr static uint32_t no_node = std::numeric_limits<uint32_t>::max();
+
+	struct channel {
+		/**
+		 * @brief Index of the target node in the transform hierarchy.
+		 * no_node if the channel does not target any node, then it is not applied.
+		 */
+		uint32_t node_index;
+
+		path path_v;
+		interpolation interpolation_v;
+
+		// range of the key times in the times array
+		uint32_t first_key;
+		uint32_t num_keys;
+
+		// offset of the key values in the values array
+		uint32_t first_value;
+	};
+
+private:
+	std::vector<float> times;
+	std::vector<float> values;
+	std::vector<channel> channels;
+
+	float duration = 0;
+
+	// key found for each channel by the last apply() call,
+	// playback time usually goes forward, so the next key is likely to be the same or the following one
+	std::vector<uint32_t> cursors;
+
+	// channels of the same kind, evaluated together
+	struct batch {
+		uint32_t num_components;
+
+		// number of key values interpolation is done between, 2 for linear and 4 for cubic spline interpolation
+		uint32_t num_points;
+
+		std::vector<uint32_t> channels{};
+
+		// interpolation parameter within the key interval and the interval length
+		std::vector<float> t{};
+		std::vector<float> interval{};
+
+		// gathered key values, [point][component][lane]
+		std::array<std::array<std::vector<float>, 4>, 4> points{};
+
+		// interpolated values, [component][lane]
+		std::array<std::vector<float>, 4> result{};
+
+		// lane arrays are padded, so their size can be bigger than the number of channels
+		void resize(size_t num_channels);
+
+		void interpolate_linear();
+		void interpolate_cubic();
+
+		// interpolate unit quaternions along the shortest arc with approximately constant speed
+		void interpolate_linear_rotations();
+		void normalize_result();
+	};
+
+	enum class batch_kind {
+		vector_linear,
+		rotation_linear,
+		vector_cubic,
+		rotation_cubic,
+
+		enum_size
+	};
+
+	std::array<batch, size_t(batch_kind::enum_size)> batches = {
+		{{.num_components = 3, .num_points = 2},
+		 {.num_components = 4, .num_points = 2},
+		 {.num_components = 3, .num_points = 4},
+		 {.num_components = 4, .num_points = 4}}
+	};
+
+	void gather(
+		batch& b, //
+		float time
+	);
+
+public:
+	std::string name;
+
+	/**
+	 * @brief Add channel.
+	 * Values of each key are 3 floats for translation and scale, and 4 floats for rotation quaternion,
+	 * stored as x, y, z, w. For cubic spline interpolation each key has three values:
+	 * in-tangent, value and out-tangent, as in glTF.
+	 * @param node_index - index of the target node in the transform hierarchy. The node must have
+	 *                     translation, rotation and scale transformation.
+	 * @param path_v - animated property of the node.
+	 * @param interpolation_v - interpolation between the keys.
+	 * @param key_times - key times in seconds, strictly increasing.
+	 * @param key_values - key values.
+	 * @throw std::invalid_argument - if there are no keys, if the key times are not increasing,
+	 *                                or if the number of values does not match the number of keys.
+	 */
+	void add_channel(
+		uint32_t node_index, //
+		path path_v,
+		interpolation interpolation_v,
+		utki::span<const float> key_times,
+		utki::span<const float> key_values
+	);
+
+	utki::span<const channel> get_channels() const noexcept
+	{
+		return this->channels;
+	}
+
+	/**
+	 * @brief Set target node of a channel.
+	 * @param channel_index - index of the channel.
+	 * @param node_index - index of the new target node in the transform hierarchy, or no_node.
+	 */
+	void set_target(
+		size_t channel_index, //
+		uint32_t node_index
+	);
+
+	/**
+	 * @brief Get animation duration.
+	 * @return Time of the last key among all the channels, in seconds.
+	 */
+	float get_duration() const noexcept
+	{
+		return this->duration;
+	}
+
+	/**
+	 * @brief Set animated node transformations.
+	 * Values are clamped to the first and last keys for time outside of a channel's key range.
+	 * The target nodes are marked dirty in the transform hierarchy, their world matrices are recalculated
+	 * by the next transform_hierarchy::update() call.
+	 * @param time - animation time in seconds.
+	 * @param h - transform hierarchy of the target nodes.
+	 */
+	void apply(
+		float time, //
+		transform_hierarchy& h
+	);
+};
+
+} // namespace ruis::render
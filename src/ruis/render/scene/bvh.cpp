@@ -0,0 +1,524 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+using namespace ruis::render;
+
+namespace {
+// the tree is balanced, so its depth is not more than number of bits of the item index
+constexpr size_t max_stack_size = 64;
+
+// returns distance to where the ray enters the box, if the ray hits the box
+std::optional<ruis::real> intersect(
+	const aabb& box, //
+	const ray& r,
+	const ruis::vec3& inverse_direction
+)
+{
+	if (box.is_empty()) {
+		return std::nullopt;
+	}
+
+	ruis::real t_min = 0;
+	ruis::real t_max = std::numeric_limits<ruis::real>::max();
+
+	for (size_t i = 0; i != 3; ++i) {
+		auto t1 = (box.min[i] - r.origin[i]) * inverse_direction[i];
+		auto t2 = (box.max[i] - r.origin[i]) * inverse_direction[i];
+		t_min = std::max(t_min, std::min(t1, t2));
+		t_max = std::min(t_max, std::max(t1, t2));
+	}
+
+	if (t_min > t_max) {
+		return std::nullopt;
+	}
+	return t_min;
+}
+
+// Moller-Trumbore ray-triangle intersection, both sides of the triangles are hit,
+// returns distance to the closest triangle hit which is closer than max_distance
+std::optional<ruis::real> intersect(
+	const triangle_mesh& mesh, //
+	const ray& r,
+	ruis::real max_distance
+)
+{
+	std::optional<ruis::real> ret;
+
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+		ASSERT(mesh.indices[i] < mesh.positions.size())
+		ASSERT(mesh.indices[i + 1] < mesh.positions.size())
+		ASSERT(mesh.indices[i + 2] < mesh.positions.size())
+		const auto& v0 = mesh.positions[mesh.indices[i]];
+		auto e1 = mesh.positions[mesh.indices[i + 1]] - v0;
+		auto e2 = mesh.positions[mesh.indices[i + 2]] - v0;
+
+		auto p = r.direction.cross(e2);
+		auto det = e1.dot(p);
+		if (det == 0) {
+			// the ray is parallel to the triangle plane or the triangle is degenerate
+			continue;
+		}
+		auto inverse_det = 1 / det;
+
+		auto s = r.origin - v0;
+		auto u = s.dot(p) * inverse_det;
+		if (u < 0 || u > 1) {
+			continue;
+		}
+
+		auto q = s.cross(e1);
+		auto v = r.direction.dot(q) * inverse_det;
+		if (v < 0 || u + v > 1) {
+			continue;
+		}
+
+		auto t = e2.dot(q) * inverse_det;
+		if (t < 0 || t >= max_distance) {
+			continue;
+		}
+
+		max_distance = t;
+		ret = t;
+	}
+
+	return ret;
+}
+
+ruis::vec3 get_inverse_direction(const ray& r)
+{
+	// division by zero gives infinity, which the slab test handles
+	return {1 / r.direction.x(), 1 / r.direction.y(), 1 / r.direction.z()};
+}
+
+bool overlap(
+	const aabb& a, //
+	const aabb& b
+)
+{
+	if (a.is_empty() || b.is_empty()) {
+		return false;
+	}
+	for (size_t i = 0; i != 3; ++i) {
+		if (a.max[i] < b.min[i] || b.max[i] < a.min[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+} // namespace
+
+void bvh::build(
+	const scene& s, //
+	primitive_triangles triangles
+)
+{
+	this->nodes.clear();
+	this->items.clear();
+	this->triangles = std::move(triangles);
+
+	auto flat_nodes = s.get_flat_nodes();
+	for (uint32_t ni = 0; ni != flat_nodes.size(); ++ni) {
+		const auto& n = *flat_nodes[ni];
+		if (!n.mesh_v) {
+			continue;
+		}
+
+		auto num_instances = uint32_t(std::max(n.instances.size(), size_t(1)));
+		for (uint32_t ii = 0; ii != num_instances; ++ii) {
+			for (const auto& p : n.mesh_v->primitives) {
+				this->items.push_back({.node_index = ni, .instance_index = ii, .primitive_v = &p.get()});
+			}
+		}
+	}
+
+	this->update_item_bounds(s);
+
+	if (this->items.empty()) {
+		return;
+	}
+
+	std::vector<uint32_t> order(this->items.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	// leaves have at least half of the maximum number of items, so there are not more tree nodes than items
+	this->nodes.reserve(this->items.size());
+	this->build_subtree(order, 0);
+
+	// put the items in the order of the tree leaves
+	std::vector<item> sorted_items;
+	std::vector<aabb> sorted_bounds;
+	std::vector<ruis::mat4> sorted_matrices;
+	sorted_items.reserve(order.size());
+	sorted_bounds.reserve(order.size());
+	sorted_matrices.reserve(order.size());
+	for (auto i : order) {
+		sorted_items.push_back(this->items[i]);
+		sorted_bounds.push_back(this->item_bounds[i]);
+		sorted_matrices.push_back(this->item_matrices[i]);
+	}
+	this->items = std::move(sorted_items);
+	this->item_bounds = std::move(sorted_bounds);
+	this->item_matrices = std::move(sorted_matrices);
+}
+
+uint32_t bvh::build_subtree(
+	utki::span<uint32_t> order, //
+	uint32_t first_item
+)
+{
+	auto index = uint32_t(this->nodes.size());
+
+	aabb bounds;
+	aabb centers;
+	for (auto i : order) {
+		bounds.extend(this->item_bounds[i]);
+		centers.extend(this->item_bounds[i].get_center());
+	}
+
+	this->nodes.push_back({
+		.bounds = bounds, //
+		.first_item = first_item,
+		.num_items = uint32_t(order.size()),
+		.right_child = 0
+	});
+
+	if (order.size() <= max_leaf_size) {
+		return index;
+	}
+
+	// split at the median of the item centers along the longest axis
+	auto size = centers.max - centers.min;
+	size_t axis = 0;
+	for (size_t i = 1; i != 3; ++i) {
+		if (size[i] > size[axis]) {
+			axis = i;
+		}
+	}
+
+	auto mid = order.size() / 2;
+	std::nth_element(
+		order.begin(), //
+		std::next(order.begin(), mid),
+		order.end(),
+		[&](auto a, auto b) {
+			return this->item_bounds[a].get_center()[axis] < this->item_bounds[b].get_center()[axis];
+		}
+	);
+
+	this->build_subtree(order.subspan(0, mid), first_item);
+	auto right = this->build_subtree(order.subspan(mid), first_item + uint32_t(mid));
+
+	this->nodes[index].right_child = right;
+
+	return index;
+}
+
+void bvh::update_item_bounds(const scene& s)
+{
+	auto flat_nodes = s.get_flat_nodes();
+	auto world_matrices = s.get_transform_hierarchy().get_world_matrices();
+
+	this->item_bounds.resize(this->items.size());
+	this->item_matrices.resize(this->items.size());
+
+	for (size_t i = 0; i != this->items.size(); ++i) {
+		const auto& it = this->items[i];
+		ASSERT(it.node_index < flat_nodes.size())
+		ASSERT(it.primitive_v)
+
+		const auto& n = *flat_nodes[it.node_index];
+		const auto& world_matrix = world_matrices[it.node_index];
+
+		if (n.instances.empty()) {
+			this->item_matrices[i] = world_matrix;
+		} else {
+			ASSERT(it.instance_index < n.instances.size())
+			this->item_matrices[i] = world_matrix * n.instances[it.instance_index];
+		}
+		this->item_bounds[i] = it.primitive_v->bounds.transform(this->item_matrices[i]);
+	}
+}
+
+std::optional<ruis::real> bvh::intersect_item(
+	uint32_t item_index, //
+	const ray& r,
+	const ruis::vec3& inverse_direction,
+	ruis::real max_distance
+) const
+{
+	auto t = intersect(this->item_bounds[item_index], r, inverse_direction);
+	if (!t || t.value() >= max_distance) {
+		return std::nullopt;
+	}
+
+	auto i = this->triangles.find(this->items[item_index].primitive_v);
+	if (i == this->triangles.end()) {
+		return t;
+	}
+
+	// the triangles are tested in the primitive coordinates, the transformation is affine, so distances
+	// measured in lengths of the transformed ray direction are same as in the scene coordinates
+	auto inverse_matrix = this->item_matrices[item_index].inv();
+	auto origin = inverse_matrix * r.origin;
+	const ray primitive_ray{
+		.origin = origin, //
+		.direction = inverse_matrix * (r.origin + r.direction) - origin
+	};
+
+	return intersect(
+		i->second, //
+		primitive_ray,
+		max_distance
+	);
+}
+
+void bvh::refit(const scene& s)
+{
+	this->update_item_bounds(s);
+	this->refit_nodes();
+}
+
+void bvh::refit_nodes()
+{
+	// children go after their parents
+	for (auto i = this->nodes.size(); i != 0;) {
+		--i;
+		auto& n = this->nodes[i];
+
+		if (n.right_child == 0) {
+			n.bounds = {};
+			for (const auto& b : utki::make_span(this->item_bounds).subspan(n.first_item, n.num_items)) {
+				n.bounds.extend(b);
+			}
+		} else {
+			n.bounds = this->nodes[i + 1].bounds;
+			n.bounds.extend(this->nodes[n.right_child].bounds);
+		}
+	}
+}
+
+void bvh::cast_ray(
+	const ray& r, //
+	std::vector<hit>& hits
+) const
+{
+	hits.clear();
+
+	if (this->nodes.empty()) {
+		return;
+	}
+
+	auto inverse_direction = get_inverse_direction(r);
+
+	std::array<uint32_t, max_stack_size> stack; // NOLINT(cppcoreguidelines-pro-type-member-init)
+	size_t stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size != 0) {
+		auto index = stack[--stack_size];
+		const auto& n = this->nodes[index];
+
+		if (!intersect(n.bounds, r, inverse_direction)) {
+			continue;
+		}
+
+		if (n.right_child != 0) {
+			ASSERT(stack_size + 2 <= stack.size())
+			stack[stack_size++] = n.right_child;
+			stack[stack_size++] = index + 1;
+			continue;
+		}
+
+		for (uint32_t i = n.first_item; i != n.first_item + n.num_items; ++i) {
+			if (auto t = this->intersect_item(i, r, inverse_direction, std::numeric_limits<ruis::real>::max())) {
+				hits.push_back({.item_index = i, .distance = t.value()});
+			}
+		}
+	}
+
+	std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) {
+		return a.distance < b.distance;
+	});
+}
+
+std::optional<bvh::hit> bvh::find_closest_hit(const ray& r) const
+{
+	if (this->nodes.empty()) {
+		return std::nullopt;
+	}
+
+	auto inverse_direction = get_inverse_direction(r);
+
+	std::optional<hit> closest;
+
+	struct stack_item {
+		uint32_t node;
+
+		// distance to the node bounds
+		ruis::real distance;
+	};
+
+	std::array<stack_item, max_stack_size> stack; // NOLINT(cppcoreguidelines-pro-type-member-init)
+	size_t stack_size = 0;
+
+	if (auto t = intersect(this->nodes[0].bounds, r, inverse_direction)) {
+		stack[stack_size++] = {.node = 0, .distance = t.value()};
+	}
+
+	while (stack_size != 0) {
+		auto si = stack[--stack_size];
+
+		if (closest && si.distance >= closest->distance) {
+			continue;
+		}
+
+		const auto& n = this->nodes[si.node];
+
+		if (n.right_child == 0) {
+			for (uint32_t i = n.first_item; i != n.first_item + n.num_items; ++i) {
+				auto max_distance = closest ? closest->distance : std::numeric_limits<ruis::real>::max();
+				if (auto t = this->intersect_item(i, r, inverse_direction, max_distance)) {
+					closest = {.item_index = i, .distance = t.value()};
+				}
+			}
+			continue;
+		}
+
+		std::array<stack_item, 2> children = {
+			{{.node = si.node + 1, .distance = 0}, {.node = n.right_child, .distance = 0}}
+		};
+
+		// push the farther child first, so that the nearer one is visited first
+		size_t num_children = 0;
+		for (auto& c : children) {
+			if (auto t = intersect(this->nodes[c.node].bounds, r, inverse_direction)) {
+				c.distance = t.value();
+				children[num_children++] = c;
+			}
+		}
+		if (num_children == 2 && children[0].distance < children[1].distance) {
+			std::swap(children[0], children[1]);
+		}
+
+		ASSERT(stack_size + num_children <= stack.size())
+		for (size_t i = 0; i != num_children; ++i) {
+			stack[stack_size++] = children[i];
+		}
+	}
+
+	return closest;
+}
+
+void bvh::query(
+	const aabb& box, //
+	std::vector<uint32_t>& result
+) const
+{
+	result.clear();
+
+	if (this->nodes.empty()) {
+		return;
+	}
+
+	std::array<uint32_t, max_stack_size> stack; // NOLINT(cppcoreguidelines-pro-type-member-init)
+	size_t stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size != 0) {
+		auto index = stack[--stack_size];
+		const auto& n = this->nodes[index];
+
+		if (!overlap(n.bounds, box)) {
+			continue;
+		}
+
+		if (n.right_child != 0) {
+			ASSERT(stack_size + 2 <= stack.size())
+			stack[stack_size++] = n.right_child;
+			stack[stack_size++] = index + 1;
+			continue;
+		}
+
+		for (uint32_t i = n.first_item; i != n.first_item + n.num_items; ++i) {
+			if (overlap(this->item_bounds[i], box)) {
+				result.push_back(i);
+			}
+		}
+	}
+}
+
+void bvh::query(
+	const frustum& f, //
+	std::vector<uint32_t>& result
+) const
+{
+	result.clear();
+
+	if (this->nodes.empty()) {
+		return;
+	}
+
+	std::array<uint32_t, max_stack_size> stack; // NOLINT(cppcoreguidelines-pro-type-member-init)
+	size_t stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size != 0) {
+		auto index = stack[--stack_size];
+		const auto& n = this->nodes[index];
+
+		auto intersection = f.classify(n.bounds);
+
+		if (intersection == frustum::intersection::outside) {
+			continue;
+		}
+
+		if (intersection == frustum::intersection::inside) {
+			// all the items of the subtree are inside
+			for (uint32_t i = n.first_item; i != n.first_item + n.num_items; ++i) {
+				if (!this->item_bounds[i].is_empty()) {
+					result.push_back(i);
+				}
+			}
+			continue;
+		}
+
+		if (n.right_child != 0) {
+			ASSERT(stack_size + 2 <= stack.size())
+			stack[stack_size++] = n.right_child;
+			stack[stack_size++] = index + 1;
+			continue;
+		}
+
+		for (uint32_t i = n.first_item; i != n.first_item + n.num_items; ++i) {
+			if (f.classify(this->item_bounds[i]) != frustum::intersection::outside) {
+				result.push_back(i);
+			}
+		}
+	}
+}
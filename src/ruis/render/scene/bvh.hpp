@@ -0,0 +1,228 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <ruis/config.hpp>
+#include <utki/span.hpp>
+
+#include "aabb.hpp"
+#include "frustum.hpp"
+#include "scene.hpp"
+
+namespace ruis::render {
+
+struct ray {
+	ruis::vec3 origin;
+
+	/**
+	 * @brief Direction of the ray.
+	 * Does not need to be normalized, hit distances are measured in lengths of the direction vector.
+	 */
+	ruis::vec3 direction;
+};
+
+/**
+ * @brief CPU side copy of mesh primitive triangles.
+ */
+struct triangle_mesh {
+	/**
+	 * @brief Vertex positions in the primitive's coordinates.
+	 */
+	std::vector<ruis::vec3> positions;
+
+	/**
+	 * @brief Vertex indices, three per triangle.
+	 */
+	std::vector<uint32_t> indices;
+};
+
+/**
+ * @brief Bounding volume hierarchy of scene primitives.
+ * Each item is an occurrence of a mesh primitive in the scene, i.e. a primitive of a node's mesh,
+ * or of one of the mesh instances, with its bounding box in scene coordinates.
+ * The hierarchy is a binary tree of boxes, built by splitting the items at the median of the longest axis.
+ * Items of each subtree are contiguous, so a subtree entirely inside of a query volume is reported
+ * without visiting its nodes.
+ *
+ * Box and frustum queries test item bounding boxes. Ray casts test triangles of the items whose bounding boxes
+ * are hit, in case the triangles of the primitive were given to build(), otherwise only the bounding boxes are tested.
+ */
+class bvh
+{
+public:
+	struct item {
+		/**
+		 * @brief Index of the node in the scene's flattened nodes.
+		 * See scene::get_flat_nodes().
+		 */
+		uint32_t node_index;
+
+		/**
+		 * @brief Index of the mesh instance, 0 if the node has no instances.
+		 */
+		uint32_t instance_index;
+
+		const primitive* primitive_v;
+	};
+
+	/**
+	 * @brief Triangles of scene primitives.
+	 */
+	using primitive_triangles = std::map<const primitive*, triangle_mesh>;
+
+	struct hit {
+		/**
+		 * @brief Index of the hit item.
+		 */
+		uint32_t item_index;
+
+		/**
+		 * @brief Distance from the ray origin to the closest hit triangle of the item.
+		 * In case the item has no triangles, it is the distance to the point where the ray enters the item bounds,
+		 * zero if the ray starts inside the bounds.
+		 */
+		ruis::real distance;
+	};
+
+private:
+	struct tree_node {
+		aabb bounds;
+
+		// range of the items of the subtree
+		uint32_t first_item;
+		uint32_t num_items;
+
+		// left child is the next node, 0 for leaf nodes
+		uint32_t right_child;
+	};
+
+	std::vector<tree_node> nodes;
+
+	std::vector<item> items;
+	std::vector<aabb> item_bounds;
+
+	// transformations of the items from primitive to scene coordinates
+	std::vector<ruis::mat4> item_matrices;
+
+	primitive_triangles triangles;
+
+	// order is the subtree's range of the item indices, it is reordered so that the subtrees' items are contiguous
+	uint32_t build_subtree(
+		utki::span<uint32_t> order, //
+		uint32_t first_item
+	);
+
+	void update_item_bounds(const scene& s);
+
+	void refit_nodes();
+
+	// returns distance to the hit of the item, if the ray hits the item closer than max_distance
+	std::optional<ruis::real> intersect_item(
+		uint32_t item_index, //
+		const ray& r,
+		const ruis::vec3& inverse_direction,
+		ruis::real max_distance
+	) const;
+
+public:
+	/**
+	 * @brief Maximum number of items in a leaf node.
+	 */
+	constexpr static uint32_t max_leaf_size = 4;
+
+	/**
+	 * @brief Build the hierarchy.
+	 * Must be called again after the scene's node tree, node meshes or mesh instances are changed.
+	 * @param s - scene to build the hierarchy of. The scene's world matrices must be up to date,
+	 *            see scene::update_transforms().
+	 * @param triangles - triangles of the scene primitives for precise ray casting, see make_scene().
+	 *                    Primitives without triangles are tested by their bounding boxes.
+	 */
+	void build(
+		const scene& s, //
+		primitive_triangles triangles = {}
+	);
+
+	/**
+	 * @brief Update the hierarchy to changed node transformations.
+	 * Recalculates bounds of all the items and the tree nodes, keeping the tree structure.
+	 * Much cheaper than build(), but queries become slower when the items move far from their initial places.
+	 * @param s - scene the hierarchy was built of, with up to date world matrices.
+	 */
+	void refit(const scene& s);
+
+	utki::span<const item> get_items() const noexcept
+	{
+		return this->items;
+	}
+
+	utki::span<const aabb> get_item_bounds() const noexcept
+	{
+		return this->item_bounds;
+	}
+
+	/**
+	 * @brief Cast ray.
+	 * @param r - ray in scene coordinates.
+	 * @param hits - output, all the items hit by the ray, sorted by distance. Previous content is cleared.
+	 */
+	void cast_ray(
+		const ray& r, //
+		std::vector<hit>& hits
+	) const;
+
+	/**
+	 * @brief Find item closest to the ray origin along the ray.
+	 * Subtrees are visited in near to far order, subtrees and items farther than the closest hit
+	 * found so far are not visited.
+	 * @param r - ray in scene coordinates.
+	 * @return The closest hit, if any.
+	 */
+	std::optional<hit> find_closest_hit(const ray& r) const;
+
+	/**
+	 * @brief Find items overlapping a box.
+	 * @param box - box in scene coordinates.
+	 * @param result - output, indices of the items whose bounds overlap the box. Previous content is cleared.
+	 */
+	void query(
+		const aabb& box, //
+		std::vector<uint32_t>& result
+	) const;
+
+	/**
+	 * @brief Find items overlapping a frustum.
+	 * @param f - frustum in scene coordinates.
+	 * @param result - output, indices of the items whose bounds are not classified as outside of the frustum.
+	 *                 Previous content is cleared.
+	 */
+	void query(
+		const frustum& f, //
+		std::vector<uint32_t>& result
+	) const;
+};
+
+} // namespace ruis::render
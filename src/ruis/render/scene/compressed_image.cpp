@@ -0,0 +1,373 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "compressed_image.hxx"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+using namespace ruis::render;
+
+namespace {
+constexpr uint32_t block_dim = 4;
+constexpr size_t etc2_rgb_block_size = 8;
+constexpr size_t eac_alpha_block_size = 8;
+
+// blocks are stored as big-endian 64-bit words
+uint64_t read_block_word(const uint8_t* p)
+{
+	uint64_t ret = 0;
+	for (size_t i = 0; i != sizeof(uint64_t); ++i) {
+		ret = (ret << 8) | p[i]; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+	return ret;
+}
+
+// extract 'num' bits with the most significant one at position 'high'
+int get_bits(uint64_t word, unsigned high, unsigned num)
+{
+	return int((word >> (high - num + 1)) & ((uint64_t(1) << num) - 1));
+}
+
+uint8_t clamp_to_uint8(int v)
+{
+	constexpr auto max = 0xff;
+	return uint8_t(std::clamp(v, 0, max));
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+int extend_4_to_8(int c)
+{
+	return (c << 4) | c;
+}
+
+int extend_5_to_8(int c)
+{
+	return (c << 3) | (c >> 2);
+}
+
+int extend_6_to_8(int c)
+{
+	return (c << 2) | (c >> 4);
+}
+
+int extend_7_to_8(int c)
+{
+	return (c << 1) | (c >> 6);
+}
+
+int to_signed_3(int c)
+{
+	return c >= 4 ? c - 8 : c;
+}
+
+constexpr std::array<std::array<int, 2>, 8> etc1_modifier_table = {
+	{{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}}
+};
+
+constexpr std::array<int, 8> etc2_distance_table = {3, 6, 11, 16, 23, 32, 41, 64};
+
+constexpr std::array<std::array<int, 8>, 16> eac_modifier_table = {
+	{{-3, -6, -9, -15, 2, 5, 8, 14},
+	 {-3, -7, -10, -13, 2, 6, 9, 12},
+	 {-2, -5, -8, -13, 1, 4, 7, 12},
+	 {-2, -4, -6, -13, 1, 3, 5, 12},
+	 {-3, -6, -8, -12, 2, 5, 7, 11},
+	 {-3, -7, -9, -11, 2, 6, 8, 10},
+	 {-4, -7, -8, -11, 3, 6, 7, 10},
+	 {-3, -5, -8, -11, 2, 4, 7, 10},
+	 {-2, -6, -8, -10, 1, 5, 7, 9},
+	 {-2, -5, -8, -10, 1, 4, 7, 9},
+	 {-2, -4, -8, -10, 1, 3, 7, 9},
+	 {-2, -5, -7, -10, 1, 4, 6, 9},
+	 {-3, -4, -7, -10, 2, 3, 6, 9},
+	 {-1, -2, -3, -10, 0, 1, 2, 9},
+	 {-4, -6, -8, -9, 3, 5, 7, 8},
+	 {-3, -5, -7, -9, 2, 4, 6, 8}}
+};
+
+using color = std::array<int, 3>;
+
+// decoded block, pixels are indexed as [x][y], same as pixel indices in the block, i.e. column-major
+using rgb_block = std::array<std::array<color, block_dim>, block_dim>;
+using alpha_block = std::array<std::array<uint8_t, block_dim>, block_dim>;
+
+// 2-bit pixel index, msb and lsb are stored separately
+int get_pixel_index(uint64_t word, uint32_t x, uint32_t y)
+{
+	auto i = x * block_dim + y;
+	return int(((word >> (16 + i)) & 1) << 1) | int((word >> i) & 1);
+}
+
+color add(const color& c, int d)
+{
+	return {c[0] + d, c[1] + d, c[2] + d};
+}
+
+void decode_paint_colors(uint64_t word, const std::array<color, 4>& paint_colors, rgb_block& out)
+{
+	for (uint32_t x = 0; x != block_dim; ++x) {
+		for (uint32_t y = 0; y != block_dim; ++y) {
+			out[x][y] = paint_colors[get_pixel_index(word, x, y)];
+		}
+	}
+}
+
+void decode_t_mode(uint64_t word, rgb_block& out)
+{
+	color c1 = {
+		extend_4_to_8((get_bits(word, 60, 2) << 2) | get_bits(word, 57, 2)),
+		extend_4_to_8(get_bits(word, 55, 4)),
+		extend_4_to_8(get_bits(word, 51, 4))
+	};
+	color c2 = {
+		extend_4_to_8(get_bits(word, 47, 4)),
+		extend_4_to_8(get_bits(word, 43, 4)),
+		extend_4_to_8(get_bits(word, 39, 4))
+	};
+	int d = etc2_distance_table[(get_bits(word, 35, 2) << 1) | get_bits(word, 32, 1)];
+
+	decode_paint_colors(word, {c1, add(c2, d), c2, add(c2, -d)}, out);
+}
+
+void decode_h_mode(uint64_t word, rgb_block& out)
+{
+	std::array<int, 3> c1_4 = {
+		get_bits(word, 62, 4),
+		(get_bits(word, 58, 3) << 1) | get_bits(word, 52, 1),
+		(get_bits(word, 51, 1) << 3) | get_bits(word, 49, 3)
+	};
+	std::array<int, 3> c2_4 = {
+		get_bits(word, 46, 4), //
+		get_bits(word, 42, 4),
+		get_bits(word, 38, 4)
+	};
+
+	auto value_1 = (c1_4[0] << 8) | (c1_4[1] << 4) | c1_4[2];
+	auto value_2 = (c2_4[0] << 8) | (c2_4[1] << 4) | c2_4[2];
+
+	int d = etc2_distance_table
+		[(get_bits(word, 34, 1) << 2) | (get_bits(word, 32, 1) << 1) | (value_1 >= value_2 ? 1 : 0)];
+
+	color c1 = {extend_4_to_8(c1_4[0]), extend_4_to_8(c1_4[1]), extend_4_to_8(c1_4[2])};
+	color c2 = {extend_4_to_8(c2_4[0]), extend_4_to_8(c2_4[1]), extend_4_to_8(c2_4[2])};
+
+	decode_paint_colors(word, {add(c1, d), add(c1, -d), add(c2, d), add(c2, -d)}, out);
+}
+
+void decode_planar_mode(uint64_t word, rgb_block& out)
+{
+	color o = {
+		extend_6_to_8(get_bits(word, 62, 6)),
+		extend_7_to_8((get_bits(word, 56, 1) << 6) | get_bits(word, 54, 6)),
+		extend_6_to_8((get_bits(word, 48, 1) << 5) | (get_bits(word, 44, 2) << 3) | get_bits(word, 41, 3))
+	};
+	color h = {
+		extend_6_to_8((get_bits(word, 38, 5) << 1) | get_bits(word, 32, 1)),
+		extend_7_to_8(get_bits(word, 31, 7)),
+		extend_6_to_8(get_bits(word, 24, 6))
+	};
+	color v = {
+		extend_6_to_8(get_bits(word, 18, 6)), //
+		extend_7_to_8(get_bits(word, 12, 7)),
+		extend_6_to_8(get_bits(word, 5, 6))
+	};
+
+	for (int x = 0; x != int(block_dim); ++x) {
+		for (int y = 0; y != int(block_dim); ++y) {
+			for (size_t c = 0; c != o.size(); ++c) {
+				out[x][y][c] = (x * (h[c] - o[c]) + y * (v[c] - o[c]) + 4 * o[c] + 2) >> 2;
+			}
+		}
+	}
+}
+
+void decode_etc2_rgb_block(const uint8_t* data, rgb_block& out)
+{
+	auto word = read_block_word(data);
+
+	bool diff = get_bits(word, 33, 1) != 0;
+	bool flip = get_bits(word, 32, 1) != 0;
+
+	color c1;
+	color c2;
+
+	if (!diff) {
+		// individual mode
+		c1 = {
+			extend_4_to_8(get_bits(word, 63, 4)),
+			extend_4_to_8(get_bits(word, 55, 4)),
+			extend_4_to_8(get_bits(word, 47, 4))
+		};
+		c2 = {
+			extend_4_to_8(get_bits(word, 59, 4)),
+			extend_4_to_8(get_bits(word, 51, 4)),
+			extend_4_to_8(get_bits(word, 43, 4))
+		};
+	} else {
+		// differential mode, overflow of the second color selects one of the ETC2 modes
+		color base = {get_bits(word, 63, 5), get_bits(word, 55, 5), get_bits(word, 47, 5)};
+		color delta = {
+			to_signed_3(get_bits(word, 58, 3)),
+			to_signed_3(get_bits(word, 50, 3)),
+			to_signed_3(get_bits(word, 42, 3))
+		};
+
+		auto overflows = [&](size_t c) {
+			auto v = base[c] + delta[c];
+			return v < 0 || v > 31;
+		};
+
+		if (overflows(0)) {
+			decode_t_mode(word, out);
+			return;
+		} else if (overflows(1)) {
+			decode_h_mode(word, out);
+			return;
+		} else if (overflows(2)) {
+			decode_planar_mode(word, out);
+			return;
+		}
+
+		for (size_t c = 0; c != base.size(); ++c) {
+			c1[c] = extend_5_to_8(base[c]);
+			c2[c] = extend_5_to_8(base[c] + delta[c]);
+		}
+	}
+
+	std::array<int, 2> table_indices = {get_bits(word, 39, 3), get_bits(word, 36, 3)};
+
+	for (uint32_t x = 0; x != block_dim; ++x) {
+		for (uint32_t y = 0; y != block_dim; ++y) {
+			// sub-blocks are 2x4 side by side, or 4x2 on top of each other if flipped
+			size_t sub_block = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+
+			auto index = get_pixel_index(word, x, y);
+			int modifier = etc1_modifier_table[table_indices[sub_block]][index & 1];
+			if (index & 2) {
+				modifier = -modifier;
+			}
+
+			out[x][y] = add(sub_block == 0 ? c1 : c2, modifier);
+		}
+	}
+}
+
+void decode_eac_alpha_block(const uint8_t* data, alpha_block& out)
+{
+	auto word = read_block_word(data);
+
+	int base = get_bits(word, 63, 8);
+	int multiplier = get_bits(word, 55, 4);
+	const auto& modifiers = eac_modifier_table[get_bits(word, 51, 4)];
+
+	for (uint32_t x = 0; x != block_dim; ++x) {
+		for (uint32_t y = 0; y != block_dim; ++y) {
+			auto i = x * block_dim + y;
+			auto index = (word >> (45 - 3 * i)) & 0x7;
+			out[x][y] = clamp_to_uint8(base + modifiers[index] * multiplier);
+		}
+	}
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+template <size_t num_channels>
+rasterimage::image_variant decode_etc2(
+	r4::vector2<uint32_t> dims, //
+	utki::span<const uint8_t> data
+)
+{
+	rasterimage::image<uint8_t, num_channels> im(dims);
+
+	uint32_t blocks_x = (dims.x() + block_dim - 1) / block_dim;
+	uint32_t blocks_y = (dims.y() + block_dim - 1) / block_dim;
+
+	const uint8_t* p = data.data();
+
+	rgb_block rgb{};
+	alpha_block alpha{};
+
+	for (uint32_t by = 0; by != blocks_y; ++by) {
+		for (uint32_t bx = 0; bx != blocks_x; ++bx) {
+			if constexpr (num_channels == 4) {
+				decode_eac_alpha_block(p, alpha);
+				p += eac_alpha_block_size;
+			}
+			decode_etc2_rgb_block(p, rgb);
+			p += etc2_rgb_block_size;
+
+			// blocks at the right and bottom edges can be partially outside of the image
+			auto w = std::min(block_dim, dims.x() - bx * block_dim);
+			auto h = std::min(block_dim, dims.y() - by * block_dim);
+
+			for (uint32_t y = 0; y != h; ++y) {
+				auto row = im.pixels().subspan(size_t(by * block_dim + y) * dims.x() + bx * block_dim, w);
+				for (uint32_t x = 0; x != w; ++x) {
+					auto& px = row[x];
+					for (size_t c = 0; c != rgb[x][y].size(); ++c) {
+						px[c] = clamp_to_uint8(rgb[x][y][c]);
+					}
+					if constexpr (num_channels == 4) {
+						px[3] = alpha[x][y];
+					}
+				}
+			}
+		}
+	}
+
+	return rasterimage::image_variant(std::move(im));
+}
+} // namespace
+
+size_t compressed_image::get_block_size() const noexcept
+{
+	switch (this->format_v) {
+		case format::etc2_rgb8:
+			return etc2_rgb_block_size;
+		case format::etc2_rgba8:
+		default:
+			return etc2_rgb_block_size + eac_alpha_block_size;
+	}
+}
+
+size_t compressed_image::get_level_size(r4::vector2<uint32_t> level_dims) const noexcept
+{
+	return size_t((level_dims.x() + block_dim - 1) / block_dim) * ((level_dims.y() + block_dim - 1) / block_dim) *
+		this->get_block_size();
+}
+
+rasterimage::image_variant compressed_image::decode() const
+{
+	if (this->levels.empty() || this->levels.front().size() < this->get_level_size(this->dims)) {
+		throw std::invalid_argument("compressed_image::decode(): not enough image data");
+	}
+
+	switch (this->format_v) {
+		case format::etc2_rgb8:
+			return decode_etc2<3>(this->dims, this->levels.front());
+		case format::etc2_rgba8:
+			return decode_etc2<4>(this->dims, this->levels.front());
+	}
+
+	throw std::invalid_argument("compressed_image::decode(): unknown format");
+}
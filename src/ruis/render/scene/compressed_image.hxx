@@ -0,0 +1,97 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <r4/vector.hpp>
+#include <rasterimage/image_variant.hpp>
+#include <ruis/render/context.hpp>
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief GPU-compressed image.
+ * Block-compressed image data which can be uploaded to GPU as is, in case the GPU supports the format.
+ */
+struct compressed_image {
+	enum class format {
+		/**
+		 * @brief ETC2 RGB, 8 bytes per 4x4 block.
+		 */
+		etc2_rgb8,
+
+		/**
+		 * @brief ETC2 RGBA with EAC alpha, 16 bytes per 4x4 block.
+		 */
+		etc2_rgba8
+	};
+
+	format format_v;
+
+	/**
+	 * @brief Dimensions of the base mipmap level, in pixels.
+	 */
+	r4::vector2<uint32_t> dims;
+
+	/**
+	 * @brief Compressed data of mipmap levels.
+	 * Base level first, then each next level is half the size of the previous one.
+	 * Can contain only the base level.
+	 */
+	std::vector<utki::span<const uint8_t>> levels;
+
+	/**
+	 * @brief Get size of a compressed 4x4 block.
+	 * @return Size of a block in bytes.
+	 */
+	size_t get_block_size() const noexcept;
+
+	/**
+	 * @brief Get expected size of compressed mipmap level data.
+	 * @param level_dims - dimensions of the mipmap level in pixels.
+	 * @return Size of the level data in bytes.
+	 */
+	size_t get_level_size(r4::vector2<uint32_t> level_dims) const noexcept;
+
+	/**
+	 * @brief Decode base level to uncompressed image.
+	 * Used as a fallback when GPU does not support the compressed format.
+	 * @return RGB or RGBA image, depending on the compressed format.
+	 */
+	rasterimage::image_variant decode() const;
+};
+
+/**
+ * @brief Function creating GPU texture out of compressed image.
+ * Rendering backends which support compressed textures provide such a function.
+ * Returns null in case the GPU does not support the compressed format.
+ */
+using compressed_texture_factory = std::function<std::shared_ptr<ruis::render::texture_2d>(
+	const compressed_image& image,
+	const ruis::render::context::texture_2d_parameters& params
+)>;
+
+} // namespace ruis::render
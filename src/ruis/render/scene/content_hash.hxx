@@ -0,0 +1,180 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Calculate 64-bit hash of data content.
+ * This is a fast non-cryptographic hash, the data is processed in 8 byte words
+ * at close to memory bandwidth. Intended for identifying data content, e.g. cache keys.
+ * @param data - data to hash.
+ * @param seed - initial hash value, allows combining hashes.
+ * @return Hash value.
+ */
+inline uint64_t content_hash(
+	utki::span<const uint8_t> data, //
+	uint64_t seed = 0
+)
+{
+	constexpr uint64_t prime_1 = 0x9e3779b185ebca87ULL;
+	constexpr uint64_t prime_2 = 0xc2b2ae3d27d4eb4fULL;
+
+	auto mix = [](uint64_t h) {
+		constexpr auto shift_1 = 33;
+		constexpr auto shift_2 = 29;
+		constexpr auto shift_3 = 32;
+		h ^= h >> shift_1;
+		h *= prime_2;
+		h ^= h >> shift_2;
+		h *= prime_1;
+		h ^= h >> shift_3;
+		return h;
+	};
+
+	uint64_t h = seed ^ (uint64_t(data.size()) * prime_1);
+
+	const uint8_t* p = data.data();
+	const uint8_t* end = p + (data.size() & ~size_t(sizeof(uint64_t) - 1));
+
+	// four independent lanes to hide multiplication latency
+	std::array<uint64_t, 4> lanes = {h, h ^ prime_1, h ^ prime_2, h + prime_1 + prime_2};
+	constexpr auto lanes_bytes = sizeof(uint64_t) * 4;
+	for (; end - p >= std::ptrdiff_t(lanes_bytes); p += lanes_bytes) {
+		for (size_t i = 0; i != lanes.size(); ++i) {
+			uint64_t w = 0;
+			std::memcpy(&w, p + i * sizeof(uint64_t), sizeof(w));
+			lanes[i] = (lanes[i] ^ w) * prime_1;
+			lanes[i] ^= lanes[i] >> 31; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		}
+	}
+
+	for (auto l : lanes) {
+		h = mix(h ^ l);
+	}
+
+	for (; p != end; p += sizeof(uint64_t)) {
+		uint64_t w = 0;
+		std::memcpy(&w, p, sizeof(w));
+		h = mix(h ^ w);
+	}
+
+	uint64_t tail = 0;
+	std::memcpy(&tail, end, data.size() & (sizeof(uint64_t) - 1));
+	return mix(h ^ tail);
+}
+
+/**
+ * @brief 128-bit hash value.
+ */
+using content_hash_128_type = std::array<uint64_t, 2>;
+
+/**
+ * @brief Calculate 128-bit hash of data content.
+ * Two 64-bit hashes with differently mixed lanes are calculated in one pass over the data.
+ * Accidental collisions are practically impossible, so the hash is suitable for identifying
+ * data content without comparing the data itself. Note that it is not a cryptographic hash.
+ * @param data - data to hash.
+ * @param seed - initial hash value, allows combining hashes.
+ * @return Hash value.
+ */
+inline content_hash_128_type content_hash_128(
+	utki::span<const uint8_t> data, //
+	const content_hash_128_type& seed = {}
+)
+{
+	constexpr uint64_t prime_1 = 0x9e3779b185ebca87ULL;
+	constexpr uint64_t prime_2 = 0xc2b2ae3d27d4eb4fULL;
+	constexpr uint64_t prime_3 = 0x165667b19e3779f9ULL;
+	constexpr uint64_t prime_4 = 0x85ebca77c2b2ae63ULL;
+
+	auto mix = [](uint64_t h) {
+		constexpr auto shift_1 = 33;
+		constexpr auto shift_2 = 29;
+		constexpr auto shift_3 = 32;
+		h ^= h >> shift_1;
+		h *= prime_2;
+		h ^= h >> shift_2;
+		h *= prime_1;
+		h ^= h >> shift_3;
+		return h;
+	};
+
+	auto rotl = [](uint64_t v, unsigned bits) {
+		constexpr auto num_bits = sizeof(uint64_t) * 8;
+		return (v << bits) | (v >> (num_bits - bits));
+	};
+
+	// second hash words are mixed the way xxHash64 does
+	auto round = [&](uint64_t acc, uint64_t w) {
+		return rotl(acc + w * prime_2, 31) * prime_1; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	};
+
+	auto size_seed = uint64_t(data.size());
+	uint64_t h = seed[0] ^ (size_seed * prime_1);
+	uint64_t g = seed[1] ^ (size_seed * prime_3);
+
+	const uint8_t* p = data.data();
+	const uint8_t* end = p + (data.size() & ~size_t(sizeof(uint64_t) - 1));
+
+	// four independent lanes of each of the hashes to hide multiplication latency
+	std::array<uint64_t, 4> lanes = {h, h ^ prime_1, h ^ prime_2, h + prime_1 + prime_2};
+	std::array<uint64_t, 4> g_lanes = {g + prime_1 + prime_2, g + prime_2, g, g - prime_1};
+	constexpr auto lanes_bytes = sizeof(uint64_t) * 4;
+	for (; end - p >= std::ptrdiff_t(lanes_bytes); p += lanes_bytes) {
+		for (size_t i = 0; i != lanes.size(); ++i) {
+			uint64_t w = 0;
+			std::memcpy(&w, p + i * sizeof(uint64_t), sizeof(w));
+			lanes[i] = (lanes[i] ^ w) * prime_1;
+			lanes[i] ^= lanes[i] >> 31; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			g_lanes[i] = round(g_lanes[i], w);
+		}
+	}
+
+	for (size_t i = 0; i != lanes.size(); ++i) {
+		h = mix(h ^ lanes[i]);
+		g = rotl(g ^ round(0, g_lanes[i]), 27) * prime_1 + prime_4; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+
+	for (; p != end; p += sizeof(uint64_t)) {
+		uint64_t w = 0;
+		std::memcpy(&w, p, sizeof(w));
+		h = mix(h ^ w);
+		g = rotl(g ^ round(0, w), 27) * prime_1 + prime_4; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+
+	uint64_t tail = 0;
+	std::memcpy(&tail, end, data.size() & (sizeof(uint64_t) - 1));
+	h = mix(h ^ tail);
+	g = mix(g ^ round(0, tail) ^ prime_3);
+
+	return {h, g};
+}
+
+} // namespace ruis::render
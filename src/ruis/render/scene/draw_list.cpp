@@ -0,0 +1,226 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "draw_list.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ruis::render;
+
+void draw_list::build(
+	const scene& s, //
+	const ruis::mat4& root_model_matrix,
+	const lod_parameters* lod,
+	const frustum* view_frustum
+)
+{
+	for (auto& b : utki::make_span(this->batches.data(), this->num_batches)) {
+		b.model_matrices.clear();
+	}
+	this->num_batches = 0;
+	this->batch_indices.clear();
+
+	this->lod_params = lod;
+
+	this->culling_stats = {};
+
+	auto nodes = s.get_flat_nodes();
+	auto world_matrices = s.get_transform_hierarchy().get_world_matrices();
+	auto subtree_ends = s.get_flat_subtree_ends();
+	ASSERT(nodes.size() == world_matrices.size())
+	ASSERT(nodes.size() == subtree_ends.size())
+
+	auto is_visible = [&](const aabb& bounds, const ruis::mat4& matrix) {
+		if (view_frustum->classify(bounds.transform(matrix)) == frustum::intersection::outside) {
+			++this->culling_stats.num_culled_meshes;
+			return false;
+		}
+		return true;
+	};
+
+	// nodes before this index are in a subtree which is entirely inside the frustum, those are not tested
+	size_t inside_end = 0;
+
+	for (size_t i = 0; i != nodes.size();) {
+		const auto& n = *nodes[i];
+		const auto& world_matrix = world_matrices[i];
+
+		bool test_meshes = false;
+		if (view_frustum && i >= inside_end) {
+			switch (view_frustum->classify(n.bounds.transform(world_matrix))) {
+				case frustum::intersection::outside:
+					// skip the whole subtree
+					++this->culling_stats.num_culled_subtrees;
+					this->culling_stats.num_culled_nodes += subtree_ends[i] - i;
+					i = subtree_ends[i];
+					continue;
+				case frustum::intersection::inside:
+					inside_end = subtree_ends[i];
+					break;
+				case frustum::intersection::intersects:
+					// bounds of a leaf node without instances are the bounds of its mesh, no need to test again
+					test_meshes = !n.children.empty() || !n.instances.empty();
+					break;
+			}
+		}
+		++i;
+
+		if (!n.mesh_v) {
+			continue;
+		}
+
+		auto model_matrix = root_model_matrix * world_matrix;
+
+		if (n.instances.empty()) {
+			if (!test_meshes || is_visible(n.mesh_v->bounds, world_matrix)) {
+				if (this->add_mesh(n, model_matrix)) {
+					++this->culling_stats.num_visible_meshes;
+				}
+			}
+		} else {
+			for (const auto& m : n.instances) {
+				if (!test_meshes || is_visible(n.mesh_v->bounds, world_matrix * m)) {
+					if (this->add_mesh(n, model_matrix * m)) {
+						++this->culling_stats.num_visible_meshes;
+					}
+				}
+			}
+		}
+	}
+
+	this->lod_params = nullptr;
+}
+
+bool draw_list::add_mesh(
+	const node& n, //
+	const ruis::mat4& model_matrix
+)
+{
+	const mesh* m = n.mesh_v.get();
+	if (!m) {
+		return false;
+	}
+
+	size_t lod = 0;
+
+	if (this->lod_params) {
+		auto coverage = get_screen_coverage(m->bounds, model_matrix, *this->lod_params);
+
+		if (n.lod_screen_coverage.empty()) {
+			const auto& thresholds = this->lod_params->thresholds;
+			lod = size_t(std::count_if(thresholds.begin(), thresholds.end(), [&](auto t) {
+				return coverage < t;
+			}));
+		} else {
+			const auto& thresholds = n.lod_screen_coverage;
+			auto i = std::find_if(thresholds.begin(), thresholds.end(), [&](auto t) {
+				return coverage >= t;
+			});
+			if (i == thresholds.end()) {
+				// too small to be drawn
+				return false;
+			}
+			lod = size_t(std::distance(thresholds.begin(), i));
+		}
+
+		// node's levels of detail come first, the rest of the levels are taken from the primitives of its mesh
+		auto mesh_lod = std::min(lod, n.lods.size());
+		if (mesh_lod != 0) {
+			m = n.lods[mesh_lod - 1].get();
+			if (!m) {
+				return false;
+			}
+			lod -= mesh_lod;
+		}
+	}
+
+	for (const auto& p : m->primitives) {
+		this->add_instance(
+			p.get(), //
+			std::min(lod, p.get().lods.size()),
+			model_matrix
+		);
+	}
+
+	return !m->primitives.empty();
+}
+
+void draw_list::add_instance(
+	const primitive& p, //
+	size_t lod,
+	const ruis::mat4& model_matrix
+)
+{
+	const auto& vao = lod == 0 ? p.vao.get() : p.lods[lod - 1].get();
+
+	auto [i, inserted] = this->batch_indices.try_emplace(&vao, this->num_batches);
+	if (inserted) {
+		if (this->num_batches == this->batches.size()) {
+			this->batches.emplace_back();
+		}
+		auto& b = this->batches[this->num_batches];
+		b.primitive_v = &p;
+		b.vao = &vao;
+		b.lod = lod;
+		++this->num_batches;
+	}
+
+	this->batches[i->second].model_matrices.push_back(model_matrix);
+}
+
+size_t draw_list::get_num_instances() const noexcept
+{
+	size_t ret = 0;
+	for (const auto& b : this->get_batches()) {
+		ret += b.model_matrices.size();
+	}
+	return ret;
+}
+
+ruis::real draw_list::get_screen_coverage(
+	const aabb& bounds, //
+	const ruis::mat4& model_matrix,
+	const lod_parameters& lod
+)
+{
+	if (bounds.is_empty()) {
+		return 0;
+	}
+
+	ruis::vec3 center = lod.view_matrix * model_matrix * bounds.get_center();
+
+	// the model matrix can have non-uniform scaling, take the largest scale of its axes
+	ruis::real scale_pow2 = 0;
+	for (size_t c = 0; c != 3; ++c) {
+		ruis::vec3 axis{model_matrix[0][c], model_matrix[1][c], model_matrix[2][c]};
+		scale_pow2 = std::max(scale_pow2, axis.norm_pow2());
+	}
+	auto radius = bounds.get_extent().norm() * std::sqrt(scale_pow2);
+
+	auto distance = center.norm();
+	if (distance <= radius) {
+		return 1;
+	}
+
+	// projected radius relative to half of the viewport height
+	return std::min(radius * lod.projection_scale / distance, ruis::real(1));
+}
@@ -0,0 +1,195 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <ruis/config.hpp>
+#include <utki/span.hpp>
+
+#include "frustum.hpp"
+#include "scene.hpp"
+
+namespace ruis::render {
+
+/**
+ * @brief List of scene primitives to draw, grouped for instanced rendering.
+ * Nodes referring to the same mesh share its primitive objects, i.e. the same vertex array and material pair.
+ * All occurrences of such a primitive in the scene are collected into a single batch holding the model matrix
+ * of each instance, so that the batch can be drawn with one instanced draw call.
+ * Batches are ordered by the first occurrence of their primitive in the scene node tree.
+ * The nodes are taken from the scene's flattened transform hierarchy, using its world matrices,
+ * see scene::update_transforms().
+ *
+ * Optionally, a level of detail is selected for each primitive occurrence based on its size on screen,
+ * see lod_parameters. Different levels of the same primitive go to different batches.
+ *
+ * Optionally, nodes outside of the view frustum are culled. Subtree bounds of each node are tested first,
+ * so that a subtree outside of the frustum is rejected as a whole and nodes of a subtree entirely inside
+ * of the frustum are not tested at all. Node meshes are tested individually only in partially visible subtrees.
+ */
+class draw_list
+{
+public:
+	struct batch {
+		const primitive* primitive_v = nullptr;
+
+		/**
+		 * @brief Vertex array to draw.
+		 * Either the primitive's vao or one of its levels of detail.
+		 */
+		const vertex_array* vao = nullptr;
+
+		/**
+		 * @brief Level of detail of the vertex array, 0 is the primitive's vao.
+		 */
+		size_t lod = 0;
+
+		std::vector<ruis::mat4> model_matrices;
+	};
+
+	struct lod_parameters {
+		ruis::mat4 view_matrix;
+
+		/**
+		 * @brief Vertical scale of the perspective projection.
+		 * Cotangent of half of the vertical field of view angle.
+		 */
+		ruis::real projection_scale;
+
+		/**
+		 * @brief Screen coverage thresholds of the levels of detail, in descending order.
+		 * Screen coverage is the fraction of the viewport height covered by the mesh bounds.
+		 * Level N is drawn when the coverage is less than N first thresholds, but not less than the rest.
+		 * Meshes having fewer levels are drawn with their least detailed level.
+		 */
+		utki::span<const ruis::real> thresholds;
+	};
+
+	struct culling_statistics {
+		/**
+		 * @brief Number of node subtrees rejected as a whole.
+		 */
+		size_t num_culled_subtrees = 0;
+
+		/**
+		 * @brief Number of nodes in the rejected subtrees.
+		 */
+		size_t num_culled_nodes = 0;
+
+		/**
+		 * @brief Number of node meshes and mesh instances rejected individually.
+		 */
+		size_t num_culled_meshes = 0;
+
+		/**
+		 * @brief Number of node meshes and mesh instances added to the draw list.
+		 * Those which passed culling, but are too small to be drawn at any level of detail, are not counted.
+		 */
+		size_t num_visible_meshes = 0;
+	};
+
+private:
+	// batches beyond num_batches are unused, those are kept to reuse memory of their model matrix vectors
+	std::vector<batch> batches;
+	size_t num_batches = 0;
+
+	std::unordered_map<const vertex_array*, size_t> batch_indices;
+
+	// only during build() call, can be null
+	const lod_parameters* lod_params = nullptr;
+
+	culling_statistics culling_stats;
+
+	// returns false if nothing was added, e.g. because the mesh is too small to be drawn
+	bool add_mesh(
+		const node& n, //
+		const ruis::mat4& model_matrix
+	);
+
+	void add_instance(
+		const primitive& p, //
+		size_t lod,
+		const ruis::mat4& model_matrix
+	);
+
+public:
+	/**
+	 * @brief Collect primitives of the scene.
+	 * Previous content of the list is cleared.
+	 * The scene's world matrices must be up to date, see scene::update_transforms().
+	 * @param s - scene to collect primitives of.
+	 * @param root_model_matrix - model matrix to apply to the scene's root nodes.
+	 * @param lod - optional level of detail selection parameters. If null, the most detailed level is used.
+	 * @param view_frustum - optional frustum to cull the scene nodes against, in coordinates of the scene,
+	 *                       i.e. before root_model_matrix is applied. If null, nothing is culled.
+	 *                       The scene's bounds must be up to date, see scene::update_bounds().
+	 */
+	void build(
+		const scene& s, //
+		const ruis::mat4& root_model_matrix,
+		const lod_parameters* lod = nullptr,
+		const frustum* view_frustum = nullptr
+	);
+
+	/**
+	 * @brief Get culling statistics.
+	 * @return Culling statistics of the last build() call.
+	 */
+	const culling_statistics& get_culling_statistics() const noexcept
+	{
+		return this->culling_stats;
+	}
+
+	/**
+	 * @brief Get batches.
+	 * Each batch has at least one instance.
+	 * @return Batches collected by last build() call.
+	 */
+	utki::span<const batch> get_batches() const noexcept
+	{
+		return utki::make_span(this->batches.data(), this->num_batches);
+	}
+
+	/**
+	 * @brief Get total number of primitive instances.
+	 * @return Sum of number of instances of all batches.
+	 */
+	size_t get_num_instances() const noexcept;
+
+	/**
+	 * @brief Get screen coverage of a bounding box.
+	 * The coverage is estimated using the bounding sphere of the box.
+	 * @param bounds - bounding box in model coordinates.
+	 * @param model_matrix - model matrix of the bounding box.
+	 * @param lod - level of detail selection parameters.
+	 * @return Fraction of the viewport height covered by the bounding sphere, 1 if the camera is inside the sphere.
+	 */
+	static ruis::real get_screen_coverage(
+		const aabb& bounds, //
+		const ruis::mat4& model_matrix,
+		const lod_parameters& lod
+	);
+};
+
+} // namespace ruis::render
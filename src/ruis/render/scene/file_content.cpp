@@ -0,0 +1,133 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "file_content.hxx"
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+#include <fsif/native_file.hpp>
+#include <utki/config.hpp>
+#include <utki/debug.hpp>
+#include <utki/util.hpp>
+
+#if (CFG_OS == CFG_OS_LINUX || CFG_OS == CFG_OS_MACOSX) && CFG_OS_NAME != CFG_OS_NAME_EMSCRIPTEN
+#	define RUIS_RENDER_SCENE_MMAP_SUPPORTED
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace ruis::render;
+
+file_content::file_content(const fsif::file& fi)
+{
+	if (this->map(fi)) {
+		return;
+	}
+
+	this->loaded_data = fi.load();
+	this->data = utki::make_span(this->loaded_data);
+}
+
+file_content::~file_content()
+{
+#ifdef RUIS_RENDER_SCENE_MMAP_SUPPORTED
+	if (this->mapping) {
+		munmap(this->mapping, this->mapping_size);
+	}
+#endif
+}
+
+bool file_content::map(const fsif::file& fi)
+{
+#ifdef RUIS_RENDER_SCENE_MMAP_SUPPORTED
+	// only native files can be memory-mapped, other file implementations,
+	// e.g. files inside of zip archives, are not backed by a file descriptor
+	if (!dynamic_cast<const fsif::native_file*>(&fi)) {
+		return false;
+	}
+
+	int fd = open(fi.path().c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	utki::scope_exit fd_scope_exit([fd]() {
+		close(fd);
+	});
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		return false;
+	}
+
+	auto size = size_t(st.st_size);
+
+	void* m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (m == MAP_FAILED) {
+		utki::log_debug([&](auto& o) {
+			o << "file_content: mmap() failed for " << fi.path() << ", falling back to loading" << std::endl;
+		});
+		return false;
+	}
+
+	this->mapping = m;
+	this->mapping_size = size;
+	this->data = utki::make_span(static_cast<const uint8_t*>(m), size);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::shared_ptr<const file_content> ruis::render::get_shared_file_content(const fsif::file& fi)
+{
+	// paths of other file implementations, e.g. inside of zip archives, do not identify the file globally
+	if (!dynamic_cast<const fsif::native_file*>(&fi)) {
+		return std::make_shared<const file_content>(fi);
+	}
+
+	static std::mutex mutex;
+	static std::map<std::string, std::weak_ptr<const file_content>, std::less<>> contents;
+
+	auto path = std::filesystem::absolute(fi.path()).lexically_normal().string();
+
+	std::lock_guard lock(mutex);
+
+	// forget contents which are not used anymore
+	std::erase_if(contents, [](const auto& c) {
+		return c.second.expired();
+	});
+
+	if (auto it = contents.find(path); it != contents.end()) {
+		if (auto c = it->second.lock()) {
+			return c;
+		}
+	}
+
+	auto c = std::make_shared<const file_content>(fi);
+	contents.insert_or_assign(std::move(path), c);
+	return c;
+}
@@ -0,0 +1,87 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <fsif/file.hpp>
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Read-only content of a file.
+ * For native files the content is memory-mapped, so no copy of the file data is made
+ * and pages are loaded by the OS on demand. For other fsif::file implementations,
+ * or in case memory mapping fails, the whole file is loaded into memory.
+ */
+class file_content
+{
+	std::vector<uint8_t> loaded_data;
+
+	void* mapping = nullptr;
+	size_t mapping_size = 0;
+
+	utki::span<const uint8_t> data;
+
+	bool map(const fsif::file& fi);
+
+public:
+	explicit file_content(const fsif::file& fi);
+
+	file_content(const file_content&) = delete;
+	file_content& operator=(const file_content&) = delete;
+
+	file_content(file_content&&) = delete;
+	file_content& operator=(file_content&&) = delete;
+
+	~file_content();
+
+	utki::span<const uint8_t> span() const noexcept
+	{
+		return this->data;
+	}
+
+	/**
+	 * @brief Check if the file content is memory-mapped.
+	 * @return true if the file content is memory-mapped.
+	 * @return false if the file content was loaded into memory.
+	 */
+	bool is_mapped() const noexcept
+	{
+		return this->mapping != nullptr;
+	}
+};
+
+/**
+ * @brief Get file content shared between all its users.
+ * Content of native files is shared by the file path, so a file referenced by several users,
+ * e.g. a geometry buffer referenced by several glTF files, is mapped or loaded only once as long as
+ * any of the users holds the returned pointer. Content of other fsif::file implementations is not shared.
+ * Can be called from any thread.
+ * @param fi - file to get the content of.
+ * @return Shared file content.
+ */
+std::shared_ptr<const file_content> get_shared_file_content(const fsif::file& fi);
+
+} // namespace ruis::render
@@ -0,0 +1,73 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "frustum.hpp"
+
+#include <cmath>
+
+using namespace ruis::render;
+
+frustum::intersection frustum::classify(const aabb& box) const noexcept
+{
+	if (box.is_empty()) {
+		return intersection::outside;
+	}
+
+	auto center = box.get_center();
+	auto extent = box.get_extent();
+
+	auto ret = intersection::inside;
+
+	for (const auto& p : this->planes) {
+		// signed distance of the box center and projected radius of the box, both scaled by the plane normal length
+		auto distance = p.x() * center.x() + p.y() * center.y() + p.z() * center.z() + p.w();
+		auto radius = std::abs(p.x()) * extent.x() + std::abs(p.y()) * extent.y() + std::abs(p.z()) * extent.z();
+
+		if (distance + radius < 0) {
+			return intersection::outside;
+		}
+		if (distance - radius < 0) {
+			ret = intersection::intersects;
+		}
+	}
+
+	return ret;
+}
+
+frustum frustum::from_matrix(const ruis::mat4& m) noexcept
+{
+	// matrix rows, the clip coordinate x is row 0 times the point and so on
+	const auto& x = m[0];
+	const auto& y = m[1];
+	const auto& z = m[2];
+	const auto& w = m[3];
+
+	return {
+		.planes = {
+			w + x, // left
+			w - x, // right
+			w + y, // bottom
+			w - y, // top
+			w + z, // near
+			w - z // far
+		}
+	};
+}
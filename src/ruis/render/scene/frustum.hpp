@@ -0,0 +1,69 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+
+#include <ruis/config.hpp>
+
+#include "aabb.hpp"
+
+namespace ruis::render {
+
+/**
+ * @brief View frustum.
+ * Convex volume bounded by six planes. Each plane is stored as (a, b, c, d) with the normal (a, b, c)
+ * pointing inside the frustum, i.e. point p is inside the frustum if a * p.x + b * p.y + c * p.z + d >= 0
+ * for all the planes. The planes are not normalized.
+ */
+struct frustum {
+	std::array<ruis::vec4, 6> planes;
+
+	enum class intersection {
+		outside,
+		intersects,
+		inside
+	};
+
+	/**
+	 * @brief Classify bounding box against the frustum.
+	 * The test is conservative, a box near a frustum corner can be classified as intersecting
+	 * while being outside of the frustum.
+	 * @param box - box to classify.
+	 * @return outside if the box is entirely outside of the frustum, inside if the box is entirely inside of
+	 *         the frustum, intersects otherwise. Empty box is outside.
+	 */
+	intersection classify(const aabb& box) const noexcept;
+
+	/**
+	 * @brief Make frustum from a clipping matrix.
+	 * The frustum contains the points which the matrix transforms into the clip volume,
+	 * i.e. -w <= x, y, z <= w. See "Fast Extraction of Viewing Frustum Planes from the
+	 * World-View-Projection Matrix" by Gil Gribb and Klaus Hartmann.
+	 * @param m - projection matrix, possibly multiplied by view and model matrices.
+	 *            Then the frustum is in the coordinates the model matrix transforms from.
+	 * @return The frustum.
+	 */
+	static frustum from_matrix(const ruis::mat4& m) noexcept;
+};
+
+} // namespace ruis::render
@@ -21,13 +21,26 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "gltf_loader.hxx"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <limits>
+
 #include <fsif/span_file.hpp>
-#include <jsondom/dom.hpp>
 #include <rasterimage/image_variant.hpp>
 #include <utki/deserializer.hpp>
 #include <utki/string.hpp>
 #include <utki/util.hpp>
 
+#include "file_content.hxx"
+#include "gpu_resource_cache.hxx"
+#include "index_optimizer.hxx"
+#include "ktx2.hxx"
+#include "mesh_simplifier.hxx"
+#include "parallel.hxx"
+
 using namespace std::string_literals;
 using namespace std::string_view_literals;
 using namespace ruis::render;
@@ -46,66 +59,154 @@ accessor::accessor(
 	component_type_v(component_type_v)
 {}
 
+uint32_t accessor::get_num_components() const noexcept
+{
+	switch (this->type_v) {
+		case type::scalar:
+		case type::vec2:
+		case type::vec3:
+		case type::vec4:
+			// enum values are equal to number of components
+			return uint32_t(this->type_v);
+		default:
+			return 0;
+	}
+}
+
+namespace {
+// progress values of the reading stages,
+// image decoding and tangent generation are the most time consuming stages
+constexpr float progress_images_start = 0.05f;
+constexpr float progress_images_end = 0.6f;
+constexpr float progress_meshes_start = 0.65f;
+constexpr float progress_meshes_end = 0.95f;
+} // namespace
+
+void gltf_loader::report_progress(float value)
+{
+	if (this->progress) {
+		this->progress->report(value);
+	}
+}
+
+void gltf_loader::check_cancelled() const
+{
+	if (this->progress) {
+		this->progress->check_cancelled();
+	}
+}
+
+std::chrono::steady_clock::time_point gltf_loader::start_stage()
+{
+	if (this->stats && this->stats->allocation_counter) {
+		this->stage_start_num_allocations = this->stats->allocation_counter->load(std::memory_order_relaxed);
+	}
+	return std::chrono::steady_clock::now();
+}
+
+std::chrono::steady_clock::time_point gltf_loader::finish_stage(
+	load_statistics::stage s, //
+	std::chrono::steady_clock::time_point start
+)
+{
+	auto now = std::chrono::steady_clock::now();
+	if (this->stats) {
+		this->stats->stage_times[size_t(s)] += now - start;
+
+		if (const auto* counter = this->stats->allocation_counter) {
+			auto num_allocations = counter->load(std::memory_order_relaxed);
+			this->stats->stage_allocations[size_t(s)] += num_allocations - this->stage_start_num_allocations;
+			this->stage_start_num_allocations = num_allocations;
+		}
+	}
+	return now;
+}
+
 gltf_loader::gltf_loader(ruis::render::context& render_context) :
-	render_context(render_context)
+	gltf_loader(render_context, parameters{})
+{}
+
+gltf_loader::gltf_loader(
+	ruis::render::context& render_context, //
+	parameters params
+) :
+	render_context(render_context),
+	params(std::move(params))
 {}
 
 namespace {
 
 // TODO: rename to read_int32()
 int32_t read_int(
-	const jsondom::value& json, //
+	json_value json, //
 	std::string_view name,
 	int32_t default_value = -1
 )
 {
-	auto it = json.object().find(name);
-	if (it != json.object().end())
-		return it->second.number().to_int32();
+	auto v = json.get(name);
+	if (v.is_number())
+		return v.to_int32();
 
 	return default_value;
 }
 
 // TODO: rename to read_uint32()
 uint32_t read_uint(
-	const jsondom::value& json, //
+	json_value json, //
 	std::string_view name,
 	uint32_t default_value = 0
 )
 {
-	auto it = json.object().find(name);
-	if (it != json.object().end())
-		return it->second.number().to_uint32();
+	auto v = json.get(name);
+	if (v.is_number())
+		return v.to_uint32();
 
 	return default_value;
 }
 
 std::string read_string(
-	const jsondom::value& json, //
+	json_value json, //
 	std::string_view name,
 	const std::string default_value = {}
 )
 {
-	auto it = json.object().find(name);
-	if (it != json.object().end())
-		return it->second.string();
+	auto v = json.get(name);
+	if (v.is_string())
+		return std::string(v.string());
 
 	return default_value;
 }
 
 std::vector<uint32_t> read_uint_array(
-	const jsondom::value& json, //
+	json_value json, //
 	std::string_view name,
 	uint32_t dafault_value = 0
 )
 {
 	std::vector<uint32_t> arr;
-	auto it = json.object().find(name);
-	if (it != json.object().end() && it->second.is_array()) {
-		arr.reserve(it->second.array().size());
+	auto arr_json = json.get(name);
+	if (arr_json.is_array()) {
+		arr.reserve(arr_json.size());
+
+		for (auto index : arr_json) {
+			arr.push_back(index.to_uint32());
+		}
+	}
+	return arr;
+}
+
+std::vector<float> read_float_array(
+	json_value json, //
+	std::string_view name
+)
+{
+	std::vector<float> arr;
+	auto arr_json = json.get(name);
+	if (arr_json.is_array()) {
+		arr.reserve(arr_json.size());
 
-		for (const auto& index : it->second.array()) {
-			arr.push_back(index.number().to_uint32());
+		for (auto value : arr_json) {
+			arr.push_back(value.to_float());
 		}
 	}
 	return arr;
@@ -113,27 +214,30 @@ std::vector<uint32_t> read_uint_array(
 
 template <typename tp_type, size_t dimension>
 r4::vector<tp_type, dimension> read_vec(
-	const jsondom::value& json,
+	json_value json,
 	std::string_view name,
 	const r4::vector<tp_type, dimension> default_value
 )
 {
-	auto it = json.object().find(name);
+	auto arr_json = json.get(name);
 
-	if (it == json.object().end() || !it->second.is_array()) {
+	if (!arr_json.is_array()) {
 		return default_value;
 	}
 
 	r4::vector<tp_type, dimension> value{0};
-	int i = 0;
-	for (const auto& subjson : it->second.array()) {
-		value[i++] = subjson.number().to_float();
+	size_t i = 0;
+	for (auto subjson : arr_json) {
+		if (i == dimension) {
+			break;
+		}
+		value[i++] = subjson.to_float();
 	}
 	return value;
 }
 
 ruis::quat read_quat(
-	const jsondom::value& json, //
+	json_value json, //
 	std::string_view name,
 	const ruis::quat default_value
 )
@@ -146,9 +250,228 @@ ruis::quat read_quat(
 	return ruis::quat{vec};
 }
 
+constexpr std::string_view data_uri_prefix = "data:"sv;
+
+bool is_data_uri(std::string_view uri)
+{
+	return uri.starts_with(data_uri_prefix);
+}
+
+std::vector<uint8_t> decode_base64(std::string_view str)
+{
+	auto decode_char = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z') {
+			return c - 'A';
+		}
+		if (c >= 'a' && c <= 'z') {
+			return c - 'a' + ('Z' - 'A' + 1);
+		}
+		if (c >= '0' && c <= '9') {
+			return c - '0' + 2 * ('Z' - 'A' + 1);
+		}
+		if (c == '+') {
+			return 62; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		}
+		if (c == '/') {
+			return 63; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		}
+		return -1;
+	};
+
+	constexpr auto bits_per_char = 6;
+	constexpr auto bits_per_byte = 8;
+
+	std::vector<uint8_t> ret;
+	ret.reserve(str.size() * bits_per_char / bits_per_byte);
+
+	uint32_t accumulator = 0;
+	int num_bits = 0;
+	for (char c : str) {
+		if (c == '=') {
+			break;
+		}
+		int v = decode_char(c);
+		if (v < 0) {
+			throw std::invalid_argument("gltf: invalid base64 data");
+		}
+		accumulator = (accumulator << bits_per_char) | uint32_t(v);
+		num_bits += bits_per_char;
+		if (num_bits >= bits_per_byte) {
+			num_bits -= bits_per_byte;
+			ret.push_back(uint8_t(accumulator >> num_bits));
+		}
+	}
+	return ret;
+}
+
+// decodes "data:[<media type>];base64,<data>" URI
+std::vector<uint8_t> decode_data_uri(std::string_view uri)
+{
+	auto comma_pos = uri.find(',');
+	if (comma_pos == std::string_view::npos || !uri.substr(0, comma_pos).ends_with(";base64"sv)) {
+		throw std::invalid_argument("gltf: only base64 encoded data URIs are supported");
+	}
+	return decode_base64(uri.substr(comma_pos + 1));
+}
+
+// resolves relative URI reference to a file path relative to the glTF file
+std::unique_ptr<fsif::file> open_uri(
+	const fsif::file& gltf_file, //
+	std::string_view uri
+)
+{
+	if (uri.find(':') != std::string_view::npos) {
+		throw std::invalid_argument(utki::cat("gltf: only relative buffer URIs are supported, got: ", uri));
+	}
+
+	// URIs are percent-encoded, e.g. spaces in file names are encoded as %20
+	std::string path(gltf_file.dir());
+	for (size_t i = 0; i != uri.size(); ++i) {
+		constexpr auto hex_base = 16;
+		if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(uint8_t(uri[i + 1])) &&
+			std::isxdigit(uint8_t(uri[i + 2])))
+		{
+			path.push_back(char(std::stoi(std::string(uri.substr(i + 1, 2)), nullptr, hex_base)));
+			i += 2;
+		} else {
+			path.push_back(uri[i]);
+		}
+	}
+
+	return gltf_file.spawn(std::move(path));
+}
+
+struct gltf_container {
+	utki::span<const uint8_t> json;
+
+	// empty for .gltf files and for .glb files without BIN chunk
+	utki::span<const uint8_t> bin;
+};
+
+// .glb files start with 'glTF' magic, everything else is considered to be a JSON .gltf file
+gltf_container read_container(utki::span<const uint8_t> gltf)
+{
+	constexpr auto gltf_header_size = 4;
+	if (gltf.size() < gltf_header_size || std::string_view(
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		reinterpret_cast<const char*>(gltf.data()),
+		gltf_header_size
+	) != "glTF"sv)
+	{
+		return {.json = gltf, .bin = {}};
+	}
+
+	utki::deserializer d(gltf);
+
+	d.skip(gltf_header_size);
+
+	auto version = d.read_uint32_le();
+	constexpr auto expected_gltf_version = 2;
+	if (version != expected_gltf_version) {
+		throw std::invalid_argument(utki::cat("read_gltf(): glTF file version is not as expected: ", version));
+	}
+
+	auto gltf_length = d.read_uint32_le();
+	if (gltf_length != gltf.size()) {
+		throw std::invalid_argument(
+			utki::cat("read_gltf(): glTF file size ", gltf.size(), " does not match length ", gltf_length)
+		);
+	}
+
+	auto chunk_length = d.read_uint32_le();
+	if (chunk_length == 0) {
+		throw std::invalid_argument("read_gltf(): chunk length = 0");
+	}
+	constexpr auto chunk_type_length = 4;
+	if (auto chunk_type = d.read_string(chunk_type_length); chunk_type != "JSON"sv) {
+		throw std::invalid_argument(
+			utki::cat("read_gltf(): unexpected first chunk type: ", chunk_type, ", expected JSON")
+		);
+	}
+
+	gltf_container ret;
+
+	ret.json = d.read_span(chunk_length);
+
+	// BIN chunk is optional, all buffers can be external
+	if (d.empty()) {
+		return ret;
+	}
+
+	chunk_length = d.read_uint32_le();
+	if (chunk_length == 0) {
+		throw std::invalid_argument("read_gltf(): chunk length = 0");
+	}
+	if (auto chunk_type = d.read_string(chunk_type_length); chunk_type != "BIN\0"sv) {
+		throw std::invalid_argument(
+			utki::cat("read_gltf(): unexpected second chunk type: ", chunk_type, ", expected BIN")
+		);
+	}
+
+	ret.bin = d.read_span(chunk_length);
+
+	return ret;
+}
+
 } // namespace
 
-utki::shared_ref<buffer_view> gltf_loader::read_buffer_view(const jsondom::value& buffer_view_json)
+utki::shared_ref<buffer> gltf_loader::read_buffer(json_value buffer_json)
+{
+	return utki::make_shared<buffer>(
+		read_uint(buffer_json, "byteLength"sv), //
+		read_string(buffer_json, "uri"sv)
+	);
+}
+
+void gltf_loader::load_buffer(buffer& buf) const
+{
+	utki::span<const uint8_t> data;
+
+	if (buf.uri.empty()) {
+		// only the first buffer of .glb file can refer to the BIN chunk
+		if (this->buffers.empty() || &buf != &this->buffers.front().get() || this->glb_binary_buffer.empty()) {
+			throw std::invalid_argument("gltf: buffer has neither URI nor .glb BIN chunk");
+		}
+		data = this->glb_binary_buffer;
+	} else if (is_data_uri(buf.uri)) {
+		auto decoded = std::make_shared<const std::vector<uint8_t>>(decode_data_uri(buf.uri));
+		this->memory.allocated(decoded->capacity());
+		data = utki::make_span(*decoded);
+		buf.owner = std::move(decoded);
+	} else {
+		ASSERT(this->gltf_file)
+		auto content = get_shared_file_content(*open_uri(*this->gltf_file, buf.uri));
+		data = content->span();
+		buf.owner = std::move(content);
+	}
+
+	// .glb BIN chunk can be padded
+	if (data.size() < buf.byte_length) {
+		throw std::invalid_argument(
+			utki::cat("gltf: buffer data size ", data.size(), " is less than buffer byteLength ", buf.byte_length)
+		);
+	}
+	buf.data = data.subspan(0, buf.byte_length);
+}
+
+utki::span<const uint8_t> gltf_loader::get_buffer_data(buffer& buf) const
+{
+	// buffers are loaded on first use, which can happen on any of the worker threads
+	std::call_once(buf.loaded, [&]() {
+		this->load_buffer(buf);
+	});
+	return buf.data;
+}
+
+utki::shared_ref<buffer> gltf_loader::get_buffer(uint32_t index) const
+{
+	if (index >= this->buffers.size()) {
+		throw std::invalid_argument(utki::cat("gltf: buffer index out of range: ", index));
+	}
+	return this->buffers[index];
+}
+
+utki::shared_ref<buffer_view> gltf_loader::read_buffer_view(json_value buffer_view_json)
 {
 	const uint32_t byte_length = read_uint(buffer_view_json, "byteLength"sv);
 	const uint32_t byte_offset = read_uint(buffer_view_json, "byteOffset"sv);
@@ -156,52 +479,235 @@ utki::shared_ref<buffer_view> gltf_loader::read_buffer_view(const jsondom::value
 	const uint32_t target = read_uint(buffer_view_json, "target"sv);
 
 	auto new_buffer_view = utki::make_shared<buffer_view>(
-		byte_length, //
+		this->get_buffer(read_uint(buffer_view_json, "buffer"sv)), //
+		byte_length,
 		byte_offset,
 		byte_stride,
 		buffer_view::target(target)
 	);
+
+	// the buffer view itself then refers to a fallback buffer, which normally has no data
+	auto meshopt_json = buffer_view_json.get("extensions"sv).get("EXT_meshopt_compression"sv);
+	if (!meshopt_json.is_object()) {
+		return new_buffer_view;
+	}
+
+	meshopt_compression params;
+
+	params.count = read_uint(meshopt_json, "count"sv);
+	params.byte_stride = read_uint(meshopt_json, "byteStride"sv);
+
+	auto mode = read_string(meshopt_json, "mode"sv);
+	if (mode == "ATTRIBUTES"sv) {
+		params.mode_v = meshopt_compression::mode::attributes;
+	} else if (mode == "TRIANGLES"sv) {
+		params.mode_v = meshopt_compression::mode::triangles;
+	} else if (mode == "INDICES"sv) {
+		params.mode_v = meshopt_compression::mode::indices;
+	} else {
+		throw std::invalid_argument(utki::cat("gltf: EXT_meshopt_compression: unknown mode: ", mode));
+	}
+
+	auto filter = read_string(meshopt_json, "filter"sv, "NONE"s);
+	if (filter == "NONE"sv) {
+		params.filter_v = meshopt_compression::filter::none;
+	} else if (filter == "OCTAHEDRAL"sv) {
+		params.filter_v = meshopt_compression::filter::octahedral;
+	} else if (filter == "QUATERNION"sv) {
+		params.filter_v = meshopt_compression::filter::quaternion;
+	} else if (filter == "EXPONENTIAL"sv) {
+		params.filter_v = meshopt_compression::filter::exponential;
+	} else {
+		throw std::invalid_argument(utki::cat("gltf: EXT_meshopt_compression: unknown filter: ", filter));
+	}
+
+	if (size_t(params.count) * params.byte_stride != byte_length) {
+		throw std::invalid_argument("gltf: EXT_meshopt_compression: decoded size does not match buffer view length");
+	}
+
+	new_buffer_view.get().meshopt = buffer_view::meshopt_source{
+		.buf = this->get_buffer(read_uint(meshopt_json, "buffer"sv)),
+		.byte_length = read_uint(meshopt_json, "byteLength"sv),
+		.byte_offset = read_uint(meshopt_json, "byteOffset"sv),
+		.params = params
+	};
+
 	return new_buffer_view;
 }
 
-// TODO: better name for tp_type
+void gltf_loader::decode_buffer_views()
+{
+	std::vector<buffer_view*> compressed;
+	for (auto& bv : this->buffer_views) {
+		if (bv.get().meshopt.has_value()) {
+			compressed.push_back(&bv.get());
+		}
+	}
+
+	// buffer views are independent, so decode them in parallel on worker threads
+	std::vector<std::vector<uint8_t>> decoded(compressed.size());
+
+	parallel_for(compressed.size(), [&](size_t i) {
+		this->check_cancelled();
+
+		const auto& src = compressed[i]->meshopt.value();
+		auto buffer_data = this->get_buffer_data(src.buf.get());
+		if (size_t(src.byte_offset) + src.byte_length > buffer_data.size()) {
+			throw std::invalid_argument("gltf: EXT_meshopt_compression: data is out of buffer bounds");
+		}
+
+		decoded[i] = decode_meshopt(
+			buffer_data.subspan(src.byte_offset, src.byte_length), //
+			src.params
+		);
+		this->memory.allocated(decoded[i].capacity());
+	});
+
+	// storing to scene data is not thread safe
+	for (size_t i = 0; i != compressed.size(); ++i) {
+		// storing reports the memory again
+		this->memory.freed(decoded[i].capacity());
+		compressed[i]->decoded_data = this->store(std::move(decoded[i]));
+	}
+}
+
+utki::span<const uint8_t> gltf_loader::get_buffer_view_data(const buffer_view& bv) const
+{
+	if (bv.meshopt.has_value()) {
+		return bv.decoded_data;
+	}
+
+	auto buffer_data = this->get_buffer_data(bv.buf.get());
+	if (size_t(bv.byte_offset) + bv.byte_length > buffer_data.size()) {
+		throw std::invalid_argument("gltf: buffer view is out of buffer bounds");
+	}
+	return buffer_data.subspan(bv.byte_offset, bv.byte_length);
+}
+
+namespace {
+template <typename tp_type>
+struct element_traits {
+	using component_type = tp_type;
+	constexpr static size_t num_components = 1;
+};
+
+template <typename tp_type, size_t dimension>
+struct element_traits<r4::vector<tp_type, dimension>> {
+	using component_type = tp_type;
+	constexpr static size_t num_components = dimension;
+};
+
+template <typename tp_type>
+tp_type read_component_le(utki::deserializer& d)
+{
+	if constexpr (std::is_same_v<tp_type, float>) {
+		return d.read_float_le();
+	} else if constexpr (std::is_same_v<tp_type, uint8_t> || std::is_same_v<tp_type, int8_t>) {
+		return tp_type(d.read_uint8());
+	} else if constexpr (std::is_same_v<tp_type, uint16_t> || std::is_same_v<tp_type, int16_t>) {
+		return tp_type(d.read_uint16_le());
+	} else {
+		static_assert(std::is_same_v<tp_type, uint32_t>, "unsupported accessor component type");
+		return d.read_uint32_le();
+	}
+}
+} // namespace
+
 template <typename tp_type>
-void gltf_loader::make_vertex_buffer_float(
-	utki::shared_ref<ruis::render::accessor> new_accessor,
+utki::span<const tp_type> gltf_loader::read_accessor_data(
+	accessor& acc,
 	utki::span<const uint8_t> buffer,
-	uint32_t acc_count, // in elements (e.g. a whole vec3)
-	uint32_t acc_stride // in bytes
+	uint32_t stride // in bytes, 0 means tightly packed
 )
 {
-	utki::deserializer d(buffer);
-	std::vector<tp_type> vertex_attribute_buffer;
-	vertex_attribute_buffer.reserve(acc_count);
+	using traits = element_traits<tp_type>;
+	using component_type = typename traits::component_type;
 
-	int n_skip_bytes = int(acc_stride) - int(sizeof(tp_type));
-	if (n_skip_bytes < 0)
-		n_skip_bytes = 0;
+	constexpr auto element_size = sizeof(component_type) * traits::num_components;
+	static_assert(sizeof(tp_type) == element_size, "element type has padding");
 
-	for (uint32_t i = 0; i < acc_count; ++i) {
-		tp_type t;
+	if (stride == 0) {
+		stride = element_size;
+	}
 
-		if constexpr (std::is_same_v<tp_type, float>) {
-			t = d.read_float_le();
-		} else {
-			// TODO: use range based for loop
-			for (uint32_t j = 0; j < t.size(); ++j) {
-				t[j] = d.read_float_le();
+	if (acc.count == 0) {
+		return {};
+	}
+
+	if (stride < element_size || buffer.size() < size_t(stride) * (acc.count - 1) + element_size) {
+		throw std::invalid_argument("gltf: accessor data is out of its buffer view bounds");
+	}
+
+	std::vector<tp_type> vec;
+
+	if constexpr (std::endian::native == std::endian::little) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		if (stride == element_size && reinterpret_cast<uintptr_t>(buffer.data()) % alignof(tp_type) == 0) {
+			// The data is tightly packed and is already in the GPU memory layout,
+			// use it directly from the binary buffer.
+			return utki::make_span(
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				reinterpret_cast<const tp_type*>(buffer.data()),
+				acc.count
+			);
+		}
+
+		// Strided or unaligned data, gather the elements. The copy size is a compile time constant,
+		// so the compiler turns the memcpy() into plain vector register loads and stores.
+		vec.resize(acc.count);
+		const uint8_t* src = buffer.data();
+		for (auto& v : vec) {
+			std::memcpy(&v, src, element_size);
+			src += stride;
+		}
+	} else {
+		// big-endian host, convert byte order of every component
+		vec.reserve(acc.count);
+		for (uint32_t i = 0; i != acc.count; ++i) {
+			utki::deserializer d(buffer.subspan(size_t(i) * stride, element_size));
+			tp_type t;
+			if constexpr (traits::num_components == 1) {
+				t = read_component_le<component_type>(d);
+			} else {
+				for (auto& c : t) {
+					c = read_component_le<component_type>(d);
+				}
 			}
+			vec.push_back(t);
 		}
-		// also, only float vectors for now. Need a template<> deserialize function for nice notation
-		vertex_attribute_buffer.push_back(std::move(t));
-		d.skip(n_skip_bytes);
 	}
 
-	new_accessor.get().vbo = this->render_context.make_vertex_buffer(utki::make_span(vertex_attribute_buffer));
-	new_accessor.get().data = std::move(vertex_attribute_buffer);
+	return this->store(std::move(vec));
 }
 
-utki::shared_ref<accessor> gltf_loader::read_accessor(const jsondom::value& accessor_json)
+template <typename tp_component_type>
+utki::span<const uint8_t> gltf_loader::read_quantized_accessor_data(
+	accessor& acc,
+	utki::span<const uint8_t> buffer,
+	uint32_t stride // in bytes, 0 means tightly packed
+)
+{
+	auto as_bytes = [](auto data) {
+		return utki::make_span(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<const uint8_t*>(data.data()),
+			data.size_bytes()
+		);
+	};
+
+	switch (acc.type_v) {
+		case accessor::type::vec2:
+			return as_bytes(this->read_accessor_data<r4::vector2<tp_component_type>>(acc, buffer, stride));
+		case accessor::type::vec3:
+			return as_bytes(this->read_accessor_data<r4::vector3<tp_component_type>>(acc, buffer, stride));
+		case accessor::type::vec4:
+			return as_bytes(this->read_accessor_data<r4::vector4<tp_component_type>>(acc, buffer, stride));
+		default:
+			throw std::invalid_argument("gltf: quantized accessor type must be a vector");
+	}
+}
+
+utki::shared_ref<accessor> gltf_loader::read_accessor(json_value accessor_json)
 {
 	accessor::type type_v = accessor::type::vec3;
 	const std::string type_s = read_string(accessor_json, "type"sv);
@@ -236,99 +742,83 @@ utki::shared_ref<accessor> gltf_loader::read_accessor(const jsondom::value& acce
 		static_cast<accessor::component_type>(component_type)
 	);
 
-	const uint32_t bv_offset = new_accessor.get().bv.get().byte_offset;
-	const uint32_t bv_length = new_accessor.get().bv.get().byte_length;
 	const uint32_t bv_stride = new_accessor.get().bv.get().byte_stride;
 
-	auto buf = glb_binary_buffer.subspan(
-		bv_offset + acc_offset, //
-		bv_length
-	);
+	auto bv_data = this->get_buffer_view_data(new_accessor.get().bv.get());
+	if (acc_offset > bv_data.size()) {
+		throw std::invalid_argument("gltf: accessor data is out of binary buffer bounds");
+	}
 
-	if (new_accessor.get().component_type_v == accessor::component_type::act_float) {
-		if (new_accessor.get().type_v == accessor::type::scalar) {
-			make_vertex_buffer_float<float>(
-				new_accessor, //
-				buf,
-				acc_count,
-				bv_stride
-			);
-		} else if (new_accessor.get().type_v == accessor::type::vec2) {
-			make_vertex_buffer_float<ruis::vec2>(
-				new_accessor, //
-				buf,
-				acc_count,
-				bv_stride
-			);
-		} else if (new_accessor.get().type_v == accessor::type::vec3) {
-			make_vertex_buffer_float<ruis::vec3>(
-				new_accessor, //
-				buf,
-				acc_count,
-				bv_stride
-			);
-		} else if (new_accessor.get().type_v == accessor::type::vec4) {
-			make_vertex_buffer_float<ruis::vec4>(
-				new_accessor, //
-				buf,
-				acc_count,
-				bv_stride
-			);
+	auto buf = bv_data.subspan(acc_offset);
+
+	auto& acc = new_accessor.get();
+
+	acc.normalized = accessor_json.get("normalized"sv).boolean();
+	acc.min = read_float_array(accessor_json, "min"sv);
+	acc.max = read_float_array(accessor_json, "max"sv);
+
+	// the data is converted to vertex attributes when making primitives,
+	// because it can be used in different ways, e.g. interleaved or not
+	if (acc.component_type_v == accessor::component_type::act_float) {
+		if (acc.type_v == accessor::type::scalar) {
+			acc.data = read_accessor_data<float>(acc, buf, bv_stride);
+		} else if (acc.type_v == accessor::type::vec2) {
+			acc.data = read_accessor_data<ruis::vec2>(acc, buf, bv_stride);
+		} else if (acc.type_v == accessor::type::vec3) {
+			acc.data = read_accessor_data<ruis::vec3>(acc, buf, bv_stride);
+		} else if (acc.type_v == accessor::type::vec4) {
+			acc.data = read_accessor_data<ruis::vec4>(acc, buf, bv_stride);
 		} else {
 			throw std::logic_error("Matrix vertex attributes are currently not supported");
 		}
 
-	} else if ((new_accessor.get().component_type_v == accessor::component_type::act_unsigned_short ||
-				new_accessor.get().component_type_v == accessor::component_type::act_unsigned_int) &&
-			   new_accessor.get().type_v == accessor::type::scalar)
-	{
-		utki::deserializer d(buf);
-		if (new_accessor.get().component_type_v == accessor::component_type::act_unsigned_short) {
-			std::vector<uint16_t> index_attribute_buffer;
-			index_attribute_buffer.reserve(acc_count);
-
-			for (size_t i = 0; i < acc_count; ++i) {
-				index_attribute_buffer.push_back(d.read_uint16_le());
-			}
-
-			new_accessor.get().data = index_attribute_buffer;
-			new_accessor.get().ibo = this->render_context.make_index_buffer(utki::make_span(index_attribute_buffer));
-
-		} else if (new_accessor.get().component_type_v == accessor::component_type::act_unsigned_int) {
-			std::vector<uint32_t> index_attribute_buffer;
-			index_attribute_buffer.reserve(acc_count);
-
-			for (size_t i = 0; i < acc_count; ++i) {
-				index_attribute_buffer.push_back(d.read_uint32_le());
-			}
-
-			new_accessor.get().data = index_attribute_buffer;
-			new_accessor.get().ibo = this->render_context.make_index_buffer(utki::make_span(index_attribute_buffer));
+	} else if (acc.type_v == accessor::type::scalar) {
+		if (acc.component_type_v == accessor::component_type::act_unsigned_short) {
+			acc.data = read_accessor_data<uint16_t>(acc, buf, bv_stride);
+		} else if (acc.component_type_v == accessor::component_type::act_unsigned_int) {
+			acc.data = read_accessor_data<uint32_t>(acc, buf, bv_stride);
+		}
+	} else {
+		// quantized vertex attributes are kept as is, those are converted to float by GPU when rendering
+		switch (acc.component_type_v) {
+			case accessor::component_type::act_signed_byte:
+				acc.quantized_data = this->read_quantized_accessor_data<int8_t>(acc, buf, bv_stride);
+				break;
+			case accessor::component_type::act_unsigned_byte:
+				acc.quantized_data = this->read_quantized_accessor_data<uint8_t>(acc, buf, bv_stride);
+				break;
+			case accessor::component_type::act_signed_short:
+				acc.quantized_data = this->read_quantized_accessor_data<int16_t>(acc, buf, bv_stride);
+				break;
+			case accessor::component_type::act_unsigned_short:
+				acc.quantized_data = this->read_quantized_accessor_data<uint16_t>(acc, buf, bv_stride);
+				break;
+			default:
+				// other vector types are not used as vertex attributes
+				break;
 		}
-		// TODO: memory optimization: in case GLTF says that index type is 32 bit, but still provides less than 65536
-		// vertices, then there is no reason to use 32 bit index, we can convert it to 16 bit index
 	}
 
 	return new_accessor;
 }
 
-utki::shared_ref<mesh> gltf_loader::read_mesh(const jsondom::value& mesh_json)
+gltf_loader::mesh_info gltf_loader::read_mesh(json_value mesh_json)
 {
-	std::vector<utki::shared_ref<primitive>> primitives;
-	std::string name = read_string(mesh_json, "name"sv);
-	const auto& json_primitives_array = mesh_json.object().at("primitives").array();
+	mesh_info mi;
+	mi.name = read_string(mesh_json, "name"sv);
+	auto json_primitives_array = mesh_json.get("primitives"sv);
+	if (!json_primitives_array.is_array()) {
+		throw std::invalid_argument(utki::cat("gltf: mesh '", mi.name, "' has no primitives"));
+	}
 
-	for (const auto& json_primitive : json_primitives_array) {
-		const auto& attributes_json = json_primitive.object().at("attributes");
+	for (auto json_primitive : json_primitives_array) {
+		auto attributes_json = json_primitive.get("attributes"sv);
 
 		int index_accessor = read_int(json_primitive, "indices"sv);
 		int position_accessor = read_int(attributes_json, "POSITION"sv);
 		int normal_accessor = read_int(attributes_json, "NORMAL"sv);
 		int texcoord_0_accessor = read_int(attributes_json, "TEXCOORD_0"sv);
-		[[maybe_unused]] int tangent_accessor = read_int(attributes_json, "TANGENT"sv);
-
-		// TOOD: Currently we do not use tangents provided from gltf file, we calculate them instead. But if they are
-		// provided in file, we should use them
+		int tangent_accessor = read_int(attributes_json, "TANGENT"sv);
 
 		int material_index = read_int(json_primitive, "material"sv);
 
@@ -348,113 +838,642 @@ utki::shared_ref<mesh> gltf_loader::read_mesh(const jsondom::value& mesh_json)
 			continue;
 		}
 
-		auto material_v = material_index >= 0 ? materials[material_index] : utki::make_shared<material>();
-
-		// TODO: use .at() instead of []
-		if (accessors[index_accessor].get().component_type_v == accessor::component_type::act_unsigned_int) {
-			auto vao = make_vao_with_tangent_space<uint32_t>(
-				accessors[index_accessor],
-				accessors[position_accessor],
-				accessors[texcoord_0_accessor],
-				accessors[normal_accessor]
-			);
-
-			primitives.push_back(utki::make_shared<primitive>(vao, std::move(material_v)));
-		} else if (accessors[index_accessor].get().component_type_v == accessor::component_type::act_unsigned_short) {
-			auto vao = make_vao_with_tangent_space<uint16_t>(
-				accessors[index_accessor],
-				accessors[position_accessor],
-				accessors[texcoord_0_accessor],
-				accessors[normal_accessor]
-			);
+		for (auto i : {index_accessor, position_accessor, normal_accessor, texcoord_0_accessor, tangent_accessor}) {
+			if (i >= int(this->accessors.size())) {
+				throw std::invalid_argument(utki::cat("gltf: primitive accessor index out of range: ", i));
+			}
+		}
 
-			primitives.push_back(utki::make_shared<primitive>(vao, std::move(material_v)));
-		} else {
+		auto index_type = this->accessors[index_accessor].get().component_type_v;
+		if (index_type != accessor::component_type::act_unsigned_int &&
+			index_type != accessor::component_type::act_unsigned_short)
+		{
 			throw std::invalid_argument("gltf: indices data type not supported (only uint32 and uint16 are supported)");
 			// TODO: branch all possible combinations if input data
 		}
+
+		mi.primitives.push_back({
+			.index_accessor = uint32_t(index_accessor),
+			.position_accessor = uint32_t(position_accessor),
+			.normal_accessor = uint32_t(normal_accessor),
+			.texcoord_0_accessor = uint32_t(texcoord_0_accessor),
+			.tangent_accessor = tangent_accessor,
+			.material_index = material_index,
+			.tangent_space_v = {},
+			.optimized_indices = {},
+			.vertex_remap = {},
+			.lod_indices = {}
+		});
 	}
 
-	return utki::make_shared<mesh>(
-		std::move(name), //
-		std::move(primitives)
-	);
+	return mi;
 }
 
-utki::shared_ref<node> gltf_loader::read_node(const jsondom::value& json_node)
+namespace {
+template <typename tp_component_type>
+float dequantize(tp_component_type c, bool normalized)
 {
-	constexpr ruis::vec3 default_scale{1, 1, 1};
-	constexpr ruis::vec3 default_translation{0, 0, 0};
-	constexpr ruis::quat default_rotation{1, 0, 0, 0};
-
-	trs_transformation transformation = identity_trs_transformation;
+	if (!normalized) {
+		return float(c);
+	}
 
-	std::string name = read_string(json_node, "name"sv);
+	constexpr auto max = float(std::numeric_limits<tp_component_type>::max());
 
-	auto it = json_node.object().find("rotation");
-	if (it != json_node.object().end()) {
-		transformation.rotation = read_quat(json_node, "rotation"sv, default_rotation);
+	if constexpr (std::is_signed_v<tp_component_type>) {
+		return std::max(float(c) / max, -1.0f);
+	} else {
+		return float(c) / max;
 	}
+}
 
-	it = json_node.object().find("scale");
-	if (it != json_node.object().end()) {
-		transformation.scale = read_vec(json_node, "scale"sv, default_scale);
+// Get vertex attribute data as float vectors.
+// Quantized data is converted to floats which are placed to the given buffer.
+template <typename tp_type>
+utki::span<const tp_type> dequantize_vertex_data(const accessor& acc, std::vector<tp_type>& buffer)
+{
+	if (const auto* d = std::get_if<utki::span<const tp_type>>(&acc.data)) {
+		return *d;
 	}
 
-	it = json_node.object().find("translation");
-	if (it != json_node.object().end()) {
-		transformation.translation = read_vec(json_node, "translation"sv, default_translation);
-	}
+	constexpr auto num_components = element_traits<tp_type>::num_components;
 
-	// TODO: support loading "matrix"
+	if (acc.get_num_components() != num_components || (acc.quantized_data.empty() && acc.count != 0)) {
+		throw std::invalid_argument("gltf: accessor type does not match vertex attribute type");
+	}
 
-	// TODO: check if "mesh" is present before reading it
-	int mesh_index = read_int(json_node, "mesh"sv);
+	auto convert = [&](auto component) {
+		using component_type = decltype(component);
 
-	child_indices.push_back(read_uint_array(json_node, "children"sv));
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		const auto* src = reinterpret_cast<const component_type*>(acc.quantized_data.data());
 
-	return utki::make_shared<node>(
-		std::move(name), //
-		mesh_index >= 0 ? this->meshes.at(mesh_index).to_shared_ptr() : nullptr,
-		std::move(transformation)
-	);
+		buffer.resize(acc.count);
+		for (auto& v : buffer) {
+			for (size_t i = 0; i != num_components; ++i) {
+				v[i] = dequantize(*src, acc.normalized);
+				++src;
+			}
+		}
+	};
+
+	switch (acc.component_type_v) {
+		case accessor::component_type::act_signed_byte:
+			convert(int8_t{});
+			break;
+		case accessor::component_type::act_unsigned_byte:
+			convert(uint8_t{});
+			break;
+		case accessor::component_type::act_signed_short:
+			convert(int16_t{});
+			break;
+		case accessor::component_type::act_unsigned_short:
+			convert(uint16_t{});
+			break;
+		default:
+			throw std::invalid_argument("gltf: unsupported vertex attribute component type");
+	}
+
+	return utki::make_span(buffer);
 }
 
-utki::shared_ref<scene> gltf_loader::read_scene(const jsondom::value& scene_json)
+float dequantize_component(const accessor& acc, float value)
 {
-	auto new_scene = utki::make_shared<scene>();
-	std::vector<uint32_t> node_indices = read_uint_array(scene_json, "nodes"sv);
-	new_scene.get().name = read_string(scene_json, "name"sv);
+	switch (acc.component_type_v) {
+		case accessor::component_type::act_signed_byte:
+			return dequantize(int8_t(value), acc.normalized);
+		case accessor::component_type::act_unsigned_byte:
+			return dequantize(uint8_t(value), acc.normalized);
+		case accessor::component_type::act_signed_short:
+			return dequantize(int16_t(value), acc.normalized);
+		case accessor::component_type::act_unsigned_short:
+			return dequantize(uint16_t(value), acc.normalized);
+		default:
+			return value;
+	}
+}
 
-	for (uint32_t ni : node_indices) {
-		new_scene.get().nodes.push_back(this->nodes[ni]);
+// Get bounding box of the vertex positions.
+// The glTF spec requires position accessors to have min and max values, those are used if present,
+// otherwise the bounding box is calculated from the vertex data.
+aabb get_position_bounds(
+	const accessor& acc, //
+	memory_tracker& memory
+)
+{
+	if (acc.min.size() == 3 && acc.max.size() == 3) {
+		aabb ret;
+		for (size_t i = 0; i != 3; ++i) {
+			ret.min[i] = dequantize_component(acc, acc.min[i]);
+			ret.max[i] = dequantize_component(acc, acc.max[i]);
+		}
+		return ret;
 	}
 
-	constexpr ruis::vec4 default_light_position{4, 4, 4, 1};
-	constexpr ruis::vec3 default_light_intensity{4, 4, 4};
+	std::vector<ruis::vec3> positions_buffer;
+	auto positions = dequantize_vertex_data(acc, positions_buffer);
+	auto positions_block = memory.track(positions_buffer);
+	return aabb::from_points(positions);
+}
 
-	if (new_scene.get().lights.size() == 0) {
-		new_scene.get().lights.push_back( //
-			utki::make_shared<ruis::render::light>(
-				default_light_position, //
-				default_light_intensity
-			)
+std::vector<uint32_t> copy_indices(const accessor& acc)
+{
+	return std::visit(
+		[](const auto& indices) -> std::vector<uint32_t> {
+			using index_type = typename std::remove_cvref_t<decltype(indices)>::value_type;
+			if constexpr (std::is_integral_v<index_type>) {
+				return {indices.begin(), indices.end()};
+			} else {
+				throw std::invalid_argument("gltf: accessor of non-integral type cannot be used as indices");
+			}
+		},
+		acc.data
+	);
+}
+} // namespace
+
+template <typename tp_type>
+utki::span<const tp_type> gltf_loader::get_float_data(const accessor& acc)
+{
+	std::vector<tp_type> buffer;
+	auto ret = dequantize_vertex_data(acc, buffer);
+	if (buffer.empty()) {
+		return ret;
+	}
+	return this->store(std::move(buffer));
+}
+
+void gltf_loader::make_tangent_spaces(std::vector<mesh_info>& mesh_infos)
+{
+	std::vector<primitive_info*> primitive_infos;
+	for (auto& mi : mesh_infos) {
+		for (auto& pi : mi.primitives) {
+			primitive_infos.push_back(&pi);
+		}
+	}
+
+	// tangent space calculation only reads accessor data, so primitives are processed in parallel
+	parallel_for(primitive_infos.size(), [&](size_t i) {
+		this->check_cancelled();
+
+		auto& pi = *primitive_infos[i];
+
+		// quantized vertex data is converted to floats only for the tangent space calculation
+		std::vector<ruis::vec3> normals_buffer;
+		auto normals = dequantize_vertex_data(this->accessors[pi.normal_accessor].get(), normals_buffer);
+		auto normals_block = this->memory.track(normals_buffer);
+
+		// use tangents from the glTF file if those are provided
+		if (pi.tangent_accessor >= 0) {
+			const auto& tangent_accessor = this->accessors[pi.tangent_accessor].get();
+			if (tangent_accessor.type_v == accessor::type::vec4) {
+				std::vector<ruis::vec4> tangents_buffer;
+				auto tangents = dequantize_vertex_data(tangent_accessor, tangents_buffer);
+				auto tangents_block = this->memory.track(tangents_buffer);
+				pi.tangent_space_v = make_tangent_space(
+					tangents, //
+					normals
+				);
+				this->track_intermediate(pi, pi.tangent_space_v.tangents);
+				this->track_intermediate(pi, pi.tangent_space_v.bitangents);
+				return;
+			}
+		}
+
+		std::vector<ruis::vec3> positions_buffer;
+		auto positions = dequantize_vertex_data(this->accessors[pi.position_accessor].get(), positions_buffer);
+		auto positions_block = this->memory.track(positions_buffer);
+
+		std::vector<ruis::vec2> texcoords_buffer;
+		auto texcoords = dequantize_vertex_data(this->accessors[pi.texcoord_0_accessor].get(), texcoords_buffer);
+		auto texcoords_block = this->memory.track(texcoords_buffer);
+
+		pi.tangent_space_v = std::visit(
+			[&](const auto& indices) {
+				using index_type = typename std::remove_cvref_t<decltype(indices)>::value_type;
+				if constexpr (std::is_same_v<index_type, uint16_t> || std::is_same_v<index_type, uint32_t>) {
+					return make_tangent_space(
+						indices, //
+						positions,
+						texcoords,
+						normals
+					);
+				} else {
+					throw std::invalid_argument("gltf: indices data type not supported");
+					return tangent_space{};
+				}
+			},
+			this->accessors[pi.index_accessor].get().data
+		);
+		this->track_intermediate(pi, pi.tangent_space_v.tangents);
+		this->track_intermediate(pi, pi.tangent_space_v.bitangents);
+	});
+}
+
+void gltf_loader::optimize_index_buffers(std::vector<mesh_info>& mesh_infos)
+{
+	std::vector<primitive_info*> primitive_infos;
+	for (auto& mi : mesh_infos) {
+		for (auto& pi : mi.primitives) {
+			primitive_infos.push_back(&pi);
+		}
+	}
+
+	// optimization only reads accessor data, so primitives are processed in parallel
+	parallel_for(primitive_infos.size(), [&](size_t i) {
+		this->check_cancelled();
+
+		auto& pi = *primitive_infos[i];
+
+		const auto& position_accessor = this->accessors[pi.position_accessor].get();
+		auto num_vertices = position_accessor.count;
+
+		pi.optimized_indices = copy_indices(this->accessors[pi.index_accessor].get());
+		this->track_intermediate(pi, pi.optimized_indices);
+		auto& indices = pi.optimized_indices;
+
+		pi.num_cache_misses_before = count_vertex_cache_misses(indices, num_vertices);
+
+		std::vector<uint32_t> original_indices = indices;
+		auto original_indices_block = this->memory.track(original_indices);
+
+		optimize_vertex_cache(indices, num_vertices);
+
+		// for small already well ordered meshes the optimized order can be worse than the original one
+		auto vertex_cache_misses = count_vertex_cache_misses(indices, num_vertices);
+		if (vertex_cache_misses > pi.num_cache_misses_before) {
+			indices = std::move(original_indices);
+			vertex_cache_misses = pi.num_cache_misses_before;
+		}
+
+		std::vector<uint32_t> vertex_cache_indices = indices;
+		auto vertex_cache_indices_block = this->memory.track(vertex_cache_indices);
+
+		std::vector<ruis::vec3> positions_buffer;
+		auto positions = dequantize_vertex_data(position_accessor, positions_buffer);
+		auto positions_block = this->memory.track(positions_buffer);
+
+		optimize_overdraw(
+			indices, //
+			positions
 		);
+
+		pi.num_cache_misses_after = count_vertex_cache_misses(indices, num_vertices);
+
+		// overdraw optimization trades some vertex cache efficiency,
+		// keep the vertex cache optimized order if the trade makes the cache misses worse than the input had
+		if (pi.num_cache_misses_after > pi.num_cache_misses_before) {
+			indices = std::move(vertex_cache_indices);
+			pi.num_cache_misses_after = vertex_cache_misses;
+		}
+
+		// vertex fetch optimization only renumbers vertices, so it does not change the number of cache misses
+		pi.vertex_remap = optimize_vertex_fetch(indices, num_vertices);
+		this->track_intermediate(pi, pi.vertex_remap);
+	});
+
+	auto& stats = this->index_optimization_stats;
+	for (const auto* pi : primitive_infos) {
+		++stats.num_primitives;
+		stats.num_triangles += pi->optimized_indices.size() / 3;
+		stats.num_cache_misses_before += pi->num_cache_misses_before;
+		stats.num_cache_misses_after += pi->num_cache_misses_after;
+	}
+}
+
+void gltf_loader::generate_lods(std::vector<mesh_info>& mesh_infos)
+{
+	std::vector<primitive_info*> primitive_infos;
+	for (auto& mi : mesh_infos) {
+		for (auto& pi : mi.primitives) {
+			primitive_infos.push_back(&pi);
+		}
+	}
+
+	// a level of detail which removes less than this fraction of triangles of the previous level is not worth it
+	constexpr float min_lod_reduction = 0.1f;
+
+	// simplification only reads accessor data, so primitives are processed in parallel
+	parallel_for(primitive_infos.size(), [&](size_t i) {
+		this->check_cancelled();
+
+		auto& pi = *primitive_infos[i];
+
+		std::vector<ruis::vec3> positions_buffer;
+		auto positions = dequantize_vertex_data(this->accessors[pi.position_accessor].get(), positions_buffer);
+		auto positions_block = this->memory.track(positions_buffer);
+
+		// levels of detail refer to the same vertices as the final primitive indices,
+		// which are renumbered in case the index buffers were optimized
+		std::vector<uint32_t> indices;
+		std::vector<ruis::vec3> remapped_positions;
+		if (this->params.optimize_indices) {
+			indices = pi.optimized_indices;
+			remapped_positions.reserve(pi.vertex_remap.size());
+			for (auto v : pi.vertex_remap) {
+				remapped_positions.push_back(positions[v]);
+			}
+			positions = remapped_positions;
+		} else {
+			indices = copy_indices(this->accessors[pi.index_accessor].get());
+		}
+		auto indices_block = this->memory.track(indices);
+		auto remapped_positions_block = this->memory.track(remapped_positions);
+
+		// each level is simplified from the full detail mesh, so that the error does not accumulate
+		float ratio = 1;
+		size_t prev_size = indices.size();
+		for (unsigned l = 0; l != this->params.num_lods; ++l) {
+			ratio *= this->params.lod_triangle_ratio;
+			auto target_index_count = size_t(float(indices.size() / 3) * ratio) * 3;
+
+			auto lod = simplify_mesh(
+				indices, //
+				positions,
+				target_index_count,
+				this->params.lod_max_error
+			);
+
+			if (float(lod.size()) > float(prev_size) * (1 - min_lod_reduction)) {
+				break;
+			}
+			prev_size = lod.size();
+
+			if (this->params.optimize_indices) {
+				optimize_vertex_cache(lod, positions.size());
+			}
+
+			this->track_intermediate(pi, lod);
+			pi.lod_indices.push_back(std::move(lod));
+		}
+	});
+}
+
+scene_data::mesh gltf_loader::make_mesh(mesh_info& mi)
+{
+	scene_data::mesh m;
+	m.name = std::move(mi.name);
+	m.primitives.reserve(mi.primitives.size());
+
+	for (auto& pi : mi.primitives) {
+		m.primitives.push_back(this->make_primitive(pi));
+		m.bounds.extend(m.primitives.back().bounds);
+	}
+
+	return m;
+}
+
+scene_data::node gltf_loader::read_node(json_value json_node)
+{
+	constexpr ruis::vec3 default_scale{1, 1, 1};
+	constexpr ruis::vec3 default_translation{0, 0, 0};
+	constexpr ruis::quat default_rotation{1, 0, 0, 0};
+
+	trs_transformation transformation = identity_trs_transformation;
+
+	std::string name = read_string(json_node, "name"sv);
+
+	if (!json_node.get("rotation"sv).is_undefined()) {
+		transformation.rotation = read_quat(json_node, "rotation"sv, default_rotation);
+	}
+
+	if (!json_node.get("scale"sv).is_undefined()) {
+		transformation.scale = read_vec(json_node, "scale"sv, default_scale);
+	}
+
+	if (!json_node.get("translation"sv).is_undefined()) {
+		transformation.translation = read_vec(json_node, "translation"sv, default_translation);
+	}
+
+	// TODO: support loading "matrix"
+
+	// TODO: check if "mesh" is present before reading it
+	int mesh_index = read_int(json_node, "mesh"sv);
+
+	if (mesh_index >= int(this->data.meshes.size())) {
+		throw std::invalid_argument(utki::cat("gltf: node mesh index out of range: ", mesh_index));
+	}
+
+	return {
+		.name = std::move(name),
+		.mesh_index = mesh_index,
+		.transformation = std::move(transformation),
+		.children = read_uint_array(json_node, "children"sv),
+		.instances = this->read_instances(json_node.get("extensions"sv).get("EXT_mesh_gpu_instancing"sv)),
+		.lods = read_uint_array(json_node.get("extensions"sv).get("MSFT_lod"sv), "ids"sv),
+		.lod_screen_coverage = read_float_array(json_node.get("extras"sv), "MSFT_screencoverage"sv)
+	};
+}
+
+std::vector<ruis::mat4> gltf_loader::read_instances(json_value instancing_json)
+{
+	if (!instancing_json.is_object()) {
+		return {};
+	}
+
+	auto attributes_json = instancing_json.get("attributes"sv);
+
+	int translation_accessor = read_int(attributes_json, "TRANSLATION"sv);
+	int rotation_accessor = read_int(attributes_json, "ROTATION"sv);
+	int scale_accessor = read_int(attributes_json, "SCALE"sv);
+
+	std::optional<uint32_t> count;
+	for (auto i : {translation_accessor, rotation_accessor, scale_accessor}) {
+		if (i < 0) {
+			continue;
+		}
+		if (i >= int(this->accessors.size())) {
+			throw std::invalid_argument(utki::cat("gltf: EXT_mesh_gpu_instancing: accessor index out of range: ", i));
+		}
+		auto c = this->accessors[i].get().count;
+		if (count.has_value() && count.value() != c) {
+			throw std::invalid_argument("gltf: EXT_mesh_gpu_instancing: attribute accessors have different counts");
+		}
+		count = c;
+	}
+
+	if (!count.has_value()) {
+		return {};
+	}
+
+	std::vector<trs_transformation> trs(count.value(), identity_trs_transformation);
+	auto trs_block = this->memory.track(trs);
+
+	// all instance attributes can be quantized, see KHR_mesh_quantization glTF extension
+	if (translation_accessor >= 0) {
+		std::vector<ruis::vec3> buffer;
+		auto data = dequantize_vertex_data(this->accessors[translation_accessor].get(), buffer);
+		auto buffer_block = this->memory.track(buffer);
+		for (size_t i = 0; i != trs.size(); ++i) {
+			trs[i].translation = data[i];
+		}
+	}
+
+	if (rotation_accessor >= 0) {
+		std::vector<ruis::vec4> buffer;
+		auto data = dequantize_vertex_data(this->accessors[rotation_accessor].get(), buffer);
+		auto buffer_block = this->memory.track(buffer);
+		for (size_t i = 0; i != trs.size(); ++i) {
+			trs[i].rotation = ruis::quat(data[i]);
+		}
+	}
+
+	if (scale_accessor >= 0) {
+		std::vector<ruis::vec3> buffer;
+		auto data = dequantize_vertex_data(this->accessors[scale_accessor].get(), buffer);
+		auto buffer_block = this->memory.track(buffer);
+		for (size_t i = 0; i != trs.size(); ++i) {
+			trs[i].scale = data[i];
+		}
+	}
+
+	std::vector<ruis::mat4> ret;
+	ret.reserve(trs.size());
+	for (const auto& t : trs) {
+		ret.push_back(t.to_matrix());
+	}
+
+	return ret;
+}
+
+scene_data::scene gltf_loader::read_scene(json_value scene_json)
+{
+	scene_data::scene new_scene;
+	new_scene.name = read_string(scene_json, "name"sv);
+	new_scene.nodes = read_uint_array(scene_json, "nodes"sv);
+
+	for (uint32_t ni : new_scene.nodes) {
+		if (ni >= this->data.nodes.size()) {
+			throw std::invalid_argument(utki::cat("gltf: scene node index out of range: ", ni));
+		}
 	}
 
 	return new_scene;
 }
 
-utki::shared_ref<image_view> gltf_loader::read_image_view(const jsondom::value& image_json)
+namespace {
+template <typename tp_type>
+utki::span<const float> to_float_span(utki::span<const tp_type> data)
+{
+	static_assert(sizeof(tp_type) % sizeof(float) == 0);
+	return utki::make_span(
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		reinterpret_cast<const float*>(data.data()),
+		data.size() * (sizeof(tp_type) / sizeof(float))
+	);
+}
+} // namespace
+
+scene_data::animation gltf_loader::read_animation(json_value animation_json)
+{
+	scene_data::animation new_animation;
+	new_animation.name = read_string(animation_json, "name"sv);
+
+	// indexing of JSON array walks it from the start, so collect the samplers once,
+	// otherwise reading would take time proportional to number of channels times number of samplers
+	auto samplers_array_json = animation_json.get("samplers"sv);
+	std::vector<json_value> samplers_json;
+	samplers_json.reserve(samplers_array_json.size());
+	for (auto sampler_json : samplers_array_json) {
+		samplers_json.push_back(sampler_json);
+	}
+
+	for (auto channel_json : animation_json.get("channels"sv)) {
+		auto target_json = channel_json.get("target"sv);
+
+		// channel without target node is to be ignored, see glTF spec
+		int node_index = read_int(target_json, "node"sv);
+		if (node_index < 0) {
+			continue;
+		}
+		if (node_index >= int(this->data.nodes.size())) {
+			throw std::invalid_argument(utki::cat("gltf: animation channel node index out of range: ", node_index));
+		}
+
+		ruis::render::animation::path path_v{};
+		auto path = read_string(target_json, "path"sv);
+		if (path == "translation"sv) {
+			path_v = ruis::render::animation::path::translation;
+		} else if (path == "rotation"sv) {
+			path_v = ruis::render::animation::path::rotation;
+		} else if (path == "scale"sv) {
+			path_v = ruis::render::animation::path::scale;
+		} else {
+			// morph target weights are not supported
+			continue;
+		}
+
+		int sampler_index = read_int(channel_json, "sampler"sv);
+		if (sampler_index < 0 || sampler_index >= int(samplers_json.size())) {
+			throw std::invalid_argument(
+				utki::cat("gltf: animation channel sampler index out of range: ", sampler_index)
+			);
+		}
+		auto sampler_json = samplers_json[sampler_index];
+
+		ruis::render::animation::interpolation interpolation_v{};
+		auto interpolation = read_string(sampler_json, "interpolation"sv, "LINEAR");
+		if (interpolation == "LINEAR"sv) {
+			interpolation_v = ruis::render::animation::interpolation::linear;
+		} else if (interpolation == "STEP"sv) {
+			interpolation_v = ruis::render::animation::interpolation::step;
+		} else if (interpolation == "CUBICSPLINE"sv) {
+			interpolation_v = ruis::render::animation::interpolation::cubic_spline;
+		} else {
+			throw std::invalid_argument(utki::cat("gltf: unknown animation interpolation: ", interpolation));
+		}
+
+		int input_accessor = read_int(sampler_json, "input"sv);
+		int output_accessor = read_int(sampler_json, "output"sv);
+		for (auto i : {input_accessor, output_accessor}) {
+			if (i < 0 || i >= int(this->accessors.size())) {
+				throw std::invalid_argument(utki::cat("gltf: animation sampler accessor index out of range: ", i));
+			}
+		}
+
+		const auto& input = this->accessors[input_accessor].get();
+		const auto* times = std::get_if<utki::span<const float>>(&input.data);
+		if (!times) {
+			throw std::invalid_argument("gltf: animation sampler input is not float scalars");
+		}
+
+		// rotations can be quantized, see KHR_mesh_quantization glTF extension
+		const auto& output = this->accessors[output_accessor].get();
+		auto values = path_v == ruis::render::animation::path::rotation
+			? to_float_span(this->get_float_data<ruis::vec4>(output))
+			: to_float_span(this->get_float_data<ruis::vec3>(output));
+
+		// cubic spline key has in-tangent, value and out-tangent
+		size_t num_values_per_key = interpolation_v == ruis::render::animation::interpolation::cubic_spline ? 3 : 1;
+		if (output.count != times->size() * num_values_per_key) {
+			throw std::invalid_argument("gltf: animation sampler output count does not match input count");
+		}
+
+		new_animation.channels.push_back({
+			.node_index = uint32_t(node_index), //
+			.path_v = path_v,
+			.interpolation_v = interpolation_v,
+			.times = *times,
+			.values = values
+		});
+	}
+
+	return new_animation;
+}
+
+utki::shared_ref<image_view> gltf_loader::read_image_view(json_value image_json)
 {
 	uint32_t buffer_view_index = read_uint(image_json, "bufferView"sv);
 	std::string name = read_string(image_json, "name"sv);
 	std::string mime_type_string = read_string(image_json, "mimeType"sv);
 
-	// TODO: rewrite with if-else instead of ternary operators
-	image_view::mime_type mt = mime_type_string == "image/jpeg" ? image_view::mime_type::image_jpeg
-		: mime_type_string == "image/png"                       ? image_view::mime_type::image_png
-																: image_view::mime_type::undefined;
+	image_view::mime_type mt = image_view::mime_type::undefined;
+	if (mime_type_string == "image/jpeg") {
+		mt = image_view::mime_type::image_jpeg;
+	} else if (mime_type_string == "image/png") {
+		mt = image_view::mime_type::image_png;
+	} else if (mime_type_string == "image/ktx2") {
+		mt = image_view::mime_type::image_ktx2;
+	}
 
 	auto new_image = utki::make_shared<image_view>(
 		name, //
@@ -464,57 +1483,210 @@ utki::shared_ref<image_view> gltf_loader::read_image_view(const jsondom::value&
 	return new_image;
 }
 
-utki::shared_ref<sampler> gltf_loader::read_sampler(const jsondom::value& sampler_json)
+utki::shared_ref<sampler> gltf_loader::read_sampler(json_value sampler_json)
 {
 	auto new_sampler = utki::make_shared<sampler>(
 		static_cast<sampler::filter>(read_uint(sampler_json, "minFilter"sv)),
 		static_cast<sampler::filter>(read_uint(sampler_json, "magFilter"sv)),
-		static_cast<sampler::wrap>(read_uint(sampler_json, "wrapS"sv)),
-		static_cast<sampler::wrap>(read_uint(sampler_json, "wrapT"sv))
+		static_cast<sampler::wrap>(read_uint(sampler_json, "wrapS"sv, uint32_t(sampler::wrap::repeat))),
+		static_cast<sampler::wrap>(read_uint(sampler_json, "wrapT"sv, uint32_t(sampler::wrap::repeat)))
 	);
 	return new_sampler;
 }
 
-utki::shared_ref<ruis::render::texture_2d> gltf_loader::read_texture(const jsondom::value& texture_json)
+utki::span<const uint8_t> gltf_loader::get_image_data(const image_view& image) const
 {
-	uint32_t image_index = read_uint(texture_json, "source"sv);
-	uint32_t sampler_index = read_uint(texture_json, "sampler"sv);
+	return this->get_buffer_view_data(image.bv.get());
+}
 
-	auto image = images[image_index];
-	auto sampler = samplers[sampler_index];
+uint32_t gltf_loader::get_texture_source(json_value texture_json) const
+{
+	// KHR_texture_basisu refers to a KTX2 image, the plain source is a fallback for loaders
+	// which cannot read it, e.g. because the KTX2 needs Basis Universal transcoding
+	auto basisu_json = texture_json.get("extensions"sv).get("KHR_texture_basisu"sv);
+	if (basisu_json.is_object()) {
+		int ktx2_index = read_int(basisu_json, "source"sv);
+		if (ktx2_index >= 0 && size_t(ktx2_index) < this->images.size() &&
+			is_supported_ktx2(this->get_image_data(this->images[ktx2_index].get())))
+		{
+			return uint32_t(ktx2_index);
+		}
+	}
 
-	auto image_span = glb_binary_buffer.subspan(
-		image.get().bv.get().byte_offset, //
-		image.get().bv.get().byte_length
-	);
-	const fsif::span_file fi(image_span);
+	int image_index = read_int(texture_json, "source"sv);
+	if (image_index < 0 || size_t(image_index) >= this->images.size()) {
+		throw std::invalid_argument(utki::cat("gltf: texture source image index out of range: ", image_index));
+	}
+	return uint32_t(image_index);
+}
 
-	rasterimage::image_variant imvar;
-	if (image.get().mime_type_v == image_view::mime_type::image_png) {
-		imvar = rasterimage::read_png(fi);
-	} else if (image.get().mime_type_v == image_view::mime_type::image_jpeg) {
-		imvar = rasterimage::read_jpeg(fi);
-	} else {
-		throw std::invalid_argument("gltf: unknown texture image format");
+namespace {
+// compressed images are not decoded, those refer to the file data
+size_t get_decoded_size(const scene_data::image& im)
+{
+	size_t ret = 0;
+	if (const auto* raster = std::get_if<rasterimage::image_variant>(&im)) {
+		std::visit(
+			[&](const auto& i) {
+				ret = i.pixels().size_bytes();
+			},
+			raster->variant()
+		);
+	}
+	return ret;
+}
+} // namespace
+
+void gltf_loader::decode_images(json_value textures_json)
+{
+	// decode only images which are used by textures, each image only once
+	std::vector<bool> image_used(this->images.size(), false);
+	std::vector<uint32_t> images_to_decode;
+	for (auto texture_json : textures_json) {
+		uint32_t image_index = this->get_texture_source(texture_json);
+		if (!image_used[image_index]) {
+			image_used[image_index] = true;
+			images_to_decode.push_back(image_index);
+		}
 	}
 
-	// TODO: fill texparams properly based on gltf file
-	ruis::render::context::texture_2d_parameters tex_params;
-	tex_params.mag_filter = ruis::render::texture_2d::filter::linear;
-	tex_params.min_filter = ruis::render::texture_2d::filter::linear;
-	tex_params.mipmap = texture_2d::mipmap::linear;
+	for (const auto& i : images_to_decode) {
+		const auto& image = this->images[i].get();
+		this->image_timings[i].name = image.name;
+		this->image_timings[i].encoded_size = image.bv.get().byte_length;
+	}
+
+	std::atomic<size_t> num_decoded = 0;
+
+	parallel_for(images_to_decode.size(), [&](size_t i) {
+		this->check_cancelled();
 
-	return this->render_context.make_texture_2d(
-		std::move(imvar), //
-		tex_params
+		auto image_index = images_to_decode[i];
+		const auto& image = this->images[image_index].get();
+
+		auto image_span = this->get_image_data(image);
+		const fsif::span_file fi(image_span);
+
+		auto start = std::chrono::steady_clock::now();
+
+		auto& im = this->data.images[image_index];
+		if (image.mime_type_v == image_view::mime_type::image_png) {
+			im = rasterimage::read_png(fi);
+		} else if (image.mime_type_v == image_view::mime_type::image_jpeg) {
+			im = rasterimage::read_jpeg(fi);
+		} else if (image.mime_type_v == image_view::mime_type::image_ktx2) {
+			// compressed image data stays in the glb buffer, it is uploaded to GPU as is
+			im = std::visit(
+				[](auto&& i) -> scene_data::image {
+					return std::move(i);
+				},
+				read_ktx2(image_span)
+			);
+		} else {
+			throw std::invalid_argument("gltf: unknown texture image format");
+		}
+
+		this->image_timings[image_index].decode_time = std::chrono::steady_clock::now() - start;
+
+		this->memory.allocated(get_decoded_size(im));
+
+		this->report_progress(
+			progress_images_start +
+			(progress_images_end - progress_images_start) * float(++num_decoded) / float(images_to_decode.size())
+		);
+	});
+}
+
+namespace {
+ruis::render::context::texture_2d_parameters to_texture_2d_parameters(const sampler& s)
+{
+	using ruis::render::texture_2d;
+
+	ruis::render::context::texture_2d_parameters params;
+
+	params.mag_filter = s.mag == sampler::filter::nearest ? texture_2d::filter::nearest : texture_2d::filter::linear;
+
+	// in case minification filter is not specified, use trilinear filtering,
+	// minified textures without mipmaps alias badly and thrash the texture cache
+	switch (s.min) {
+		case sampler::filter::nearest:
+			params.min_filter = texture_2d::filter::nearest;
+			params.mipmap = texture_2d::mipmap::none;
+			break;
+		case sampler::filter::linear:
+			params.min_filter = texture_2d::filter::linear;
+			params.mipmap = texture_2d::mipmap::none;
+			break;
+		case sampler::filter::nearest_mipmap_nearest:
+			params.min_filter = texture_2d::filter::nearest;
+			params.mipmap = texture_2d::mipmap::nearest;
+			break;
+		case sampler::filter::linear_mipmap_nearest:
+			params.min_filter = texture_2d::filter::linear;
+			params.mipmap = texture_2d::mipmap::nearest;
+			break;
+		case sampler::filter::nearest_mipmap_linear:
+			params.min_filter = texture_2d::filter::nearest;
+			params.mipmap = texture_2d::mipmap::linear;
+			break;
+		case sampler::filter::linear_mipmap_linear:
+		case sampler::filter::undefined:
+		default:
+			params.min_filter = texture_2d::filter::linear;
+			params.mipmap = texture_2d::mipmap::linear;
+			break;
+	}
+
+	return params;
+}
+
+texture_wrapping::mode to_texture_wrapping_mode(sampler::wrap w)
+{
+	switch (w) {
+		case sampler::wrap::clamp_to_edge:
+			return texture_wrapping::mode::clamp_to_edge;
+		case sampler::wrap::mirrored_repeat:
+			return texture_wrapping::mode::mirrored_repeat;
+		case sampler::wrap::repeat:
+		default:
+			return texture_wrapping::mode::repeat;
+	}
+}
+} // namespace
+
+scene_data::texture gltf_loader::read_texture(json_value texture_json)
+{
+	uint32_t image_index = this->get_texture_source(texture_json);
+
+	// texture without sampler uses default sampler
+	const sampler default_sampler(
+		sampler::filter::undefined, //
+		sampler::filter::undefined,
+		sampler::wrap::repeat,
+		sampler::wrap::repeat
 	);
+
+	int sampler_index = read_int(texture_json, "sampler"sv);
+	if (sampler_index >= int(this->samplers.size())) {
+		throw std::invalid_argument(utki::cat("gltf: texture sampler index out of range: ", sampler_index));
+	}
+
+	const auto& s = sampler_index >= 0 ? this->samplers[sampler_index].get() : default_sampler;
+
+	// Mipmap chain is generated by the rendering context when the texture is created,
+	// which is done on GPU for OpenGL ES backend.
+	return {
+		.image_index = image_index,
+		.params = to_texture_2d_parameters(s),
+		.wrapping = {.s = to_texture_wrapping_mode(s.wrap_s), .t = to_texture_wrapping_mode(s.wrap_t)}
+	};
 }
 
-utki::shared_ref<material> gltf_loader::read_material(const jsondom::value& material_json)
+scene_data::material gltf_loader::read_material(json_value material_json)
 {
-	auto mat = utki::make_shared<material>();
+	scene_data::material mat;
 
-	mat.get().name = read_string(material_json, "name"sv);
+	mat.name = read_string(material_json, "name"sv);
 
 	int diffuse_index = -1;
 	int normal_index = -1;
@@ -522,327 +1694,652 @@ utki::shared_ref<material> gltf_loader::read_material(const jsondom::value& mate
 	// arm is ambient-metalness-roughness
 	int arm_index = -1;
 
-	auto it = material_json.object().find("normalTexture");
-	if (it != material_json.object().end() && it->second.is_object()) {
-		normal_index = read_int(it->second, "index"sv);
+	if (auto tex_json = material_json.get("normalTexture"sv); tex_json.is_object()) {
+		normal_index = read_int(tex_json, "index"sv);
 	}
 
-	auto it_pbr = material_json.object().find("pbrMetallicRoughness");
-	if (it_pbr != material_json.object().end() && it_pbr->second.is_object()) {
-		auto it = it_pbr->second.object().find("baseColorTexture");
-		if (it != it_pbr->second.object().end() && it->second.is_object()) {
-			diffuse_index = read_int(it->second, "index"sv);
+	auto pbr_json = material_json.get("pbrMetallicRoughness"sv);
+	if (pbr_json.is_object()) {
+		if (auto tex_json = pbr_json.get("baseColorTexture"sv); tex_json.is_object()) {
+			diffuse_index = read_int(tex_json, "index"sv);
 		}
-		it = it_pbr->second.object().find("metallicRoughnessTexture");
-		if (it != it_pbr->second.object().end() && it->second.is_object()) {
-			arm_index = read_int(it->second, "index"sv);
+		if (auto tex_json = pbr_json.get("metallicRoughnessTexture"sv); tex_json.is_object()) {
+			arm_index = read_int(tex_json, "index"sv);
 		}
 	}
 
-	if (diffuse_index >= 0) {
-		mat.get().tex_diffuse = textures[diffuse_index];
-	}
-
-	if (normal_index >= 0) {
-		mat.get().tex_normal = textures[normal_index];
+	for (auto i : {diffuse_index, normal_index, arm_index}) {
+		if (i >= int(this->data.textures.size())) {
+			throw std::invalid_argument(utki::cat("gltf: material texture index out of range: ", i));
+		}
 	}
 
-	if (arm_index >= 0) {
-		mat.get().tex_arm = textures[arm_index];
-	}
+	mat.tex_diffuse = diffuse_index;
+	mat.tex_normal = normal_index;
+	mat.tex_arm = arm_index;
 
 	return mat;
 }
 
 template <typename tp_type>
 std::vector<utki::shared_ref<tp_type>> gltf_loader::read_root_array(
-	std::function<tp_type(const jsondom::value& j)> read_func,
-	const jsondom::value& root_json,
+	std::function<tp_type(json_value j)> read_func,
+	json_value root_json,
 	const std::string& name
 )
 {
 	std::vector<utki::shared_ref<tp_type>> all;
-	auto it = root_json.object().find(name);
-	if (it != root_json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			all.push_back(read_func(sub_json));
-		}
+	for (auto sub_json : root_json.get(name)) {
+		all.push_back(read_func(sub_json));
 	}
 	return all;
 }
 
-utki::shared_ref<scene> gltf_loader::load(const fsif::file& fi)
+utki::shared_ref<scene> gltf_loader::load(
+	const fsif::file& fi, //
+	load_statistics* stats
+)
 {
-	auto gltf = fi.load();
-	utki::deserializer d(gltf);
+	auto sd = this->read(fi, nullptr, stats);
 
-	constexpr auto gltf_header_size = 4;
-	if (auto header_sv = d.read_string(gltf_header_size); header_sv != "glTF"sv) {
-		throw std::invalid_argument(utki::cat("read_gltf(): file header is not 'glTF': ", header_sv));
-	}
+	// GPU upload is measured as one more loading stage
+	this->stats = stats;
+	utki::scope_exit stats_scope_exit([this]() {
+		this->stats = nullptr;
+	});
 
-	auto version = d.read_uint32_le();
-	constexpr auto expected_gltf_version = 2;
-	if (version != expected_gltf_version) {
-		throw std::invalid_argument(utki::cat("read_gltf(): glTF file version is not as expected: ", version));
-	}
+	std::vector<std::chrono::nanoseconds> upload_times(sd.images.size());
 
-	auto gltf_length = d.read_uint32_le();
-	if (gltf_length != gltf.size()) {
-		throw std::invalid_argument(
-			utki::cat("read_gltf(): glTF file size ", gltf.size(), " does not match length ", gltf_length)
-		);
-	}
+	// resources are deduplicated within the scene only, the cache also tells the uploaded data size
+	gpu_resource_cache cache;
 
-	auto chunk_length = d.read_uint32_le();
-	if (chunk_length == 0) {
-		throw std::invalid_argument("read_gltf(): chunk length = 0");
+	auto upload_start = this->start_stage();
+	auto s = make_scene(
+		this->render_context, //
+		sd,
+		upload_times,
+		&cache
+	);
+
+	this->finish_stage(load_statistics::stage::gpu_upload, upload_start);
+
+	if (stats) {
+		auto cache_stats = cache.get_statistics();
+		stats->bytes_uploaded = cache_stats.textures.live_bytes + cache_stats.vertex_buffers.live_bytes +
+			cache_stats.index_buffers.live_bytes;
 	}
-	constexpr auto chunk_type_length = 4;
-	if (auto chunk_type = d.read_string(chunk_type_length); chunk_type != "JSON"sv) {
-		throw std::invalid_argument(
-			utki::cat("read_gltf(): unexpected first chunk type: ", chunk_type, ", expected JSON")
-		);
+
+	ASSERT(upload_times.size() == this->image_timings.size())
+	for (size_t i = 0; i != upload_times.size(); ++i) {
+		this->image_timings[i].upload_time = upload_times[i];
 	}
 
-	auto json_span = d.read_span(chunk_length);
+	return s;
+}
 
-	chunk_length = d.read_uint32_le();
-	if (chunk_length == 0) {
-		throw std::invalid_argument("read_gltf(): chunk length = 0");
+scene_data gltf_loader::read(
+	const fsif::file& fi, //
+	load_progress* progress,
+	load_statistics* stats
+)
+{
+	this->progress = progress;
+	this->stats = stats;
+	utki::scope_exit progress_scope_exit([this]() {
+		this->progress = nullptr;
+		this->stats = nullptr;
+	});
+
+	if (stats) {
+		stats->reset();
 	}
-	if (auto chunk_type = d.read_string(chunk_type_length); chunk_type != "BIN\0"sv) {
-		throw std::invalid_argument(
-			utki::cat("read_gltf(): unexpected first chunk type: ", chunk_type, ", expected JSON")
-		);
+	this->stored_bytes = 0;
+	this->memory.reset();
+
+	auto stage_start = this->start_stage();
+
+	// the file is memory-mapped when possible, so the JSON and BIN chunks are used in-place, without copying,
+	// the scene data keeps the file content alive as vertex data can point directly into it
+	auto content = std::make_shared<const file_content>(fi);
+
+	this->data = {};
+	this->index_optimization_stats = {};
+	this->data.storage.push_back(content);
+	this->accessors.clear();
+	this->buffers.clear();
+	this->buffer_views.clear();
+	this->samplers.clear();
+	this->images.clear();
+
+	// the binary buffer points into the file content which is only valid during reading,
+	// the loaded buffers are released as well, the scene data holds those it needs
+	utki::scope_exit binary_buffer_scope_exit([this]() {
+		this->gltf_file = nullptr;
+		this->glb_binary_buffer = {};
+		this->accessors.clear();
+		this->images.clear();
+		this->buffer_views.clear();
+		this->buffers.clear();
+	});
+
+	auto container = read_container(content->span());
+
+	this->gltf_file = &fi;
+	this->glb_binary_buffer = container.bin;
+
+	auto json_span = container.json;
+
+	stage_start = this->finish_stage(load_statistics::stage::file_read, stage_start);
+
+	// the document must outlive all the json values obtained from it
+	const json_document doc(json_span);
+	this->memory.allocated(doc.get_memory_size());
+	auto json = doc.root();
+	if (!json.is_object()) {
+		throw std::invalid_argument("read_gltf(): glTF root is not a JSON object");
 	}
 
-	glb_binary_buffer = d.read_span(chunk_length);
+	stage_start = this->finish_stage(load_statistics::stage::json_parse, stage_start);
 
-	auto json = jsondom::read(json_span);
-	ASSERT(json.is_object())
+	this->report_progress(progress_images_start);
+
+	for (auto buffer_json : json.get("buffers"sv)) {
+		buffers.push_back(read_buffer(buffer_json));
+	}
 
 	{
-		auto it = json.object().find("bufferViews");
-		if (it == json.object().end() || !it->second.is_array()) {
+		auto buffer_views_json = json.get("bufferViews"sv);
+		if (!buffer_views_json.is_array()) {
 			throw std::invalid_argument("read_gltf(): glTF does not have any valid bufferViews");
 		} else {
-			for (const auto& buffer_view_json : it->second.array()) {
+			for (auto buffer_view_json : buffer_views_json) {
 				buffer_views.push_back(read_buffer_view(buffer_view_json));
 			}
 		}
 	}
 
-	std::map<std::string, jsondom::value, std::less<>>::iterator it;
+	this->decode_buffer_views();
 
-	it = json.object().find("images");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			images.push_back(read_image_view(sub_json));
-		}
+	stage_start = this->finish_stage(load_statistics::stage::buffer_decode, stage_start);
+
+	for (auto sub_json : json.get("images"sv)) {
+		images.push_back(read_image_view(sub_json));
 	}
 
-	it = json.object().find("samplers");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			samplers.push_back(read_sampler(sub_json));
-		}
+	for (auto sub_json : json.get("samplers"sv)) {
+		samplers.push_back(read_sampler(sub_json));
 	}
 
-	it = json.object().find("textures");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			textures.push_back(read_texture(sub_json));
+	this->data.images.resize(this->images.size());
+	this->image_timings.clear();
+	this->image_timings.resize(this->images.size());
+
+	if (auto textures_json = json.get("textures"sv); textures_json.is_array()) {
+		// decode all images in parallel on worker threads
+		this->decode_images(textures_json);
+
+		for (auto sub_json : textures_json) {
+			this->data.textures.push_back(read_texture(sub_json));
 		}
 	}
-	it = json.object().find("materials");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			materials.push_back(read_material(sub_json));
-		}
+	this->report_progress(progress_images_end);
+
+	stage_start = this->finish_stage(load_statistics::stage::image_decode, stage_start);
+
+	for (auto sub_json : json.get("materials"sv)) {
+		this->data.materials.push_back(read_material(sub_json));
+	}
+
+	for (auto sub_json : json.get("accessors"sv)) {
+		accessors.push_back(read_accessor(sub_json));
 	}
 
-	it = json.object().find("accessors");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			accessors.push_back(read_accessor(sub_json));
+	if (auto meshes_json = json.get("meshes"sv); meshes_json.is_array()) {
+		std::vector<mesh_info> mesh_infos;
+		for (auto sub_json : meshes_json) {
+			mesh_infos.push_back(read_mesh(sub_json));
+		}
+
+		this->report_progress(progress_meshes_start);
+
+		stage_start = this->finish_stage(load_statistics::stage::accessor_decode, stage_start);
+
+		this->make_tangent_spaces(mesh_infos);
+
+		stage_start = this->finish_stage(load_statistics::stage::tangent_generation, stage_start);
+
+		if (this->params.optimize_indices) {
+			this->optimize_index_buffers(mesh_infos);
+
+			stage_start = this->finish_stage(load_statistics::stage::index_optimization, stage_start);
+		}
+
+		if (this->params.num_lods != 0) {
+			this->generate_lods(mesh_infos);
+
+			stage_start = this->finish_stage(load_statistics::stage::lod_generation, stage_start);
+		}
+
+		this->report_progress(progress_meshes_end);
+
+		for (auto& mi : mesh_infos) {
+			this->data.meshes.push_back(make_mesh(mi));
 		}
 	}
 
-	it = json.object().find("meshes");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			meshes.push_back(read_mesh(sub_json));
+	for (auto sub_json : json.get("nodes"sv)) {
+		this->data.nodes.push_back(read_node(sub_json));
+	}
+
+	for (const auto& n : this->data.nodes) {
+		for (uint32_t ci : n.children) {
+			if (ci >= this->data.nodes.size()) {
+				throw std::invalid_argument(utki::cat("gltf: node child index out of range: ", ci));
+			}
+		}
+		for (uint32_t li : n.lods) {
+			if (li >= this->data.nodes.size()) {
+				throw std::invalid_argument(utki::cat("gltf: node level of detail index out of range: ", li));
+			}
 		}
 	}
 
-	it = json.object().find("nodes");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			nodes.push_back(read_node(sub_json));
+	for (auto sub_json : json.get("scenes"sv)) {
+		this->data.scenes.push_back(read_scene(sub_json));
+	}
+
+	for (auto sub_json : json.get("animations"sv)) {
+		this->data.animations.push_back(read_animation(sub_json));
+	}
+
+	// negative scene index means this .gltf file is a library
+	this->data.active_scene = read_int(json, "scene"sv);
+	if (this->data.active_scene >= int(this->data.scenes.size())) {
+		throw std::invalid_argument(utki::cat("gltf: active scene index out of range: ", this->data.active_scene));
+	}
+
+	// vertex and image data can point directly into the loaded buffers
+	for (const auto& b : this->buffers) {
+		if (b.get().owner) {
+			this->data.storage.push_back(b.get().owner);
 		}
 	}
 
-	// hierarchize nodes
-	ASSERT(nodes.size() == child_indices.size())
-	for (uint32_t i = 0; i < nodes.size(); ++i) {
-		for (uint32_t ci : child_indices[i]) {
-			nodes[i].get().children.push_back(nodes[ci]);
+	this->finish_stage(load_statistics::stage::scene_build, stage_start);
+
+	if (stats) {
+		this->collect_statistics(content->span().size(), doc.get_memory_size());
+	}
+
+	this->report_progress(1);
+
+	return std::move(this->data);
+}
+
+void gltf_loader::collect_statistics(
+	size_t file_size, //
+	size_t json_memory_size
+)
+{
+	ASSERT(this->stats)
+	auto& st = *this->stats;
+
+	size_t decoded_buffers_size = 0;
+
+	st.bytes_read = file_size;
+	for (const auto& b : this->buffers) {
+		// buffers without owner are the .glb BIN chunk, which is a part of the file
+		if (b.get().owner) {
+			st.bytes_read += b.get().data.size();
+			if (is_data_uri(b.get().uri)) {
+				decoded_buffers_size += b.get().data.size();
+			}
 		}
 	}
 
-	it = json.object().find("scenes");
-	if (it != json.object().end() && it->second.is_array()) {
-		for (const auto& sub_json : it->second.array()) {
-			scenes.push_back(read_scene(sub_json));
+	size_t decoded_images_size = 0;
+	for (const auto& im : this->data.images) {
+		decoded_images_size += get_decoded_size(im);
+	}
+
+	st.bytes_decoded = this->stored_bytes + decoded_images_size;
+
+	st.retained_memory = st.bytes_decoded + decoded_buffers_size + json_memory_size;
+
+	st.peak_temporary_memory = this->memory.get_peak();
+
+	st.num_textures = this->data.textures.size();
+
+	for (const auto& m : this->data.meshes) {
+		for (const auto& p : m.primitives) {
+			++st.num_primitives;
+
+			std::visit(
+				[&](const auto& indices) {
+					st.num_triangles += indices.size() / 3;
+				},
+				p.indices
+			);
+
+			for (const auto& l : p.lods) {
+				std::visit(
+					[&](const auto& indices) {
+						st.num_lod_triangles += indices.size() / 3;
+					},
+					l
+				);
+			}
+
+			if (p.attributes.empty()) {
+				continue;
+			}
+			const auto& a = p.attributes.front();
+			if (p.interleaved_layout.has_value()) {
+				st.num_vertices += a.data.size_bytes() / p.interleaved_layout->stride;
+			} else {
+				st.num_vertices += a.data.size() / a.num_components;
+			}
 		}
 	}
+}
 
-	auto active_scene = utki::make_shared<scene>();
-	int active_scene_index = read_int(json, "scene"sv);
-	if (active_scene_index < 0) {
-		// this .gltf file is a library
-	} else {
-		active_scene = scenes[active_scene_index];
+std::vector<std::unique_ptr<fsif::file>> gltf_loader::get_external_buffer_files(
+	const fsif::file& fi, //
+	utki::span<const uint8_t> content
+)
+{
+	const json_document doc(read_container(content).json);
+
+	std::vector<std::unique_ptr<fsif::file>> ret;
+
+	for (auto buffer_json : doc.root().get("buffers"sv)) {
+		auto uri = read_string(buffer_json, "uri"sv);
+		if (uri.empty() || is_data_uri(uri)) {
+			continue;
+		}
+		ret.push_back(open_uri(fi, uri));
 	}
 
-	return active_scene;
+	return ret;
 }
 
+namespace {
 template <typename tp_type>
-utki::shared_ref<ruis::render::vertex_array> gltf_loader::make_vao_with_tangent_space(
-	utki::shared_ref<accessor> index_accessor,
-	utki::shared_ref<accessor> position_accessor,
-	utki::shared_ref<accessor> texcoord_0_accessor,
-	utki::shared_ref<accessor> normal_accessor
-)
+scene_data::vertex_attribute make_vertex_attribute(utki::span<const tp_type> data)
 {
-	uint32_t num_vertices = position_accessor.get().count;
-	uint32_t num_triangles = index_accessor.get().count / 3;
-
-	const auto& indices = std::get<std::vector<tp_type>>(index_accessor.get().data);
-	const auto& positions = std::get<std::vector<ruis::vec3>>(position_accessor.get().data);
-	const auto& texcoords = std::get<std::vector<ruis::vec2>>(texcoord_0_accessor.get().data);
-	const auto& normals = std::get<std::vector<ruis::vec3>>(normal_accessor.get().data);
-
-	std::vector<ruis::vec3> tangents; // texture x-axis
-	std::vector<ruis::vec3> bitangents; // texture y-axis
-
-	tangents.resize(num_vertices);
-	std::ranges::fill(tangents, ruis::vec3(0, 0, 0));
-
-	bitangents.resize(num_vertices);
-	std::ranges::fill(bitangents, ruis::vec3(0, 0, 0));
-
-	// Calculate the vertex tangents and bitangents.
-	for (uint32_t i = 0; i < num_triangles; ++i) {
-		auto index0 = indices[i * 3 + 0];
-		auto index1 = indices[i * 3 + 1];
-		auto index2 = indices[i * 3 + 2];
-
-		auto p0 = positions[index0];
-		auto p1 = positions[index1];
-		auto p2 = positions[index2];
-
-		auto t0 = texcoords[index0];
-		auto t1 = texcoords[index1];
-		auto t2 = texcoords[index2];
-
-		auto edge1 = p1 - p0;
-		auto edge2 = p2 - p0;
-
-		auto tex_edge1 = t1 - t0;
-		auto tex_edge2 = t2 - t0;
-
-		// Calculate the triangle tangent and bitangent.
-		//
-		// We want to map vectors (1, 0) and (0, 1) from texture space to 3d space (to tangent and bitangent vectors).
-		//
-		// vec2 te1, te2 : triangle edges in texture space
-		// vec3 e1, e2 : triangle edges in 3d space
-		//
-		// Vectors (1, 0) and (0, 1) as a linear combination of te1 and te2:
-		//
-		// (1, 0) = te1 * a11 + te2 * a21
-		// (0, 1) = te1 * a12 + te2 * a22
-		//
-		// We need to solve these equations for a11, a12, a21, a22. The system of equations can be written in matrix
-		// form:
-		//
-		// | te1.x te2.x | * | a11 a12 | = | 1 0 |        <->        T * A = I
-		// | te1.y te2.y |   | a21 a22 |   | 0 1 |
-		//
-		// Solving this matrix equation is actually finding a right inverse matrix A for matrix T.
-		//
-		// Then, tangent and bitangent vectors are linear combinations of e1 and e2 with same aXX coefficients.
-		//
-		// tangent = e1 * a11 + e2 * a21
-		// bitangent = e1 * a12 + e2 * a22
-
-		auto t = r4::matrix<ruis::real, 2, 2>(
-					 tex_edge1, // row 0
-					 tex_edge2 // row 1
+	static_assert(sizeof(tp_type) % sizeof(float) == 0, "only float vertex attributes are supported");
+	constexpr auto num_components = sizeof(tp_type) / sizeof(float);
+
+	return {
+		.num_components = num_components, //
+		.data = utki::make_span(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<const float*>(data.data()),
+			data.size() * num_components
 		)
-					 .transpose(); // rows become columns
+	};
+}
 
-		constexpr auto epsilon = ruis::real(1e-5f);
+// element size is in floats, for interleaved vertex data it is the whole vertex
+std::vector<float> remap_vertex_data(
+	utki::span<const float> data, //
+	size_t element_size,
+	utki::span<const uint32_t> remap
+)
+{
+	if (data.size() != remap.size() * element_size) {
+		throw std::invalid_argument("gltf: vertex attributes have different number of elements");
+	}
 
-		auto tangent = ruis::vec3(1, 0, 0);
-		auto bitangent = ruis::vec3(0, 1, 0);
+	std::vector<float> ret;
+	ret.reserve(data.size());
+	for (auto i : remap) {
+		auto element = data.subspan(size_t(i) * element_size, element_size);
+		ret.insert(ret.end(), element.begin(), element.end());
+	}
+	return ret;
+}
 
-		using std::abs;
-		if (abs(t.det()) >= epsilon) {
-			auto a = t.inv();
+scene_data::index_data_type make_index_data(const accessor& acc)
+{
+	return std::visit(
+		[](const auto& data) -> scene_data::index_data_type {
+			using element_type = typename std::remove_cvref_t<decltype(data)>::value_type;
+			if constexpr (std::is_integral_v<element_type>) {
+				return data;
+			} else {
+				throw std::invalid_argument("gltf: accessor of non-integral type cannot be used as indices");
+			}
+		},
+		acc.data
+	);
+}
+} // namespace
 
-			tangent = edge1 * a[0][0] + edge2 * a[1][0];
-			bitangent = edge1 * a[0][1] + edge2 * a[1][1];
-		}
+namespace {
+size_t get_component_size(vertex_layout::component_type type)
+{
+	switch (type) {
+		case vertex_layout::component_type::int8:
+		case vertex_layout::component_type::uint8:
+			return sizeof(uint8_t);
+		case vertex_layout::component_type::int16:
+		case vertex_layout::component_type::uint16:
+			return sizeof(uint16_t);
+		case vertex_layout::component_type::float32:
+		default:
+			return sizeof(float);
+	}
+}
 
-		// Accumulate the tangents and bitangents.
-		tangents[index0] += tangent;
-		bitangents[index0] += bitangent;
+// tightly packed vertex attribute data to be interleaved
+struct vertex_attribute_source {
+	utki::span<const uint8_t> data;
+	uint32_t num_components;
+	vertex_layout::component_type type = vertex_layout::component_type::float32;
+	bool normalized = false;
+
+	template <typename tp_type>
+	vertex_attribute_source(utki::span<const tp_type> data) :
+		data(utki::make_span(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<const uint8_t*>(data.data()),
+			data.size_bytes()
+		)),
+		num_components(sizeof(tp_type) / sizeof(float))
+	{
+		static_assert(sizeof(tp_type) % sizeof(float) == 0, "only float vertex attributes are supported");
+	}
 
-		tangents[index1] += tangent;
-		bitangents[index1] += bitangent;
+	// float or quantized accessor data
+	vertex_attribute_source(const accessor& acc, uint32_t num_components) :
+		data(acc.quantized_data),
+		num_components(num_components),
+		normalized(acc.normalized)
+	{
+		if (acc.get_num_components() != num_components) {
+			throw std::invalid_argument("gltf: accessor type does not match vertex attribute type");
+		}
 
-		tangents[index2] += tangent;
-		bitangents[index2] += bitangent;
+		switch (acc.component_type_v) {
+			case accessor::component_type::act_float:
+				std::visit(
+					[this](const auto& d) {
+						using element_type = typename std::remove_cvref_t<decltype(d)>::value_type;
+						if constexpr (std::is_integral_v<element_type>) {
+							throw std::invalid_argument(
+								"gltf: accessor of integral type cannot be used as vertex attribute"
+							);
+						} else {
+							*this = vertex_attribute_source(d);
+						}
+					},
+					acc.data
+				);
+				break;
+			case accessor::component_type::act_signed_byte:
+				this->type = vertex_layout::component_type::int8;
+				break;
+			case accessor::component_type::act_unsigned_byte:
+				this->type = vertex_layout::component_type::uint8;
+				break;
+			case accessor::component_type::act_signed_short:
+				this->type = vertex_layout::component_type::int16;
+				break;
+			case accessor::component_type::act_unsigned_short:
+				this->type = vertex_layout::component_type::uint16;
+				break;
+			default:
+				throw std::invalid_argument("gltf: unsupported vertex attribute component type");
+		}
 	}
 
-	// Orthogonalize and normalize the vertex tangents.
-	for (uint32_t i = 0; i < num_vertices; ++i) {
-		// Tangent and bitangent are not necessarily ortogonal to each other, but those have to be
-		// ortogonal to the normal.
+	size_t get_element_size() const noexcept
+	{
+		return this->num_components * get_component_size(this->type);
+	}
+};
 
-		// Ortogonalize the tangent and bitangent to the normal.
+// returns interleaved vertex data and its layout
+std::pair<std::vector<float>, vertex_layout> interleave_vertex_attributes(
+	uint32_t num_vertices, //
+	utki::span<const vertex_attribute_source> sources
+)
+{
+	vertex_layout layout;
 
-		tangents[i] -= normals[i].dot(tangents[i]) * normals[i];
-		bitangents[i] -= normals[i].dot(bitangents[i]) * normals[i];
+	// attributes are 4 byte aligned, as recommended for vertex fetch performance
+	constexpr size_t attribute_alignment = 4;
 
-		tangents[i].normalize();
-		bitangents[i].normalize();
+	for (const auto& s : sources) {
+		if (s.data.size() != size_t(num_vertices) * s.get_element_size()) {
+			throw std::invalid_argument("gltf: vertex attributes have different number of elements");
+		}
+		layout.attributes.push_back({
+			.offset = layout.stride, //
+			.num_components = s.num_components,
+			.type = s.type,
+			.normalized = s.normalized
+		});
+		layout.stride += uint32_t(
+			(s.get_element_size() + attribute_alignment - 1) / attribute_alignment * attribute_alignment
+		);
+	}
 
-		// TODO: The triangle in texture space can be wound in different direction than in object space,
-		// need to flip the tangent basis to make normals from normal map point towards triangle normal direction.
+	// float data keeps the vertices 4 byte aligned, quantized attributes take a fraction of a float
+	std::vector<float> buffer(size_t(num_vertices) * layout.stride / sizeof(float));
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	auto dst = reinterpret_cast<uint8_t*>(buffer.data());
+	for (uint32_t v = 0; v != num_vertices; ++v) {
+		for (size_t i = 0; i != sources.size(); ++i) {
+			auto size = sources[i].get_element_size();
+			std::memcpy(
+				dst + layout.attributes[i].offset, //
+				sources[i].data.data() + v * size,
+				size
+			);
+		}
+		dst += layout.stride;
 	}
 
-	auto tangents_vbo = this->render_context.make_vertex_buffer(tangents);
-	auto bitangents_vbo = this->render_context.make_vertex_buffer(bitangents);
+	return {std::move(buffer), std::move(layout)};
+}
+} // namespace
+
+scene_data::primitive gltf_loader::make_primitive(primitive_info& pi)
+{
+	if (pi.material_index >= int(this->data.materials.size())) {
+		throw std::invalid_argument(utki::cat("gltf: primitive material index out of range: ", pi.material_index));
+	}
 
-	auto vao = this->render_context.make_vertex_array(
-		// clang-format off
-		{
-			utki::shared_ref<ruis::render::vertex_buffer>(position_accessor.get().vbo),
-			utki::shared_ref<ruis::render::vertex_buffer>(texcoord_0_accessor.get().vbo),
-			utki::shared_ref<ruis::render::vertex_buffer>(normal_accessor.get().vbo),
-			tangents_vbo,
-			bitangents_vbo
-		},
-		// clang-format on
-		// TODO: check if ibo is guaranteed to be non-null
-		utki::shared_ref<ruis::render::index_buffer>(index_accessor.get().ibo),
-		ruis::render::vertex_array::mode::triangles
+	scene_data::primitive p;
+	p.material_index = pi.material_index;
+	p.bounds = get_position_bounds(
+		this->accessors[pi.position_accessor].get(), //
+		this->memory
 	);
 
-	return vao;
+	auto& index_accessor = this->accessors[pi.index_accessor].get();
+	auto& position_accessor = this->accessors[pi.position_accessor].get();
+	auto& texcoord_0_accessor = this->accessors[pi.texcoord_0_accessor].get();
+	auto& normal_accessor = this->accessors[pi.normal_accessor].get();
+
+	bool fits_16_bit = position_accessor.count <= size_t(std::numeric_limits<uint16_t>::max()) + 1;
+
+	auto store_indices = [&](std::vector<uint32_t>& indices) -> scene_data::index_data_type {
+		if (fits_16_bit) {
+			return this->store(std::vector<uint16_t>(indices.begin(), indices.end()));
+		}
+		return this->store(std::move(indices));
+	};
+
+	if (this->params.optimize_indices) {
+		if (fits_16_bit && std::holds_alternative<utki::span<const uint32_t>>(index_accessor.data)) {
+			++this->index_optimization_stats.num_downconverted;
+		}
+		p.indices = store_indices(pi.optimized_indices);
+	} else {
+		p.indices = make_index_data(index_accessor);
+	}
+
+	p.lods.reserve(pi.lod_indices.size());
+	for (auto& l : pi.lod_indices) {
+		p.lods.push_back(store_indices(l));
+	}
+
+	auto tangents = this->store(std::move(pi.tangent_space_v.tangents));
+	auto bitangents = this->store(std::move(pi.tangent_space_v.bitangents));
+
+	if (this->params.interleave_vertex_attributes) {
+		// attribute order corresponds to shader attribute indices
+		// quantized attributes are interleaved as is
+		std::array<vertex_attribute_source, 5> sources = {
+			{{position_accessor, 3}, //
+			 {texcoord_0_accessor, 2},
+			 {normal_accessor, 3},
+			 tangents,
+			 bitangents}
+		};
+
+		auto [vertices, layout] = interleave_vertex_attributes(position_accessor.count, sources);
+
+		if (this->params.optimize_indices) {
+			// indices were remapped to the vertex fetch optimized order, reorder vertices accordingly
+			auto interleaved_block = this->memory.track(vertices);
+			vertices = remap_vertex_data(vertices, layout.stride / sizeof(float), pi.vertex_remap);
+		}
+
+		// interleaved vertex data is uploaded as a plain float buffer, the layout describes the attributes
+		p.attributes.push_back({
+			.num_components = 1, //
+			.data = this->store(std::move(vertices))
+		});
+		p.interleaved_layout = std::move(layout);
+	} else {
+		// the rendering context only creates float vertex buffers, so quantized data is converted to floats
+		p.attributes = {
+			make_vertex_attribute(this->get_float_data<ruis::vec3>(position_accessor)),
+			make_vertex_attribute(this->get_float_data<ruis::vec2>(texcoord_0_accessor)),
+			make_vertex_attribute(this->get_float_data<ruis::vec3>(normal_accessor)),
+			make_vertex_attribute(tangents),
+			make_vertex_attribute(bitangents)
+		};
+
+		if (this->params.optimize_indices) {
+			for (auto& a : p.attributes) {
+				a.data = this->store(remap_vertex_data(a.data, a.num_components, pi.vertex_remap));
+			}
+		}
+	}
+
+	// the intermediate data is not needed anymore, release it right away to lower the peak memory use
+	pi.optimized_indices = {};
+	pi.vertex_remap = {};
+	pi.lod_indices = {};
+	pi.tangent_space_v = {};
+	this->memory.freed(pi.tracked_memory);
+	pi.tracked_memory = 0;
+
+	return p;
 }
@@ -21,20 +21,52 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <variant>
 
-#include <jsondom/dom.hpp>
 #include <ruis/context.hpp>
 #include <ruis/render/renderer.hpp>
 
+#include "json_reader.hxx"
+#include "load_progress.hxx"
+#include "memory_tracker.hxx"
 #include "mesh.hpp"
+#include "meshopt_decoder.hxx"
 #include "node.hpp"
 #include "scene.hpp"
+#include "scene_data.hxx"
+#include "tangent_space.hxx"
 
 namespace ruis::render {
 
-// currently we support only one data buffer, the single data buffer located in the .glb file
+// data buffer, either the BIN chunk of the .glb file or an external file or a data URI
+struct buffer {
+	uint32_t byte_length;
+
+	// empty for the .glb BIN chunk
+	std::string uri;
+
+	// the data is loaded on first use, from any thread
+	std::once_flag loaded;
+	std::shared_ptr<const void> owner;
+	utki::span<const uint8_t> data;
+
+	buffer(
+		uint32_t byte_length, //
+		std::string uri
+	) :
+		byte_length(byte_length),
+		uri(std::move(uri))
+	{}
+};
+
 struct buffer_view {
+	utki::shared_ref<buffer> buf;
 	uint32_t byte_length;
 	uint32_t byte_offset;
 	uint32_t byte_stride;
@@ -46,12 +78,27 @@ struct buffer_view {
 		element_array_buffer = 34963
 	} target_v;
 
+	// EXT_meshopt_compression, location of the compressed data
+	struct meshopt_source {
+		utki::shared_ref<buffer> buf;
+		uint32_t byte_length;
+		uint32_t byte_offset;
+		meshopt_compression params;
+	};
+
+	std::optional<meshopt_source> meshopt;
+
+	// data of the compressed buffer view after decoding, owned by the scene data
+	utki::span<const uint8_t> decoded_data;
+
 	buffer_view(
-		uint32_t byte_length, //
+		utki::shared_ref<buffer> buf, //
+		uint32_t byte_length,
 		uint32_t byte_offset,
 		uint32_t byte_stride,
 		target target_v
 	) :
+		buf(std::move(buf)),
 		byte_length(byte_length),
 		byte_offset(byte_offset),
 		byte_stride(byte_stride),
@@ -87,19 +134,33 @@ struct accessor {
 		act_float = 5126
 	} component_type_v;
 
-	std::shared_ptr<ruis::render::vertex_buffer> vbo;
-	std::shared_ptr<ruis::render::index_buffer> ibo;
-
 	using vertex_data_type = std::variant<
-		std::vector<float>,
-		std::vector<ruis::vec2>,
-		std::vector<ruis::vec3>,
-		std::vector<ruis::vec4>,
-		std::vector<uint16_t>,
-		std::vector<uint32_t>>;
-
+		utki::span<const float>,
+		utki::span<const ruis::vec2>,
+		utki::span<const ruis::vec3>,
+		utki::span<const ruis::vec4>,
+		utki::span<const uint16_t>,
+		utki::span<const uint32_t>>;
+
+	// Accessor data. Points either directly into the binary buffer, in case the data is tightly packed
+	// and is already in the required memory layout, or to the converted data kept in the scene_data storage.
 	vertex_data_type data;
 
+	// Whether integer components are normalized, used for quantized vertex attributes.
+	bool normalized = false;
+
+	// Quantized vertex attribute data, see KHR_mesh_quantization glTF extension.
+	// Tightly packed vectors of integer components, component type is given by component_type_v.
+	// Same as the data, points either into the binary buffer or to the scene_data storage.
+	utki::span<const uint8_t> quantized_data;
+
+	// Minimum and maximum values of the components, empty if not given.
+	// For quantized data these are values of the integer components.
+	std::vector<float> min;
+	std::vector<float> max;
+
+	uint32_t get_num_components() const noexcept;
+
 	accessor(
 		utki::shared_ref<buffer_view> bv, //
 		uint32_t count,
@@ -118,7 +179,8 @@ struct image_view {
 	enum class mime_type {
 		undefined = 0,
 		image_jpeg = 1,
-		image_png = 2
+		image_png = 2,
+		image_ktx2 = 3
 	} mime_type_v;
 
 	image_view(
@@ -135,6 +197,7 @@ struct image_view {
 struct sampler {
 	// these explicit enum item numbers are from glTF spec
 	enum class filter {
+		undefined = 0,
 		nearest = 9728,
 		linear = 9729,
 		nearest_mipmap_nearest = 9984,
@@ -168,66 +231,445 @@ struct sampler {
 	{}
 };
 
+/**
+ * @brief Timing information of a single image loading.
+ */
+struct image_load_timing {
+	std::string name;
+
+	// size of the encoded image data, in bytes
+	size_t encoded_size = 0;
+
+	// wall time spent decoding the image on a worker thread
+	std::chrono::nanoseconds decode_time{0};
+
+	// wall time spent creating the texture on the rendering thread
+	std::chrono::nanoseconds upload_time{0};
+};
+
+/**
+ * @brief Statistics of the index buffers optimization.
+ * ACMR is the average cache miss ratio, i.e. number of post-transform vertex cache misses per triangle,
+ * the lower the better. It is never less than 0.5 for a closed mesh and at most 3.
+ */
+struct index_optimization_statistics {
+	size_t num_primitives = 0;
+	size_t num_triangles = 0;
+	size_t num_cache_misses_before = 0;
+	size_t num_cache_misses_after = 0;
+
+	// number of primitives with 32-bit indices which were converted to 16-bit indices
+	size_t num_downconverted = 0;
+
+	float get_acmr_before() const noexcept
+	{
+		return this->num_triangles == 0 ? 0 : float(this->num_cache_misses_before) / float(this->num_triangles);
+	}
+
+	float get_acmr_after() const noexcept
+	{
+		return this->num_triangles == 0 ? 0 : float(this->num_cache_misses_after) / float(this->num_triangles);
+	}
+};
+
+/**
+ * @brief Statistics of a single scene loading.
+ * Sizes are in bytes, counts of vertices, triangles and primitives are summed over all meshes,
+ * regardless of how many times the meshes are instantiated by the scene nodes.
+ */
+struct load_statistics {
+	enum class stage {
+		// reading the glTF file and parsing its container
+		file_read,
+		json_parse,
+		// decoding of EXT_meshopt_compression buffer views
+		buffer_decode,
+		image_decode,
+		// reading vertex and index data, including dequantization and external buffers loading
+		accessor_decode,
+		tangent_generation,
+		index_optimization,
+		// simplification of the primitives into levels of detail
+		lod_generation,
+		// building final vertex and index data of the primitives, e.g. interleaving, and the node hierarchy
+		scene_build,
+		// creating the GPU objects, only measured by gltf_loader::load()
+		gpu_upload,
+
+		enum_size
+	};
+
+	/**
+	 * @brief Wall time spent in each loading stage, indexed by stage.
+	 */
+	std::array<std::chrono::nanoseconds, size_t(stage::enum_size)> stage_times{};
+
+	/**
+	 * @brief Optional counter of memory allocations, e.g. incremented by a replaced global operator new.
+	 * It is provided by the caller and is kept when the statistics are reset.
+	 * If set, the number of allocations made during each loading stage, including allocations
+	 * made by worker threads, is recorded to stage_allocations.
+	 */
+	const std::atomic<size_t>* allocation_counter = nullptr;
+
+	/**
+	 * @brief Number of memory allocations made in each loading stage, indexed by stage.
+	 * Only filled if allocation_counter is set.
+	 */
+	std::array<size_t, size_t(stage::enum_size)> stage_allocations{};
+
+	/**
+	 * @brief Size of the glTF file and of the external and data URI buffers it uses.
+	 */
+	size_t bytes_read = 0;
+
+	/**
+	 * @brief Size of the data produced by decoding and converting the file data.
+	 * Includes decoded images, decoded buffer views and converted vertex and index data.
+	 */
+	size_t bytes_decoded = 0;
+
+	/**
+	 * @brief Size of the data uploaded to GPU, only filled by gltf_loader::load().
+	 * Identical resources are uploaded only once and counted once.
+	 */
+	size_t bytes_uploaded = 0;
+
+	size_t num_vertices = 0;
+	size_t num_triangles = 0;
+	size_t num_textures = 0;
+
+	/**
+	 * @brief Number of triangles of all the generated levels of detail.
+	 * Not included in num_triangles.
+	 */
+	size_t num_lod_triangles = 0;
+
+	/**
+	 * @brief Number of mesh primitives, each primitive is a separate draw call.
+	 */
+	size_t num_primitives = 0;
+
+	/**
+	 * @brief Size of the decoded and intermediate data held when reading is finished.
+	 * That is the decoded data, decoded data URI buffers and the parsed JSON.
+	 * Short-lived buffers which are freed during reading are not included, see peak_temporary_memory.
+	 * Memory-mapped file content is not included.
+	 */
+	size_t retained_memory = 0;
+
+	/**
+	 * @brief High-water mark of the memory used by the decoded and intermediate data during reading.
+	 * In addition to the retained data, it includes short-lived dequantization, index optimization,
+	 * simplification and interleaving buffers of all worker threads which exist at the same time.
+	 * Internal buffers of image decoders and memory-mapped file content are not included.
+	 */
+	size_t peak_temporary_memory = 0;
+
+	std::chrono::nanoseconds get_time(stage s) const noexcept
+	{
+		return this->stage_times[size_t(s)];
+	}
+
+	std::chrono::nanoseconds get_total_time() const noexcept
+	{
+		std::chrono::nanoseconds ret{0};
+		for (const auto& t : this->stage_times) {
+			ret += t;
+		}
+		return ret;
+	}
+
+	size_t get_num_allocations(stage s) const noexcept
+	{
+		return this->stage_allocations[size_t(s)];
+	}
+
+	/**
+	 * @brief Reset the collected statistics.
+	 * The allocation counter is kept.
+	 */
+	void reset() noexcept
+	{
+		auto counter = this->allocation_counter;
+		*this = {};
+		this->allocation_counter = counter;
+	}
+};
+
 class gltf_loader
 {
+public:
+	struct parameters {
+		/**
+		 * @brief Put all vertex attributes of a primitive into a single interleaved vertex buffer.
+		 * Interleaved vertex data gives better vertex fetch cache locality and results in fewer
+		 * vertex buffer objects, but requires the renderer to respect primitive::interleaved_layout.
+		 */
+		bool interleave_vertex_attributes = false;
+
+		/**
+		 * @brief Optimize index buffers of the primitives.
+		 * Triangles are reordered for post-transform vertex cache utilization and then to reduce overdraw,
+		 * vertices are reordered by first use for vertex fetch locality. 32-bit indices are converted
+		 * to 16-bit ones when all vertex indices fit. Takes extra time when reading the glTF file.
+		 */
+		bool optimize_indices = false;
+
+		/**
+		 * @brief Number of levels of detail to generate for each primitive.
+		 * The levels are made by simplifying the primitive's triangles, see simplify_mesh(), and share
+		 * the primitive's vertex data. Fewer levels are generated in case the mesh cannot be simplified
+		 * within the lod_max_error. Takes extra time when reading the glTF file.
+		 */
+		unsigned num_lods = 0;
+
+		/**
+		 * @brief Target ratio of number of triangles of each level of detail to the previous one.
+		 */
+		float lod_triangle_ratio = 0.5f;
+
+		/**
+		 * @brief Maximum simplification error, relative to the primitive size.
+		 */
+		float lod_max_error = 0.02f;
+	};
+
+private:
 	// NOLINTNEXTLINE(clang-analyzer-webkit.NoUncountedMemberChecker, "false-positive")
 	ruis::render::context& render_context;
 
+	const parameters params;
+
+	// file being read and its .glb BIN chunk, only during reading stage
+	const fsif::file* gltf_file = nullptr;
 	utki::span<const uint8_t> glb_binary_buffer;
 
-	// order of items in arrays below is important during loading stage
-	std::vector<utki::shared_ref<scene>> scenes;
-	std::vector<utki::shared_ref<node>> nodes;
-	std::vector<utki::shared_ref<mesh>> meshes;
+	// scene data being read, only during reading stage
+	scene_data data;
+
+	// progress of the reading, only during reading stage, can be null
+	load_progress* progress = nullptr;
+
+	// these can be called from worker threads
+	void report_progress(float value);
+	void check_cancelled() const;
+
+	// statistics of the reading, only during reading stage, can be null
+	load_statistics* stats = nullptr;
+
+	// size of the data put to the scene data storage by the reading, only during reading stage
+	size_t stored_bytes = 0;
+
+	// memory of the decoded and intermediate data, only during reading stage,
+	// updated by worker threads and by buffer loading which is done on first use, hence mutable
+	mutable memory_tracker memory;
+
+	// value of the statistics allocation counter at the current stage start, only during reading stage
+	size_t stage_start_num_allocations = 0;
+
+	// returns the current time, to be passed to finish_stage()
+	std::chrono::steady_clock::time_point start_stage();
+
+	// adds the time passed and the allocations made since the stage start to the stage statistics,
+	// returns the current time, which is the start of the next stage
+	std::chrono::steady_clock::time_point finish_stage(
+		load_statistics::stage s, //
+		std::chrono::steady_clock::time_point start
+	);
+
+	template <typename tp_type>
+	utki::span<const tp_type> store(std::vector<tp_type> vec)
+	{
+		this->stored_bytes += vec.size() * sizeof(tp_type);
+		this->memory.allocated(vec.capacity() * sizeof(tp_type));
+		return this->data.store(std::move(vec));
+	}
+
+	void collect_statistics(
+		size_t file_size, //
+		size_t json_memory_size
+	);
+
+	// order of items in arrays below is important during reading stage
 	std::vector<utki::shared_ref<accessor>> accessors;
+	std::vector<utki::shared_ref<buffer>> buffers;
 	std::vector<utki::shared_ref<buffer_view>> buffer_views;
-
-	std::vector<utki::shared_ref<material>> materials;
-	std::vector<utki::shared_ref<ruis::render::texture_2d>> textures;
 	std::vector<utki::shared_ref<sampler>> samplers;
 	std::vector<utki::shared_ref<image_view>> images;
 
-	// TODO: why does it have to be a class member? Can't be a local variable?
-	// storage for node child hierarchy (only during loading stage)
-	std::vector<std::vector<uint32_t>> child_indices;
+	std::vector<image_load_timing> image_timings;
+
+	index_optimization_statistics index_optimization_stats;
 
 	template <typename tp_type>
-	void make_vertex_buffer_float(
-		utki::shared_ref<ruis::render::accessor>, //
+	utki::span<const tp_type> read_accessor_data(
+		accessor& acc, //
 		utki::span<const uint8_t> buffer,
-		uint32_t acc_count,
-		uint32_t acc_stride
+		uint32_t stride
+	);
+
+	template <typename tp_component_type>
+	utki::span<const uint8_t> read_quantized_accessor_data(
+		accessor& acc, //
+		utki::span<const uint8_t> buffer,
+		uint32_t stride
 	);
 
+	template <typename tp_type>
+	utki::span<const tp_type> get_float_data(const accessor& acc);
+
 	template <typename tp_type>
 	std::vector<utki::shared_ref<tp_type>> read_root_array(
-		std::function<tp_type(const jsondom::value& j)> read_func, //
-		const jsondom::value& root_json,
+		std::function<tp_type(json_value j)> read_func, //
+		json_value root_json,
 		const std::string& name
 	);
 
-	template <typename tp_type>
-	utki::shared_ref<ruis::render::vertex_array> make_vao_with_tangent_space(
-		utki::shared_ref<accessor> index_accessor, //
-		utki::shared_ref<accessor> position_accessor,
-		utki::shared_ref<accessor> texcoord_0_accessor,
-		utki::shared_ref<accessor> normal_accessor
-	);
+	// mesh primitive description, only during reading stage
+	struct primitive_info {
+		uint32_t index_accessor;
+		uint32_t position_accessor;
+		uint32_t normal_accessor;
+		uint32_t texcoord_0_accessor;
+		int tangent_accessor;
+		int material_index;
+
+		tangent_space tangent_space_v;
+
+		// filled only if index optimization is enabled
+		std::vector<uint32_t> optimized_indices;
+		std::vector<uint32_t> vertex_remap;
+		size_t num_cache_misses_before = 0;
+		size_t num_cache_misses_after = 0;
 
-	utki::shared_ref<buffer_view> read_buffer_view(const jsondom::value& buffer_view_json);
-	utki::shared_ref<accessor> read_accessor(const jsondom::value& accessor_json);
-	utki::shared_ref<mesh> read_mesh(const jsondom::value& mesh_json);
-	utki::shared_ref<node> read_node(const jsondom::value& node_json);
-	utki::shared_ref<scene> read_scene(const jsondom::value& scene_json);
+		// filled only if levels of detail generation is enabled
+		std::vector<std::vector<uint32_t>> lod_indices;
+
+		// size of the above data reported to the memory tracker
+		size_t tracked_memory = 0;
+	};
+
+	// mesh description, only during reading stage
+	struct mesh_info {
+		std::string name;
+		std::vector<primitive_info> primitives;
+	};
 
-	utki::shared_ref<image_view> read_image_view(const jsondom::value& image_json);
-	utki::shared_ref<sampler> read_sampler(const jsondom::value& sampler_json);
-	utki::shared_ref<ruis::render::texture_2d> read_texture(const jsondom::value& texture_json);
-	utki::shared_ref<material> read_material(const jsondom::value& material_json);
+	// reports memory of the primitive data which is kept until the primitive is built
+	template <typename tp_type>
+	void track_intermediate(primitive_info& pi, const std::vector<tp_type>& vec)
+	{
+		auto size = vec.capacity() * sizeof(tp_type);
+		pi.tracked_memory += size;
+		this->memory.allocated(size);
+	}
+
+	mesh_info read_mesh(json_value mesh_json);
+	void make_tangent_spaces(std::vector<mesh_info>& mesh_infos);
+	void optimize_index_buffers(std::vector<mesh_info>& mesh_infos);
+	void generate_lods(std::vector<mesh_info>& mesh_infos);
+	scene_data::mesh make_mesh(mesh_info& mi);
+	scene_data::primitive make_primitive(primitive_info& pi);
+
+	utki::shared_ref<buffer> read_buffer(json_value buffer_json);
+	void load_buffer(buffer& buf) const;
+	utki::span<const uint8_t> get_buffer_data(buffer& buf) const;
+	utki::shared_ref<buffer> get_buffer(uint32_t index) const;
+	utki::shared_ref<buffer_view> read_buffer_view(json_value buffer_view_json);
+	void decode_buffer_views();
+	utki::span<const uint8_t> get_buffer_view_data(const buffer_view& bv) const;
+	utki::shared_ref<accessor> read_accessor(json_value accessor_json);
+	scene_data::node read_node(json_value node_json);
+	std::vector<ruis::mat4> read_instances(json_value instancing_json);
+	scene_data::scene read_scene(json_value scene_json);
+	scene_data::animation read_animation(json_value animation_json);
+
+	utki::shared_ref<image_view> read_image_view(json_value image_json);
+	utki::shared_ref<sampler> read_sampler(json_value sampler_json);
+	utki::span<const uint8_t> get_image_data(const image_view& image) const;
+	uint32_t get_texture_source(json_value texture_json) const;
+	void decode_images(json_value textures_json);
+	scene_data::texture read_texture(json_value texture_json);
+	scene_data::material read_material(json_value material_json);
 
 public:
-	utki::shared_ref<scene> load(const fsif::file& fi);
+	/**
+	 * @brief Read scene data from glTF file.
+	 * Both binary .glb and JSON .gltf files are supported. External buffers are resolved relative
+	 * to the glTF file and are only loaded if used. External buffer files are memory-mapped when possible
+	 * and are shared with other glTF files referencing the same buffer file, see get_shared_file_content().
+	 * Reading does not create any GPU objects, so it can be done on any thread.
+	 * The GPU objects can be created later from the returned data using make_scene().
+	 * @param fi - file to read.
+	 * @param progress - optional progress to report the reading progress to and to check for cancellation.
+	 * @param stats - optional output of the reading statistics.
+	 * @return Read scene data.
+	 * @throw load_cancelled - if the reading was cancelled via the progress object.
+	 */
+	scene_data read(
+		const fsif::file& fi, //
+		load_progress* progress = nullptr,
+		load_statistics* stats = nullptr
+	);
+
+	/**
+	 * @brief Load scene from glTF file.
+	 * Same as reading scene data and then making a scene out of it.
+	 * Must be called on the rendering thread.
+	 * @param fi - file to load.
+	 * @param stats - optional output of the loading statistics.
+	 * @return Active scene of the glTF file.
+	 */
+	utki::shared_ref<scene> load(
+		const fsif::file& fi, //
+		load_statistics* stats = nullptr
+	);
+
 	gltf_loader(ruis::render::context& render_context);
+	gltf_loader(
+		ruis::render::context& render_context, //
+		parameters params
+	);
+
+	/**
+	 * @brief Get external buffer files referenced by a glTF file.
+	 * Buffers embedded as data URIs are not included.
+	 * @param fi - the glTF file, used to resolve relative buffer URIs.
+	 * @param content - content of the glTF file.
+	 * @return Buffer files.
+	 */
+	static std::vector<std::unique_ptr<fsif::file>> get_external_buffer_files(
+		const fsif::file& fi, //
+		utki::span<const uint8_t> content
+	);
+
+	const parameters& get_parameters() const noexcept
+	{
+		return this->params;
+	}
+
+	/**
+	 * @brief Get per-image timings of the last read or load.
+	 * Upload times are only filled by load().
+	 * Images are decoded in parallel on worker threads, so the sum of decode times
+	 * can be greater than the wall time spent on decoding all the images.
+	 * @return Timings, indices are same as indices of images in the glTF file.
+	 */
+	const std::vector<image_load_timing>& get_image_timings() const noexcept
+	{
+		return this->image_timings;
+	}
+
+	/**
+	 * @brief Get index optimization statistics of the last read or load.
+	 * The statistics are only collected if index optimization is enabled by the loader parameters.
+	 * @return Index optimization statistics, summed over all the primitives.
+	 */
+	const index_optimization_statistics& get_index_optimization_statistics() const noexcept
+	{
+		return this->index_optimization_stats;
+	}
 };
 
 } // namespace ruis::render
\ No newline at end of file
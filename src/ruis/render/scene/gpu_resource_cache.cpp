@@ -0,0 +1,283 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "gpu_resource_cache.hxx"
+
+#include <utki/string.hpp>
+
+#include "content_hash.hxx"
+
+using namespace ruis::render;
+
+namespace {
+template <typename tp_type>
+utki::span<const uint8_t> as_bytes(utki::span<const tp_type> data)
+{
+	return utki::make_span(
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		reinterpret_cast<const uint8_t*>(data.data()),
+		data.size_bytes()
+	);
+}
+
+uint64_t pack_dims(const r4::vector2<uint32_t>& dims)
+{
+	return (uint64_t(dims.x()) << (sizeof(uint32_t) * 8)) | dims.y();
+}
+
+uint32_t pack_texture_parameters(const ruis::render::context::texture_2d_parameters& params)
+{
+	constexpr auto filter_bits = 8;
+	constexpr auto mipmap_bits = 16;
+
+	return uint32_t(params.min_filter) | (uint32_t(params.mag_filter) << filter_bits) |
+		(uint32_t(params.mipmap) << mipmap_bits);
+}
+} // namespace
+
+template <typename tp_resource_type>
+utki::shared_ref<tp_resource_type> gpu_resource_cache::resource_map<tp_resource_type>::get(
+	const key_type& key,
+	size_t size,
+	const std::function<utki::shared_ref<tp_resource_type>()>& make
+)
+{
+	auto i = this->entries.find(key);
+	if (i != this->entries.end()) {
+		if (auto r = i->second.resource.lock()) {
+			++this->stats.hits;
+			this->stats.saved_bytes += size;
+			return utki::shared_ref<tp_resource_type>(std::move(r));
+		}
+	}
+
+	++this->stats.misses;
+
+	auto r = make();
+
+	this->entries.insert_or_assign(
+		key, //
+		entry{
+			.resource = r.to_shared_ptr(),
+			.size = size
+		}
+	);
+
+	// remove expired entries from time to time, so that the map does not grow infinitely,
+	// amortized cost of the removal is constant per insertion
+	if (++this->num_insertions > this->entries.size() / 2) {
+		this->remove_expired();
+	}
+
+	return r;
+}
+
+template <typename tp_resource_type>
+void gpu_resource_cache::resource_map<tp_resource_type>::remove_expired()
+{
+	std::erase_if(this->entries, [](const auto& e) {
+		return e.second.resource.expired();
+	});
+	this->num_insertions = 0;
+}
+
+template <typename tp_resource_type>
+gpu_resource_cache::counters gpu_resource_cache::resource_map<tp_resource_type>::get_statistics()
+{
+	this->remove_expired();
+
+	auto ret = this->stats;
+	ret.live_entries = this->entries.size();
+	ret.live_bytes = 0;
+	for (const auto& e : this->entries) {
+		ret.live_bytes += e.second.size;
+	}
+	return ret;
+}
+
+gpu_resource_cache& gpu_resource_cache::inst()
+{
+	static gpu_resource_cache instance;
+	return instance;
+}
+
+utki::shared_ref<texture_2d> gpu_resource_cache::get_texture_2d(
+	ruis::render::context& render_context,
+	const rasterimage::image_variant& image,
+	const ruis::render::context::texture_2d_parameters& params
+)
+{
+	auto [dims, bytes] = std::visit(
+		[&](const auto& im) {
+			return std::make_pair(pack_dims(im.dims()), as_bytes(im.pixels()));
+		},
+		image.variant()
+	);
+
+	auto hash = content_hash_128(bytes);
+
+	// dimensions are part of the content, e.g. 2x8 and 4x4 images with same pixel data are different
+	key_type key{
+		&render_context,
+		hash[0],
+		hash[1],
+		bytes.size(),
+		dims,
+		uint32_t(image.variant().index()),
+		pack_texture_parameters(params)
+	};
+
+	std::lock_guard lock(this->mutex);
+	return this->textures.get(key, bytes.size(), [&]() {
+		return render_context.make_texture_2d(image, params);
+	});
+}
+
+utki::shared_ref<texture_2d> gpu_resource_cache::get_texture_2d(
+	ruis::render::context& render_context,
+	const compressed_image& image,
+	const ruis::render::context::texture_2d_parameters& params,
+	const compressed_texture_factory& factory
+)
+{
+	content_hash_128_type hash{};
+	size_t size = 0;
+	for (const auto& l : image.levels) {
+		hash = content_hash_128(l, hash);
+		size += l.size();
+	}
+
+	// compressed formats go after uncompressed image variant indices
+	constexpr auto compressed_format_base = 0x100;
+
+	key_type key{
+		&render_context,
+		hash[0],
+		hash[1],
+		size,
+		pack_dims(image.dims),
+		uint32_t(compressed_format_base + unsigned(image.format_v)),
+		pack_texture_parameters(params)
+	};
+
+	std::lock_guard lock(this->mutex);
+	return this->textures.get(key, size, [&]() {
+		if (factory) {
+			if (auto t = factory(image, params)) {
+				return utki::shared_ref<texture_2d>(std::move(t));
+			}
+		}
+		return render_context.make_texture_2d(image.decode(), params);
+	});
+}
+
+utki::shared_ref<vertex_buffer> gpu_resource_cache::get_vertex_buffer(
+	ruis::render::context& render_context,
+	utki::span<const float> data,
+	uint32_t num_components
+)
+{
+	auto bytes = as_bytes(data);
+	auto hash = content_hash_128(bytes);
+
+	key_type key{
+		&render_context, //
+		hash[0],
+		hash[1],
+		bytes.size(),
+		0,
+		num_components,
+		0
+	};
+
+	auto make = [&]() {
+		auto make_vec = [&](auto element) {
+			using element_type = decltype(element);
+			return render_context.make_vertex_buffer(utki::make_span(
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				reinterpret_cast<const element_type*>(data.data()),
+				data.size() / (sizeof(element_type) / sizeof(float))
+			));
+		};
+
+		switch (num_components) {
+			case 1:
+				return render_context.make_vertex_buffer(data);
+			case 2:
+				return make_vec(ruis::vec2{});
+			case 3:
+				return make_vec(ruis::vec3{});
+			case 4:
+				return make_vec(ruis::vec4{});
+			default:
+				throw std::invalid_argument(
+					utki::cat("gpu_resource_cache: unsupported number of vertex components: ", num_components)
+				);
+		}
+	};
+
+	std::lock_guard lock(this->mutex);
+	return this->vertex_buffers.get(key, bytes.size(), make);
+}
+
+template <typename tp_index_type>
+utki::shared_ref<index_buffer> gpu_resource_cache::get_index_buffer(
+	ruis::render::context& render_context, //
+	utki::span<const tp_index_type> indices
+)
+{
+	auto bytes = as_bytes(indices);
+	auto hash = content_hash_128(bytes);
+
+	key_type key{
+		&render_context, //
+		hash[0],
+		hash[1],
+		bytes.size(),
+		0,
+		uint32_t(sizeof(tp_index_type)),
+		0
+	};
+
+	std::lock_guard lock(this->mutex);
+	return this->index_buffers.get(key, bytes.size(), [&]() {
+		return render_context.make_index_buffer(indices);
+	});
+}
+
+template utki::shared_ref<index_buffer> gpu_resource_cache::get_index_buffer(
+	ruis::render::context& render_context,
+	utki::span<const uint16_t> indices
+);
+template utki::shared_ref<index_buffer> gpu_resource_cache::get_index_buffer(
+	ruis::render::context& render_context,
+	utki::span<const uint32_t> indices
+);
+
+gpu_resource_cache::statistics gpu_resource_cache::get_statistics()
+{
+	std::lock_guard lock(this->mutex);
+	return {
+		.textures = this->textures.get_statistics(),
+		.vertex_buffers = this->vertex_buffers.get_statistics(),
+		.index_buffers = this->index_buffers.get_statistics()
+	};
+}
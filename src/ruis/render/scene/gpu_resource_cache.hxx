@@ -0,0 +1,206 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include <rasterimage/image_variant.hpp>
+#include <ruis/render/context.hpp>
+
+#include "compressed_image.hxx"
+
+namespace ruis::render {
+
+/**
+ * @brief Content-addressed cache of GPU resources.
+ * Textures, vertex buffers and index buffers are looked up by a hash of their content,
+ * so that identical data loaded several times, e.g. by several scenes showing variants
+ * of the same model, is uploaded to GPU only once.
+ * The cache holds weak references to the resources, so resources which are not used by anyone
+ * are freed as usual and their cache entries expire.
+ * The content is not kept by the cache, entries are identified by 128-bit hash of the content
+ * along with its size, dimensions and type, so accidental collisions are practically impossible.
+ * Resources of different rendering contexts are never shared.
+ * All methods are thread-safe.
+ */
+class gpu_resource_cache
+{
+public:
+	struct counters {
+		/**
+		 * @brief Number of lookups which returned an existing resource.
+		 */
+		size_t hits = 0;
+
+		/**
+		 * @brief Number of lookups which created a new resource.
+		 */
+		size_t misses = 0;
+
+		/**
+		 * @brief Number of bytes which were not uploaded to GPU thanks to cache hits.
+		 */
+		size_t saved_bytes = 0;
+
+		/**
+		 * @brief Number of resources currently alive.
+		 */
+		size_t live_entries = 0;
+
+		/**
+		 * @brief Size of data of resources currently alive, in bytes.
+		 * Texture sizes do not account for mipmaps.
+		 */
+		size_t live_bytes = 0;
+	};
+
+	struct statistics {
+		counters textures;
+		counters vertex_buffers;
+		counters index_buffers;
+	};
+
+private:
+	using key_type = std::tuple<
+		const ruis::render::context*,
+		uint64_t, // content hash, first half
+		uint64_t, // content hash, second half
+		size_t, // content size in bytes
+		uint64_t, // content dimensions, for textures
+		uint32_t, // content type specific
+		uint32_t // content type specific
+		>;
+
+	template <typename tp_resource_type>
+	struct resource_map {
+		struct entry {
+			std::weak_ptr<tp_resource_type> resource;
+			size_t size;
+		};
+
+		std::map<key_type, entry> entries;
+		counters stats;
+
+		// number of insertions since last removal of expired entries
+		size_t num_insertions = 0;
+
+		utki::shared_ref<tp_resource_type> get(
+			const key_type& key, //
+			size_t size,
+			const std::function<utki::shared_ref<tp_resource_type>()>& make
+		);
+
+		void remove_expired();
+
+		counters get_statistics();
+	};
+
+	std::mutex mutex;
+
+	resource_map<ruis::render::texture_2d> textures;
+	resource_map<ruis::render::vertex_buffer> vertex_buffers;
+	resource_map<ruis::render::index_buffer> index_buffers;
+
+public:
+	/**
+	 * @brief Get process-wide cache instance.
+	 * @return Process-wide cache instance.
+	 */
+	static gpu_resource_cache& inst();
+
+	/**
+	 * @brief Get texture with given content.
+	 * @param render_context - rendering context to create the texture with in case it is not found in the cache.
+	 * @param image - texture image.
+	 * @param params - texture parameters. Textures with different parameters are different cache entries.
+	 * @return Existing texture with same content, or a newly created one.
+	 */
+	utki::shared_ref<ruis::render::texture_2d> get_texture_2d(
+		ruis::render::context& render_context,
+		const rasterimage::image_variant& image,
+		const ruis::render::context::texture_2d_parameters& params
+	);
+
+	/**
+	 * @brief Get texture with given compressed content.
+	 * In case the compressed texture factory is not set or it does not support the image format,
+	 * the image is decoded and uploaded uncompressed.
+	 * @param render_context - rendering context to create the texture with in case it is not found in the cache.
+	 * @param image - compressed texture image.
+	 * @param params - texture parameters. Textures with different parameters are different cache entries.
+	 * @param factory - function to create compressed GPU texture with.
+	 * @return Existing texture with same content, or a newly created one.
+	 */
+	utki::shared_ref<ruis::render::texture_2d> get_texture_2d(
+		ruis::render::context& render_context,
+		const compressed_image& image,
+		const ruis::render::context::texture_2d_parameters& params,
+		const compressed_texture_factory& factory
+	);
+
+	/**
+	 * @brief Get vertex buffer with given content.
+	 * @param render_context - rendering context to create the buffer with in case it is not found in the cache.
+	 * @param data - vertex data.
+	 * @param num_components - number of float components per vertex, 1 to 4.
+	 * @return Existing vertex buffer with same content, or a newly created one.
+	 */
+	utki::shared_ref<ruis::render::vertex_buffer> get_vertex_buffer(
+		ruis::render::context& render_context,
+		utki::span<const float> data,
+		uint32_t num_components
+	);
+
+	/**
+	 * @brief Get index buffer with given content.
+	 * @param render_context - rendering context to create the buffer with in case it is not found in the cache.
+	 * @param indices - index data.
+	 * @return Existing index buffer with same content, or a newly created one.
+	 */
+	template <typename tp_index_type>
+	utki::shared_ref<ruis::render::index_buffer> get_index_buffer(
+		ruis::render::context& render_context, //
+		utki::span<const tp_index_type> indices
+	);
+
+	/**
+	 * @brief Get cache statistics.
+	 * Also removes expired entries from the cache.
+	 * @return Cache statistics.
+	 */
+	statistics get_statistics();
+};
+
+extern template utki::shared_ref<ruis::render::index_buffer> gpu_resource_cache::get_index_buffer(
+	ruis::render::context& render_context,
+	utki::span<const uint16_t> indices
+);
+extern template utki::shared_ref<ruis::render::index_buffer> gpu_resource_cache::get_index_buffer(
+	ruis::render::context& render_context,
+	utki::span<const uint32_t> indices
+);
+
+} // namespace ruis::render
@@ -0,0 +1,447 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "index_optimizer.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+using namespace ruis::render;
+
+namespace {
+constexpr auto invalid_index = std::numeric_limits<uint32_t>::max();
+
+void check_indices(
+	utki::span<const uint32_t> indices, //
+	size_t num_vertices
+)
+{
+	if (indices.size() % 3 != 0) {
+		throw std::invalid_argument("index optimizer: number of indices is not a multiple of 3");
+	}
+	if (std::any_of(indices.begin(), indices.end(), [&](auto i) {
+			return i >= num_vertices;
+		}))
+	{
+		throw std::invalid_argument("index optimizer: index is out of vertices range");
+	}
+}
+
+// simulated FIFO vertex cache, vertex is in the cache if it was added less than cache_size misses ago
+class fifo_cache
+{
+	std::vector<size_t> timestamps;
+	size_t time;
+	unsigned cache_size;
+
+public:
+	fifo_cache(size_t num_vertices, unsigned cache_size) :
+		timestamps(num_vertices, 0),
+		time(cache_size + 1),
+		cache_size(cache_size)
+	{}
+
+	// returns number of misses
+	unsigned add_triangle(const uint32_t* tri)
+	{
+		unsigned misses = 0;
+		for (unsigned i = 0; i != 3; ++i) {
+			auto& ts = this->timestamps[tri[i]];
+			if (this->time - ts > this->cache_size) {
+				ts = this->time++;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	// makes all the vertices to be out of cache
+	void reset()
+	{
+		this->time += this->cache_size + 1;
+	}
+};
+} // namespace
+
+size_t ruis::render::count_vertex_cache_misses(
+	utki::span<const uint32_t> indices, //
+	size_t num_vertices,
+	unsigned cache_size
+)
+{
+	check_indices(indices, num_vertices);
+
+	fifo_cache cache(num_vertices, cache_size);
+
+	size_t misses = 0;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		misses += cache.add_triangle(indices.data() + i);
+	}
+	return misses;
+}
+
+namespace {
+// parameters of Forsyth's algorithm, the scoring cache is a bit bigger than the hardware FIFO cache
+constexpr unsigned score_cache_size = 32;
+constexpr float cache_decay_power = 1.5f;
+constexpr float last_triangle_score = 0.75f;
+constexpr float valence_boost_scale = 2.0f;
+constexpr float valence_boost_power = 0.5f;
+
+float get_vertex_score(int cache_position, uint32_t num_live_triangles)
+{
+	if (num_live_triangles == 0) {
+		// no triangles left to emit for this vertex
+		return -1;
+	}
+
+	float score = 0;
+	if (cache_position >= 0) {
+		if (cache_position < 3) {
+			// vertices of the last emitted triangle get fixed score, so that the algorithm
+			// does not prefer to emit a triangle using two of them, which would result in strip-like order
+			score = last_triangle_score;
+		} else {
+			constexpr auto scaler = 1.0f / (score_cache_size - 3);
+			score = std::pow(1.0f - float(cache_position - 3) * scaler, cache_decay_power);
+		}
+	}
+
+	// boost vertices with few triangles left, so that lone triangles do not get left behind
+	score += valence_boost_scale * std::pow(float(num_live_triangles), -valence_boost_power);
+
+	return score;
+}
+} // namespace
+
+void ruis::render::optimize_vertex_cache(
+	utki::span<uint32_t> indices, //
+	size_t num_vertices
+)
+{
+	check_indices(indices, num_vertices);
+
+	size_t num_triangles = indices.size() / 3;
+	if (num_triangles == 0) {
+		return;
+	}
+
+	// vertex to triangles adjacency, live triangles of a vertex are kept at the beginning of its list
+	std::vector<uint32_t> num_live_triangles(num_vertices, 0);
+	for (auto i : indices) {
+		++num_live_triangles[i];
+	}
+
+	std::vector<uint32_t> adjacency_offsets(num_vertices + 1, 0);
+	std::partial_sum(num_live_triangles.begin(), num_live_triangles.end(), std::next(adjacency_offsets.begin()));
+
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill = adjacency_offsets;
+		for (size_t i = 0; i != indices.size(); ++i) {
+			adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+		}
+	}
+
+	std::vector<int> cache_positions(num_vertices, -1);
+	std::vector<float> vertex_scores(num_vertices);
+	for (size_t v = 0; v != num_vertices; ++v) {
+		vertex_scores[v] = get_vertex_score(-1, num_live_triangles[v]);
+	}
+
+	std::vector<float> triangle_scores(num_triangles);
+	for (size_t t = 0; t != num_triangles; ++t) {
+		const auto* tri = &indices[t * 3];
+		triangle_scores[t] = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+	}
+
+	std::vector<bool> emitted(num_triangles, false);
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	// the cache holds up to 3 extra vertices which are pushed out by the last emitted triangle
+	std::array<uint32_t, score_cache_size + 3> cache{};
+	std::array<uint32_t, score_cache_size + 3> new_cache{};
+	size_t cache_count = 0;
+
+	uint32_t best_triangle = 0;
+	size_t scan_position = 0;
+
+	for (size_t n = 0; n != num_triangles; ++n) {
+		if (best_triangle == invalid_index) {
+			// no candidates among the triangles of the cached vertices, pick next not emitted triangle
+			while (emitted[scan_position]) {
+				++scan_position;
+			}
+			best_triangle = uint32_t(scan_position);
+		}
+
+		emitted[best_triangle] = true;
+		const uint32_t* tri = &indices[size_t(best_triangle) * 3];
+		result.insert(result.end(), tri, tri + 3);
+
+		// put the triangle vertices to the front of the LRU cache
+		size_t new_cache_count = 0;
+		for (unsigned i = 0; i != 3; ++i) {
+			new_cache[new_cache_count++] = tri[i];
+		}
+		for (size_t i = 0; i != cache_count; ++i) {
+			auto v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				new_cache[new_cache_count++] = v;
+			}
+		}
+
+		// remove the emitted triangle from adjacency of its vertices
+		for (unsigned i = 0; i != 3; ++i) {
+			auto v = tri[i];
+			auto begin = std::next(adjacency.begin(), adjacency_offsets[v]);
+			auto end = std::next(begin, num_live_triangles[v]);
+			auto it = std::find(begin, end, best_triangle);
+			if (it != end) {
+				std::iter_swap(it, std::prev(end));
+				--num_live_triangles[v];
+			}
+		}
+
+		// vertices pushed out of the cache get their cache positions reset
+		for (size_t i = score_cache_size; i < new_cache_count; ++i) {
+			cache_positions[new_cache[i]] = -1;
+		}
+		cache_count = std::min(new_cache_count, size_t(score_cache_size));
+		std::copy_n(new_cache.begin(), new_cache_count, cache.begin());
+
+		// update scores of the cached vertices and of the vertices pushed out of the cache
+		for (size_t i = 0; i != new_cache_count; ++i) {
+			auto v = cache[i];
+			if (i < cache_count) {
+				cache_positions[v] = int(i);
+			}
+
+			auto new_score = get_vertex_score(cache_positions[v], num_live_triangles[v]);
+			auto score_delta = new_score - vertex_scores[v];
+			vertex_scores[v] = new_score;
+
+			auto begin = std::next(adjacency.begin(), adjacency_offsets[v]);
+			auto end = std::next(begin, num_live_triangles[v]);
+			for (auto it = begin; it != end; ++it) {
+				triangle_scores[*it] += score_delta;
+			}
+		}
+
+		// next triangle is the best one among the triangles of the cached vertices
+		best_triangle = invalid_index;
+		float best_score = -1;
+		for (size_t i = 0; i != cache_count; ++i) {
+			auto v = cache[i];
+			auto begin = std::next(adjacency.begin(), adjacency_offsets[v]);
+			auto end = std::next(begin, num_live_triangles[v]);
+			for (auto it = begin; it != end; ++it) {
+				if (triangle_scores[*it] > best_score) {
+					best_score = triangle_scores[*it];
+					best_triangle = *it;
+				}
+			}
+		}
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+namespace {
+// splits the triangles into clusters, each cluster starts where the vertex cache state effectively restarts
+std::vector<size_t> make_clusters(
+	utki::span<const uint32_t> indices, //
+	size_t num_vertices,
+	float threshold
+)
+{
+	size_t num_triangles = indices.size() / 3;
+
+	// hard boundaries, where a triangle misses the cache on all its vertices
+	std::vector<size_t> hard_boundaries;
+	{
+		fifo_cache cache(num_vertices, default_vertex_cache_size);
+		for (size_t t = 0; t != num_triangles; ++t) {
+			if (cache.add_triangle(&indices[t * 3]) == 3) {
+				hard_boundaries.push_back(t);
+			}
+		}
+	}
+	hard_boundaries.push_back(num_triangles);
+
+	// soft boundaries, where ACMR of the cluster so far is within the threshold of the whole hard cluster's ACMR,
+	// splitting there and starting with empty cache does not degrade the vertex cache efficiency too much
+	std::vector<size_t> clusters;
+
+	fifo_cache cache(num_vertices, default_vertex_cache_size);
+
+	for (size_t c = 0; c + 1 < hard_boundaries.size(); ++c) {
+		auto begin = hard_boundaries[c];
+		auto end = hard_boundaries[c + 1];
+
+		cache.reset();
+		size_t cluster_misses = 0;
+		for (size_t t = begin; t != end; ++t) {
+			cluster_misses += cache.add_triangle(&indices[t * 3]);
+		}
+		float cluster_threshold = threshold * float(cluster_misses) / float(end - begin);
+
+		clusters.push_back(begin);
+
+		cache.reset();
+		size_t misses = 0;
+		size_t size = 0;
+		for (size_t t = begin; t != end; ++t) {
+			misses += cache.add_triangle(&indices[t * 3]);
+			++size;
+
+			if (t + 1 != end && float(misses) <= float(size) * cluster_threshold) {
+				clusters.push_back(t + 1);
+				cache.reset();
+				misses = 0;
+				size = 0;
+			}
+		}
+	}
+
+	return clusters;
+}
+} // namespace
+
+void ruis::render::optimize_overdraw(
+	utki::span<uint32_t> indices, //
+	utki::span<const ruis::vec3> positions,
+	float threshold
+)
+{
+	check_indices(indices, positions.size());
+
+	size_t num_triangles = indices.size() / 3;
+	if (num_triangles == 0) {
+		return;
+	}
+
+	auto clusters = make_clusters(indices, positions.size(), threshold);
+	clusters.push_back(num_triangles);
+
+	// area weighted centroid of the mesh
+	ruis::vec3 mesh_centroid{0};
+	float mesh_area = 0;
+
+	struct cluster_info {
+		ruis::vec3 centroid{0};
+		ruis::vec3 normal{0};
+		float area = 0;
+		float sort_key = 0;
+	};
+
+	std::vector<cluster_info> infos(clusters.size() - 1);
+
+	for (size_t c = 0; c != infos.size(); ++c) {
+		auto& info = infos[c];
+		for (size_t t = clusters[c]; t != clusters[c + 1]; ++t) {
+			const auto& p0 = positions[indices[t * 3]];
+			const auto& p1 = positions[indices[t * 3 + 1]];
+			const auto& p2 = positions[indices[t * 3 + 2]];
+
+			// length of the cross product is twice the triangle area
+			auto n = (p1 - p0).cross(p2 - p0);
+			float area = n.norm();
+
+			info.centroid += (p0 + p1 + p2) * (area / 3);
+			info.normal += n;
+			info.area += area;
+		}
+
+		mesh_centroid += info.centroid;
+		mesh_area += info.area;
+
+		if (info.area > 0) {
+			info.centroid /= info.area;
+		}
+	}
+
+	if (mesh_area > 0) {
+		mesh_centroid /= mesh_area;
+	}
+
+	// clusters facing outwards of the mesh are likely to occlude the others, so they are drawn first
+	for (auto& info : infos) {
+		float normal_length = info.normal.norm();
+		if (normal_length > 0) {
+			info.normal /= normal_length;
+		}
+		info.sort_key = (info.centroid - mesh_centroid) * info.normal;
+	}
+
+	std::vector<size_t> order(infos.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) {
+		return infos[a].sort_key > infos[b].sort_key;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (auto c : order) {
+		result.insert(
+			result.end(), //
+			std::next(indices.begin(), ptrdiff_t(clusters[c] * 3)),
+			std::next(indices.begin(), ptrdiff_t(clusters[c + 1] * 3))
+		);
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin());
+}
+
+std::vector<uint32_t> ruis::render::optimize_vertex_fetch(
+	utki::span<uint32_t> indices, //
+	size_t num_vertices
+)
+{
+	check_indices(indices, num_vertices);
+
+	std::vector<uint32_t> new_indices(num_vertices, invalid_index);
+	std::vector<uint32_t> remap;
+	remap.reserve(num_vertices);
+
+	for (auto& i : indices) {
+		auto& ni = new_indices[i];
+		if (ni == invalid_index) {
+			ni = uint32_t(remap.size());
+			remap.push_back(i);
+		}
+		i = ni;
+	}
+
+	// unused vertices are kept, so that all vertex attributes still have the same number of elements
+	for (size_t v = 0; v != num_vertices; ++v) {
+		if (new_indices[v] == invalid_index) {
+			remap.push_back(uint32_t(v));
+		}
+	}
+
+	return remap;
+}
@@ -0,0 +1,92 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <ruis/config.hpp>
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Size of the FIFO post-transform vertex cache used to analyze index buffers.
+ * Typical size for the contemporary desktop and mobile GPUs.
+ */
+constexpr unsigned default_vertex_cache_size = 16;
+
+/**
+ * @brief Count post-transform vertex cache misses of a triangle list.
+ * The GPU vertex cache is simulated as a FIFO cache.
+ * @param indices - triangle list indices.
+ * @param num_vertices - number of vertices referenced by the indices.
+ * @param cache_size - size of the simulated cache.
+ * @return Number of vertex cache misses, i.e. number of vertex shader invocations.
+ */
+size_t count_vertex_cache_misses(
+	utki::span<const uint32_t> indices, //
+	size_t num_vertices,
+	unsigned cache_size = default_vertex_cache_size
+);
+
+/**
+ * @brief Reorder triangles for better post-transform vertex cache utilization.
+ * Uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" algorithm.
+ * @param indices - triangle list indices to reorder in-place.
+ * @param num_vertices - number of vertices referenced by the indices.
+ */
+void optimize_vertex_cache(
+	utki::span<uint32_t> indices, //
+	size_t num_vertices
+);
+
+/**
+ * @brief Reorder triangles to reduce overdraw.
+ * The triangles are split into clusters at points where vertex cache state restarts,
+ * then the clusters are sorted so that the ones facing outwards of the mesh go first.
+ * Makes sense to be used after optimize_vertex_cache().
+ * @param indices - triangle list indices to reorder in-place.
+ * @param positions - vertex positions.
+ * @param threshold - allowed vertex cache efficiency degradation, e.g. 1.05 allows
+ *                    the ACMR to get 5% worse in exchange of finer clusters.
+ */
+void optimize_overdraw(
+	utki::span<uint32_t> indices, //
+	utki::span<const ruis::vec3> positions,
+	float threshold = 1.05f
+);
+
+/**
+ * @brief Reorder vertices for better vertex fetch memory locality.
+ * The vertices are numbered in the order of their first use by the triangles,
+ * vertices not used by any triangle go last.
+ * @param indices - triangle list indices, remapped in-place to the new vertex order.
+ * @param num_vertices - number of vertices.
+ * @return Remap table, i-th element is the old index of the i-th vertex in the new order.
+ */
+std::vector<uint32_t> optimize_vertex_fetch(
+	utki::span<uint32_t> indices, //
+	size_t num_vertices
+);
+
+} // namespace ruis::render
@@ -0,0 +1,575 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "json_reader.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <utki/debug.hpp>
+#include <utki/string.hpp>
+
+using namespace ruis::render;
+
+namespace {
+bool is_whitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+void append_utf8(std::vector<char>& out, uint32_t code_point)
+{
+	// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+	if (code_point < 0x80) {
+		out.push_back(char(code_point));
+	} else if (code_point < 0x800) {
+		out.push_back(char(0xc0 | (code_point >> 6)));
+		out.push_back(char(0x80 | (code_point & 0x3f)));
+	} else if (code_point < 0x10000) {
+		out.push_back(char(0xe0 | (code_point >> 12)));
+		out.push_back(char(0x80 | ((code_point >> 6) & 0x3f)));
+		out.push_back(char(0x80 | (code_point & 0x3f)));
+	} else {
+		out.push_back(char(0xf0 | (code_point >> 18)));
+		out.push_back(char(0x80 | ((code_point >> 12) & 0x3f)));
+		out.push_back(char(0x80 | ((code_point >> 6) & 0x3f)));
+		out.push_back(char(0x80 | (code_point & 0x3f)));
+	}
+	// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+}
+
+[[noreturn]] void throw_error(std::string_view message, size_t pos)
+{
+	throw std::invalid_argument(utki::cat("json: ", message, " at position ", pos));
+}
+} // namespace
+
+json_document::json_document(utki::span<const uint8_t> text) :
+	text(
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		reinterpret_cast<const char*>(text.data()),
+		text.size()
+	)
+{
+	if (text.size() >= std::numeric_limits<uint32_t>::max()) {
+		throw std::invalid_argument("json: text is too big");
+	}
+
+	this->parse();
+}
+
+void json_document::parse()
+{
+	// rough estimate, to avoid reallocations for typical glTF JSON
+	constexpr auto bytes_per_token = 8;
+	this->tokens.reserve(this->text.size() / bytes_per_token);
+
+	// indices of the currently open array and object tokens
+	std::vector<uint32_t> stack;
+
+	const auto size = this->text.size();
+
+	auto skip_whitespace = [&](size_t pos) {
+		while (pos != size && is_whitespace(this->text[pos])) {
+			++pos;
+		}
+		return pos;
+	};
+
+	auto expect = [&](size_t pos, char c) {
+		if (pos == size || this->text[pos] != c) {
+			throw_error(utki::cat("expected '", c, "'"), pos);
+		}
+		return pos + 1;
+	};
+
+	// parses object member key and the colon after it
+	auto parse_key = [&](size_t pos) {
+		pos = skip_whitespace(pos);
+		if (pos == size || this->text[pos] != '"') {
+			throw_error("expected object member name", pos);
+		}
+		pos = this->parse_string(pos);
+		return expect(skip_whitespace(pos), ':');
+	};
+
+	auto close = [&]() {
+		this->tokens[stack.back()].length_or_next = uint32_t(this->tokens.size());
+		stack.pop_back();
+	};
+
+	size_t pos = 0;
+	bool need_value = true;
+
+	for (;;) {
+		pos = skip_whitespace(pos);
+
+		if (need_value) {
+			if (pos == size) {
+				throw_error("unexpected end of text", pos);
+			}
+
+			switch (this->text[pos]) {
+				case '{':
+					stack.push_back(uint32_t(this->tokens.size()));
+					this->tokens.push_back({.type = json_value::type::object, .offset = uint32_t(pos)});
+					pos = skip_whitespace(pos + 1);
+					if (pos != size && this->text[pos] == '}') {
+						close();
+						++pos;
+						need_value = false;
+					} else {
+						pos = parse_key(pos);
+					}
+					continue;
+				case '[':
+					stack.push_back(uint32_t(this->tokens.size()));
+					this->tokens.push_back({.type = json_value::type::array, .offset = uint32_t(pos)});
+					pos = skip_whitespace(pos + 1);
+					if (pos != size && this->text[pos] == ']') {
+						close();
+						++pos;
+						need_value = false;
+					}
+					continue;
+				case '"':
+					pos = this->parse_string(pos);
+					break;
+				case 't':
+				case 'f':
+				case 'n':
+					pos = this->parse_literal(pos);
+					break;
+				default:
+					pos = this->parse_number(pos);
+					break;
+			}
+			need_value = false;
+			continue;
+		}
+
+		// a value has just been parsed
+		if (stack.empty()) {
+			if (pos != size) {
+				throw_error("unexpected text after the root value", pos);
+			}
+			break;
+		}
+
+		if (pos == size) {
+			throw_error("unexpected end of text", pos);
+		}
+
+		bool is_object = this->tokens[stack.back()].type == json_value::type::object;
+		char c = this->text[pos];
+		if (c == ',') {
+			++pos;
+			if (is_object) {
+				pos = parse_key(pos);
+			}
+			need_value = true;
+		} else if ((c == '}' && is_object) || (c == ']' && !is_object)) {
+			close();
+			++pos;
+		} else {
+			throw_error(is_object ? "expected ',' or '}'" : "expected ',' or ']'", pos);
+		}
+	}
+}
+
+size_t json_document::parse_literal(size_t pos)
+{
+	using namespace std::string_view_literals;
+
+	constexpr std::array<std::pair<std::string_view, json_value::type>, 3> literals = {
+		{{"true"sv, json_value::type::boolean}, //
+		 {"false"sv, json_value::type::boolean},
+		 {"null"sv, json_value::type::null}}
+	};
+
+	for (const auto& [literal, type] : literals) {
+		if (this->text.substr(pos).starts_with(literal)) {
+			this->tokens.push_back({
+				.type = type, //
+				.offset = uint32_t(pos),
+				.length_or_next = uint32_t(literal.size())
+			});
+			return pos + literal.size();
+		}
+	}
+
+	throw_error("invalid literal", pos);
+}
+
+size_t json_document::parse_string(size_t pos)
+{
+	ASSERT(this->text[pos] == '"')
+	++pos;
+
+	size_t begin = pos;
+	bool escaped = false;
+	for (; pos < this->text.size(); ++pos) {
+		char c = this->text[pos];
+		if (c == '"') {
+			break;
+		}
+		if (c == '\\') {
+			escaped = true;
+			++pos;
+		} else if (uint8_t(c) < ' ') {
+			throw_error("control character in string", pos);
+		}
+	}
+	if (pos >= this->text.size()) {
+		throw_error("unterminated string", begin);
+	}
+
+	if (!escaped) {
+		this->tokens.push_back({
+			.type = json_value::type::string, //
+			.offset = uint32_t(begin),
+			.length_or_next = uint32_t(pos - begin)
+		});
+		return pos + 1;
+	}
+
+	auto offset = this->unescaped.size();
+
+	auto read_hex4 = [&](size_t p) {
+		constexpr auto num_hex_digits = 4;
+		constexpr auto hex_base = 16;
+		if (p + num_hex_digits > pos) {
+			throw_error("invalid unicode escape sequence", p);
+		}
+		uint32_t v = 0;
+		for (size_t i = p; i != p + num_hex_digits; ++i) {
+			char c = this->text[i];
+			int d = 0;
+			if (is_digit(c)) {
+				d = c - '0';
+			} else if (c >= 'a' && c <= 'f') {
+				d = c - 'a' + 10; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			} else if (c >= 'A' && c <= 'F') {
+				d = c - 'A' + 10; // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+			} else {
+				throw_error("invalid unicode escape sequence", p);
+			}
+			v = v * hex_base + uint32_t(d);
+		}
+		return v;
+	};
+
+	for (size_t i = begin; i != pos; ++i) {
+		char c = this->text[i];
+		if (c != '\\') {
+			this->unescaped.push_back(c);
+			continue;
+		}
+
+		++i;
+		switch (this->text[i]) {
+			case '"':
+			case '\\':
+			case '/':
+				this->unescaped.push_back(this->text[i]);
+				break;
+			case 'b':
+				this->unescaped.push_back('\b');
+				break;
+			case 'f':
+				this->unescaped.push_back('\f');
+				break;
+			case 'n':
+				this->unescaped.push_back('\n');
+				break;
+			case 'r':
+				this->unescaped.push_back('\r');
+				break;
+			case 't':
+				this->unescaped.push_back('\t');
+				break;
+			case 'u':
+				{
+					// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+					uint32_t cp = read_hex4(i + 1);
+					i += 4;
+
+					// UTF-16 surrogate pair
+					if (cp >= 0xd800 && cp < 0xdc00 && i + 6 < pos && this->text[i + 1] == '\\' &&
+						this->text[i + 2] == 'u')
+					{
+						uint32_t low = read_hex4(i + 3);
+						if (low >= 0xdc00 && low < 0xe000) {
+							cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+							i += 6;
+						}
+					}
+					// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+					append_utf8(this->unescaped, cp);
+				}
+				break;
+			default:
+				throw_error("invalid escape sequence", i);
+		}
+	}
+
+	this->tokens.push_back({
+		.type = json_value::type::string, //
+		.escaped = true,
+		.offset = uint32_t(offset),
+		.length_or_next = uint32_t(this->unescaped.size() - offset)
+	});
+
+	return pos + 1;
+}
+
+size_t json_document::parse_number(size_t pos)
+{
+	size_t begin = pos;
+	const auto size = this->text.size();
+
+	auto skip_digits = [&](size_t p) {
+		size_t start = p;
+		while (p != size && is_digit(this->text[p])) {
+			++p;
+		}
+		if (p == start) {
+			throw_error("invalid number", begin);
+		}
+		return p;
+	};
+
+	if (this->text[pos] == '-') {
+		++pos;
+	}
+	if (pos + 1 < size && this->text[pos] == '0' && is_digit(this->text[pos + 1])) {
+		throw_error("leading zeros are not allowed in numbers", begin);
+	}
+	pos = skip_digits(pos);
+	if (pos != size && this->text[pos] == '.') {
+		pos = skip_digits(pos + 1);
+	}
+	if (pos != size && (this->text[pos] == 'e' || this->text[pos] == 'E')) {
+		++pos;
+		if (pos != size && (this->text[pos] == '+' || this->text[pos] == '-')) {
+			++pos;
+		}
+		pos = skip_digits(pos);
+	}
+
+	this->tokens.push_back({
+		.type = json_value::type::number, //
+		.offset = uint32_t(begin),
+		.length_or_next = uint32_t(pos - begin)
+	});
+
+	return pos;
+}
+
+uint32_t json_document::get_next(uint32_t index) const noexcept
+{
+	const auto& t = this->tokens[index];
+	if (t.type == json_value::type::array || t.type == json_value::type::object) {
+		return t.length_or_next;
+	}
+	return index + 1;
+}
+
+json_value::type json_value::get_type() const noexcept
+{
+	if (!this->doc || this->index >= this->doc->tokens.size()) {
+		return type::undefined;
+	}
+	return this->doc->tokens[this->index].type;
+}
+
+json_value json_value::get(std::string_view key) const noexcept
+{
+	if (!this->is_object()) {
+		return {};
+	}
+
+	auto end = this->doc->tokens[this->index].length_or_next;
+
+	// members are key and value token pairs
+	for (uint32_t i = this->index + 1; i < end; i = this->doc->get_next(i + 1)) {
+		if (json_value(this->doc, i).string() == key) {
+			return {this->doc, i + 1};
+		}
+	}
+	return {};
+}
+
+bool json_value::boolean() const noexcept
+{
+	if (!this->is_boolean()) {
+		return false;
+	}
+	return this->doc->text[this->doc->tokens[this->index].offset] == 't';
+}
+
+std::string_view json_value::string() const noexcept
+{
+	if (!this->is_string()) {
+		return {};
+	}
+	const auto& t = this->doc->tokens[this->index];
+	if (t.escaped) {
+		return {this->doc->unescaped.data() + t.offset, t.length_or_next};
+	}
+	return this->doc->text.substr(t.offset, t.length_or_next);
+}
+
+double json_value::number() const noexcept
+{
+	if (!this->is_number()) {
+		return 0;
+	}
+
+	const auto& t = this->doc->tokens[this->index];
+	auto str = this->doc->text.substr(t.offset, t.length_or_next);
+
+	// the number syntax was validated during parsing,
+	// the decimal digits are accumulated into integer mantissa and the decimal point moves the exponent
+	constexpr auto max_mantissa_digits = 19;
+	constexpr uint64_t decimal_base = 10;
+
+	size_t p = 0;
+	bool negative = str[p] == '-';
+	if (negative) {
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int num_digits = 0;
+	int exponent = 0;
+
+	auto add_digit = [&](char c) {
+		if (num_digits < max_mantissa_digits) {
+			mantissa = mantissa * decimal_base + uint64_t(c - '0');
+			if (mantissa != 0) {
+				++num_digits;
+			}
+			return true;
+		}
+		return false;
+	};
+
+	for (; p != str.size() && is_digit(str[p]); ++p) {
+		if (!add_digit(str[p])) {
+			++exponent;
+		}
+	}
+	if (p != str.size() && str[p] == '.') {
+		for (++p; p != str.size() && is_digit(str[p]); ++p) {
+			if (add_digit(str[p])) {
+				--exponent;
+			}
+		}
+	}
+	if (p != str.size() && (str[p] == 'e' || str[p] == 'E')) {
+		++p;
+		bool negative_exponent = str[p] == '-';
+		if (str[p] == '-' || str[p] == '+') {
+			++p;
+		}
+		int e = 0;
+		constexpr auto max_exponent = 10000;
+		for (; p != str.size(); ++p) {
+			e = std::min(e * int(decimal_base) + (str[p] - '0'), max_exponent);
+		}
+		exponent += negative_exponent ? -e : e;
+	}
+
+	// powers of ten up to 22 are exactly representable as double
+	constexpr std::array<double, 23> powers_of_ten = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+													  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+													  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	auto value = double(mantissa);
+	if (mantissa != 0) {
+		auto abs_exponent = size_t(std::abs(exponent));
+		double scale = abs_exponent < powers_of_ten.size() ? powers_of_ten[abs_exponent]
+														   : std::pow(double(decimal_base), double(abs_exponent));
+		value = exponent < 0 ? value / scale : value * scale;
+	}
+
+	return negative ? -value : value;
+}
+
+json_array_iterator& json_array_iterator::operator++() noexcept
+{
+	this->v.index = this->v.doc->get_next(this->v.index);
+	return *this;
+}
+
+json_array_iterator json_value::begin() const noexcept
+{
+	if (!this->is_array()) {
+		return {*this};
+	}
+	return {json_value(this->doc, this->index + 1)};
+}
+
+json_array_iterator json_value::end() const noexcept
+{
+	if (!this->is_array()) {
+		return {*this};
+	}
+	return {json_value(this->doc, this->doc->tokens[this->index].length_or_next)};
+}
+
+size_t json_value::size() const noexcept
+{
+	if (this->is_array()) {
+		return size_t(std::distance(this->begin(), this->end()));
+	}
+
+	if (this->is_object()) {
+		size_t ret = 0;
+		auto end = this->doc->tokens[this->index].length_or_next;
+		for (uint32_t i = this->index + 1; i < end; i = this->doc->get_next(i + 1)) {
+			++ret;
+		}
+		return ret;
+	}
+
+	return 0;
+}
+
+json_value json_value::operator[](size_t i) const noexcept
+{
+	for (auto it = this->begin(); it != this->end(); ++it, --i) {
+		if (i == 0) {
+			return *it;
+		}
+	}
+	return {};
+}
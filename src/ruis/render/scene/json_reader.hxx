@@ -0,0 +1,277 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+class json_document;
+class json_array_iterator;
+
+/**
+ * @brief Lightweight handle of a JSON value inside of a json_document.
+ * The handle is cheap to copy, it is only valid as long as the document is alive.
+ * Accessing absent values does not throw, but results in an undefined value, so that
+ * optional members can be read without checking their presence first.
+ */
+class json_value
+{
+	friend class json_document;
+	friend class json_array_iterator;
+
+	const json_document* doc = nullptr;
+	uint32_t index = 0;
+
+	json_value(const json_document* doc, uint32_t index) :
+		doc(doc),
+		index(index)
+	{}
+
+public:
+	enum class type {
+		undefined,
+		null,
+		boolean,
+		number,
+		string,
+		array,
+		object
+	};
+
+	json_value() = default;
+
+	type get_type() const noexcept;
+
+	bool is_undefined() const noexcept
+	{
+		return this->get_type() == type::undefined;
+	}
+
+	bool is_boolean() const noexcept
+	{
+		return this->get_type() == type::boolean;
+	}
+
+	bool is_number() const noexcept
+	{
+		return this->get_type() == type::number;
+	}
+
+	bool is_string() const noexcept
+	{
+		return this->get_type() == type::string;
+	}
+
+	bool is_array() const noexcept
+	{
+		return this->get_type() == type::array;
+	}
+
+	bool is_object() const noexcept
+	{
+		return this->get_type() == type::object;
+	}
+
+	/**
+	 * @brief Get object member.
+	 * Members are looked up by linear search, which is faster than a map lookup
+	 * for the small objects glTF consists of.
+	 * @param key - member name.
+	 * @return Member value, or undefined value if this is not an object or it has no such member.
+	 */
+	json_value get(std::string_view key) const noexcept;
+
+	/**
+	 * @brief Get boolean value.
+	 * @return The boolean value, false if this is not a boolean.
+	 */
+	bool boolean() const noexcept;
+
+	/**
+	 * @brief Get string value.
+	 * @return The string value, empty if this is not a string.
+	 */
+	std::string_view string() const noexcept;
+
+	/**
+	 * @brief Get number value.
+	 * The number is parsed from the document text on each call.
+	 * @return The number value, 0 if this is not a number.
+	 */
+	double number() const noexcept;
+
+	float to_float() const noexcept
+	{
+		return float(this->number());
+	}
+
+	int32_t to_int32() const noexcept
+	{
+		return int32_t(this->number());
+	}
+
+	uint32_t to_uint32() const noexcept
+	{
+		auto n = this->number();
+		return n < 0 ? 0 : uint32_t(n);
+	}
+
+	/**
+	 * @brief Iterate array elements.
+	 * Iterating a non-array value gives no elements.
+	 */
+	json_array_iterator begin() const noexcept;
+	json_array_iterator end() const noexcept;
+
+	/**
+	 * @brief Get number of array elements or object members.
+	 * Counting requires iterating over the elements.
+	 * @return Number of elements, 0 if this is neither an array nor an object.
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Get array element.
+	 * Indexing requires iterating over the elements preceding the requested one.
+	 * @param i - element index.
+	 * @return The element, or undefined value if this is not an array or the index is out of range.
+	 */
+	json_value operator[](size_t i) const noexcept;
+};
+
+class json_array_iterator
+{
+	friend class json_value;
+
+	json_value v;
+
+	json_array_iterator(json_value v) :
+		v(v)
+	{}
+
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using difference_type = std::ptrdiff_t;
+	using value_type = json_value;
+	using pointer = const json_value*;
+	using reference = const json_value&;
+
+	json_array_iterator() = default;
+
+	reference operator*() const noexcept
+	{
+		return this->v;
+	}
+
+	pointer operator->() const noexcept
+	{
+		return &this->v;
+	}
+
+	json_array_iterator& operator++() noexcept;
+
+	json_array_iterator operator++(int) noexcept
+	{
+		auto ret = *this;
+		++(*this);
+		return ret;
+	}
+
+	bool operator==(const json_array_iterator& other) const noexcept
+	{
+		return this->v.index == other.v.index;
+	}
+};
+
+/**
+ * @brief Parsed JSON document.
+ * The JSON text is tokenized in a single pass into a flat array of tokens, no tree of
+ * heap allocated nodes is built. Strings and numbers refer to the original text and are
+ * decoded on access, only strings with escape sequences are decoded at parsing time.
+ * The JSON text must stay alive as long as the document is used.
+ */
+class json_document
+{
+	friend class json_value;
+	friend class json_array_iterator;
+
+	struct token {
+		json_value::type type;
+
+		// for strings with escape sequences the text is in the unescaped buffer
+		bool escaped = false;
+
+		uint32_t offset = 0;
+
+		// text length for scalars, index of the next sibling token for arrays and objects
+		uint32_t length_or_next = 0;
+	};
+
+	std::string_view text;
+	std::vector<token> tokens;
+	std::vector<char> unescaped;
+
+	uint32_t get_next(uint32_t index) const noexcept;
+
+	void parse();
+	size_t parse_literal(size_t pos);
+	size_t parse_string(size_t pos);
+	size_t parse_number(size_t pos);
+
+public:
+	/**
+	 * @param text - JSON text.
+	 * @throw std::invalid_argument - in case the text is not a valid JSON.
+	 */
+	explicit json_document(utki::span<const uint8_t> text);
+
+	json_document(const json_document&) = delete;
+	json_document& operator=(const json_document&) = delete;
+
+	json_document(json_document&&) = delete;
+	json_document& operator=(json_document&&) = delete;
+
+	~json_document() = default;
+
+	json_value root() const noexcept
+	{
+		return {this, 0};
+	}
+
+	/**
+	 * @brief Get size of the memory allocated by the document.
+	 * The JSON text itself is not included.
+	 * @return Size in bytes.
+	 */
+	size_t get_memory_size() const noexcept
+	{
+		return this->tokens.capacity() * sizeof(token) + this->unescaped.capacity();
+	}
+};
+
+} // namespace ruis::render
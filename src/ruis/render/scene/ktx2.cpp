@@ -0,0 +1,207 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "ktx2.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include <utki/string.hpp>
+
+using namespace ruis::render;
+
+namespace {
+constexpr std::array<uint8_t, 12> ktx2_identifier = {
+	0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a
+};
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+constexpr size_t vk_format_offset = 12;
+constexpr size_t pixel_width_offset = 20;
+constexpr size_t pixel_height_offset = 24;
+constexpr size_t pixel_depth_offset = 28;
+constexpr size_t layer_count_offset = 32;
+constexpr size_t face_count_offset = 36;
+constexpr size_t level_count_offset = 40;
+constexpr size_t supercompression_scheme_offset = 44;
+constexpr size_t level_index_offset = 80;
+constexpr size_t level_index_entry_size = 24;
+
+enum vk_format : uint32_t {
+	vk_format_r8g8b8_unorm = 23,
+	vk_format_r8g8b8_srgb = 29,
+	vk_format_r8g8b8a8_unorm = 37,
+	vk_format_r8g8b8a8_srgb = 43,
+	vk_format_etc2_r8g8b8_unorm_block = 147,
+	vk_format_etc2_r8g8b8_srgb_block = 148,
+	vk_format_etc2_r8g8b8a8_unorm_block = 151,
+	vk_format_etc2_r8g8b8a8_srgb_block = 152
+};
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+
+template <typename T>
+T read_little_endian(utki::span<const uint8_t> data, size_t offset)
+{
+	if (offset + sizeof(T) > data.size()) {
+		throw std::invalid_argument("read_ktx2(): unexpected end of data");
+	}
+	T ret = 0;
+	for (size_t i = 0; i != sizeof(T); ++i) {
+		ret |= T(data[offset + i]) << (i * 8); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+	return ret;
+}
+
+template <size_t num_channels>
+rasterimage::image_variant read_uncompressed(r4::vector2<uint32_t> dims, utki::span<const uint8_t> level)
+{
+	rasterimage::image<uint8_t, num_channels> im(dims);
+	auto size = size_t(dims.x()) * dims.y() * num_channels;
+	if (level.size() < size) {
+		throw std::invalid_argument("read_ktx2(): not enough image data");
+	}
+	std::memcpy(im.pixels().data(), level.data(), size);
+	return rasterimage::image_variant(std::move(im));
+}
+struct ktx2_header {
+	uint32_t format;
+	r4::vector2<uint32_t> dims;
+	uint32_t num_levels;
+};
+
+ktx2_header read_header(utki::span<const uint8_t> data)
+{
+	if (!is_ktx2(data)) {
+		throw std::invalid_argument("read_ktx2(): not a KTX2 file");
+	}
+
+	ktx2_header ret{
+		.format = read_little_endian<uint32_t>(data, vk_format_offset),
+		.dims =
+			{read_little_endian<uint32_t>(data, pixel_width_offset),
+			 read_little_endian<uint32_t>(data, pixel_height_offset)},
+		// zero level count means that mipmaps are to be generated by the loader
+		.num_levels = std::max(read_little_endian<uint32_t>(data, level_count_offset), uint32_t(1))
+	};
+
+	if (ret.dims.x() == 0 || ret.dims.y() == 0 || read_little_endian<uint32_t>(data, pixel_depth_offset) != 0) {
+		throw std::invalid_argument("read_ktx2(): only 2d images are supported");
+	}
+	if (read_little_endian<uint32_t>(data, layer_count_offset) > 1 ||
+		read_little_endian<uint32_t>(data, face_count_offset) != 1)
+	{
+		throw std::invalid_argument("read_ktx2(): array and cubemap images are not supported");
+	}
+
+	if (auto scheme = read_little_endian<uint32_t>(data, supercompression_scheme_offset); scheme != 0) {
+		throw std::invalid_argument(utki::cat("read_ktx2(): unsupported supercompression scheme: ", scheme));
+	}
+
+	switch (ret.format) {
+		case vk_format_r8g8b8_unorm:
+		case vk_format_r8g8b8_srgb:
+		case vk_format_r8g8b8a8_unorm:
+		case vk_format_r8g8b8a8_srgb:
+		case vk_format_etc2_r8g8b8_unorm_block:
+		case vk_format_etc2_r8g8b8_srgb_block:
+		case vk_format_etc2_r8g8b8a8_unorm_block:
+		case vk_format_etc2_r8g8b8a8_srgb_block:
+			break;
+		default:
+			// format 0 (VK_FORMAT_UNDEFINED) means Basis Universal payload, which needs transcoding
+			throw std::invalid_argument(utki::cat("read_ktx2(): unsupported vkFormat: ", ret.format));
+	}
+
+	return ret;
+}
+} // namespace
+
+bool ruis::render::is_ktx2(utki::span<const uint8_t> data) noexcept
+{
+	return data.size() >= ktx2_identifier.size() &&
+		std::equal(ktx2_identifier.begin(), ktx2_identifier.end(), data.begin());
+}
+
+bool ruis::render::is_supported_ktx2(utki::span<const uint8_t> data) noexcept
+{
+	try {
+		read_header(data);
+		return true;
+	} catch (std::invalid_argument&) {
+		return false;
+	}
+}
+
+ktx2_image ruis::render::read_ktx2(utki::span<const uint8_t> data)
+{
+	auto header = read_header(data);
+	auto dims = header.dims;
+
+	std::vector<utki::span<const uint8_t>> levels;
+	levels.reserve(header.num_levels);
+	for (uint32_t i = 0; i != header.num_levels; ++i) {
+		auto entry_offset = level_index_offset + i * level_index_entry_size;
+		auto offset = read_little_endian<uint64_t>(data, entry_offset);
+		auto length = read_little_endian<uint64_t>(data, entry_offset + sizeof(uint64_t));
+		if (offset > data.size() || length > data.size() - offset) {
+			throw std::invalid_argument("read_ktx2(): mipmap level is out of data bounds");
+		}
+		levels.push_back(data.subspan(size_t(offset), size_t(length)));
+	}
+
+	auto make_compressed = [&](compressed_image::format f) {
+		compressed_image ret{.format_v = f, .dims = dims, .levels = std::move(levels)};
+
+		// drop mipmap levels with not enough data, the base level is mandatory
+		auto level_dims = dims;
+		for (size_t i = 0; i != ret.levels.size(); ++i) {
+			if (ret.levels[i].size() < ret.get_level_size(level_dims)) {
+				if (i == 0) {
+					throw std::invalid_argument("read_ktx2(): not enough image data");
+				}
+				ret.levels.resize(i);
+				break;
+			}
+			level_dims = {std::max(level_dims.x() / 2, uint32_t(1)), std::max(level_dims.y() / 2, uint32_t(1))};
+		}
+		return ret;
+	};
+
+	switch (header.format) {
+		case vk_format_r8g8b8_unorm:
+		case vk_format_r8g8b8_srgb:
+			return read_uncompressed<3>(dims, levels.front());
+		case vk_format_r8g8b8a8_unorm:
+		case vk_format_r8g8b8a8_srgb:
+			return read_uncompressed<4>(dims, levels.front());
+		case vk_format_etc2_r8g8b8_unorm_block:
+		case vk_format_etc2_r8g8b8_srgb_block:
+			return make_compressed(compressed_image::format::etc2_rgb8);
+		case vk_format_etc2_r8g8b8a8_unorm_block:
+		case vk_format_etc2_r8g8b8a8_srgb_block:
+		default:
+			// other formats are rejected by read_header()
+			return make_compressed(compressed_image::format::etc2_rgba8);
+	}
+}
@@ -0,0 +1,62 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <variant>
+
+#include <rasterimage/image_variant.hpp>
+#include <utki/span.hpp>
+
+#include "compressed_image.hxx"
+
+namespace ruis::render {
+
+using ktx2_image = std::variant<rasterimage::image_variant, compressed_image>;
+
+/**
+ * @brief Check if data starts with KTX2 file identifier.
+ * @param data - data to check.
+ * @return true if the data looks like a KTX2 file.
+ * @return false otherwise.
+ */
+bool is_ktx2(utki::span<const uint8_t> data) noexcept;
+
+/**
+ * @brief Check if KTX2 image can be read.
+ * Only checks the KTX2 header, the image data is not validated.
+ * @param data - KTX2 file contents.
+ * @return true if the image format is supported by read_ktx2().
+ * @return false otherwise.
+ */
+bool is_supported_ktx2(utki::span<const uint8_t> data) noexcept;
+
+/**
+ * @brief Parse KTX2 image.
+ * Supported are 2d images without supercompression, in ETC2 RGB/RGBA or uncompressed 8-bit RGB/RGBA formats.
+ * Compressed image levels refer to the passed in data, so the data must outlive the returned image.
+ * @param data - KTX2 file contents.
+ * @return Uncompressed or compressed image.
+ * @throw std::invalid_argument - in case the data is malformed or the image format is not supported.
+ */
+ktx2_image read_ktx2(utki::span<const uint8_t> data);
+
+} // namespace ruis::render
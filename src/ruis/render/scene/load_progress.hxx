@@ -0,0 +1,97 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <atomic>
+#include <stdexcept>
+
+namespace ruis::render {
+
+/**
+ * @brief Exception thrown when scene loading is cancelled.
+ */
+class load_cancelled : public std::runtime_error
+{
+public:
+	load_cancelled() :
+		std::runtime_error("scene loading cancelled")
+	{}
+};
+
+/**
+ * @brief Progress of scene loading.
+ * Shared between the loading thread and its observers, all methods are thread-safe.
+ */
+class load_progress
+{
+	std::atomic<float> fraction{0};
+	std::atomic<bool> cancelled{false};
+
+public:
+	/**
+	 * @brief Request cancellation of the loading.
+	 * The loading thread will throw load_cancelled at its next progress report.
+	 */
+	void cancel() noexcept
+	{
+		this->cancelled.store(true, std::memory_order_relaxed);
+	}
+
+	bool is_cancelled() const noexcept
+	{
+		return this->cancelled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get loading progress.
+	 * @return Value from 0 to 1.
+	 */
+	float get() const noexcept
+	{
+		return this->fraction.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Report loading progress.
+	 * Called by the loading thread. Also serves as a cancellation point.
+	 * @param value - progress value from 0 to 1.
+	 * @throw load_cancelled - if cancellation was requested.
+	 */
+	void report(float value)
+	{
+		this->fraction.store(value, std::memory_order_relaxed);
+		this->check_cancelled();
+	}
+
+	/**
+	 * @brief Cancellation point.
+	 * @throw load_cancelled - if cancellation was requested.
+	 */
+	void check_cancelled() const
+	{
+		if (this->is_cancelled()) {
+			throw load_cancelled();
+		}
+	}
+};
+
+} // namespace ruis::render
@@ -0,0 +1,114 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ruis::render {
+
+/**
+ * @brief Tracker of memory used by a process running on several threads.
+ * The process reports sizes of the memory it allocates and frees, the tracker keeps the current size
+ * and its high-water mark. All methods are thread-safe.
+ */
+class memory_tracker
+{
+	std::atomic<size_t> current{0};
+	std::atomic<size_t> peak{0};
+
+public:
+	/**
+	 * @brief Memory block reported as allocated during its lifetime.
+	 */
+	class scoped_block
+	{
+		memory_tracker& tracker;
+		size_t size;
+
+	public:
+		scoped_block(
+			memory_tracker& tracker, //
+			size_t size
+		) :
+			tracker(tracker),
+			size(size)
+		{
+			this->tracker.allocated(this->size);
+		}
+
+		scoped_block(const scoped_block&) = delete;
+		scoped_block& operator=(const scoped_block&) = delete;
+
+		scoped_block(scoped_block&&) = delete;
+		scoped_block& operator=(scoped_block&&) = delete;
+
+		~scoped_block()
+		{
+			this->tracker.freed(this->size);
+		}
+	};
+
+	void reset() noexcept
+	{
+		this->current.store(0, std::memory_order_relaxed);
+		this->peak.store(0, std::memory_order_relaxed);
+	}
+
+	void allocated(size_t size) noexcept
+	{
+		auto cur = this->current.fetch_add(size, std::memory_order_relaxed) + size;
+		auto p = this->peak.load(std::memory_order_relaxed);
+		while (cur > p && !this->peak.compare_exchange_weak(p, cur, std::memory_order_relaxed)) {
+		}
+	}
+
+	void freed(size_t size) noexcept
+	{
+		this->current.fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	size_t get_current() const noexcept
+	{
+		return this->current.load(std::memory_order_relaxed);
+	}
+
+	size_t get_peak() const noexcept
+	{
+		return this->peak.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Track memory of a vector until the end of the scope.
+	 * The vector is not expected to grow during the scope.
+	 * @param vec - vector to track.
+	 * @return Block to be kept until the vector is freed.
+	 */
+	template <typename tp_type>
+	scoped_block track(const std::vector<tp_type>& vec)
+	{
+		return {*this, vec.capacity() * sizeof(tp_type)};
+	}
+};
+
+} // namespace ruis::render
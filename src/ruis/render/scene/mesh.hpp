@@ -21,10 +21,32 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <optional>
+
+#include <ruis/config.hpp>
 #include <ruis/render/texture_2d.hpp>
 #include <ruis/render/vertex_array.hpp>
 
+#include "aabb.hpp"
+
 namespace ruis::render {
+
+/**
+ * @brief Texture coordinates wrapping.
+ * The wrapping is a property of material's texture reference rather than of the texture itself,
+ * because same texture object can be shared by several materials.
+ */
+struct texture_wrapping {
+	enum class mode {
+		repeat,
+		mirrored_repeat,
+		clamp_to_edge
+	};
+
+	mode s = mode::repeat;
+	mode t = mode::repeat;
+};
+
 struct material {
 	std::string name;
 
@@ -43,17 +65,95 @@ struct material {
 	 * ARM = ambient occlusion, roughness, metalness.
 	 */
 	std::shared_ptr<ruis::render::texture_2d> tex_arm;
+
+	texture_wrapping wrapping_diffuse;
+	texture_wrapping wrapping_normal;
+	texture_wrapping wrapping_arm;
+};
+
+/**
+ * @brief Layout of interleaved vertex data.
+ * All vertex attributes are stored in a single vertex buffer, one vertex after another.
+ */
+struct vertex_layout {
+	enum class component_type {
+		float32,
+		int8,
+		uint8,
+		int16,
+		uint16
+	};
+
+	struct attribute {
+		/**
+		 * @brief Offset of the attribute from the beginning of the vertex, in bytes.
+		 */
+		uint32_t offset;
+
+		/**
+		 * @brief Number of components of the attribute, 1 to 4.
+		 */
+		uint32_t num_components;
+
+		/**
+		 * @brief Type of the attribute components.
+		 * Integer components are used for quantized vertex data, see KHR_mesh_quantization glTF extension.
+		 */
+		component_type type = component_type::float32;
+
+		/**
+		 * @brief Whether integer components are normalized.
+		 * Normalized components are mapped to [0, 1] range for unsigned and to [-1, 1] range for signed types.
+		 * Not normalized integer components are converted to float as is.
+		 */
+		bool normalized = false;
+	};
+
+	/**
+	 * @brief Size of a single vertex, in bytes.
+	 */
+	uint32_t stride = 0;
+
+	/**
+	 * @brief Vertex attributes.
+	 * Index of the attribute in the vector corresponds to the shader attribute index.
+	 */
+	std::vector<attribute> attributes;
 };
 
 struct primitive {
 	utki::shared_ref<ruis::render::vertex_array> vao;
 	utki::shared_ref<material> material_v;
+
+	/**
+	 * @brief Interleaved vertex data layout.
+	 * If set, then the vertex array has only one vertex buffer which contains all the vertex attributes
+	 * interleaved according to this layout. Otherwise, each vertex attribute has its own vertex buffer.
+	 */
+	std::optional<vertex_layout> interleaved_layout;
+
+	/**
+	 * @brief Vertex arrays of simplified levels of detail.
+	 * Ordered from the most detailed to the least detailed, the primitive's vao itself is the level 0.
+	 * The levels share vertex buffers with the vao, only the index buffers are different.
+	 */
+	std::vector<utki::shared_ref<ruis::render::vertex_array>> lods;
+
+	/**
+	 * @brief Bounding box of the primitive's vertices, in mesh coordinates.
+	 */
+	aabb bounds;
 };
 
 struct mesh {
 	std::string name;
 
 	std::vector<utki::shared_ref<primitive>> primitives;
+
+	/**
+	 * @brief Bounding box of all the primitives, in mesh coordinates.
+	 */
+	aabb bounds;
 };
 
 } // namespace ruis::render
\ No newline at end of file
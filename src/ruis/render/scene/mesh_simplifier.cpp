@@ -0,0 +1,372 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "mesh_simplifier.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+using namespace ruis::render;
+
+namespace {
+// symmetric 4x4 matrix of plane equation products, sum of squared distances to the planes
+struct quadric {
+	double a2 = 0;
+	double ab = 0;
+	double ac = 0;
+	double ad = 0;
+	double b2 = 0;
+	double bc = 0;
+	double bd = 0;
+	double c2 = 0;
+	double cd = 0;
+	double d2 = 0;
+
+	// sum of the plane weights
+	double weight = 0;
+
+	quadric() = default;
+
+	// quadric of plane a * x + b * y + c * z + d = 0, weighted
+	quadric(double a, double b, double c, double d, double w) :
+		a2(a * a * w),
+		ab(a * b * w),
+		ac(a * c * w),
+		ad(a * d * w),
+		b2(b * b * w),
+		bc(b * c * w),
+		bd(b * d * w),
+		c2(c * c * w),
+		cd(c * d * w),
+		d2(d * d * w),
+		weight(w)
+	{}
+
+	quadric& operator+=(const quadric& q)
+	{
+		this->a2 += q.a2;
+		this->ab += q.ab;
+		this->ac += q.ac;
+		this->ad += q.ad;
+		this->b2 += q.b2;
+		this->bc += q.bc;
+		this->bd += q.bd;
+		this->c2 += q.c2;
+		this->cd += q.cd;
+		this->d2 += q.d2;
+		this->weight += q.weight;
+		return *this;
+	}
+
+	// weighted mean of squared distances from the point to the planes
+	double evaluate(const ruis::vec3& p) const
+	{
+		if (this->weight == 0) {
+			return 0;
+		}
+
+		double x = p.x();
+		double y = p.y();
+		double z = p.z();
+
+		// v^T * Q * v, where v = (x, y, z, 1)
+		double ret = this->a2 * x * x + this->b2 * y * y + this->c2 * z * z + this->d2 //
+			+ 2 * (this->ab * x * y + this->ac * x * z + this->bc * y * z) //
+			+ 2 * (this->ad * x + this->bd * y + this->cd * z);
+
+		// can be slightly negative due to rounding errors
+		return std::max(ret / this->weight, 0.0);
+	}
+};
+
+struct collapse {
+	uint32_t from;
+	uint32_t to;
+	double error;
+};
+
+// triangles adjacent to each vertex, in compressed sparse row format
+struct adjacency {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+
+	adjacency(utki::span<const uint32_t> indices, size_t num_vertices) :
+		offsets(num_vertices + 1, 0),
+		triangles(indices.size())
+	{
+		for (auto i : indices) {
+			++this->offsets[i + 1];
+		}
+		for (size_t i = 1; i < this->offsets.size(); ++i) {
+			this->offsets[i] += this->offsets[i - 1];
+		}
+
+		std::vector<uint32_t> fill(this->offsets.begin(), this->offsets.end() - 1);
+		for (size_t i = 0; i != indices.size(); ++i) {
+			this->triangles[fill[indices[i]]++] = uint32_t(i / 3);
+		}
+	}
+
+	utki::span<const uint32_t> get(uint32_t vertex) const
+	{
+		return utki::make_span(this->triangles).subspan(
+			this->offsets[vertex], //
+			this->offsets[vertex + 1] - this->offsets[vertex]
+		);
+	}
+};
+
+ruis::vec3 triangle_normal(const ruis::vec3& p0, const ruis::vec3& p1, const ruis::vec3& p2)
+{
+	return (p1 - p0).cross(p2 - p0);
+}
+
+// finds vertices on the borders, i.e. on the edges which have only one adjacent triangle
+std::vector<bool> find_border_vertices(utki::span<const uint32_t> indices, size_t num_vertices)
+{
+	auto make_key = [](uint32_t a, uint32_t b) {
+		constexpr auto bits_in_uint32 = sizeof(uint32_t) * 8;
+		return (uint64_t(a) << bits_in_uint32) | b;
+	};
+
+	std::unordered_set<uint64_t> edges;
+	edges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (size_t e = 0; e != 3; ++e) {
+			edges.insert(make_key(indices[i + e], indices[i + (e + 1) % 3]));
+		}
+	}
+
+	std::vector<bool> ret(num_vertices, false);
+	for (auto key : edges) {
+		constexpr auto bits_in_uint32 = sizeof(uint32_t) * 8;
+		auto a = uint32_t(key >> bits_in_uint32);
+		auto b = uint32_t(key);
+		// edge is shared by two triangles in case the triangles have same winding
+		if (!edges.contains(make_key(b, a))) {
+			ret[a] = true;
+			ret[b] = true;
+		}
+	}
+	return ret;
+}
+
+// checks that moving the vertex to the new position does not flip or degenerate its triangles
+bool is_collapse_valid(
+	const collapse& c,
+	utki::span<const uint32_t> indices,
+	utki::span<const ruis::vec3> positions,
+	const adjacency& adj
+)
+{
+	for (auto t : adj.get(c.from)) {
+		const auto* tri = &indices[size_t(t) * 3];
+		if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+			// the triangle is removed by the collapse
+			continue;
+		}
+
+		std::array<ruis::vec3, 3> p{};
+		for (size_t i = 0; i != 3; ++i) {
+			p[i] = positions[tri[i]];
+		}
+		auto before = triangle_normal(p[0], p[1], p[2]);
+
+		for (size_t i = 0; i != 3; ++i) {
+			if (tri[i] == c.from) {
+				p[i] = positions[c.to];
+			}
+		}
+		auto after = triangle_normal(p[0], p[1], p[2]);
+
+		if (before.dot(after) <= 0) {
+			return false;
+		}
+	}
+	return true;
+}
+} // namespace
+
+std::vector<uint32_t> ruis::render::simplify_mesh(
+	utki::span<const uint32_t> indices,
+	utki::span<const ruis::vec3> positions,
+	size_t target_index_count,
+	float target_error,
+	float* result_error
+)
+{
+	if (indices.size() % 3 != 0) {
+		throw std::invalid_argument("simplify_mesh(): number of indices is not a multiple of 3");
+	}
+	if (std::any_of(indices.begin(), indices.end(), [&](auto i) {
+			return i >= positions.size();
+		}))
+	{
+		throw std::invalid_argument("simplify_mesh(): index is out of vertices range");
+	}
+
+	std::vector<uint32_t> ret(indices.begin(), indices.end());
+
+	if (result_error) {
+		*result_error = 0;
+	}
+
+	if (ret.empty()) {
+		return ret;
+	}
+
+	// errors are measured relative to the mesh extent
+	ruis::vec3 min = positions[ret.front()];
+	ruis::vec3 max = min;
+	for (auto i : ret) {
+		min = r4::min(min, positions[i]);
+		max = r4::max(max, positions[i]);
+	}
+	auto extent = double(std::max({max.x() - min.x(), max.y() - min.y(), max.z() - min.z()}));
+	if (extent == 0) {
+		return ret;
+	}
+	double max_error = double(target_error) * extent;
+	double max_error_pow2 = max_error * max_error;
+
+	std::vector<quadric> quadrics(positions.size());
+	for (size_t i = 0; i < ret.size(); i += 3) {
+		const auto& p0 = positions[ret[i]];
+		auto n = triangle_normal(p0, positions[ret[i + 1]], positions[ret[i + 2]]);
+		auto length = double(n.norm());
+		if (length == 0) {
+			continue;
+		}
+
+		// weight by triangle area, so that small triangles affect the error less
+		double a = n.x() / length;
+		double b = n.y() / length;
+		double c = n.z() / length;
+		double d = -(a * p0.x() + b * p0.y() + c * p0.z());
+		quadric q(a, b, c, d, length / 2);
+
+		for (size_t v = 0; v != 3; ++v) {
+			quadrics[ret[i + v]] += q;
+		}
+	}
+
+	auto locked = find_border_vertices(ret, positions.size());
+
+	double error_pow2 = 0;
+
+	std::vector<collapse> collapses;
+	std::vector<uint32_t> remap(positions.size());
+	std::vector<bool> touched(positions.size());
+
+	// Each pass collapses cheapest edges, vertex neighbourhoods affected by a collapse
+	// are not touched again during the same pass, so that the collapse validity checks hold.
+	while (ret.size() > target_index_count) {
+		adjacency adj(ret, positions.size());
+
+		collapses.clear();
+		for (size_t i = 0; i < ret.size(); i += 3) {
+			for (size_t e = 0; e != 3; ++e) {
+				auto a = ret[i + e];
+				auto b = ret[i + (e + 1) % 3];
+
+				for (auto [from, to] : {std::make_pair(a, b), std::make_pair(b, a)}) {
+					if (locked[from]) {
+						continue;
+					}
+					quadric q = quadrics[from];
+					q += quadrics[to];
+					collapses.push_back({.from = from, .to = to, .error = q.evaluate(positions[to])});
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const auto& l, const auto& r) {
+			return l.error < r.error;
+		});
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+
+		// each collapse removes about 2 triangles
+		size_t num_triangles_to_remove = (ret.size() - target_index_count) / 3;
+		size_t num_triangles_removed = 0;
+		size_t num_collapses = 0;
+
+		for (const auto& c : collapses) {
+			if (c.error > max_error_pow2 || num_triangles_removed >= num_triangles_to_remove) {
+				break;
+			}
+
+			if (touched[c.from] || touched[c.to]) {
+				continue;
+			}
+
+			if (!is_collapse_valid(c, ret, positions, adj)) {
+				continue;
+			}
+
+			for (auto t : adj.get(c.from)) {
+				const auto* tri = &ret[size_t(t) * 3];
+				for (size_t v = 0; v != 3; ++v) {
+					touched[tri[v]] = true;
+					if (tri[v] == c.to) {
+						++num_triangles_removed;
+					}
+				}
+			}
+
+			remap[c.from] = c.to;
+			quadrics[c.to] += quadrics[c.from];
+			error_pow2 = std::max(error_pow2, c.error);
+			++num_collapses;
+		}
+
+		if (num_collapses == 0) {
+			break;
+		}
+
+		// apply the collapses and remove degenerate triangles
+		size_t num_indices = 0;
+		for (size_t i = 0; i < ret.size(); i += 3) {
+			auto a = remap[ret[i]];
+			auto b = remap[ret[i + 1]];
+			auto c = remap[ret[i + 2]];
+			if (a == b || b == c || c == a) {
+				continue;
+			}
+			ret[num_indices++] = a;
+			ret[num_indices++] = b;
+			ret[num_indices++] = c;
+		}
+		ret.resize(num_indices);
+	}
+
+	if (result_error) {
+		*result_error = float(std::sqrt(error_pow2) / extent);
+	}
+
+	return ret;
+}
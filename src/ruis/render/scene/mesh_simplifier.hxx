@@ -0,0 +1,56 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <ruis/config.hpp>
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Simplify triangle mesh.
+ * Edges are collapsed in the order of increasing quadric error metric, see Garland and Heckbert's
+ * "Surface Simplification Using Quadric Error Metrics". An edge is collapsed into one of its vertices,
+ * vertices are never moved, so the simplified indices refer to the same vertex data as the original ones.
+ * Vertices on mesh borders, including attribute seams where vertices are split, are never collapsed,
+ * so the mesh outline and texture coordinates are preserved. Collapses which flip triangles are rejected.
+ * @param indices - triangle list indices.
+ * @param positions - vertex positions.
+ * @param target_index_count - number of indices to reduce the mesh to. The result can have more indices
+ *                             in case the target error is reached or there are no more edges to collapse.
+ * @param target_error - maximum error, relative to the mesh extent, i.e. 0.01 is 1% of the mesh bounding box
+ *                       largest dimension.
+ * @param result_error - optional output of the resulting error, relative to the mesh extent.
+ * @return Simplified triangle list indices.
+ */
+std::vector<uint32_t> simplify_mesh(
+	utki::span<const uint32_t> indices,
+	utki::span<const ruis::vec3> positions,
+	size_t target_index_count,
+	float target_error,
+	float* result_error = nullptr
+);
+
+} // namespace ruis::render
@@ -0,0 +1,606 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "meshopt_decoder.hxx"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <utki/string.hpp>
+
+using namespace ruis::render;
+
+// The bitstream formats are described in the EXT_meshopt_compression extension specification,
+// see https://github.com/KhronosGroup/glTF/tree/main/extensions/2.0/Vendor/EXT_meshopt_compression
+
+namespace {
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+
+uint16_t load_le16(const uint8_t* p)
+{
+	return uint16_t(p[0] | (p[1] << 8));
+}
+
+void store_le16(uint8_t* p, uint16_t v)
+{
+	p[0] = uint8_t(v);
+	p[1] = uint8_t(v >> 8);
+}
+
+uint32_t load_le32(const uint8_t* p)
+{
+	return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+void store_le32(uint8_t* p, uint32_t v)
+{
+	for (unsigned i = 0; i != sizeof(v); ++i) {
+		p[i] = uint8_t(v >> (i * 8));
+	}
+}
+
+// bounds checked reading of the compressed data
+class reader
+{
+	utki::span<const uint8_t> data;
+	size_t pos = 0;
+
+public:
+	reader(utki::span<const uint8_t> data, size_t pos = 0) :
+		data(data),
+		pos(pos)
+	{}
+
+	size_t get_pos() const noexcept
+	{
+		return this->pos;
+	}
+
+	size_t bytes_left() const noexcept
+	{
+		return this->data.size() - this->pos;
+	}
+
+	uint8_t read_byte()
+	{
+		if (this->pos == this->data.size()) {
+			throw std::invalid_argument("decode_meshopt(): unexpected end of data");
+		}
+		return this->data[this->pos++];
+	}
+
+	const uint8_t* read_bytes(size_t size)
+	{
+		if (this->bytes_left() < size) {
+			throw std::invalid_argument("decode_meshopt(): unexpected end of data");
+		}
+		const auto* ret = this->data.data() + this->pos;
+		this->pos += size;
+		return ret;
+	}
+
+	uint32_t read_vbyte()
+	{
+		uint8_t lead = this->read_byte();
+		if (lead < 0x80) {
+			return lead;
+		}
+
+		uint32_t result = lead & 0x7f;
+		unsigned shift = 7;
+		for (unsigned i = 0; i != 4; ++i) {
+			uint8_t group = this->read_byte();
+			result |= uint32_t(group & 0x7f) << shift;
+			shift += 7;
+			if (group < 0x80) {
+				break;
+			}
+		}
+		return result;
+	}
+};
+
+uint32_t unzigzag(uint32_t v)
+{
+	return (v >> 1) ^ (0 - (v & 1));
+}
+
+uint8_t unzigzag8(uint8_t v)
+{
+	return uint8_t((0 - (v & 1)) ^ (v >> 1));
+}
+
+//
+// vertex codec
+//
+
+constexpr uint8_t vertex_header = 0xa0;
+constexpr size_t byte_group_size = 16;
+constexpr size_t vertex_block_size_bytes = 8192;
+constexpr size_t vertex_block_max_size = 256;
+constexpr size_t tail_max_size = 32;
+
+// encoder guarantees this many bytes of data after each byte group start, thanks to the tail
+constexpr size_t byte_group_decode_limit = 24;
+
+size_t get_vertex_block_size(size_t vertex_size)
+{
+	size_t ret = vertex_block_size_bytes / vertex_size;
+	ret &= ~(byte_group_size - 1);
+	return std::min(ret, vertex_block_max_size);
+}
+
+void decode_bytes_group(reader& r, uint8_t* dst, unsigned bits_log2)
+{
+	switch (bits_log2) {
+		case 0:
+			std::memset(dst, 0, byte_group_size);
+			return;
+		case 3:
+			std::memcpy(dst, r.read_bytes(byte_group_size), byte_group_size);
+			return;
+		default:
+			break;
+	}
+
+	// 2 or 4 bit values, most significant bits first,
+	// value with all bits set means the actual byte is stored after the packed values
+	unsigned bits = 1 << bits_log2;
+	unsigned escape = (1 << bits) - 1;
+	const uint8_t* packed = r.read_bytes(byte_group_size * bits / 8);
+
+	for (size_t i = 0; i != byte_group_size; ++i) {
+		unsigned shift = 8 - bits - (i * bits) % 8;
+		unsigned value = (packed[i * bits / 8] >> shift) & escape;
+		dst[i] = value == escape ? r.read_byte() : uint8_t(value);
+	}
+}
+
+void decode_bytes(reader& r, utki::span<uint8_t> buffer)
+{
+	// 2 bits of header per byte group
+	size_t num_groups = buffer.size() / byte_group_size;
+	const uint8_t* header = r.read_bytes((num_groups + 3) / 4);
+
+	for (size_t g = 0; g != num_groups; ++g) {
+		if (r.bytes_left() < byte_group_decode_limit) {
+			throw std::invalid_argument("decode_meshopt(): unexpected end of vertex data");
+		}
+		unsigned bits_log2 = (header[g / 4] >> ((g % 4) * 2)) & 3;
+		decode_bytes_group(r, buffer.data() + g * byte_group_size, bits_log2);
+	}
+}
+
+void decode_vertex_buffer(
+	utki::span<const uint8_t> data, //
+	utki::span<uint8_t> dst,
+	size_t count,
+	size_t vertex_size
+)
+{
+	if (vertex_size == 0 || vertex_size > vertex_block_max_size || vertex_size % 4 != 0) {
+		throw std::invalid_argument(utki::cat("decode_meshopt(): invalid vertex size: ", vertex_size));
+	}
+
+	if (data.size() < 1 + vertex_size) {
+		throw std::invalid_argument("decode_meshopt(): vertex data is too short");
+	}
+
+	if ((data[0] & 0xf0) != vertex_header || (data[0] & 0x0f) != 0) {
+		throw std::invalid_argument("decode_meshopt(): unsupported vertex codec header");
+	}
+
+	// the tail holds the first vertex, which is the base for delta decoding
+	std::array<uint8_t, vertex_block_max_size> last_vertex{};
+	std::memcpy(last_vertex.data(), data.data() + data.size() - vertex_size, vertex_size);
+
+	reader r(data, 1);
+
+	auto block_size = get_vertex_block_size(vertex_size);
+
+	std::array<uint8_t, vertex_block_max_size> buffer{};
+
+	for (size_t offset = 0; offset < count; offset += block_size) {
+		auto num_vertices = std::min(block_size, count - offset);
+		auto num_vertices_aligned = (num_vertices + byte_group_size - 1) & ~(byte_group_size - 1);
+
+		uint8_t* block = dst.data() + offset * vertex_size;
+
+		// each byte of the vertex is encoded separately as deltas from the same byte of the previous vertex
+		for (size_t k = 0; k != vertex_size; ++k) {
+			decode_bytes(r, utki::make_span(buffer.data(), num_vertices_aligned));
+
+			uint8_t p = last_vertex[k];
+			for (size_t i = 0; i != num_vertices; ++i) {
+				p = uint8_t(unzigzag8(buffer[i]) + p);
+				block[i * vertex_size + k] = p;
+			}
+			last_vertex[k] = p;
+		}
+	}
+
+	if (r.bytes_left() != std::max(vertex_size, tail_max_size)) {
+		throw std::invalid_argument("decode_meshopt(): unexpected vertex data size");
+	}
+}
+
+//
+// index codec
+//
+
+constexpr uint8_t index_header = 0xe0;
+constexpr uint8_t sequence_header = 0xd0;
+constexpr size_t fifo_size = 16;
+constexpr size_t codeaux_table_size = 16;
+
+void store_index(uint8_t* dst, size_t i, size_t index_size, uint32_t index)
+{
+	if (index_size == sizeof(uint16_t)) {
+		store_le16(dst + i * sizeof(uint16_t), uint16_t(index));
+	} else {
+		store_le32(dst + i * sizeof(uint32_t), index);
+	}
+}
+
+void decode_index_buffer(
+	utki::span<const uint8_t> data, //
+	utki::span<uint8_t> dst,
+	size_t count,
+	size_t index_size
+)
+{
+	if (count % 3 != 0) {
+		throw std::invalid_argument("decode_meshopt(): triangle index count is not a multiple of 3");
+	}
+
+	// header, 1 byte per triangle and codeaux table
+	if (data.size() < 1 + count / 3 + codeaux_table_size) {
+		throw std::invalid_argument("decode_meshopt(): index data is too short");
+	}
+
+	if ((data[0] & 0xf0) != index_header || (data[0] & 0x0f) > 1) {
+		throw std::invalid_argument("decode_meshopt(): unsupported index codec header");
+	}
+	unsigned version = data[0] & 0x0f;
+
+	std::array<std::array<uint32_t, 2>, fifo_size> edge_fifo{};
+	std::array<uint32_t, fifo_size> vertex_fifo{};
+	edge_fifo.fill({~uint32_t(0), ~uint32_t(0)});
+	vertex_fifo.fill(~uint32_t(0));
+	size_t edge_fifo_offset = 0;
+	size_t vertex_fifo_offset = 0;
+
+	auto push_edge = [&](uint32_t a, uint32_t b) {
+		edge_fifo[edge_fifo_offset] = {a, b};
+		edge_fifo_offset = (edge_fifo_offset + 1) % fifo_size;
+	};
+	auto push_vertex = [&](uint32_t v, bool cond = true) {
+		vertex_fifo[vertex_fifo_offset] = v;
+		vertex_fifo_offset = (vertex_fifo_offset + (cond ? 1 : 0)) % fifo_size;
+	};
+	auto get_vertex = [&](size_t back_offset) {
+		return vertex_fifo[(vertex_fifo_offset - back_offset) % fifo_size];
+	};
+
+	uint32_t next = 0;
+	uint32_t last = 0;
+
+	unsigned fec_max = version >= 1 ? 13 : 15;
+
+	const uint8_t* codes = data.data() + 1;
+
+	// triangle data is followed by codeaux table
+	auto data_end = data.size() - codeaux_table_size;
+	const uint8_t* codeaux_table = data.data() + data_end;
+	reader r(data.subspan(0, data_end), 1 + count / 3);
+
+	auto decode_index = [&]() {
+		last += unzigzag(r.read_vbyte());
+		return last;
+	};
+
+	uint8_t* out = dst.data();
+
+	for (size_t i = 0; i != count; i += 3) {
+		uint8_t code = codes[i / 3];
+
+		uint32_t a = 0;
+		uint32_t b = 0;
+		uint32_t c = 0;
+
+		if (code < 0xf0) {
+			// edge from the edge fifo plus one vertex
+			unsigned fe = code >> 4;
+			const auto& edge = edge_fifo[(edge_fifo_offset - 1 - fe) % fifo_size];
+			a = edge[0];
+			b = edge[1];
+
+			unsigned fec = code & 0x0f;
+			if (fec < fec_max) {
+				// new vertex or vertex from the vertex fifo
+				c = fec == 0 ? next++ : get_vertex(1 + fec);
+				push_vertex(c, fec == 0);
+			} else {
+				// 13 and 14 are -1 and +1 deltas from the last free index in version 1
+				c = fec != 15 ? (last += (fec == 13 ? uint32_t(-1) : 1)) : decode_index();
+				push_vertex(c);
+			}
+
+			push_edge(c, b);
+			push_edge(a, c);
+		} else {
+			unsigned fea = 0;
+			unsigned feb = 0;
+			unsigned fec = 0;
+
+			if (code < 0xfe) {
+				// frequent combinations of vertex fifo indices are stored in the table
+				uint8_t codeaux = codeaux_table[code & 0x0f];
+				feb = codeaux >> 4;
+				fec = codeaux & 0x0f;
+			} else {
+				uint8_t codeaux = r.read_byte();
+				fea = code == 0xfe ? 0 : 15;
+				feb = codeaux >> 4;
+				fec = codeaux & 0x0f;
+
+				// restart of the vertex numbering
+				if (codeaux == 0) {
+					next = 0;
+				}
+			}
+
+			// next is incremented for all three vertices before reading free indices, same as the encoder does
+			a = fea == 0 ? next++ : 0;
+			b = feb == 0 ? next++ : get_vertex(feb);
+			c = fec == 0 ? next++ : get_vertex(fec);
+
+			if (fea == 15) {
+				a = decode_index();
+			}
+			if (feb == 15) {
+				b = decode_index();
+			}
+			if (fec == 15) {
+				c = decode_index();
+			}
+
+			push_vertex(a);
+			push_vertex(b, feb == 0 || feb == 15);
+			push_vertex(c, fec == 0 || fec == 15);
+
+			push_edge(b, a);
+			push_edge(c, b);
+			push_edge(a, c);
+		}
+
+		store_index(out, i, index_size, a);
+		store_index(out, i + 1, index_size, b);
+		store_index(out, i + 2, index_size, c);
+	}
+
+	if (r.get_pos() != data_end) {
+		throw std::invalid_argument("decode_meshopt(): unexpected index data size");
+	}
+}
+
+void decode_index_sequence(
+	utki::span<const uint8_t> data, //
+	utki::span<uint8_t> dst,
+	size_t count,
+	size_t index_size
+)
+{
+	constexpr size_t tail_size = 4;
+
+	// header, at least 1 byte per index and the tail
+	if (data.size() < 1 + count + tail_size) {
+		throw std::invalid_argument("decode_meshopt(): index sequence data is too short");
+	}
+
+	if ((data[0] & 0xf0) != sequence_header || (data[0] & 0x0f) > 1) {
+		throw std::invalid_argument("decode_meshopt(): unsupported index sequence codec header");
+	}
+
+	auto data_end = data.size() - tail_size;
+	reader r(data.subspan(0, data_end), 1);
+
+	// two baselines, lowest bit of each value selects the baseline
+	std::array<uint32_t, 2> last = {0, 0};
+
+	for (size_t i = 0; i != count; ++i) {
+		uint32_t v = r.read_vbyte();
+		auto& baseline = last[v & 1];
+		baseline += unzigzag(v >> 1);
+		store_index(dst.data(), i, index_size, baseline);
+	}
+
+	if (r.get_pos() != data_end) {
+		throw std::invalid_argument("decode_meshopt(): unexpected index sequence data size");
+	}
+}
+
+//
+// filters
+//
+
+int round_to_int(float v)
+{
+	return int(v + (v >= 0 ? 0.5f : -0.5f));
+}
+
+template <typename tp_component_type>
+void apply_octahedral_filter(utki::span<uint8_t> data)
+{
+	constexpr auto component_size = sizeof(tp_component_type);
+	constexpr auto max = float((1 << (component_size * 8 - 1)) - 1);
+
+	auto load = [](const uint8_t* p) -> float {
+		if constexpr (component_size == 1) {
+			return float(int8_t(*p));
+		} else {
+			return float(int16_t(load_le16(p)));
+		}
+	};
+	auto store = [](uint8_t* p, int v) {
+		if constexpr (component_size == 1) {
+			*p = uint8_t(int8_t(v));
+		} else {
+			store_le16(p, uint16_t(int16_t(v)));
+		}
+	};
+
+	for (size_t i = 0; i + 4 * component_size <= data.size(); i += 4 * component_size) {
+		uint8_t* p = data.data() + i;
+
+		// z is reconstructed assuming it encodes 1 with same number of bits as x and y
+		float x = load(p);
+		float y = load(p + component_size);
+		float z = load(p + 2 * component_size) - std::abs(x) - std::abs(y);
+
+		// fix up octahedral coordinates for z < 0
+		float t = z >= 0 ? 0 : z;
+		x += x >= 0 ? t : -t;
+		y += y >= 0 ? t : -t;
+
+		float s = max / std::sqrt(x * x + y * y + z * z);
+
+		// 4th component is left as is
+		store(p, round_to_int(x * s));
+		store(p + component_size, round_to_int(y * s));
+		store(p + 2 * component_size, round_to_int(z * s));
+	}
+}
+
+void apply_quaternion_filter(utki::span<uint8_t> data)
+{
+	constexpr auto element_size = 4 * sizeof(int16_t);
+	constexpr float max = 32767;
+	const float scale = 1 / std::sqrt(2.0f);
+
+	for (size_t i = 0; i + element_size <= data.size(); i += element_size) {
+		uint8_t* p = data.data() + i;
+
+		std::array<int16_t, 4> q{};
+		for (size_t c = 0; c != q.size(); ++c) {
+			q[c] = int16_t(load_le16(p + c * sizeof(int16_t)));
+		}
+
+		// scale is stored in the high bits of the 4th component
+		float ss = scale / float(q[3] | 3);
+
+		float x = float(q[0]) * ss;
+		float y = float(q[1]) * ss;
+		float z = float(q[2]) * ss;
+
+		// the largest component is omitted, it is reconstructed from the unit length
+		float ww = 1 - x * x - y * y - z * z;
+		float w = std::sqrt(ww >= 0 ? ww : 0);
+
+		// lowest 2 bits of the 4th component give the index of the omitted component
+		unsigned qc = q[3] & 3;
+		store_le16(p + ((qc + 1) & 3) * sizeof(int16_t), uint16_t(int16_t(round_to_int(x * max))));
+		store_le16(p + ((qc + 2) & 3) * sizeof(int16_t), uint16_t(int16_t(round_to_int(y * max))));
+		store_le16(p + ((qc + 3) & 3) * sizeof(int16_t), uint16_t(int16_t(round_to_int(z * max))));
+		store_le16(p + qc * sizeof(int16_t), uint16_t(int16_t(round_to_int(w * max))));
+	}
+}
+
+void apply_exponential_filter(utki::span<uint8_t> data)
+{
+	for (size_t i = 0; i + sizeof(uint32_t) <= data.size(); i += sizeof(uint32_t)) {
+		uint8_t* p = data.data() + i;
+		uint32_t v = load_le32(p);
+
+		// 24-bit signed mantissa and 8-bit signed exponent
+		auto m = int32_t(v << 8) >> 8;
+		auto e = int32_t(v) >> 24;
+
+		float f = std::ldexp(float(m), e);
+		store_le32(p, std::bit_cast<uint32_t>(f));
+	}
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+} // namespace
+
+std::vector<uint8_t> ruis::render::decode_meshopt(
+	utki::span<const uint8_t> data, //
+	const meshopt_compression& params
+)
+{
+	std::vector<uint8_t> ret(size_t(params.count) * params.byte_stride);
+
+	switch (params.mode_v) {
+		case meshopt_compression::mode::attributes:
+			decode_vertex_buffer(data, ret, params.count, params.byte_stride);
+			break;
+		case meshopt_compression::mode::triangles:
+		case meshopt_compression::mode::indices:
+			if (params.byte_stride != sizeof(uint16_t) && params.byte_stride != sizeof(uint32_t)) {
+				throw std::invalid_argument(
+					utki::cat("decode_meshopt(): invalid index size: ", params.byte_stride)
+				);
+			}
+			if (params.filter_v != meshopt_compression::filter::none) {
+				throw std::invalid_argument("decode_meshopt(): filters are only allowed for attributes");
+			}
+			if (params.mode_v == meshopt_compression::mode::triangles) {
+				decode_index_buffer(data, ret, params.count, params.byte_stride);
+			} else {
+				decode_index_sequence(data, ret, params.count, params.byte_stride);
+			}
+			break;
+	}
+
+	switch (params.filter_v) {
+		case meshopt_compression::filter::none:
+			break;
+		case meshopt_compression::filter::octahedral:
+			if (params.byte_stride == 4) {
+				apply_octahedral_filter<int8_t>(ret);
+			} else if (params.byte_stride == 8) {
+				apply_octahedral_filter<int16_t>(ret);
+			} else {
+				throw std::invalid_argument("decode_meshopt(): octahedral filter requires byte stride of 4 or 8");
+			}
+			break;
+		case meshopt_compression::filter::quaternion:
+			if (params.byte_stride != 8) {
+				throw std::invalid_argument("decode_meshopt(): quaternion filter requires byte stride of 8");
+			}
+			apply_quaternion_filter(ret);
+			break;
+		case meshopt_compression::filter::exponential:
+			if (params.byte_stride % 4 != 0) {
+				throw std::invalid_argument(
+					"decode_meshopt(): exponential filter requires byte stride to be a multiple of 4"
+				);
+			}
+			apply_exponential_filter(ret);
+			break;
+	}
+
+	return ret;
+}
@@ -0,0 +1,98 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Parameters of a buffer view compressed with EXT_meshopt_compression glTF extension.
+ */
+struct meshopt_compression {
+	enum class mode {
+		/**
+		 * @brief Vertex attribute data, vertex codec.
+		 */
+		attributes,
+
+		/**
+		 * @brief Triangle list indices, index codec.
+		 */
+		triangles,
+
+		/**
+		 * @brief Arbitrary index sequence, index sequence codec.
+		 */
+		indices
+	};
+
+	enum class filter {
+		none,
+
+		/**
+		 * @brief Octahedral encoding of unit vectors, for normals and tangents.
+		 */
+		octahedral,
+
+		/**
+		 * @brief Unit quaternions encoded as three components.
+		 */
+		quaternion,
+
+		/**
+		 * @brief Floats encoded as 24-bit mantissa and 8-bit exponent.
+		 */
+		exponential
+	};
+
+	mode mode_v = mode::attributes;
+	filter filter_v = filter::none;
+
+	/**
+	 * @brief Number of elements, i.e. vertices or indices.
+	 */
+	uint32_t count = 0;
+
+	/**
+	 * @brief Size of a single element in bytes.
+	 */
+	uint32_t byte_stride = 0;
+};
+
+/**
+ * @brief Decode meshopt compressed buffer view data.
+ * The data is decoded into little-endian byte order, as any other glTF buffer data.
+ * @param data - compressed data.
+ * @param params - compression parameters.
+ * @return Decoded data of count * byte_stride bytes.
+ * @throw std::invalid_argument - in case the compressed data is malformed or the parameters are invalid.
+ */
+std::vector<uint8_t> decode_meshopt(
+	utki::span<const uint8_t> data, //
+	const meshopt_compression& params
+);
+
+} // namespace ruis::render
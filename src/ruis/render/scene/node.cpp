@@ -21,22 +21,116 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "node.hpp"
 
+#include "transform_hierarchy.hpp"
+
 using namespace ruis::render;
 
+ruis::mat4 trs_transformation::to_matrix() const
+{
+	auto m = ruis::mat4().set_identity();
+	m.translate(this->translation);
+	m.rotate(this->rotation);
+	m.scale(this->scale);
+
+	return m;
+}
+
+node::node(
+	std::string name, //
+	std::shared_ptr<mesh> mesh_v,
+	transformation_variant transformation
+) :
+	transformation(std::move(transformation)),
+	name(std::move(name)),
+	mesh_v(std::move(mesh_v))
+{}
+
+void node::attach(
+	std::shared_ptr<transform_hierarchy> h, //
+	uint32_t index
+)
+{
+	ASSERT(h)
+	ASSERT(index < h->size())
+	this->hierarchy = std::move(h);
+	this->hierarchy_index = index;
+}
+
+transformation_variant node::get_transformation() const
+{
+	if (this->hierarchy) {
+		return this->hierarchy->get_transformation(this->hierarchy_index);
+	}
+	return this->transformation;
+}
+
 ruis::mat4 node::get_transformation_matrix() const
 {
+	if (this->hierarchy) {
+		return this->hierarchy->get_local_matrix(this->hierarchy_index);
+	}
+
 	if (std::holds_alternative<ruis::mat4>(this->transformation)) {
 		return std::get<ruis::mat4>(this->transformation);
 	} else {
 		ASSERT(std::holds_alternative<trs_transformation>(this->transformation))
 
-		const auto& trs = std::get<trs_transformation>(this->transformation);
+		return std::get<trs_transformation>(this->transformation).to_matrix();
+	}
+}
+
+ruis::mat4 node::get_world_matrix() const
+{
+	if (this->hierarchy) {
+		return this->hierarchy->get_world_matrix(this->hierarchy_index);
+	}
+	return this->get_transformation_matrix();
+}
+
+void node::set_transformation(transformation_variant t)
+{
+	if (this->hierarchy) {
+		this->hierarchy->set_transformation(this->hierarchy_index, t);
+	} else {
+		this->transformation = std::move(t);
+	}
+	this->bounds_dirty = true;
+}
 
-		auto m = ruis::mat4().set_identity();
-		m.translate(trs.translation);
-		m.rotate(trs.rotation);
-		m.scale(trs.scale);
+bool node::update_bounds()
+{
+	bool changed = this->bounds_dirty;
+	for (auto& c : this->children) {
+		// all children are updated, even if some of them have already reported a change
+		changed = c.get().update_bounds() || changed;
+	}
 
-		return m;
+	if (!changed) {
+		return false;
 	}
+
+	this->recalculate_bounds();
+
+	return true;
+}
+
+void node::recalculate_bounds()
+{
+	this->bounds = {};
+
+	if (this->mesh_v) {
+		if (this->instances.empty()) {
+			this->bounds = this->mesh_v->bounds;
+		} else {
+			for (const auto& m : this->instances) {
+				this->bounds.extend(this->mesh_v->bounds.transform(m));
+			}
+		}
+	}
+
+	for (const auto& c : this->children) {
+		this->bounds.extend(c.get().bounds.transform(c.get().get_transformation_matrix()));
+	}
+
+	this->bounds_dirty = false;
 }
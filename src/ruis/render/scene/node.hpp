@@ -35,6 +35,8 @@ struct trs_transformation {
 	ruis::vec3 translation{0, 0, 0};
 	ruis::quat rotation{0, 0, 0, 1};
 	ruis::vec3 scale{1, 1, 1};
+
+	ruis::mat4 to_matrix() const;
 };
 
 constexpr trs_transformation identity_trs_transformation{
@@ -48,16 +50,118 @@ using transformation_variant = std::variant<
 	ruis::mat4 //
 	>;
 
-struct node {
-	std::string name;
+class transform_hierarchy;
 
-	std::shared_ptr<mesh> mesh_v;
+/**
+ * @brief Scene node.
+ * Once the node is a part of a scene, its transformation is stored in the scene's transform hierarchy
+ * and the node acts as a view into it, see scene::flatten().
+ */
+class node
+{
+	friend class scene;
 
+	// transformation of the node while it is not attached to a transform hierarchy
 	transformation_variant transformation;
 
+	std::shared_ptr<transform_hierarchy> hierarchy;
+	uint32_t hierarchy_index = 0;
+
+	void attach(
+		std::shared_ptr<transform_hierarchy> h, //
+		uint32_t index
+	);
+
+	void recalculate_bounds();
+
+public:
+	std::string name;
+
+	std::shared_ptr<mesh> mesh_v;
+
 	std::vector<utki::shared_ref<node>> children;
 
+	/**
+	 * @brief Per-instance transformation matrices.
+	 * If not empty, the node's mesh is drawn once per instance, the instance transformation
+	 * is applied before the node's transformation. Children are not instanced.
+	 * See EXT_mesh_gpu_instancing glTF extension.
+	 */
+	std::vector<ruis::mat4> instances;
+
+	/**
+	 * @brief Meshes of lower levels of detail.
+	 * The node's mesh is the level 0, these are levels 1, 2 and so on. Rendered with the node's
+	 * transformation instead of the node's mesh when the node is small on screen.
+	 * See MSFT_lod glTF extension.
+	 */
+	std::vector<std::shared_ptr<mesh>> lods;
+
+	/**
+	 * @brief Screen coverage thresholds of the levels of detail.
+	 * Either empty or has one value per level, including level 0. The first level whose screen coverage,
+	 * i.e. fraction of the viewport height covered by the mesh bounds, is not less than its threshold
+	 * is rendered, nothing is rendered when the coverage is less than all the thresholds.
+	 * If empty, the renderer's thresholds are used.
+	 */
+	std::vector<ruis::real> lod_screen_coverage;
+
+	/**
+	 * @brief Bounding box of the node's subtree, in the node's coordinates.
+	 * Contains the node's mesh, including all its instances, and all the node's descendants.
+	 * The node's own transformation is not applied. Empty if the subtree has no meshes.
+	 * Kept up to date by update_bounds().
+	 */
+	aabb bounds;
+
+	/**
+	 * @brief Whether the node's bounds or transformation have changed since the last update_bounds() call.
+	 * Set by set_transformation(). Must be set when the node's mesh, instances or children are changed directly.
+	 */
+	bool bounds_dirty = true;
+
+	node(
+		std::string name = {}, //
+		std::shared_ptr<mesh> mesh_v = nullptr,
+		transformation_variant transformation = identity_trs_transformation
+	);
+
+	/**
+	 * @brief Get the node's transformation.
+	 * @return The node's transformation relative to its parent.
+	 */
+	transformation_variant get_transformation() const;
+
+	/**
+	 * @brief Get the node's transformation matrix.
+	 * For a node of a scene the matrix is cached in the scene's transform hierarchy.
+	 * @return The node's transformation matrix relative to its parent.
+	 */
 	ruis::mat4 get_transformation_matrix() const;
+
+	/**
+	 * @brief Get the node's world matrix.
+	 * For a node of a scene this is the node's transformation relative to the scene root,
+	 * as of the last scene::update_transforms() call. For a node which is not a part of a scene
+	 * this is the node's transformation matrix.
+	 * @return The node's world matrix.
+	 */
+	ruis::mat4 get_world_matrix() const;
+
+	/**
+	 * @brief Set the node's transformation.
+	 * Marks the node's bounds dirty, so that bounds of its ancestors are updated by update_bounds().
+	 * @param t - new transformation.
+	 */
+	void set_transformation(transformation_variant t);
+
+	/**
+	 * @brief Update bounds of the node's subtree.
+	 * Only the bounds of dirty nodes and of their ancestors are recalculated.
+	 * @return true if the node's bounds or transformation have changed, i.e. the bounds of the parent node
+	 *         need to be recalculated.
+	 */
+	bool update_bounds();
 };
 
 } // namespace ruis::render
@@ -0,0 +1,117 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <utki/config.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Number of worker threads to use for parallel loading tasks.
+ * @return Number of hardware threads, but at least 1.
+ */
+inline unsigned get_num_worker_threads()
+{
+#if CFG_OS_NAME == CFG_OS_NAME_EMSCRIPTEN
+	// no pthreads in emscripten build
+	return 1;
+#else
+	return std::max(std::thread::hardware_concurrency(), 1u);
+#endif
+}
+
+/**
+ * @brief Run a function for each index in range [0, count) using a pool of worker threads.
+ * The calling thread also participates in the work. The function returns after all the items are processed.
+ * Items are picked by worker threads one by one, so the order of processing is not defined.
+ * In case the function throws, remaining items are not processed and the first caught
+ * exception is rethrown to the caller.
+ * In case worker threads cannot be started, the items are processed by fewer threads.
+ * @param count - number of items to process.
+ * @param func - function to call for each item index.
+ */
+inline void parallel_for(
+	size_t count, //
+	const std::function<void(size_t)>& func
+)
+{
+	auto num_threads = std::min(size_t(get_num_worker_threads()), count);
+
+	if (num_threads <= 1) {
+		for (size_t i = 0; i != count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::atomic<size_t> next_index{0};
+	std::atomic<bool> failed{false};
+	std::exception_ptr exception;
+	std::mutex exception_mutex;
+
+	auto worker = [&]() {
+		for (size_t i = next_index++; i < count && !failed; i = next_index++) {
+			try {
+				func(i);
+			} catch (...) {
+				std::lock_guard lock(exception_mutex);
+				if (!failed) {
+					exception = std::current_exception();
+					failed = true;
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_threads - 1);
+	for (size_t i = 0; i != num_threads - 1; ++i) {
+		try {
+			threads.emplace_back(worker);
+		} catch (std::system_error&) {
+			// could not start more threads, e.g. because of resource limits,
+			// the threads already started and the calling thread process all the items then
+			break;
+		}
+	}
+
+	worker();
+
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+} // namespace ruis::render
@@ -21,7 +21,10 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "scene.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <unordered_map>
 
 using namespace ruis::render;
 
@@ -44,6 +47,126 @@ std::shared_ptr<light> scene::get_secondary_light()
 void scene::update(uint32_t dt)
 {
 	time += dt;
+
+	// animation key times are in seconds
+	auto seconds = double(this->time) / std::milli::den;
+
+	for (auto& a : this->animations) {
+		auto& anim = a.get();
+
+		auto duration = double(anim.get_duration());
+		anim.apply(duration > 0 ? float(std::fmod(seconds, duration)) : 0, this->hierarchy.get());
+
+		for (const auto& c : anim.get_channels()) {
+			if (c.node_index != animation::no_node) {
+				ASSERT(c.node_index < this->flat_nodes.size())
+				this->flat_nodes[c.node_index]->bounds_dirty = true;
+			}
+		}
+	}
+}
+
+void scene::flatten()
+{
+	this->hierarchy = utki::make_shared<transform_hierarchy>();
+
+	// needed to retarget the animations
+	auto old_flat_nodes = std::move(this->flat_nodes);
+	this->flat_nodes.clear();
+
+	struct stack_item {
+		node* n;
+		uint32_t parent;
+	};
+
+	std::vector<stack_item> stack;
+	for (auto i = this->nodes.rbegin(); i != this->nodes.rend(); ++i) {
+		stack.push_back({.n = &i->get(), .parent = transform_hierarchy::no_parent});
+	}
+
+	while (!stack.empty()) {
+		auto item = stack.back();
+		stack.pop_back();
+
+		auto& n = *item.n;
+		auto index = this->hierarchy.get().add(item.parent, n.get_transformation());
+		n.attach(this->hierarchy.to_shared_ptr(), index);
+		this->flat_nodes.push_back(&n);
+
+		// push in reverse order, so that children are flattened in their original order
+		for (auto i = n.children.rbegin(); i != n.children.rend(); ++i) {
+			stack.push_back({.n = &i->get(), .parent = index});
+		}
+	}
+
+	const auto& h = this->hierarchy.get();
+	this->flat_subtree_ends.resize(h.size());
+	for (uint32_t i = 0; i != h.size(); ++i) {
+		this->flat_subtree_ends[i] = i + 1;
+	}
+	// children go after their parents, so the subtree ends are propagated upwards in one reverse pass
+	for (auto i = uint32_t(h.size()); i != 0;) {
+		--i;
+		if (auto p = h.get_parent(i); p != transform_hierarchy::no_parent) {
+			this->flat_subtree_ends[p] = std::max(this->flat_subtree_ends[p], this->flat_subtree_ends[i]);
+		}
+	}
+
+	if (this->animations.empty()) {
+		return;
+	}
+
+	std::unordered_map<const node*, uint32_t> flat_indices;
+	for (uint32_t i = 0; i != this->flat_nodes.size(); ++i) {
+		flat_indices.insert(std::make_pair(this->flat_nodes[i], i));
+	}
+
+	for (auto& a : this->animations) {
+		auto& anim = a.get();
+		for (size_t ci = 0; ci != anim.get_channels().size(); ++ci) {
+			auto old_index = anim.get_channels()[ci].node_index;
+			if (old_index >= old_flat_nodes.size()) {
+				anim.set_target(ci, animation::no_node);
+				continue;
+			}
+			auto i = flat_indices.find(old_flat_nodes[old_index]);
+			anim.set_target(ci, i == flat_indices.end() ? animation::no_node : i->second);
+		}
+	}
+}
+
+void scene::update_transforms()
+{
+	this->hierarchy.get().update();
+}
+
+void scene::update_bounds()
+{
+	const auto& h = this->hierarchy.get();
+	ASSERT(h.size() == this->flat_nodes.size())
+
+	for (auto i = uint32_t(this->flat_nodes.size()); i != 0;) {
+		--i;
+		auto& n = *this->flat_nodes[i];
+		if (!n.bounds_dirty) {
+			continue;
+		}
+
+		n.recalculate_bounds();
+
+		if (auto p = h.get_parent(i); p != transform_hierarchy::no_parent) {
+			this->flat_nodes[p]->bounds_dirty = true;
+		}
+	}
+}
+
+aabb scene::get_bounds() const
+{
+	aabb ret;
+	for (const auto& n : this->nodes) {
+		ret.extend(n.get().bounds.transform(n.get().get_transformation_matrix()));
+	}
+	return ret;
 }
 
 ruis::mat4 camera::get_projection_matrix(ruis::real aspect_ratio)
@@ -20,7 +20,9 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 /* ================ LICENSE END ================ */
 
 #pragma once
+#include "animation.hpp"
 #include "node.hpp"
+#include "transform_hierarchy.hpp"
 
 namespace ruis::render {
 
@@ -61,6 +63,14 @@ class scene
 {
 	uint32_t time = 0;
 
+	utki::shared_ref<transform_hierarchy> hierarchy = utki::make_shared<transform_hierarchy>();
+
+	// nodes in the order of the transform hierarchy
+	std::vector<node*> flat_nodes;
+
+	// for each flattened node, index of the first node after its subtree
+	std::vector<uint32_t> flat_subtree_ends;
+
 public:
 	std::string name;
 
@@ -70,6 +80,14 @@ public:
 
 	std::shared_ptr<camera> active_camera;
 
+	/**
+	 * @brief Animations of the scene.
+	 * Channels target the nodes by their indices in the flattened nodes, see get_flat_nodes().
+	 * On flatten() the channels are retargeted to the new indices of the same nodes,
+	 * channels of the nodes which are no longer in the scene are left without target.
+	 */
+	std::vector<utki::shared_ref<animation>> animations{};
+
 	scene() = default;
 	scene(const scene&) = default;
 	scene(scene&&) = default;
@@ -80,7 +98,69 @@ public:
 	std::shared_ptr<light> get_primary_light();
 	std::shared_ptr<light> get_secondary_light();
 
+	/**
+	 * @brief Advance scene time.
+	 * Applies the scene animations at the new time, each animation is played in a loop.
+	 * Animated nodes are marked dirty, the new node transformations take effect on the next
+	 * update_transforms() and update_bounds() calls.
+	 * @param dt - time delta in milliseconds.
+	 */
 	void update(uint32_t dt);
+
+	/**
+	 * @brief Flatten the node tree into the scene's transform hierarchy.
+	 * All the scene nodes are attached to a new transform hierarchy in depth-first order,
+	 * from then on the nodes' transformations are stored in the hierarchy.
+	 * Must be called after the node tree structure has been changed, i.e. nodes added or removed.
+	 */
+	void flatten();
+
+	/**
+	 * @brief Update world matrices of the scene nodes.
+	 * Only the nodes whose transformations have changed and their descendants are recalculated,
+	 * see transform_hierarchy::update().
+	 */
+	void update_transforms();
+
+	const transform_hierarchy& get_transform_hierarchy() const noexcept
+	{
+		return this->hierarchy.get();
+	}
+
+	/**
+	 * @brief Get the scene nodes in the order of the transform hierarchy.
+	 * The node at index i has index i in the transform hierarchy.
+	 * @return Nodes flattened by the last flatten() call.
+	 */
+	utki::span<const node* const> get_flat_nodes() const noexcept
+	{
+		return this->flat_nodes;
+	}
+
+	/**
+	 * @brief Get subtree ranges of the flattened nodes.
+	 * Since the nodes are flattened in depth-first order, subtree of each node occupies a contiguous range
+	 * of the flattened nodes, starting with the node itself.
+	 * @return For each flattened node, index of the first node after its subtree.
+	 */
+	utki::span<const uint32_t> get_flat_subtree_ends() const noexcept
+	{
+		return this->flat_subtree_ends;
+	}
+
+	/**
+	 * @brief Update bounds of the scene nodes.
+	 * Only the dirty nodes and their ancestors are recalculated, see node::update_bounds().
+	 * Single pass over the flattened nodes in reverse order, so that children are updated before their parents.
+	 */
+	void update_bounds();
+
+	/**
+	 * @brief Get bounding box of the scene.
+	 * The bounds are as of the last update_bounds() call.
+	 * @return Bounding box of all the scene nodes, in scene coordinates.
+	 */
+	aabb get_bounds() const;
 };
 
 } // namespace ruis::render
\ No newline at end of file
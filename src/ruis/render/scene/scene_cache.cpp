@@ -0,0 +1,720 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "scene_cache.hxx"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#include <fsif/native_file.hpp>
+#include <utki/debug.hpp>
+#include <utki/string.hpp>
+
+#include "content_hash.hxx"
+#include "file_content.hxx"
+
+using namespace std::string_view_literals;
+using namespace ruis::render;
+
+namespace {
+constexpr std::string_view cache_file_magic = "RSCN"sv;
+
+// data blobs are aligned in the file so that those can be used directly from the memory-mapped file
+constexpr size_t blob_alignment = 16;
+
+// byte order mark to reject cache files written on a machine with different endianness
+constexpr uint32_t byte_order_mark = 0x01020304;
+
+size_t align_up(size_t offset)
+{
+	return (offset + blob_alignment - 1) / blob_alignment * blob_alignment;
+}
+
+class cache_writer
+{
+public:
+	std::vector<uint8_t> buffer;
+
+	void write_bytes(utki::span<const uint8_t> bytes)
+	{
+		this->buffer.insert(this->buffer.end(), bytes.begin(), bytes.end());
+	}
+
+	template <typename tp_type>
+	void write(const tp_type& value)
+	{
+		static_assert(std::is_trivially_copyable_v<tp_type>);
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		this->write_bytes(utki::make_span(reinterpret_cast<const uint8_t*>(&value), sizeof(value)));
+	}
+
+	void write_string(std::string_view str)
+	{
+		this->write(uint32_t(str.size()));
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		this->write_bytes(utki::make_span(reinterpret_cast<const uint8_t*>(str.data()), str.size()));
+	}
+
+	template <typename tp_type>
+	void write_blob(utki::span<const tp_type> data)
+	{
+		this->write(uint64_t(data.size_bytes()));
+		this->buffer.resize(align_up(this->buffer.size()), 0);
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		this->write_bytes(utki::make_span(reinterpret_cast<const uint8_t*>(data.data()), data.size_bytes()));
+	}
+};
+
+class cache_reader
+{
+	utki::span<const uint8_t> content;
+	size_t pos = 0;
+
+public:
+	cache_reader(utki::span<const uint8_t> content) :
+		content(content)
+	{}
+
+	utki::span<const uint8_t> read_bytes(size_t size)
+	{
+		if (this->content.size() - this->pos < size) {
+			throw std::invalid_argument("scene_cache: unexpected end of file");
+		}
+		auto ret = this->content.subspan(this->pos, size);
+		this->pos += size;
+		return ret;
+	}
+
+	template <typename tp_type>
+	tp_type read()
+	{
+		static_assert(std::is_trivially_copyable_v<tp_type>);
+		tp_type ret;
+		std::memcpy(&ret, this->read_bytes(sizeof(ret)).data(), sizeof(ret));
+		return ret;
+	}
+
+	std::string read_string()
+	{
+		auto bytes = this->read_bytes(this->read<uint32_t>());
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+	}
+
+	template <typename tp_type>
+	utki::span<const tp_type> read_blob()
+	{
+		auto size = this->read<uint64_t>();
+		if (size % sizeof(tp_type) != 0) {
+			throw std::invalid_argument("scene_cache: blob size is not a multiple of element size");
+		}
+		this->read_bytes(align_up(this->pos) - this->pos);
+		auto bytes = this->read_bytes(size);
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(tp_type) != 0) {
+			throw std::invalid_argument("scene_cache: misaligned blob");
+		}
+		return utki::make_span(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<const tp_type*>(bytes.data()),
+			bytes.size() / sizeof(tp_type)
+		);
+	}
+
+	// read element count and check that at least this number of elements of given minimal size can be read
+	size_t read_count(size_t min_element_size = 1)
+	{
+		auto count = this->read<uint32_t>();
+		if ((this->content.size() - this->pos) / min_element_size < count) {
+			throw std::invalid_argument("scene_cache: invalid element count");
+		}
+		return count;
+	}
+
+	bool is_end() const noexcept
+	{
+		return this->pos == this->content.size();
+	}
+};
+
+template <size_t index = 0>
+rasterimage::image_variant make_image(
+	size_t variant_index, //
+	r4::vector2<uint32_t> dims,
+	utki::span<const uint8_t> pixels
+)
+{
+	using variant_type = std::remove_cvref_t<decltype(std::declval<rasterimage::image_variant>().variant())>;
+
+	if constexpr (index == std::variant_size_v<variant_type>) {
+		throw std::invalid_argument("scene_cache: unknown image type");
+	} else {
+		if (variant_index != index) {
+			return make_image<index + 1>(variant_index, dims, pixels);
+		}
+
+		std::variant_alternative_t<index, variant_type> im(dims);
+		if (im.pixels().size_bytes() != pixels.size()) {
+			throw std::invalid_argument("scene_cache: image size mismatch");
+		}
+		std::memcpy(im.pixels().data(), pixels.data(), pixels.size());
+		return rasterimage::image_variant(std::move(im));
+	}
+}
+
+void write_transformation(
+	cache_writer& w, //
+	const transformation_variant& transformation
+)
+{
+	w.write(uint32_t(transformation.index()));
+	std::visit(
+		[&](const auto& t) {
+			using type = std::remove_cvref_t<decltype(t)>;
+			if constexpr (std::is_same_v<type, trs_transformation>) {
+				w.write(t.translation);
+				w.write(t.rotation.to_vector4());
+				w.write(t.scale);
+			} else {
+				static_assert(std::is_same_v<type, ruis::mat4>);
+				w.write(t);
+			}
+		},
+		transformation
+	);
+}
+
+transformation_variant read_transformation(cache_reader& r)
+{
+	switch (r.read<uint32_t>()) {
+		case 0:
+			{
+				trs_transformation t;
+				t.translation = r.read<ruis::vec3>();
+				t.rotation = ruis::quat(r.read<ruis::vec4>());
+				t.scale = r.read<ruis::vec3>();
+				return t;
+			}
+		case 1:
+			return r.read<ruis::mat4>();
+		default:
+			throw std::invalid_argument("scene_cache: unknown transformation type");
+	}
+}
+
+void write_index_data(
+	cache_writer& w, //
+	const scene_data::index_data_type& index_data
+)
+{
+	std::visit(
+		[&](const auto& indices) {
+			w.write(uint32_t(sizeof(indices[0])));
+			w.write_blob(indices);
+		},
+		index_data
+	);
+}
+
+scene_data::index_data_type read_index_data(cache_reader& r)
+{
+	switch (r.read<uint32_t>()) {
+		case sizeof(uint16_t):
+			return r.read_blob<uint16_t>();
+		case sizeof(uint32_t):
+			return r.read_blob<uint32_t>();
+		default:
+			throw std::invalid_argument("scene_cache: unsupported index size");
+	}
+}
+
+scene_data deserialize(
+	utki::span<const uint8_t> payload //
+)
+{
+	cache_reader r(payload);
+	scene_data data;
+
+	data.images.resize(r.read_count());
+	for (auto& im : data.images) {
+		switch (r.read<uint32_t>()) {
+			case 0:
+				{
+					auto variant_index = r.read<uint32_t>();
+					auto dims = r.read<r4::vector2<uint32_t>>();
+					im = make_image(variant_index, dims, r.read_blob<uint8_t>());
+				}
+				break;
+			case 1:
+				{
+					compressed_image ci{
+						.format_v = compressed_image::format(r.read<uint32_t>()),
+						.dims = r.read<r4::vector2<uint32_t>>(),
+						.levels = {}
+					};
+					if (ci.format_v != compressed_image::format::etc2_rgb8 &&
+						ci.format_v != compressed_image::format::etc2_rgba8)
+					{
+						throw std::invalid_argument("scene_cache: unknown compressed image format");
+					}
+					ci.levels.resize(r.read_count());
+					for (auto& l : ci.levels) {
+						l = r.read_blob<uint8_t>();
+					}
+					if (ci.levels.empty() || ci.levels.front().size() < ci.get_level_size(ci.dims)) {
+						throw std::invalid_argument("scene_cache: compressed image size mismatch");
+					}
+					im = std::move(ci);
+				}
+				break;
+			default:
+				throw std::invalid_argument("scene_cache: unknown image kind");
+		}
+	}
+
+	data.textures.resize(r.read_count());
+	for (auto& t : data.textures) {
+		t.image_index = r.read<uint32_t>();
+		if (t.image_index >= data.images.size()) {
+			throw std::invalid_argument("scene_cache: texture image index out of range");
+		}
+		t.params.min_filter = texture_2d::filter(r.read<uint32_t>());
+		t.params.mag_filter = texture_2d::filter(r.read<uint32_t>());
+		t.params.mipmap = texture_2d::mipmap(r.read<uint32_t>());
+		t.wrapping = r.read<texture_wrapping>();
+	}
+
+	data.materials.resize(r.read_count());
+	for (auto& m : data.materials) {
+		m.name = r.read_string();
+		m.tex_diffuse = r.read<int32_t>();
+		m.tex_normal = r.read<int32_t>();
+		m.tex_arm = r.read<int32_t>();
+	}
+
+	data.meshes.resize(r.read_count());
+	for (auto& m : data.meshes) {
+		m.name = r.read_string();
+		m.primitives.resize(r.read_count());
+		for (auto& p : m.primitives) {
+			p.material_index = r.read<int32_t>();
+
+			p.attributes.resize(r.read_count());
+			for (auto& a : p.attributes) {
+				a.num_components = r.read<uint32_t>();
+				a.data = r.read_blob<float>();
+			}
+
+			if (r.read<uint32_t>() != 0) {
+				auto& layout = p.interleaved_layout.emplace();
+				layout.stride = r.read<uint32_t>();
+				layout.attributes.resize(r.read_count());
+				for (auto& a : layout.attributes) {
+					a.offset = r.read<uint32_t>();
+					a.num_components = r.read<uint32_t>();
+					auto type = r.read<uint32_t>();
+					if (type > uint32_t(vertex_layout::component_type::uint16)) {
+						throw std::invalid_argument("scene_cache: unknown vertex component type");
+					}
+					a.type = vertex_layout::component_type(type);
+					a.normalized = r.read<uint32_t>() != 0;
+				}
+			}
+
+			p.indices = read_index_data(r);
+
+			p.lods.resize(r.read_count());
+			for (auto& l : p.lods) {
+				l = read_index_data(r);
+			}
+
+			p.bounds = r.read<aabb>();
+		}
+		m.bounds = r.read<aabb>();
+	}
+
+	data.nodes.resize(r.read_count());
+	for (auto& n : data.nodes) {
+		n.name = r.read_string();
+		n.mesh_index = r.read<int32_t>();
+		n.transformation = read_transformation(r);
+		n.children.resize(r.read_count(sizeof(uint32_t)));
+		for (auto& c : n.children) {
+			c = r.read<uint32_t>();
+		}
+		n.instances.resize(r.read_count(sizeof(ruis::mat4)));
+		for (auto& m : n.instances) {
+			m = r.read<ruis::mat4>();
+		}
+		n.lods.resize(r.read_count(sizeof(uint32_t)));
+		for (auto& l : n.lods) {
+			l = r.read<uint32_t>();
+		}
+		n.lod_screen_coverage.resize(r.read_count(sizeof(float)));
+		for (auto& c : n.lod_screen_coverage) {
+			c = r.read<float>();
+		}
+	}
+
+	data.scenes.resize(r.read_count());
+	for (auto& s : data.scenes) {
+		s.name = r.read_string();
+		s.nodes.resize(r.read_count(sizeof(uint32_t)));
+		for (auto& ni : s.nodes) {
+			ni = r.read<uint32_t>();
+		}
+	}
+
+	data.animations.resize(r.read_count());
+	for (auto& a : data.animations) {
+		a.name = r.read_string();
+		a.channels.resize(r.read_count());
+		for (auto& c : a.channels) {
+			c.node_index = r.read<uint32_t>();
+			if (c.node_index >= data.nodes.size()) {
+				throw std::invalid_argument("scene_cache: animation channel node index out of range");
+			}
+			c.path_v = animation::path(r.read<uint32_t>());
+			c.interpolation_v = animation::interpolation(r.read<uint32_t>());
+			c.times = r.read_blob<float>();
+			c.values = r.read_blob<float>();
+		}
+	}
+
+	data.active_scene = r.read<int32_t>();
+
+	if (!r.is_end()) {
+		throw std::invalid_argument("scene_cache: unexpected data at the end of file");
+	}
+
+	return data;
+}
+
+struct cache_file_header {
+	std::array<char, 4> magic;
+	uint32_t version;
+	uint32_t byte_order_mark;
+	uint32_t reserved;
+	uint64_t key;
+	uint64_t payload_size;
+};
+
+std::string make_cache_file_name(std::string_view path)
+{
+	std::stringstream ss;
+	ss << std::hex << std::setfill('0') << std::setw(sizeof(uint64_t) * 2)
+	   << content_hash(utki::make_span(
+			  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			  reinterpret_cast<const uint8_t*>(path.data()),
+			  path.size()
+		  ))
+	   << ".scene";
+	return ss.str();
+}
+} // namespace
+
+scene_cache::scene_cache(std::string dir) :
+	dir(std::move(dir))
+{}
+
+uint64_t scene_cache::make_key(
+	utki::span<const uint8_t> content, //
+	const gltf_loader::parameters& params
+)
+{
+	uint64_t flags = (params.interleave_vertex_attributes ? 1 : 0) | (params.optimize_indices ? 2 : 0);
+	uint64_t seed = (uint64_t(version) << (sizeof(uint32_t) * 8)) | flags;
+
+	// generated levels of detail depend on the simplification parameters
+	if (params.num_lods != 0) {
+		const std::array<float, 3> lod_params = {
+			float(params.num_lods),
+			params.lod_triangle_ratio,
+			params.lod_max_error
+		};
+		seed = content_hash(
+			utki::make_span(
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				reinterpret_cast<const uint8_t*>(lod_params.data()),
+				sizeof(lod_params)
+			),
+			seed
+		);
+	}
+
+	return content_hash(content, seed);
+}
+
+void scene_cache::write(
+	const scene_data& data, //
+	uint64_t key,
+	const fsif::file& fi
+)
+{
+	cache_writer w;
+
+	w.write(cache_file_header{});
+
+	w.write(uint32_t(data.images.size()));
+	for (const auto& im : data.images) {
+		w.write(uint32_t(im.index()));
+		if (const auto* ci = std::get_if<compressed_image>(&im)) {
+			w.write(uint32_t(ci->format_v));
+			w.write(ci->dims);
+			w.write(uint32_t(ci->levels.size()));
+			for (const auto& l : ci->levels) {
+				w.write_blob(l);
+			}
+			continue;
+		}
+
+		const auto& imvar = std::get<rasterimage::image_variant>(im);
+		std::visit(
+			[&](const auto& image) {
+				w.write(uint32_t(imvar.variant().index()));
+				w.write(image.dims());
+				w.write_blob(image.pixels());
+			},
+			imvar.variant()
+		);
+	}
+
+	w.write(uint32_t(data.textures.size()));
+	for (const auto& t : data.textures) {
+		w.write(t.image_index);
+		w.write(uint32_t(t.params.min_filter));
+		w.write(uint32_t(t.params.mag_filter));
+		w.write(uint32_t(t.params.mipmap));
+		w.write(t.wrapping);
+	}
+
+	w.write(uint32_t(data.materials.size()));
+	for (const auto& m : data.materials) {
+		w.write_string(m.name);
+		w.write(int32_t(m.tex_diffuse));
+		w.write(int32_t(m.tex_normal));
+		w.write(int32_t(m.tex_arm));
+	}
+
+	w.write(uint32_t(data.meshes.size()));
+	for (const auto& m : data.meshes) {
+		w.write_string(m.name);
+		w.write(uint32_t(m.primitives.size()));
+		for (const auto& p : m.primitives) {
+			w.write(int32_t(p.material_index));
+
+			w.write(uint32_t(p.attributes.size()));
+			for (const auto& a : p.attributes) {
+				w.write(a.num_components);
+				w.write_blob(a.data);
+			}
+
+			w.write(uint32_t(p.interleaved_layout.has_value()));
+			if (p.interleaved_layout.has_value()) {
+				w.write(p.interleaved_layout->stride);
+				w.write(uint32_t(p.interleaved_layout->attributes.size()));
+				for (const auto& a : p.interleaved_layout->attributes) {
+					w.write(a.offset);
+					w.write(a.num_components);
+					w.write(uint32_t(a.type));
+					w.write(uint32_t(a.normalized));
+				}
+			}
+
+			write_index_data(w, p.indices);
+
+			w.write(uint32_t(p.lods.size()));
+			for (const auto& l : p.lods) {
+				write_index_data(w, l);
+			}
+
+			w.write(p.bounds);
+		}
+		w.write(m.bounds);
+	}
+
+	w.write(uint32_t(data.nodes.size()));
+	for (const auto& n : data.nodes) {
+		w.write_string(n.name);
+		w.write(int32_t(n.mesh_index));
+		write_transformation(w, n.transformation);
+		w.write(uint32_t(n.children.size()));
+		for (auto c : n.children) {
+			w.write(c);
+		}
+		w.write(uint32_t(n.instances.size()));
+		for (const auto& m : n.instances) {
+			w.write(m);
+		}
+		w.write(uint32_t(n.lods.size()));
+		for (auto l : n.lods) {
+			w.write(l);
+		}
+		w.write(uint32_t(n.lod_screen_coverage.size()));
+		for (auto c : n.lod_screen_coverage) {
+			w.write(c);
+		}
+	}
+
+	w.write(uint32_t(data.scenes.size()));
+	for (const auto& s : data.scenes) {
+		w.write_string(s.name);
+		w.write(uint32_t(s.nodes.size()));
+		for (auto ni : s.nodes) {
+			w.write(ni);
+		}
+	}
+
+	w.write(uint32_t(data.animations.size()));
+	for (const auto& a : data.animations) {
+		w.write_string(a.name);
+		w.write(uint32_t(a.channels.size()));
+		for (const auto& c : a.channels) {
+			w.write(c.node_index);
+			w.write(uint32_t(c.path_v));
+			w.write(uint32_t(c.interpolation_v));
+			w.write_blob(c.times);
+			w.write_blob(c.values);
+		}
+	}
+
+	w.write(int32_t(data.active_scene));
+
+	cache_file_header header{};
+	std::copy(cache_file_magic.begin(), cache_file_magic.end(), header.magic.begin());
+	header.version = version;
+	header.byte_order_mark = byte_order_mark;
+	header.key = key;
+	header.payload_size = w.buffer.size() - sizeof(cache_file_header);
+	std::memcpy(w.buffer.data(), &header, sizeof(header));
+
+	fi.open(fsif::mode::create);
+	utki::scope_exit file_scope_exit([&fi]() {
+		fi.close();
+	});
+	fi.write(utki::make_span(w.buffer));
+}
+
+std::optional<scene_data> scene_cache::read(
+	const fsif::file& fi, //
+	uint64_t key
+)
+{
+	if (!fi.exists()) {
+		return {};
+	}
+
+	auto content = std::make_shared<const file_content>(fi);
+	auto span = content->span();
+
+	if (span.size() < sizeof(cache_file_header)) {
+		return {};
+	}
+
+	cache_file_header header{};
+	std::memcpy(&header, span.data(), sizeof(header));
+
+	if (std::string_view(header.magic.data(), header.magic.size()) != cache_file_magic ||
+		header.version != version || header.byte_order_mark != byte_order_mark || header.key != key ||
+		header.payload_size != span.size() - sizeof(cache_file_header))
+	{
+		return {};
+	}
+
+	// the header size is a multiple of blob alignment, so blobs are aligned relative to the payload as well
+	static_assert(sizeof(cache_file_header) % blob_alignment == 0);
+
+	try {
+		auto data = deserialize(span.subspan(sizeof(cache_file_header)));
+		data.storage.push_back(std::move(content));
+		return data;
+	} catch (std::invalid_argument& e) {
+		utki::log_debug([&](auto& o) {
+			o << "scene_cache::read(): invalid cache file " << fi.path() << ": " << e.what() << std::endl;
+		});
+		return {};
+	}
+}
+
+scene_data scene_cache::read(
+	const fsif::file& fi, //
+	gltf_loader& loader,
+	statistics* stats,
+	load_progress* progress
+)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	utki::scope_exit stats_scope_exit([&]() {
+		if (stats) {
+			stats->read_time = std::chrono::steady_clock::now() - start;
+		}
+	});
+
+	uint64_t key = [&]() {
+		const file_content content(fi);
+		auto ret = make_key(content.span(), loader.get_parameters());
+
+		// changing an external buffer file invalidates the entry as well
+		for (const auto& f : gltf_loader::get_external_buffer_files(fi, content.span())) {
+			ret = content_hash(get_shared_file_content(*f)->span(), ret);
+		}
+		return ret;
+	}();
+
+	fsif::native_file cache_file((std::filesystem::path(this->dir) / make_cache_file_name(fi.path())).string());
+
+	if (auto data = read(cache_file, key)) {
+		if (stats) {
+			stats->hit = true;
+		}
+		if (progress) {
+			progress->report(1);
+		}
+		return std::move(data.value());
+	}
+
+	if (stats) {
+		stats->hit = false;
+	}
+
+	auto data = loader.read(fi, progress);
+
+	try {
+		std::filesystem::create_directories(this->dir);
+
+		// write to temporary file and then rename it, so that other processes never see partially written cache file
+		fsif::native_file tmp_file(utki::cat(cache_file.path(), ".tmp"));
+		write(data, key, tmp_file);
+		std::filesystem::rename(tmp_file.path(), cache_file.path());
+	} catch (std::exception& e) {
+		utki::log_debug([&](auto& o) {
+			o << "scene_cache::read(): failed to write cache file " << cache_file.path() << ": " << e.what()
+			  << std::endl;
+		});
+	}
+
+	return data;
+}
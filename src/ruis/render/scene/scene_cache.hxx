@@ -0,0 +1,132 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <fsif/file.hpp>
+
+#include "gltf_loader.hxx"
+#include "scene_data.hxx"
+
+namespace ruis::render {
+
+/**
+ * @brief On-disk cache of scene data.
+ * Scene data read from a glTF file is stored in a binary cache file which is ready to be memory-mapped,
+ * i.e. vertex and index data are stored in their final GPU memory layout and images are stored decoded.
+ * Reading the scene data back from the cache only needs to map the file and parse a small header,
+ * no JSON parsing, image decoding or tangent generation is done.
+ *
+ * The cache entry is keyed by a hash of the source file content, content of its external buffer files and
+ * the loader parameters, so changing any of those invalidates the entry. The cache file format
+ * is versioned, files written by a different version are invalid as well. Invalid entries are
+ * rebuilt from the source file.
+ *
+ * Cache files are native endian and are not intended to be portable between machines.
+ */
+class scene_cache
+{
+	std::string dir;
+
+public:
+	/**
+	 * @brief Version of the cache file format.
+	 * Must be incremented on every change of the file format or of the scene_data structure.
+	 */
+	constexpr static uint32_t version = 8;
+
+	/**
+	 * @param dir - directory to store cache files in. Created if it does not exist.
+	 */
+	explicit scene_cache(std::string dir);
+
+	struct statistics {
+		/**
+		 * @brief Whether the scene data was read from a valid cache entry.
+		 */
+		bool hit = false;
+
+		/**
+		 * @brief Wall time spent reading the scene data, including cache update on miss.
+		 */
+		std::chrono::nanoseconds read_time{0};
+	};
+
+	/**
+	 * @brief Read scene data.
+	 * In case the cache has a valid entry for the file, then the scene data is read from the cache.
+	 * Otherwise, the scene data is read from the file using the loader and the cache entry is (re)written.
+	 * Failure to write the cache entry is not an error, the read scene data is returned anyway.
+	 * @param fi - glTF file to read.
+	 * @param loader - loader to read the file with on cache miss.
+	 * @param stats - optional output of the reading statistics.
+	 * @param progress - optional progress to report the reading progress to and to check for cancellation.
+	 * @return Scene data.
+	 * @throw load_cancelled - if the reading was cancelled via the progress object.
+	 */
+	scene_data read(
+		const fsif::file& fi, //
+		gltf_loader& loader,
+		statistics* stats = nullptr,
+		load_progress* progress = nullptr
+	);
+
+	/**
+	 * @brief Serialize scene data to a cache file.
+	 * @param data - scene data to serialize.
+	 * @param key - cache key to store in the file header.
+	 * @param fi - file to write.
+	 */
+	static void write(
+		const scene_data& data, //
+		uint64_t key,
+		const fsif::file& fi
+	);
+
+	/**
+	 * @brief Deserialize scene data from a cache file.
+	 * The returned scene data refers to the memory-mapped cache file content, which is kept alive
+	 * by the scene data storage.
+	 * @param fi - cache file to read.
+	 * @param key - expected cache key.
+	 * @return Scene data, or empty optional if the file is not a valid cache file for the given key.
+	 */
+	static std::optional<scene_data> read(
+		const fsif::file& fi, //
+		uint64_t key
+	);
+
+	/**
+	 * @brief Calculate cache key for the file content.
+	 * @param content - source file content.
+	 * @param params - loader parameters.
+	 * @return Cache key.
+	 */
+	static uint64_t make_key(
+		utki::span<const uint8_t> content, //
+		const gltf_loader::parameters& params
+	);
+};
+
+} // namespace ruis::render
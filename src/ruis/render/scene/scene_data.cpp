@@ -0,0 +1,355 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "scene_data.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include <utki/string.hpp>
+
+using namespace ruis::render;
+
+namespace {
+template <typename tp_component_type>
+float dequantize(const uint8_t* p, bool normalized)
+{
+	tp_component_type c{};
+	std::memcpy(&c, p, sizeof(c));
+
+	if (!normalized) {
+		return float(c);
+	}
+
+	constexpr auto max = float(std::numeric_limits<tp_component_type>::max());
+
+	if constexpr (std::is_signed_v<tp_component_type>) {
+		return std::max(float(c) / max, -1.0f);
+	} else {
+		return float(c) / max;
+	}
+}
+
+// positions are the first vertex attribute, in case of interleaved vertex data they can be quantized
+triangle_mesh make_triangle_mesh(const scene_data::primitive& p)
+{
+	triangle_mesh ret;
+
+	if (p.attributes.empty()) {
+		return ret;
+	}
+	const auto& data = p.attributes.front().data;
+
+	if (p.interleaved_layout.has_value()) {
+		const auto& layout = p.interleaved_layout.value();
+		if (layout.attributes.empty() || layout.stride == 0) {
+			return ret;
+		}
+		const auto& a = layout.attributes.front();
+
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		const auto* vertices = reinterpret_cast<const uint8_t*>(data.data());
+		size_t num_vertices = data.size_bytes() / layout.stride;
+
+		ret.positions.resize(num_vertices);
+		for (size_t v = 0; v != num_vertices; ++v) {
+			const auto* src = vertices + v * layout.stride + a.offset;
+			for (size_t i = 0; i != 3; ++i) {
+				switch (a.type) {
+					case vertex_layout::component_type::int8:
+						ret.positions[v][i] = dequantize<int8_t>(src + i, a.normalized);
+						break;
+					case vertex_layout::component_type::uint8:
+						ret.positions[v][i] = dequantize<uint8_t>(src + i, a.normalized);
+						break;
+					case vertex_layout::component_type::int16:
+						ret.positions[v][i] = dequantize<int16_t>(src + i * sizeof(int16_t), a.normalized);
+						break;
+					case vertex_layout::component_type::uint16:
+						ret.positions[v][i] = dequantize<uint16_t>(src + i * sizeof(uint16_t), a.normalized);
+						break;
+					case vertex_layout::component_type::float32:
+					default:
+						std::memcpy(&ret.positions[v][i], src + i * sizeof(float), sizeof(float));
+						break;
+				}
+			}
+		}
+	} else {
+		ret.positions.resize(data.size() / 3);
+		for (size_t v = 0; v != ret.positions.size(); ++v) {
+			ret.positions[v] = {data[v * 3], data[v * 3 + 1], data[v * 3 + 2]};
+		}
+	}
+
+	std::visit(
+		[&](const auto& indices) {
+			ret.indices.reserve(indices.size());
+			for (auto i : indices) {
+				if (i >= ret.positions.size()) {
+					throw std::invalid_argument(utki::cat("make_scene(): vertex index out of range: ", i));
+				}
+				ret.indices.push_back(i);
+			}
+		},
+		p.indices
+	);
+
+	return ret;
+}
+} // namespace
+
+utki::shared_ref<scene> ruis::render::make_scene(
+	ruis::render::context& render_context,
+	const scene_data& data,
+	utki::span<std::chrono::nanoseconds> image_upload_times,
+	gpu_resource_cache* cache,
+	const compressed_texture_factory& make_compressed_texture,
+	bvh::primitive_triangles* triangles
+)
+{
+	ASSERT(image_upload_times.empty() || image_upload_times.size() == data.images.size())
+
+	if (triangles) {
+		triangles->clear();
+	}
+
+	// without shared cache, still deduplicate resources within the scene
+	std::optional<gpu_resource_cache> local_cache;
+	if (!cache) {
+		cache = &local_cache.emplace();
+	}
+
+	std::vector<utki::shared_ref<ruis::render::texture_2d>> textures;
+	textures.reserve(data.textures.size());
+	for (const auto& t : data.textures) {
+		auto start = std::chrono::steady_clock::now();
+
+		textures.push_back(std::visit(
+			[&](const auto& im) {
+				if constexpr (std::is_same_v<std::remove_cvref_t<decltype(im)>, compressed_image>) {
+					return cache->get_texture_2d(render_context, im, t.params, make_compressed_texture);
+				} else {
+					return cache->get_texture_2d(render_context, im, t.params);
+				}
+			},
+			data.images.at(t.image_index)
+		));
+
+		if (!image_upload_times.empty()) {
+			image_upload_times[t.image_index] += std::chrono::steady_clock::now() - start;
+		}
+	}
+
+	auto get_texture = [&](int index) -> std::shared_ptr<ruis::render::texture_2d> {
+		if (index < 0) {
+			return nullptr;
+		}
+		return textures.at(index).to_shared_ptr();
+	};
+
+	auto get_wrapping = [&](int index) -> texture_wrapping {
+		if (index < 0) {
+			return {};
+		}
+		return data.textures.at(index).wrapping;
+	};
+
+	std::vector<utki::shared_ref<material>> materials;
+	materials.reserve(data.materials.size());
+	for (const auto& m : data.materials) {
+		materials.push_back(utki::make_shared<material>(
+			m.name, //
+			get_texture(m.tex_diffuse),
+			get_texture(m.tex_normal),
+			get_texture(m.tex_arm),
+			get_wrapping(m.tex_diffuse),
+			get_wrapping(m.tex_normal),
+			get_wrapping(m.tex_arm)
+		));
+	}
+
+	// several primitives can share same vertex data, e.g. positions, look up such data only once
+	using buffer_key_type = std::tuple<const void*, size_t, uint32_t>;
+	std::map<buffer_key_type, utki::shared_ref<vertex_buffer>> vertex_buffers;
+	std::map<buffer_key_type, utki::shared_ref<index_buffer>> index_buffers;
+
+	std::vector<utki::shared_ref<mesh>> meshes;
+	meshes.reserve(data.meshes.size());
+	for (const auto& m : data.meshes) {
+		std::vector<utki::shared_ref<primitive>> primitives;
+		primitives.reserve(m.primitives.size());
+
+		for (const auto& p : m.primitives) {
+			std::vector<utki::shared_ref<const vertex_buffer>> vbos;
+			vbos.reserve(p.attributes.size());
+			for (const auto& a : p.attributes) {
+				buffer_key_type key{a.data.data(), a.data.size(), a.num_components};
+				auto i = vertex_buffers.find(key);
+				if (i == vertex_buffers.end()) {
+					auto vbo = cache->get_vertex_buffer(render_context, a.data, a.num_components);
+					i = vertex_buffers.insert(std::make_pair(key, std::move(vbo))).first;
+				}
+				vbos.emplace_back(i->second);
+			}
+
+			auto get_index_buffer = [&](const scene_data::index_data_type& index_data) {
+				return std::visit(
+					[&](const auto& indices) {
+						buffer_key_type key{indices.data(), indices.size(), sizeof(indices[0])};
+						auto i = index_buffers.find(key);
+						if (i == index_buffers.end()) {
+							i = index_buffers
+									.insert(std::make_pair(key, cache->get_index_buffer(render_context, indices)))
+									.first;
+						}
+						return i->second;
+					},
+					index_data
+				);
+			};
+
+			// levels of detail only differ in index buffers
+			std::vector<utki::shared_ref<vertex_array>> lods;
+			lods.reserve(p.lods.size());
+			for (const auto& l : p.lods) {
+				lods.push_back(render_context.make_vertex_array(
+					vbos, //
+					get_index_buffer(l),
+					ruis::render::vertex_array::mode::triangles
+				));
+			}
+
+			auto vao = render_context.make_vertex_array(
+				std::move(vbos), //
+				get_index_buffer(p.indices),
+				ruis::render::vertex_array::mode::triangles
+			);
+
+			primitives.push_back(utki::make_shared<primitive>(
+				std::move(vao), //
+				p.material_index >= 0 ? materials.at(p.material_index) : utki::make_shared<material>(),
+				p.interleaved_layout,
+				std::move(lods),
+				p.bounds
+			));
+
+			if (triangles) {
+				triangles->insert(std::make_pair(&primitives.back().get(), make_triangle_mesh(p)));
+			}
+		}
+
+		meshes.push_back(utki::make_shared<mesh>(
+			m.name, //
+			std::move(primitives),
+			m.bounds
+		));
+	}
+
+	std::vector<utki::shared_ref<node>> nodes;
+	nodes.reserve(data.nodes.size());
+	for (const auto& n : data.nodes) {
+		auto new_node = utki::make_shared<node>(
+			n.name, //
+			n.mesh_index >= 0 ? meshes.at(n.mesh_index).to_shared_ptr() : nullptr,
+			n.transformation
+		);
+		new_node.get().instances = n.instances;
+		for (uint32_t li : n.lods) {
+			// only the mesh of the level of detail node is used
+			int mesh_index = data.nodes.at(li).mesh_index;
+			new_node.get().lods.push_back(mesh_index >= 0 ? meshes.at(mesh_index).to_shared_ptr() : nullptr);
+		}
+		new_node.get().lod_screen_coverage.assign(n.lod_screen_coverage.begin(), n.lod_screen_coverage.end());
+		nodes.push_back(std::move(new_node));
+	}
+
+	// hierarchize nodes
+	for (size_t i = 0; i != nodes.size(); ++i) {
+		for (uint32_t ci : data.nodes[i].children) {
+			nodes[i].get().children.push_back(nodes.at(ci));
+		}
+	}
+
+	if (data.active_scene < 0) {
+		// the scene data is a library
+		return utki::make_shared<scene>();
+	}
+
+	const auto& sd = data.scenes.at(data.active_scene);
+
+	auto s = utki::make_shared<scene>();
+	s.get().name = sd.name;
+	for (uint32_t ni : sd.nodes) {
+		s.get().nodes.push_back(nodes.at(ni));
+	}
+
+	s.get().flatten();
+	s.get().update_bounds();
+
+	if (!data.animations.empty()) {
+		// animation channels target the nodes by their flattened indices
+		std::map<const node*, uint32_t> flat_indices;
+		auto flat_nodes = s.get().get_flat_nodes();
+		for (uint32_t i = 0; i != flat_nodes.size(); ++i) {
+			flat_indices.insert(std::make_pair(flat_nodes[i], i));
+		}
+
+		for (const auto& a : data.animations) {
+			auto new_animation = utki::make_shared<animation>();
+			new_animation.get().name = a.name;
+			for (const auto& c : a.channels) {
+				auto i = flat_indices.find(&nodes.at(c.node_index).get());
+				if (i == flat_indices.end()) {
+					// the node is not in the active scene
+					continue;
+				}
+				new_animation.get().add_channel(
+					i->second, //
+					c.path_v,
+					c.interpolation_v,
+					c.times,
+					c.values
+				);
+			}
+			if (!new_animation.get().get_channels().empty()) {
+				s.get().animations.push_back(std::move(new_animation));
+			}
+		}
+	}
+
+	constexpr ruis::vec4 default_light_position{4, 4, 4, 1};
+	constexpr ruis::vec3 default_light_intensity{4, 4, 4};
+
+	s.get().lights.push_back( //
+		utki::make_shared<ruis::render::light>(
+			default_light_position, //
+			default_light_intensity
+		)
+	);
+
+	return s;
+}
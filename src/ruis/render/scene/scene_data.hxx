@@ -0,0 +1,203 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <variant>
+
+#include <rasterimage/image_variant.hpp>
+#include <ruis/render/context.hpp>
+
+#include "animation.hpp"
+#include "bvh.hpp"
+#include "compressed_image.hxx"
+#include "gpu_resource_cache.hxx"
+#include "node.hpp"
+#include "scene.hpp"
+
+namespace ruis::render {
+
+/**
+ * @brief CPU side scene data ready to be uploaded to GPU.
+ * This is an intermediate representation of the scene between reading it from a file
+ * and creating GPU resources. All the data is in its final memory layout, so
+ * making a scene out of it only needs to create the GPU objects.
+ * Reading scene data does not need a rendering context, so it can be done on any thread.
+ */
+struct scene_data {
+	using image = std::variant<rasterimage::image_variant, compressed_image>;
+
+	struct texture {
+		uint32_t image_index;
+		ruis::render::context::texture_2d_parameters params;
+		texture_wrapping wrapping;
+	};
+
+	struct vertex_attribute {
+		/**
+		 * @brief Number of float components of the attribute, 1 to 4.
+		 */
+		uint32_t num_components;
+
+		/**
+		 * @brief Attribute data.
+		 * For interleaved primitives this is the whole interleaved vertex data.
+		 */
+		utki::span<const float> data;
+	};
+
+	using index_data_type = std::variant<
+		utki::span<const uint16_t>, //
+		utki::span<const uint32_t>>;
+
+	struct primitive {
+		/**
+		 * @brief Vertex attributes.
+		 * In case of interleaved layout there is only one attribute holding all the vertex data.
+		 */
+		std::vector<vertex_attribute> attributes;
+		std::optional<vertex_layout> interleaved_layout;
+		index_data_type indices;
+		int material_index = -1;
+
+		/**
+		 * @brief Index data of simplified levels of detail, see primitive::lods.
+		 * The levels use the same vertex data as the primitive.
+		 */
+		std::vector<index_data_type> lods;
+
+		aabb bounds;
+	};
+
+	struct material {
+		std::string name;
+		int tex_diffuse = -1;
+		int tex_normal = -1;
+		int tex_arm = -1;
+	};
+
+	struct mesh {
+		std::string name;
+		std::vector<primitive> primitives;
+		aabb bounds;
+	};
+
+	struct node {
+		std::string name;
+		int mesh_index = -1;
+		transformation_variant transformation;
+		std::vector<uint32_t> children;
+
+		/**
+		 * @brief Per-instance transformation matrices, see node::instances.
+		 */
+		std::vector<ruis::mat4> instances;
+
+		/**
+		 * @brief Indices of the nodes providing meshes of lower levels of detail, see node::lods.
+		 */
+		std::vector<uint32_t> lods;
+
+		std::vector<float> lod_screen_coverage;
+	};
+
+	struct scene {
+		std::string name;
+		std::vector<uint32_t> nodes;
+	};
+
+	struct animation_channel {
+		uint32_t node_index;
+		ruis::render::animation::path path_v;
+		ruis::render::animation::interpolation interpolation_v;
+
+		/**
+		 * @brief Key times in seconds.
+		 */
+		utki::span<const float> times;
+
+		/**
+		 * @brief Key values, see animation::add_channel() for the layout.
+		 */
+		utki::span<const float> values;
+	};
+
+	struct animation {
+		std::string name;
+		std::vector<animation_channel> channels;
+	};
+
+	std::vector<image> images;
+	std::vector<texture> textures;
+	std::vector<material> materials;
+	std::vector<mesh> meshes;
+	std::vector<node> nodes;
+	std::vector<scene> scenes;
+	std::vector<animation> animations;
+
+	int active_scene = -1;
+
+	/**
+	 * @brief Owners of the memory the data spans point to.
+	 * E.g. memory-mapped file content or vectors of converted vertex data.
+	 */
+	std::vector<std::shared_ptr<const void>> storage;
+
+	template <typename tp_type>
+	utki::span<const tp_type> store(std::vector<tp_type> vec)
+	{
+		auto p = std::make_shared<const std::vector<tp_type>>(std::move(vec));
+		auto ret = utki::make_span(*p);
+		this->storage.push_back(std::move(p));
+		return ret;
+	}
+};
+
+/**
+ * @brief Create scene GPU objects from scene data.
+ * Identical textures, vertex and index data result in a single shared GPU object.
+ * Must be called on the rendering thread.
+ * @param render_context - rendering context to create GPU objects with.
+ * @param data - scene data.
+ * @param image_upload_times - optional output of per-image texture creation times,
+ *        if not empty, must have same size as data.images.
+ * @param cache - optional cache to look up existing GPU objects in, e.g. the process-wide cache.
+ *        If null, GPU objects are only shared within the scene.
+ * @param make_compressed_texture - optional function to create compressed textures with.
+ *        If not set, compressed images are decoded and uploaded uncompressed.
+ * @param triangles - optional output of CPU side copies of the primitive triangles, e.g. for precise
+ *        ray casting, see bvh::build(). The scene data is usually dropped after making the scene,
+ *        while GPU objects cannot be read back. Previous content is cleared.
+ * @return Active scene of the scene data, or empty scene if the data has no active scene.
+ */
+utki::shared_ref<scene> make_scene(
+	ruis::render::context& render_context,
+	const scene_data& data,
+	utki::span<std::chrono::nanoseconds> image_upload_times = {},
+	gpu_resource_cache* cache = nullptr,
+	const compressed_texture_factory& make_compressed_texture = nullptr,
+	bvh::primitive_triangles* triangles = nullptr
+);
+
+} // namespace ruis::render
@@ -22,13 +22,15 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "scene_renderer.hxx"
 
 #include <chrono>
+#include <cmath>
 
 #include "../../../carcockpit/application.hpp"
 
 using namespace ruis::render;
 
 scene_renderer::scene_renderer(utki::shared_ref<ruis::context> c) :
-	context_v(std::move(c))
+	context_v(std::move(c)),
+	instancing_supported(ruis::render::shader_pbr_instanced::is_supported())
 {
 	texture_default_black = context_v.get().loader().load<ruis::res::texture_2d>("texture_default_black");
 	texture_default_white = context_v.get().loader().load<ruis::res::texture_2d>("texture_default_white");
@@ -58,15 +60,20 @@ void scene_renderer::set_external_camera(std::shared_ptr<ruis::render::camera> c
 	external_camera = cam;
 }
 
+void scene_renderer::set_lod_thresholds(std::vector<ruis::real> thresholds)
+{
+	this->lod_thresholds = std::move(thresholds);
+}
+
 void scene_renderer::render(
 	const ruis::vec2& dims, //
 	const ruis::mat4& viewport_matrix
 )
 {
-	if (!scene_v)
-		return;
+	this->last_render_stats = {};
 
-	auto cam = external_camera ? external_camera : scene_v.get()->active_camera;
+	// without scene, e.g. while it is being loaded, only the environment is rendered using the external camera
+	auto cam = external_camera ? external_camera : (scene_v ? scene_v.get()->active_camera : nullptr);
 
 	if (!cam)
 		return;
@@ -76,6 +83,19 @@ void scene_renderer::render(
 
 	view_matrix = cam->get_view_matrix();
 
+	{
+		auto& r = this->context_v.get().ren().rendering_context.get();
+		bool depth = r.is_depth_enabled();
+		r.enable_depth(false);
+		utki::scope_exit scope_exit([&r, depth]() {
+			r.enable_depth(depth);
+		});
+		render_environment();
+	}
+
+	if (!scene_v)
+		return;
+
 	constexpr ruis::vec4 default_light_position{2, 4, -2, 1};
 	constexpr ruis::vec3 default_light_intensity{2, 2, 2};
 
@@ -87,22 +107,31 @@ void scene_renderer::render(
 		main_light.intensity = default_light_intensity;
 	}
 
-	{
-		auto& r = this->context_v.get().ren().rendering_context.get();
-		bool depth = r.is_depth_enabled();
-		r.enable_depth(false);
-		utki::scope_exit scope_exit([&r, depth]() {
-			r.enable_depth(depth);
-		});
-		render_environment();
-	}
-
 	ruis::mat4 root_model_matrix;
 	root_model_matrix.set_identity();
 	root_model_matrix.scale(scene_scaling_factor);
 
-	for (const auto& node_v : scene_v->nodes) {
-		this->render_node(node_v.get(), root_model_matrix);
+	const draw_list::lod_parameters lod_params = {
+		.view_matrix = view_matrix,
+		.projection_scale = 1 / std::tan(cam->fovy / 2),
+		.thresholds = this->lod_thresholds
+	};
+
+	// node transformations could have been changed since the last frame
+	scene_v->update_transforms();
+	scene_v->update_bounds();
+
+	// frustum in scene coordinates, the viewport matrix is not included as it only places the view on screen
+	auto view_frustum = frustum::from_matrix(cam->get_projection_matrix(aspect) * view_matrix * root_model_matrix);
+
+	this->draw_list_v.build(*scene_v, root_model_matrix, &lod_params, &view_frustum);
+
+	const auto& transform_stats = scene_v->get_transform_hierarchy().get_last_update_statistics();
+	this->last_render_stats.num_local_matrix_updates = transform_stats.num_local_matrices;
+	this->last_render_stats.num_world_matrix_updates = transform_stats.num_world_matrices;
+	this->last_render_stats.culling = this->draw_list_v.get_culling_statistics();
+	for (const auto& b : this->draw_list_v.get_batches()) {
+		this->render_batch(b);
 	}
 }
 
@@ -143,50 +172,75 @@ void scene_renderer::render_environment()
 	);
 }
 
-void scene_renderer::render_node(
-	const node& n, //
-	const ruis::mat4& parent_tree_model_matrix
-)
+void scene_renderer::render_batch(const draw_list::batch& b)
 {
-	auto parent_model_matrix = parent_tree_model_matrix * n.get_transformation_matrix();
-
-	// TODO: why maybe_unused?
-	[[maybe_unused]] ruis::mat4 modelview_matrix = view_matrix * parent_model_matrix;
-	[[maybe_unused]] ruis::mat4 mvp_matrix = projection_matrix * modelview_matrix;
-
-	[[maybe_unused]] ruis::vec4 light_pos_view_coords =
-		view_matrix * main_light.pos; // light position in view (camera) coords
-
-	// render the node itself
-	if (n.mesh_v) {
-		for (const auto& primitive : n.mesh_v->primitives) {
-			// TODO: remove phong?
-			// [[maybe_unused]] const auto& phong = carcockpit::application::inst().shader_phong_v;
-			const auto& pbr = carcockpit::application::inst().shader_pbr_v;
-
-			// choose shader and textures here, set material-specific uniforms
-
-			const auto& tex_diffuse = primitive.get().material_v.get().tex_diffuse;
-			const auto& tex_normal = primitive.get().material_v.get().tex_normal;
-			const auto& tex_arm = primitive.get().material_v.get().tex_arm;
-
-			pbr.render(
-				primitive.get().vao.get(), //
-				mvp_matrix,
-				modelview_matrix,
-				projection_matrix,
-				tex_diffuse ? *tex_diffuse.get() : texture_default_white->tex(),
-				tex_normal ? *tex_normal.get() : texture_default_normal->tex(),
-				tex_arm ? *tex_arm.get() : texture_default_white->tex(),
-				texture_environment_cube ? texture_environment_cube->tex() : texture_default_environment_cube->tex(),
-				light_pos_view_coords,
-				main_light.intensity
-			);
-		}
+	ASSERT(b.primitive_v)
+	ASSERT(b.vao)
+	const auto& primitive = *b.primitive_v;
+	const auto& material = primitive.material_v.get();
+
+	ruis::vec4 light_pos_view_coords = view_matrix * main_light.pos; // light position in view (camera) coords
+
+	// choose textures here, set material-specific uniforms
+
+	const auto& tex_diffuse = material.tex_diffuse ? *material.tex_diffuse : texture_default_white->tex();
+	const auto& tex_normal = material.tex_normal ? *material.tex_normal : texture_default_normal->tex();
+	const auto& tex_arm = material.tex_arm ? *material.tex_arm : texture_default_white->tex();
+	const auto& tex_environment =
+		texture_environment_cube ? texture_environment_cube->tex() : texture_default_environment_cube->tex();
+
+	std::array<ruis::render::texture_wrapping, 3> wrapping = {
+		material.wrapping_diffuse,
+		material.wrapping_normal,
+		material.wrapping_arm,
+	};
+
+	this->last_render_stats.num_instances += b.model_matrices.size();
+	if (b.lod != 0) {
+		this->last_render_stats.num_lod_instances += b.model_matrices.size();
+	}
+
+	// instanced shader only supports interleaved vertex data, which is what the application loads
+	if (this->instancing_supported && b.model_matrices.size() > 1 && primitive.interleaved_layout) {
+		carcockpit::application::inst().shader_pbr_instanced_v.render(
+			*b.vao, //
+			primitive.interleaved_layout.value(),
+			b.model_matrices,
+			view_matrix,
+			projection_matrix,
+			tex_diffuse,
+			tex_normal,
+			tex_arm,
+			tex_environment,
+			light_pos_view_coords,
+			main_light.intensity,
+			wrapping
+		);
+		++this->last_render_stats.num_draw_calls;
+		++this->last_render_stats.num_instanced_draw_calls;
+		return;
 	}
 
-	// render children
-	for (const auto& node_v : n.children) {
-		this->render_node(node_v.get(), parent_model_matrix);
+	const auto& pbr = carcockpit::application::inst().shader_pbr_v;
+
+	for (const auto& model_matrix : b.model_matrices) {
+		ruis::mat4 modelview_matrix = view_matrix * model_matrix;
+		ruis::mat4 mvp_matrix = projection_matrix * modelview_matrix;
+
+		pbr.render(
+			*b.vao, //
+			mvp_matrix,
+			modelview_matrix,
+			projection_matrix,
+			tex_diffuse,
+			tex_normal,
+			tex_arm,
+			tex_environment,
+			light_pos_view_coords,
+			main_light.intensity,
+			primitive.interleaved_layout ? &primitive.interleaved_layout.value() : nullptr,
+			wrapping
+		);
+		++this->last_render_stats.num_draw_calls;
 	}
 }
@@ -26,6 +26,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <ruis/res/texture_2d.hpp>
 #include <ruis/res/texture_cube.hpp>
 
+#include "draw_list.hxx"
 #include "node.hpp"
 #include "scene.hpp"
 
@@ -33,6 +34,46 @@ namespace ruis::render {
 
 class scene_renderer
 {
+public:
+	struct render_statistics {
+		/**
+		 * @brief Number of draw calls, including instanced ones.
+		 */
+		size_t num_draw_calls = 0;
+
+		/**
+		 * @brief Number of instanced draw calls.
+		 */
+		size_t num_instanced_draw_calls = 0;
+
+		/**
+		 * @brief Number of drawn primitive instances.
+		 */
+		size_t num_instances = 0;
+
+		/**
+		 * @brief Number of primitive instances drawn with a simplified level of detail.
+		 */
+		size_t num_lod_instances = 0;
+
+		/**
+		 * @brief Number of node local matrices recalculated for the frame.
+		 * Only the nodes whose transformations have changed since the previous frame are recalculated.
+		 */
+		size_t num_local_matrix_updates = 0;
+
+		/**
+		 * @brief Number of node world matrices recalculated for the frame.
+		 * Includes the changed nodes and all their descendants.
+		 */
+		size_t num_world_matrix_updates = 0;
+
+		/**
+		 * @brief View frustum culling statistics of the frame.
+		 */
+		draw_list::culling_statistics culling;
+	};
+
 protected:
 	std::shared_ptr<ruis::render::vertex_array> fullscreen_quad_vao;
 	std::shared_ptr<ruis::render::scene> scene_v;
@@ -49,15 +90,30 @@ protected:
 	std::shared_ptr<const ruis::res::texture_cube> texture_default_environment_cube;
 	std::shared_ptr<const ruis::res::texture_cube> texture_environment_cube;
 
-	void render_node(
-		const node& n, //
-		const ruis::mat4& parent_tree_model_matrix
-	);
+	// reused between frames to avoid memory allocations
+	draw_list draw_list_v;
+
+	// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+	std::vector<ruis::real> lod_thresholds = {0.5, 0.25, 0.125};
+
+	bool instancing_supported;
+
+	render_statistics last_render_stats;
+
+	void render_batch(const draw_list::batch& b);
 	void render_environment();
 	void prepare_fullscreen_quad_vao();
 
 public:
 	scene_renderer(utki::shared_ref<ruis::context> c);
+
+	/**
+	 * @brief Render the scene over the environment.
+	 * In case the scene is not set, e.g. while it is being loaded, only the environment is rendered,
+	 * which requires the external camera to be set.
+	 * @param dims - dimensions of the viewport.
+	 * @param viewport_matrix - matrix which places the viewport on screen.
+	 */
 	void render(
 		const ruis::vec2& dims, //
 		const ruis::mat4& viewport_matrix
@@ -66,6 +122,24 @@ public:
 	void set_scene_scaling_factor(ruis::real scene_scaling_factor);
 	void set_environment_cube(std::shared_ptr<const ruis::res::texture_cube> texture_environment_cube);
 	void set_external_camera(std::shared_ptr<ruis::render::camera> cam);
+
+	/**
+	 * @brief Set screen coverage thresholds of the levels of detail.
+	 * See draw_list::lod_parameters::thresholds. Empty thresholds disable level of detail selection,
+	 * except for the nodes having their own screen coverage thresholds.
+	 * Default thresholds are 0.5, 0.25 and 0.125.
+	 * @param thresholds - thresholds in descending order.
+	 */
+	void set_lod_thresholds(std::vector<ruis::real> thresholds);
+
+	/**
+	 * @brief Get statistics of the last render() call.
+	 * @return Render statistics.
+	 */
+	const render_statistics& get_last_render_statistics() const noexcept
+	{
+		return this->last_render_stats;
+	}
 };
 
 } // namespace ruis::render
\ No newline at end of file
@@ -0,0 +1,247 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "tangent_space.hxx"
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+using namespace ruis::render;
+
+namespace {
+// number of triangles processed in one batch, small enough for batch arrays to stay in L1 cache
+constexpr size_t batch_size = 64;
+
+using batch_type = std::array<float, batch_size>;
+
+struct vec3_soa {
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+
+	vec3_soa(size_t size) :
+		x(size, 0),
+		y(size, 0),
+		z(size, 0)
+	{}
+};
+} // namespace
+
+template <typename index_type>
+tangent_space ruis::render::make_tangent_space(
+	utki::span<const index_type> indices,
+	utki::span<const ruis::vec3> positions,
+	utki::span<const ruis::vec2> texcoords,
+	utki::span<const ruis::vec3> normals
+)
+{
+	const size_t num_vertices = positions.size();
+
+	if (texcoords.size() != num_vertices || normals.size() != num_vertices) {
+		throw std::invalid_argument("make_tangent_space(): vertex attributes have different number of elements");
+	}
+
+	// accumulated per-vertex tangents and bitangents
+	vec3_soa tan(num_vertices);
+	vec3_soa bitan(num_vertices);
+
+	const size_t num_triangles = indices.size() / 3;
+
+	for (size_t first = 0; first < num_triangles; first += batch_size) {
+		const size_t count = std::min(batch_size, num_triangles - first);
+
+		// triangle edges in 3d space
+		batch_type e1x, e1y, e1z, e2x, e2y, e2z;
+		// triangle edges in texture space
+		batch_type u1, v1, u2, v2;
+
+		// gather
+		for (size_t i = 0; i != count; ++i) {
+			auto tri = indices.subspan((first + i) * 3, 3);
+			if (tri[0] >= num_vertices || tri[1] >= num_vertices || tri[2] >= num_vertices) {
+				throw std::invalid_argument("make_tangent_space(): vertex index out of range");
+			}
+
+			const auto& p0 = positions[tri[0]];
+			const auto& p1 = positions[tri[1]];
+			const auto& p2 = positions[tri[2]];
+
+			e1x[i] = p1.x() - p0.x();
+			e1y[i] = p1.y() - p0.y();
+			e1z[i] = p1.z() - p0.z();
+			e2x[i] = p2.x() - p0.x();
+			e2y[i] = p2.y() - p0.y();
+			e2z[i] = p2.z() - p0.z();
+
+			const auto& t0 = texcoords[tri[0]];
+			const auto& t1 = texcoords[tri[1]];
+			const auto& t2 = texcoords[tri[2]];
+
+			u1[i] = t1.x() - t0.x();
+			v1[i] = t1.y() - t0.y();
+			u2[i] = t2.x() - t0.x();
+			v2[i] = t2.y() - t0.y();
+		}
+
+		// Calculate the triangle tangent and bitangent.
+		//
+		// We want to map vectors (1, 0) and (0, 1) from texture space to 3d space (to tangent and bitangent vectors).
+		//
+		// vec2 te1 = (u1, v1), te2 = (u2, v2) : triangle edges in texture space
+		// vec3 e1, e2 : triangle edges in 3d space
+		//
+		// Vectors (1, 0) and (0, 1) as a linear combination of te1 and te2:
+		//
+		// (1, 0) = te1 * a11 + te2 * a21
+		// (0, 1) = te1 * a12 + te2 * a22
+		//
+		// In matrix form:
+		//
+		// | u1 u2 | * | a11 a12 | = | 1 0 |        <->        T * A = I
+		// | v1 v2 |   | a21 a22 |   | 0 1 |
+		//
+		// So, A is the inverse of T:
+		//
+		// A = 1 / det(T) * |  v2 -u2 |
+		//                  | -v1  u1 |
+		//
+		// Then, tangent and bitangent vectors are linear combinations of e1 and e2 with same aXX coefficients.
+		//
+		// tangent = e1 * a11 + e2 * a21 = (e1 * v2 - e2 * v1) / det(T)
+		// bitangent = e1 * a12 + e2 * a22 = (e2 * u1 - e1 * u2) / det(T)
+		//
+		// In case the triangle is degenerate in texture space, use (1, 0, 0) and (0, 1, 0).
+
+		batch_type tx, ty, tz, bx, by, bz;
+
+		constexpr auto epsilon = 1e-5f;
+
+		// no branches and no function calls, so this loop is vectorized by the compiler
+		for (size_t i = 0; i != count; ++i) {
+			float det = u1[i] * v2[i] - u2[i] * v1[i];
+			bool degenerate = std::abs(det) < epsilon;
+			float r = degenerate ? 0.0f : 1.0f / det;
+
+			tx[i] = degenerate ? 1.0f : (e1x[i] * v2[i] - e2x[i] * v1[i]) * r;
+			ty[i] = (e1y[i] * v2[i] - e2y[i] * v1[i]) * r;
+			tz[i] = (e1z[i] * v2[i] - e2z[i] * v1[i]) * r;
+
+			bx[i] = (e2x[i] * u1[i] - e1x[i] * u2[i]) * r;
+			by[i] = degenerate ? 1.0f : (e2y[i] * u1[i] - e1y[i] * u2[i]) * r;
+			bz[i] = (e2z[i] * u1[i] - e1z[i] * u2[i]) * r;
+		}
+
+		// scatter, accumulate the tangents and bitangents for triangle vertices
+		for (size_t i = 0; i != count; ++i) {
+			auto tri = indices.subspan((first + i) * 3, 3);
+			for (auto v : tri) {
+				tan.x[v] += tx[i];
+				tan.y[v] += ty[i];
+				tan.z[v] += tz[i];
+				bitan.x[v] += bx[i];
+				bitan.y[v] += by[i];
+				bitan.z[v] += bz[i];
+			}
+		}
+	}
+
+	vec3_soa norm(num_vertices);
+	for (size_t i = 0; i != num_vertices; ++i) {
+		norm.x[i] = normals[i].x();
+		norm.y[i] = normals[i].y();
+		norm.z[i] = normals[i].z();
+	}
+
+	// Orthogonalize and normalize the vertex tangents.
+	//
+	// Tangent and bitangent are not necessarily ortogonal to each other, but those have to be
+	// ortogonal to the normal.
+	auto orthonormalize = [&](vec3_soa& vec) {
+		for (size_t i = 0; i != num_vertices; ++i) {
+			float d = norm.x[i] * vec.x[i] + norm.y[i] * vec.y[i] + norm.z[i] * vec.z[i];
+			float x = vec.x[i] - d * norm.x[i];
+			float y = vec.y[i] - d * norm.y[i];
+			float z = vec.z[i] - d * norm.z[i];
+
+			float len = std::sqrt(x * x + y * y + z * z);
+			float r = len > 0.0f ? 1.0f / len : 0.0f;
+
+			vec.x[i] = x * r;
+			vec.y[i] = y * r;
+			vec.z[i] = z * r;
+		}
+	};
+
+	orthonormalize(tan);
+	orthonormalize(bitan);
+
+	// TODO: The triangle in texture space can be wound in different direction than in object space,
+	// need to flip the tangent basis to make normals from normal map point towards triangle normal direction.
+
+	tangent_space ret;
+	ret.tangents.resize(num_vertices);
+	ret.bitangents.resize(num_vertices);
+	for (size_t i = 0; i != num_vertices; ++i) {
+		ret.tangents[i] = ruis::vec3(tan.x[i], tan.y[i], tan.z[i]);
+		ret.bitangents[i] = ruis::vec3(bitan.x[i], bitan.y[i], bitan.z[i]);
+	}
+
+	return ret;
+}
+
+template tangent_space ruis::render::make_tangent_space<uint16_t>(
+	utki::span<const uint16_t> indices,
+	utki::span<const ruis::vec3> positions,
+	utki::span<const ruis::vec2> texcoords,
+	utki::span<const ruis::vec3> normals
+);
+
+template tangent_space ruis::render::make_tangent_space<uint32_t>(
+	utki::span<const uint32_t> indices,
+	utki::span<const ruis::vec3> positions,
+	utki::span<const ruis::vec2> texcoords,
+	utki::span<const ruis::vec3> normals
+);
+
+tangent_space ruis::render::make_tangent_space(
+	utki::span<const ruis::vec4> tangents, //
+	utki::span<const ruis::vec3> normals
+)
+{
+	if (tangents.size() != normals.size()) {
+		throw std::invalid_argument("make_tangent_space(): tangents and normals have different number of elements");
+	}
+
+	tangent_space ret;
+	ret.tangents.reserve(tangents.size());
+	ret.bitangents.reserve(tangents.size());
+
+	for (size_t i = 0; i != tangents.size(); ++i) {
+		const auto& t = tangents[i];
+		ruis::vec3 tangent(t.x(), t.y(), t.z());
+
+		ret.tangents.push_back(tangent);
+		ret.bitangents.push_back(normals[i].cross(tangent) * t.w());
+	}
+
+	return ret;
+}
@@ -0,0 +1,86 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <vector>
+
+#include <ruis/config.hpp>
+#include <utki/span.hpp>
+
+namespace ruis::render {
+
+/**
+ * @brief Per-vertex tangent space basis vectors.
+ * Tangent is the texture space x-axis and bitangent is the texture space y-axis,
+ * both expressed in object space.
+ */
+struct tangent_space {
+	std::vector<ruis::vec3> tangents;
+	std::vector<ruis::vec3> bitangents;
+};
+
+/**
+ * @brief Calculate per-vertex tangent space from triangle geometry and texture coordinates.
+ * Triangles are processed in batches. Per-triangle data of a batch is gathered into structure-of-arrays
+ * form, so that the arithmetic is done by branch-free loops which the compiler auto-vectorizes.
+ * @param indices - triangle list indices.
+ * @param positions - vertex positions.
+ * @param texcoords - vertex texture coordinates.
+ * @param normals - vertex normals.
+ * @return Per-vertex tangent space, orthogonalized to the normals and normalized.
+ */
+template <typename index_type>
+tangent_space make_tangent_space(
+	utki::span<const index_type> indices,
+	utki::span<const ruis::vec3> positions,
+	utki::span<const ruis::vec2> texcoords,
+	utki::span<const ruis::vec3> normals
+);
+
+extern template tangent_space make_tangent_space<uint16_t>(
+	utki::span<const uint16_t> indices,
+	utki::span<const ruis::vec3> positions,
+	utki::span<const ruis::vec2> texcoords,
+	utki::span<const ruis::vec3> normals
+);
+
+extern template tangent_space make_tangent_space<uint32_t>(
+	utki::span<const uint32_t> indices,
+	utki::span<const ruis::vec3> positions,
+	utki::span<const ruis::vec2> texcoords,
+	utki::span<const ruis::vec3> normals
+);
+
+/**
+ * @brief Make tangent space from tangents given in glTF file.
+ * As defined by glTF spec, the bitangent is reconstructed as cross(normal, tangent.xyz) * tangent.w,
+ * where tangent.w is +1 or -1 indicating the handedness of the tangent basis.
+ * @param tangents - vertex tangents with handedness sign in w component.
+ * @param normals - vertex normals.
+ * @return Per-vertex tangent space.
+ */
+tangent_space make_tangent_space(
+	utki::span<const ruis::vec4> tangents, //
+	utki::span<const ruis::vec3> normals
+);
+
+} // namespace ruis::render
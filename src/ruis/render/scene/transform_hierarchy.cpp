@@ -0,0 +1,136 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "transform_hierarchy.hpp"
+
+#include <stdexcept>
+
+using namespace ruis::render;
+
+uint32_t transform_hierarchy::add(
+	uint32_t parent, //
+	const transformation_variant& t
+)
+{
+	auto index = uint32_t(this->parents.size());
+
+	if (parent != no_parent && parent >= index) {
+		throw std::invalid_argument("transform_hierarchy::add(): parent node is not added");
+	}
+
+	this->parents.push_back(parent);
+	this->translations.emplace_back();
+	this->rotations.emplace_back();
+	this->scales.emplace_back();
+	this->is_matrix.emplace_back();
+	this->local_matrices.emplace_back();
+	this->world_matrices.emplace_back();
+	this->dirty.emplace_back();
+	this->world_changed.emplace_back();
+
+	this->set_transformation(index, t);
+
+	this->local_matrices[index] = this->calculate_local_matrix(index);
+	this->world_matrices[index] = parent == no_parent ? this->local_matrices[index]
+													  : this->world_matrices[parent] * this->local_matrices[index];
+	this->dirty[index] = false;
+	this->world_changed[index] = true;
+
+	return index;
+}
+
+transformation_variant transform_hierarchy::get_transformation(uint32_t index) const
+{
+	if (this->is_matrix[index]) {
+		return this->local_matrices[index];
+	}
+
+	return trs_transformation{
+		.translation = this->translations[index],
+		.rotation = this->rotations[index],
+		.scale = this->scales[index]
+	};
+}
+
+void transform_hierarchy::set_transformation(
+	uint32_t index, //
+	const transformation_variant& t
+)
+{
+	if (std::holds_alternative<ruis::mat4>(t)) {
+		// matrix transformation is the local matrix, nothing to calculate
+		this->local_matrices[index] = std::get<ruis::mat4>(t);
+		this->is_matrix[index] = true;
+	} else {
+		ASSERT(std::holds_alternative<trs_transformation>(t))
+		const auto& trs = std::get<trs_transformation>(t);
+		this->translations[index] = trs.translation;
+		this->rotations[index] = trs.rotation;
+		this->scales[index] = trs.scale;
+		this->is_matrix[index] = false;
+	}
+	this->dirty[index] = true;
+}
+
+ruis::mat4 transform_hierarchy::calculate_local_matrix(uint32_t index) const
+{
+	if (this->is_matrix[index]) {
+		return this->local_matrices[index];
+	}
+
+	const trs_transformation trs{
+		.translation = this->translations[index],
+		.rotation = this->rotations[index],
+		.scale = this->scales[index]
+	};
+	return trs.to_matrix();
+}
+
+void transform_hierarchy::update()
+{
+	this->last_update = {};
+
+	for (uint32_t i = 0; i != this->parents.size(); ++i) {
+		auto p = this->parents[i];
+		ASSERT(p == no_parent || p < i)
+
+		bool changed = this->dirty[i];
+		if (changed) {
+			if (!this->is_matrix[i]) {
+				this->local_matrices[i] = this->calculate_local_matrix(i);
+				++this->last_update.num_local_matrices;
+			}
+			this->dirty[i] = false;
+		}
+
+		// parent goes before its children, so its flag is already set in this pass
+		changed = changed || (p != no_parent && this->world_changed[p]);
+		this->world_changed[i] = changed;
+
+		if (!changed) {
+			continue;
+		}
+
+		this->world_matrices[i] =
+			p == no_parent ? this->local_matrices[i] : this->world_matrices[p] * this->local_matrices[i];
+		++this->last_update.num_world_matrices;
+	}
+}
@@ -0,0 +1,238 @@
+/*
+carcockpit - Car cockpit example GUI project
+
+Copyright (C) 2024-2025 Gagistech Oy <gagisechoy@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <utki/span.hpp>
+
+#include "node.hpp"
+
+namespace ruis::render {
+
+/**
+ * @brief Flattened hierarchy of node transformations.
+ * Nodes are stored in topological order, i.e. a parent node always goes before its children,
+ * so world matrices of all the nodes are calculated in one linear pass over the arrays, see update().
+ * Transformations are kept in structure-of-arrays layout, so that the pass walks contiguous memory
+ * instead of chasing pointers through the node tree.
+ */
+class transform_hierarchy
+{
+public:
+	/**
+	 * @brief Parent index of root nodes.
+	 */
+	constexpr static uint32_t no_parent = std::numeric_limits<uint32_t>::max();
+
+	/**
+	 * @brief Statistics of an update() call.
+	 */
+	struct update_statistics {
+		/**
+		 * @brief Number of local matrices recalculated from translation, rotation and scale.
+		 */
+		size_t num_local_matrices = 0;
+
+		/**
+		 * @brief Number of recalculated world matrices.
+		 */
+		size_t num_world_matrices = 0;
+	};
+
+private:
+	std::vector<uint32_t> parents;
+
+	std::vector<ruis::vec3> translations;
+	std::vector<ruis::quat> rotations;
+	std::vector<ruis::vec3> scales;
+	std::vector<uint8_t> is_matrix;
+
+	// cached local matrices, for nodes with matrix transformation those are the transformations themselves
+	std::vector<ruis::mat4> local_matrices;
+	std::vector<ruis::mat4> world_matrices;
+
+	// whether the node's transformation has been changed since the last update() call
+	std::vector<uint8_t> dirty;
+
+	// whether the node's world matrix has been recalculated by the last update() call
+	std::vector<uint8_t> world_changed;
+
+	update_statistics last_update;
+
+	ruis::mat4 calculate_local_matrix(uint32_t index) const;
+
+public:
+	/**
+	 * @brief Add node.
+	 * The node's world matrix is calculated right away.
+	 * @param parent - index of the parent node or no_parent for a root node.
+	 *                 The parent node must be added before its children.
+	 * @param t - transformation of the node relative to its parent.
+	 * @return Index of the added node.
+	 * @throw std::invalid_argument - if the parent node has not been added.
+	 */
+	uint32_t add(
+		uint32_t parent, //
+		const transformation_variant& t
+	);
+
+	size_t size() const noexcept
+	{
+		return this->parents.size();
+	}
+
+	uint32_t get_parent(uint32_t index) const
+	{
+		return this->parents[index];
+	}
+
+	utki::span<const uint32_t> get_parents() const noexcept
+	{
+		return this->parents;
+	}
+
+	transformation_variant get_transformation(uint32_t index) const;
+
+	/**
+	 * @brief Set node's transformation relative to its parent.
+	 * Marks the node dirty. Matrices of the node and of its subtree are not updated until next update() call.
+	 * @param index - index of the node.
+	 * @param t - new transformation.
+	 */
+	void set_transformation(
+		uint32_t index, //
+		const transformation_variant& t
+	);
+
+	/**
+	 * @brief Set translation of a node.
+	 * Same as set_transformation(), but only changes translation. The node must have translation, rotation
+	 * and scale transformation.
+	 * @param index - index of the node.
+	 * @param translation - new translation.
+	 */
+	void set_translation(
+		uint32_t index, //
+		const ruis::vec3& translation
+	)
+	{
+		ASSERT(!this->is_matrix[index])
+		this->translations[index] = translation;
+		this->dirty[index] = true;
+	}
+
+	/**
+	 * @brief Set rotation of a node.
+	 * Same as set_transformation(), but only changes rotation. The node must have translation, rotation
+	 * and scale transformation.
+	 * @param index - index of the node.
+	 * @param rotation - new rotation.
+	 */
+	void set_rotation(
+		uint32_t index, //
+		const ruis::quat& rotation
+	)
+	{
+		ASSERT(!this->is_matrix[index])
+		this->rotations[index] = rotation;
+		this->dirty[index] = true;
+	}
+
+	/**
+	 * @brief Set scale of a node.
+	 * Same as set_transformation(), but only changes scale. The node must have translation, rotation
+	 * and scale transformation.
+	 * @param index - index of the node.
+	 * @param scale - new scale.
+	 */
+	void set_scale(
+		uint32_t index, //
+		const ruis::vec3& scale
+	)
+	{
+		ASSERT(!this->is_matrix[index])
+		this->scales[index] = scale;
+		this->dirty[index] = true;
+	}
+
+	/**
+	 * @brief Get node's transformation matrix relative to its parent.
+	 * @param index - index of the node.
+	 * @return The node's local transformation matrix.
+	 */
+	ruis::mat4 get_local_matrix(uint32_t index) const
+	{
+		if (this->dirty[index] && !this->is_matrix[index]) {
+			return this->calculate_local_matrix(index);
+		}
+		return this->local_matrices[index];
+	}
+
+	/**
+	 * @brief Get node's world matrix.
+	 * @param index - index of the node.
+	 * @return The node's transformation matrix relative to the hierarchy root, as of the last update() call.
+	 */
+	const ruis::mat4& get_world_matrix(uint32_t index) const
+	{
+		return this->world_matrices[index];
+	}
+
+	utki::span<const ruis::mat4> get_world_matrices() const noexcept
+	{
+		return this->world_matrices;
+	}
+
+	/**
+	 * @brief Check if node's world matrix has been changed by the last update() call.
+	 * Newly added nodes are reported as changed until the next update() call.
+	 * @param index - index of the node.
+	 * @return true if the node's world matrix has been recalculated.
+	 */
+	bool is_world_matrix_changed(uint32_t index) const
+	{
+		return this->world_changed[index];
+	}
+
+	/**
+	 * @brief Update world matrices of the dirty nodes and their subtrees.
+	 * Single pass over the nodes in their order. Local matrix is recalculated only for a dirty node.
+	 * World matrix is recalculated for a dirty node and for a node whose parent's world matrix
+	 * has been recalculated in the same pass, so the change is pushed down to the whole subtree.
+	 * Clean subtrees are not touched.
+	 */
+	void update();
+
+	/**
+	 * @brief Get statistics of the last update() call.
+	 * @return Numbers of matrices recalculated by the last update() call.
+	 */
+	const update_statistics& get_last_update_statistics() const noexcept
+	{
+		return this->last_update;
+	}
+};
+
+} // namespace ruis::render
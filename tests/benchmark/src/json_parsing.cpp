@@ -0,0 +1,136 @@
+#include "json_parsing.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <jsondom/dom.hpp>
+#include <ruis/render/scene/json_reader.hxx>
+#include <utki/span.hpp>
+#include <utki/string.hpp>
+
+using namespace std::string_view_literals;
+
+using namespace benchmark;
+
+namespace {
+constexpr size_t num_elements = 20'000;
+
+utki::span<const uint8_t> to_span(std::string_view text)
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	return utki::make_span(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+std::string make_synthetic_gltf()
+{
+	std::string ret = R"({"asset":{"version":"2.0"},"accessors":[)";
+	for (size_t i = 0; i != num_elements; ++i) {
+		if (i != 0) {
+			ret += ',';
+		}
+		ret += utki::cat(
+			R"({"bufferView":)",
+			i,
+			R"(,"byteOffset":0,"componentType":5126,"count":)",
+			i * 3 + 1,
+			R"(,"type":"VEC3","max":[1.5,2.25,-3.125],"min":[-1.5,-2.25,3.125]})"
+		);
+	}
+	ret += R"(],"nodes":[)";
+	for (size_t i = 0; i != num_elements; ++i) {
+		if (i != 0) {
+			ret += ',';
+		}
+		ret += utki::cat(
+			R"({"name":"node_)",
+			i,
+			R"(","mesh":)",
+			i,
+			R"(,"translation":[0.5,-1e-3,12.75],"rotation":[0,0,0.7071068,0.7071068],"children":[)",
+			i + 1,
+			',',
+			i + 2,
+			"]}"
+		);
+	}
+	ret += "]}";
+	return ret;
+}
+
+double traverse_jsondom(const jsondom::value& json)
+{
+	double sum = 0;
+	for (const auto& acc : json.object().at("accessors").array()) {
+		sum += acc.object().at("count").number().to_float();
+		sum += acc.object().at("max").array()[1].number().to_float();
+	}
+	for (const auto& node : json.object().at("nodes").array()) {
+		sum += double(node.object().at("name").string().size());
+		for (const auto& t : node.object().at("translation").array()) {
+			sum += t.number().to_float();
+		}
+		for (const auto& c : node.object().at("children").array()) {
+			sum += c.number().to_float();
+		}
+	}
+	return sum;
+}
+
+double traverse_json_reader(ruis::render::json_value json)
+{
+	double sum = 0;
+	for (auto acc : json.get("accessors"sv)) {
+		sum += acc.get("count"sv).to_float();
+		sum += acc.get("max"sv)[1].to_float();
+	}
+	for (auto node : json.get("nodes"sv)) {
+		sum += double(node.get("name"sv).string().size());
+		for (auto t : node.get("translation"sv)) {
+			sum += t.to_float();
+		}
+		for (auto c : node.get("children"sv)) {
+			sum += c.to_float();
+		}
+	}
+	return sum;
+}
+} // namespace
+
+json_parsing_times benchmark::measure_json_parsing(unsigned num_iterations)
+{
+	using clock = std::chrono::steady_clock;
+
+	auto text = make_synthetic_gltf();
+	auto span = to_span(text);
+
+	json_parsing_times ret;
+	ret.text_size = text.size();
+
+	// first iteration warms up the caches and is not measured
+	for (unsigned i = 0; i != num_iterations + 1; ++i) {
+		auto start = clock::now();
+		auto dom = jsondom::read(span);
+		double dom_sum = traverse_jsondom(dom);
+		auto dom_time = std::chrono::nanoseconds(clock::now() - start).count();
+
+		start = clock::now();
+		ruis::render::json_document doc(span);
+		double reader_sum = traverse_json_reader(doc.root());
+		auto reader_time = std::chrono::nanoseconds(clock::now() - start).count();
+
+		if (reader_sum != dom_sum) {
+			throw std::logic_error(utki::cat("json_reader result ", reader_sum, " differs from jsondom ", dom_sum));
+		}
+
+		if (i == 0) {
+			continue;
+		}
+
+		ret.jsondom.push_back(uint64_t(dom_time));
+		ret.json_reader.push_back(uint64_t(reader_time));
+	}
+
+	return ret;
+}
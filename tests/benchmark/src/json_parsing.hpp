@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace benchmark {
+
+struct json_parsing_times {
+	// size of the parsed JSON text in bytes
+	size_t text_size = 0;
+
+	// times of parsing and traversing the text in nanoseconds, one per iteration
+	std::vector<uint64_t> jsondom;
+	std::vector<uint64_t> json_reader;
+};
+
+/**
+ * @brief Measure glTF JSON parsing by the loader's JSON reader against jsondom.
+ * The parsed text is a large synthetic glTF JSON with lots of small objects,
+ * similar to big real world scenes. Both parsers access same members of each object,
+ * the way the loader does.
+ * @param num_iterations - number of measured parses by each parser.
+ * @return The measured times.
+ * @throw std::logic_error - if the parsers produce different values.
+ */
+json_parsing_times measure_json_parsing(unsigned num_iterations);
+
+} // namespace benchmark
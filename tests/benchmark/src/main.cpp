@@ -0,0 +1,557 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <clargs/parser.hpp>
+#include <fsif/native_file.hpp>
+#include <fsif/span_file.hpp>
+#include <ruis/render/null/context.hpp>
+#include <ruis/render/scene/bvh.hpp>
+#include <ruis/render/scene/draw_list.hxx>
+#include <ruis/render/scene/gltf_loader.hxx>
+#include <utki/string.hpp>
+
+#include "json_parsing.hpp"
+#include "synthetic_scenes.hpp"
+
+using namespace std::string_view_literals;
+
+namespace {
+// counts all memory allocations of the process, see the replaced operator new below
+std::atomic<size_t> num_allocations{0};
+} // namespace
+
+// Replaced global allocation function, so that allocations made during loading can be counted.
+// Array and nothrow versions call this one. Note that it does not work together with address sanitizer.
+void* operator new(std::size_t size)
+{
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t /* size */) noexcept
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+	std::free(p);
+}
+
+namespace {
+using stage = ruis::render::load_statistics::stage;
+
+constexpr std::array<std::string_view, size_t(stage::enum_size)> stage_names = {
+	"file_read",
+	"json_parse",
+	"buffer_decode",
+	"image_decode",
+	"accessor_decode",
+	"tangent_generation",
+	"index_optimization",
+	"lod_generation",
+	"scene_build",
+	"gpu_upload"
+};
+
+struct input {
+	std::string name;
+	size_t file_size;
+	std::unique_ptr<fsif::file> fi;
+
+	// keeps the content of the span file alive
+	std::vector<uint8_t> content;
+};
+
+struct summary {
+	uint64_t min = 0;
+	uint64_t median = 0;
+	uint64_t p99 = 0;
+};
+
+summary summarize(std::vector<uint64_t> values)
+{
+	if (values.empty()) {
+		return {};
+	}
+
+	std::sort(values.begin(), values.end());
+
+	// nearest-rank percentile
+	auto percentile = [&](size_t p) {
+		constexpr auto percent = 100;
+		size_t rank = (p * values.size() + percent - 1) / percent;
+		return values[std::max(rank, size_t(1)) - 1];
+	};
+
+	return {
+		.min = values.front(),
+		.median = values[values.size() / 2],
+		.p99 = percentile(99) // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	};
+}
+
+std::string to_json(const summary& s)
+{
+	return utki::cat(R"({"min":)", s.min, R"(,"median":)", s.median, R"(,"p99":)", s.p99, "}");
+}
+
+std::string join(const std::vector<std::string>& items)
+{
+	std::string ret;
+	for (const auto& i : items) {
+		if (!ret.empty()) {
+			ret += ',';
+		}
+		ret += i;
+	}
+	return ret;
+}
+
+std::string escape_json(std::string_view str)
+{
+	std::string ret;
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			ret += '\\';
+		}
+		ret += c;
+	}
+	return ret;
+}
+
+struct result {
+	std::string name;
+	size_t file_size = 0;
+
+	// statistics of the last iteration, sizes and counts are same for all iterations
+	ruis::render::load_statistics last;
+
+	std::array<summary, size_t(stage::enum_size)> stage_times;
+	std::array<summary, size_t(stage::enum_size)> stage_allocations;
+	summary total_time;
+	summary total_allocations;
+
+	// CPU time of preparing a frame of the loaded scene: animations, transforms, bounds and draw list
+	summary frame_time;
+
+	// CPU time of applying the scene animations, part of the frame time
+	size_t num_animation_channels = 0;
+	summary animation_time;
+
+	// spatial index of the loaded scene
+	size_t num_bvh_items = 0;
+	uint64_t bvh_build_time = 0;
+	uint64_t bvh_refit_time = 0;
+	uint64_t picks_per_second = 0;
+	size_t num_pick_hits = 0;
+};
+
+constexpr unsigned num_frames = 100;
+
+constexpr unsigned num_picks = 10000;
+
+void measure_picks(
+	const ruis::render::scene& s, //
+	result& r
+)
+{
+	using clock = std::chrono::steady_clock;
+
+	ruis::render::bvh bvh;
+
+	auto start = clock::now();
+	bvh.build(s);
+	r.bvh_build_time = uint64_t(std::chrono::nanoseconds(clock::now() - start).count());
+	r.num_bvh_items = bvh.get_items().size();
+
+	start = clock::now();
+	bvh.refit(s);
+	r.bvh_refit_time = uint64_t(std::chrono::nanoseconds(clock::now() - start).count());
+
+	// rays from a sphere around the scene to random points inside of the scene bounds, same for each run
+	auto bounds = s.get_bounds();
+	if (bounds.is_empty()) {
+		return;
+	}
+	auto center = bounds.get_center();
+	auto radius = bounds.get_extent().norm() * 2 + 1;
+
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<ruis::real> dist(-1, 1);
+
+	std::vector<ruis::render::ray> rays;
+	rays.reserve(num_picks);
+	for (unsigned i = 0; i != num_picks; ++i) {
+		ruis::vec3 dir{dist(gen), dist(gen), dist(gen)};
+		dir.normalize();
+		ruis::vec3 target = center + bounds.get_extent().comp_mul(ruis::vec3{dist(gen), dist(gen), dist(gen)});
+		auto origin = center + dir * radius;
+		rays.push_back({.origin = origin, .direction = target - origin});
+	}
+
+	start = clock::now();
+	for (const auto& ray : rays) {
+		if (bvh.find_closest_hit(ray)) {
+			++r.num_pick_hits;
+		}
+	}
+	auto time = std::chrono::nanoseconds(clock::now() - start).count();
+
+	r.picks_per_second = time == 0 ? 0 : uint64_t(uint64_t(num_picks) * std::nano::den / uint64_t(time));
+}
+
+void measure_frames(
+	ruis::render::scene& s, //
+	result& r
+)
+{
+	using clock = std::chrono::steady_clock;
+
+	// 60 frames per second
+	constexpr uint32_t frame_duration_ms = 16;
+
+	for (const auto& a : s.animations) {
+		r.num_animation_channels += a.get().get_channels().size();
+	}
+
+	auto root_model_matrix = ruis::mat4().set_identity();
+	ruis::render::draw_list dl;
+
+	std::vector<uint64_t> times;
+	std::vector<uint64_t> animation_times;
+	for (unsigned i = 0; i != num_frames; ++i) {
+		auto start = clock::now();
+
+		s.update(frame_duration_ms);
+		animation_times.push_back(uint64_t(std::chrono::nanoseconds(clock::now() - start).count()));
+
+		s.update_transforms();
+		s.update_bounds();
+		dl.build(s, root_model_matrix);
+
+		times.push_back(uint64_t(std::chrono::nanoseconds(clock::now() - start).count()));
+	}
+
+	r.frame_time = summarize(std::move(times));
+	r.animation_time = summarize(std::move(animation_times));
+}
+
+result run(
+	ruis::render::context& rc, //
+	const ruis::render::gltf_loader::parameters& params,
+	const input& in,
+	unsigned num_iterations
+)
+{
+	std::array<std::vector<uint64_t>, size_t(stage::enum_size)> times;
+	std::array<std::vector<uint64_t>, size_t(stage::enum_size)> allocations;
+	std::vector<uint64_t> total_times;
+	std::vector<uint64_t> total_allocations;
+
+	ruis::render::load_statistics stats;
+	stats.allocation_counter = &num_allocations;
+
+	std::shared_ptr<ruis::render::scene> last_scene;
+
+	// first iteration warms up the caches and is not measured
+	for (unsigned i = 0; i != num_iterations + 1; ++i) {
+		ruis::render::gltf_loader l(rc, params);
+		auto scene = l.load(*in.fi, &stats);
+		last_scene = scene.to_shared_ptr();
+
+		if (i == 0) {
+			continue;
+		}
+
+		uint64_t num_allocs = 0;
+		for (size_t s = 0; s != size_t(stage::enum_size); ++s) {
+			times[s].push_back(uint64_t(stats.stage_times[s].count()));
+			allocations[s].push_back(stats.stage_allocations[s]);
+			num_allocs += stats.stage_allocations[s];
+		}
+		total_times.push_back(uint64_t(stats.get_total_time().count()));
+		total_allocations.push_back(num_allocs);
+	}
+
+	result ret;
+	ret.name = in.name;
+	ret.file_size = in.file_size;
+	ret.last = stats;
+
+	for (size_t s = 0; s != size_t(stage::enum_size); ++s) {
+		ret.stage_times[s] = summarize(std::move(times[s]));
+		ret.stage_allocations[s] = summarize(std::move(allocations[s]));
+	}
+	ret.total_time = summarize(std::move(total_times));
+	ret.total_allocations = summarize(std::move(total_allocations));
+
+	if (last_scene) {
+		measure_frames(*last_scene, ret);
+		measure_picks(*last_scene, ret);
+	}
+
+	return ret;
+}
+
+void print(const result& r)
+{
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+
+	auto us = [](uint64_t ns) {
+		return duration_cast<microseconds>(std::chrono::nanoseconds(ns)).count();
+	};
+
+	std::cout << r.name << ": " << r.file_size << " bytes, " << r.last.num_vertices << " vertices, "
+			  << r.last.num_triangles << " triangles, " << r.last.num_primitives << " primitives, "
+			  << r.last.num_textures << " textures, retained memory " << r.last.retained_memory << " bytes, peak memory "
+			  << r.last.peak_temporary_memory << " bytes" << std::endl;
+
+	auto print_row = [&](std::string_view name, const summary& time, const summary& allocs) {
+		std::cout << "  " << name << ": min = " << us(time.min) << " us, median = " << us(time.median)
+				  << " us, p99 = " << us(time.p99) << " us, allocations median = " << allocs.median << std::endl;
+	};
+
+	for (size_t s = 0; s != size_t(stage::enum_size); ++s) {
+		print_row(stage_names[s], r.stage_times[s], r.stage_allocations[s]);
+	}
+	print_row("total", r.total_time, r.total_allocations);
+
+	std::cout << "  frame: min = " << us(r.frame_time.min) << " us, median = " << us(r.frame_time.median)
+			  << " us, p99 = " << us(r.frame_time.p99) << " us" << std::endl;
+	if (r.num_animation_channels != 0) {
+		std::cout << "  animation: " << r.num_animation_channels << " channels, min = " << us(r.animation_time.min)
+				  << " us, median = " << us(r.animation_time.median) << " us, p99 = " << us(r.animation_time.p99)
+				  << " us" << std::endl;
+	}
+	std::cout << "  bvh: " << r.num_bvh_items << " items, build = " << us(r.bvh_build_time)
+			  << " us, refit = " << us(r.bvh_refit_time) << " us, " << r.picks_per_second << " picks per second, "
+			  << r.num_pick_hits << " of " << num_picks << " picks hit" << std::endl;
+}
+
+std::string to_json(const result& r)
+{
+	std::vector<std::string> stages;
+	for (size_t s = 0; s != size_t(stage::enum_size); ++s) {
+		stages.push_back(utki::cat(
+			'"',
+			stage_names[s],
+			R"(":{"time_ns":)",
+			to_json(r.stage_times[s]),
+			R"(,"allocations":)",
+			to_json(r.stage_allocations[s]),
+			"}"
+		));
+	}
+	stages.push_back(utki::cat(
+		R"("total":{"time_ns":)",
+		to_json(r.total_time),
+		R"(,"allocations":)",
+		to_json(r.total_allocations),
+		"}"
+	));
+
+	const auto& l = r.last;
+	return utki::cat(
+		R"({"name":")",
+		escape_json(r.name),
+		R"(","file_size":)",
+		r.file_size,
+		R"(,"num_vertices":)",
+		l.num_vertices,
+		R"(,"num_triangles":)",
+		l.num_triangles,
+		R"(,"num_lod_triangles":)",
+		l.num_lod_triangles,
+		R"(,"num_primitives":)",
+		l.num_primitives,
+		R"(,"num_textures":)",
+		l.num_textures,
+		R"(,"bytes_read":)",
+		l.bytes_read,
+		R"(,"bytes_decoded":)",
+		l.bytes_decoded,
+		R"(,"bytes_uploaded":)",
+		l.bytes_uploaded,
+		R"(,"retained_memory":)",
+		l.retained_memory,
+		R"(,"peak_temporary_memory":)",
+		l.peak_temporary_memory,
+		R"(,"stages":{)",
+		join(stages),
+		R"(},"frame_time_ns":)",
+		to_json(r.frame_time),
+		R"(,"animation":{"num_channels":)",
+		r.num_animation_channels,
+		R"(,"time_ns":)",
+		to_json(r.animation_time),
+		"}",
+		R"(,"bvh":{"num_items":)",
+		r.num_bvh_items,
+		R"(,"build_time_ns":)",
+		r.bvh_build_time,
+		R"(,"refit_time_ns":)",
+		r.bvh_refit_time,
+		R"(,"picks_per_second":)",
+		r.picks_per_second,
+		R"(,"num_pick_hits":)",
+		r.num_pick_hits,
+		"}}"
+	);
+}
+
+void print(const benchmark::json_parsing_times& times)
+{
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+
+	auto us = [](uint64_t ns) {
+		return duration_cast<microseconds>(std::chrono::nanoseconds(ns)).count();
+	};
+
+	std::cout << "json parsing: " << times.text_size << " bytes" << std::endl;
+
+	auto print_row = [&](std::string_view name, const summary& time) {
+		std::cout << "  " << name << ": min = " << us(time.min) << " us, median = " << us(time.median)
+				  << " us, p99 = " << us(time.p99) << " us" << std::endl;
+	};
+
+	print_row("jsondom", summarize(times.jsondom));
+	print_row("json_reader", summarize(times.json_reader));
+}
+
+std::string to_json(const benchmark::json_parsing_times& times)
+{
+	return utki::cat(
+		R"({"text_size":)",
+		times.text_size,
+		R"(,"jsondom_time_ns":)",
+		to_json(summarize(times.jsondom)),
+		R"(,"json_reader_time_ns":)",
+		to_json(summarize(times.json_reader)),
+		"}"
+	);
+}
+
+std::vector<input> make_inputs(const std::string& samples_dir)
+{
+	std::vector<input> ret;
+
+	std::vector<std::filesystem::path> files;
+	for (const auto& e : std::filesystem::directory_iterator(samples_dir)) {
+		auto ext = e.path().extension();
+		if (e.is_regular_file() && (ext == ".glb" || ext == ".gltf")) {
+			files.push_back(e.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	for (const auto& f : files) {
+		ret.push_back({
+			.name = f.filename().string(),
+			.file_size = size_t(std::filesystem::file_size(f)),
+			.fi = std::make_unique<fsif::native_file>(f.string()),
+			.content = {}
+		});
+	}
+
+	for (auto& s : benchmark::make_synthetic_scenes()) {
+		input in{
+			.name = std::move(s.name), //
+			.file_size = s.glb.size(),
+			.fi = nullptr,
+			.content = std::move(s.glb)
+		};
+		in.fi = std::make_unique<fsif::span_file>(utki::make_span(in.content));
+		ret.push_back(std::move(in));
+	}
+
+	return ret;
+}
+} // namespace
+
+int main(int argc, const char** argv)
+{
+	unsigned num_iterations = 10;
+	std::string samples_dir = "../unit/samples_gltf";
+	std::string out_file;
+
+	clargs::parser p;
+
+	p.add("iterations", "number of loads of each scene, default = 10", [&](std::string_view v) {
+		num_iterations = unsigned(std::stoul(std::string(v)));
+	});
+
+	p.add("samples-dir", "directory with glTF files to load, default = ../unit/samples_gltf", [&](std::string_view v) {
+		samples_dir = v;
+	});
+
+	p.add("out", "file to write the results to in JSON format", [&](std::string_view v) {
+		out_file = v;
+	});
+
+	std::vector<std::string_view> args(argv + 1, argv + argc);
+	p.parse(args);
+
+	// same parameters as used by the application
+	const ruis::render::gltf_loader::parameters params = {
+		.interleave_vertex_attributes = true,
+		.optimize_indices = true,
+		.num_lods = 3
+	};
+
+	auto rc = utki::make_shared<ruis::render::null::context>();
+
+	std::vector<std::string> results;
+	for (const auto& in : make_inputs(samples_dir)) {
+		auto r = run(rc.get(), params, in, num_iterations);
+		print(r);
+		results.push_back(to_json(r));
+	}
+
+	auto json_parsing = benchmark::measure_json_parsing(num_iterations);
+	print(json_parsing);
+
+	if (!out_file.empty()) {
+		if (auto dir = std::filesystem::path(out_file).parent_path(); !dir.empty()) {
+			std::filesystem::create_directories(dir);
+		}
+
+		std::ofstream(out_file) << utki::cat(
+			R"({"iterations":)",
+			num_iterations,
+			R"(,"interleave_vertex_attributes":)",
+			params.interleave_vertex_attributes ? "true" : "false",
+			R"(,"optimize_indices":)",
+			params.optimize_indices ? "true" : "false",
+			R"(,"num_lods":)",
+			params.num_lods,
+			R"(,"scenes":[)",
+			join(results),
+			R"(],"json_parsing":)",
+			to_json(json_parsing),
+			"}"
+		) << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,434 @@
+#include "synthetic_scenes.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#include <utki/span.hpp>
+#include <utki/string.hpp>
+
+using namespace benchmark;
+
+namespace {
+// these explicit numbers are from glTF spec
+constexpr uint32_t component_type_unsigned_short = 5123;
+constexpr uint32_t component_type_unsigned_int = 5125;
+constexpr uint32_t component_type_float = 5126;
+constexpr uint32_t target_array_buffer = 34962;
+constexpr uint32_t target_element_array_buffer = 34963;
+
+// animation data buffer views have no target
+constexpr uint32_t no_target = 0;
+
+std::string join(const std::vector<std::string>& items)
+{
+	std::string ret;
+	for (const auto& i : items) {
+		if (!ret.empty()) {
+			ret += ',';
+		}
+		ret += i;
+	}
+	return ret;
+}
+
+// makes .glb file out of glTF JSON and binary buffer
+std::vector<uint8_t> make_glb(std::string_view json, utki::span<const uint8_t> bin)
+{
+	std::vector<uint8_t> ret;
+
+	auto write_uint32 = [&](uint32_t v) {
+		for (size_t i = 0; i != sizeof(v); ++i) {
+			ret.push_back(uint8_t(v >> (i * 8)));
+		}
+	};
+
+	auto write_chunk = [&](std::string_view type, utki::span<const uint8_t> data, uint8_t padding) {
+		constexpr auto chunk_alignment = 4;
+		auto padded_size = (data.size() + chunk_alignment - 1) / chunk_alignment * chunk_alignment;
+		write_uint32(uint32_t(padded_size));
+		ret.insert(ret.end(), type.begin(), type.end());
+		ret.insert(ret.end(), data.begin(), data.end());
+		ret.resize(ret.size() + padded_size - data.size(), padding);
+	};
+
+	ret.insert(ret.end(), {'g', 'l', 'T', 'F'});
+	write_uint32(2); // version
+	write_uint32(0); // length, set below
+
+	write_chunk(
+		"JSON",
+		utki::make_span(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<const uint8_t*>(json.data()),
+			json.size()
+		),
+		' '
+	);
+	// chunk type has trailing zero byte, so the string view is constructed with explicit size
+	write_chunk(std::string_view("BIN\0", 4), bin, 0);
+
+	auto length = uint32_t(ret.size());
+	for (size_t i = 0; i != sizeof(length); ++i) {
+		ret[8 + i] = uint8_t(length >> (i * 8));
+	}
+
+	return ret;
+}
+
+class glb_builder
+{
+	std::vector<uint8_t> bin;
+
+	std::vector<std::string> buffer_views;
+	std::vector<std::string> accessors;
+	std::vector<std::string> meshes;
+	std::vector<std::string> nodes;
+	std::vector<std::string> animation_channels;
+	std::vector<std::string> animation_samplers;
+
+	template <typename tp_type>
+	uint32_t add_buffer_view(const std::vector<tp_type>& data, uint32_t target)
+	{
+		// keep all the data 4 bytes aligned
+		constexpr auto alignment = 4;
+		this->bin.resize((this->bin.size() + alignment - 1) / alignment * alignment, 0);
+
+		auto offset = this->bin.size();
+		auto size = data.size() * sizeof(tp_type);
+		this->bin.resize(offset + size);
+		std::memcpy(this->bin.data() + offset, data.data(), size);
+
+		this->buffer_views.push_back(utki::cat(
+			R"({"buffer":0,"byteOffset":)",
+			offset,
+			R"(,"byteLength":)",
+			size,
+			target == no_target ? std::string() : utki::cat(R"(,"target":)", target),
+			"}"
+		));
+		return uint32_t(this->buffer_views.size() - 1);
+	}
+
+	template <typename tp_type>
+	uint32_t add_accessor(
+		const std::vector<tp_type>& data, //
+		uint32_t num_components,
+		uint32_t component_type,
+		uint32_t target
+	)
+	{
+		constexpr std::string_view types[] = {"", "SCALAR", "VEC2", "VEC3", "VEC4"};
+
+		auto bv = this->add_buffer_view(data, target);
+		this->accessors.push_back(utki::cat(
+			R"({"bufferView":)",
+			bv,
+			R"(,"componentType":)",
+			component_type,
+			R"(,"count":)",
+			data.size() / num_components,
+			R"(,"type":")",
+			types[num_components],
+			R"("})"
+		));
+		return uint32_t(this->accessors.size() - 1);
+	}
+
+public:
+	// flat grid of size x size quads in z = 0 plane
+	uint32_t add_grid_mesh(uint32_t size)
+	{
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> texcoords;
+		for (uint32_t y = 0; y <= size; ++y) {
+			for (uint32_t x = 0; x <= size; ++x) {
+				positions.insert(positions.end(), {float(x), float(y), 0});
+				normals.insert(normals.end(), {0, 0, 1});
+				texcoords.insert(texcoords.end(), {float(x) / float(size), float(y) / float(size)});
+			}
+		}
+
+		std::vector<uint32_t> indices;
+		for (uint32_t y = 0; y != size; ++y) {
+			for (uint32_t x = 0; x != size; ++x) {
+				uint32_t v = y * (size + 1) + x;
+				indices.insert(indices.end(), {v, v + 1, v + size + 1, v + 1, v + size + 2, v + size + 1});
+			}
+		}
+
+		auto num_vertices = positions.size() / 3;
+
+		uint32_t indices_accessor = 0;
+		if (num_vertices <= size_t(std::numeric_limits<uint16_t>::max()) + 1) {
+			indices_accessor = this->add_accessor(
+				std::vector<uint16_t>(indices.begin(), indices.end()),
+				1,
+				component_type_unsigned_short,
+				target_element_array_buffer
+			);
+		} else {
+			indices_accessor =
+				this->add_accessor(indices, 1, component_type_unsigned_int, target_element_array_buffer);
+		}
+
+		auto positions_accessor = this->add_accessor(positions, 3, component_type_float, target_array_buffer);
+		auto normals_accessor = this->add_accessor(normals, 3, component_type_float, target_array_buffer);
+		auto texcoords_accessor = this->add_accessor(texcoords, 2, component_type_float, target_array_buffer);
+
+		this->meshes.push_back(utki::cat(
+			R"({"name":"grid_)",
+			this->meshes.size(),
+			R"(","primitives":[{"attributes":{"POSITION":)",
+			positions_accessor,
+			R"(,"NORMAL":)",
+			normals_accessor,
+			R"(,"TEXCOORD_0":)",
+			texcoords_accessor,
+			R"(},"indices":)",
+			indices_accessor,
+			"}]}"
+		));
+		return uint32_t(this->meshes.size() - 1);
+	}
+
+	uint32_t add_node(
+		int mesh, //
+		float x,
+		float y,
+		const std::vector<uint32_t>& children = {}
+	)
+	{
+		std::vector<std::string> c;
+		c.reserve(children.size());
+		for (auto i : children) {
+			c.push_back(utki::cat(i));
+		}
+
+		this->nodes.push_back(utki::cat(
+			R"({"name":"node_)",
+			this->nodes.size(),
+			'"',
+			mesh >= 0 ? utki::cat(R"(,"mesh":)", mesh) : std::string(),
+			R"(,"translation":[)",
+			x,
+			',',
+			y,
+			R"(,0])",
+			children.empty() ? std::string() : utki::cat(R"(,"children":[)", join(c), "]"),
+			"}"
+		));
+		return uint32_t(this->nodes.size() - 1);
+	}
+
+	uint32_t add_key_times(const std::vector<float>& times)
+	{
+		return this->add_accessor(times, 1, component_type_float, no_target);
+	}
+
+	// adds channel with its own sampler to the scene's only animation
+	void add_animation_channel(
+		uint32_t node, //
+		std::string_view path,
+		std::string_view interpolation,
+		uint32_t times_accessor,
+		const std::vector<float>& values,
+		uint32_t num_components
+	)
+	{
+		auto values_accessor = this->add_accessor(values, num_components, component_type_float, no_target);
+
+		this->animation_samplers.push_back(utki::cat(
+			R"({"input":)",
+			times_accessor,
+			R"(,"output":)",
+			values_accessor,
+			R"(,"interpolation":")",
+			interpolation,
+			R"("})"
+		));
+		this->animation_channels.push_back(utki::cat(
+			R"({"sampler":)",
+			this->animation_samplers.size() - 1,
+			R"(,"target":{"node":)",
+			node,
+			R"(,"path":")",
+			path,
+			R"("}})"
+		));
+	}
+
+	std::vector<uint8_t> build(const std::vector<uint32_t>& scene_nodes)
+	{
+		std::vector<std::string> sn;
+		sn.reserve(scene_nodes.size());
+		for (auto i : scene_nodes) {
+			sn.push_back(utki::cat(i));
+		}
+
+		std::string animations;
+		if (!this->animation_channels.empty()) {
+			animations = utki::cat(
+				R"(,"animations":[{"name":"animation","channels":[)",
+				join(this->animation_channels),
+				R"(],"samplers":[)",
+				join(this->animation_samplers),
+				"]}]"
+			);
+		}
+
+		auto json = utki::cat(
+			R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":)",
+			this->bin.size(),
+			R"(}],"bufferViews":[)",
+			join(this->buffer_views),
+			R"(],"accessors":[)",
+			join(this->accessors),
+			R"(],"meshes":[)",
+			join(this->meshes),
+			R"(],"nodes":[)",
+			join(this->nodes),
+			']',
+			animations,
+			R"(,"scenes":[{"nodes":[)",
+			join(sn),
+			R"(]}],"scene":0})"
+		);
+
+		return make_glb(json, this->bin);
+	}
+};
+
+// single small mesh instantiated by a two-level hierarchy of many nodes
+synthetic_scene make_many_nodes_scene()
+{
+	constexpr uint32_t num_groups = 100;
+	constexpr uint32_t group_size = 100;
+	constexpr uint32_t mesh_size = 4;
+
+	glb_builder b;
+	auto mesh = b.add_grid_mesh(mesh_size);
+
+	std::vector<uint32_t> groups;
+	for (uint32_t g = 0; g != num_groups; ++g) {
+		std::vector<uint32_t> children;
+		for (uint32_t i = 0; i != group_size; ++i) {
+			children.push_back(b.add_node(int(mesh), float(i * mesh_size), 0));
+		}
+		groups.push_back(b.add_node(-1, 0, float(g * mesh_size), children));
+	}
+
+	return {
+		.name = "synthetic_many_nodes",
+		.glb = b.build(groups)
+	};
+}
+
+// many nodes with animated translation, rotation and scale, each channel has many keys
+synthetic_scene make_animated_nodes_scene()
+{
+	constexpr uint32_t num_groups = 50;
+	constexpr uint32_t group_size = 60;
+	constexpr uint32_t mesh_size = 4;
+	constexpr uint32_t num_keys = 32;
+	constexpr float key_interval = 0.1f;
+	constexpr float key_phase_step = 0.5f;
+	constexpr float scale_amplitude = 0.5f;
+
+	glb_builder b;
+	auto mesh = b.add_grid_mesh(mesh_size);
+
+	std::vector<float> times;
+	for (uint32_t k = 0; k != num_keys; ++k) {
+		times.push_back(float(k) * key_interval);
+	}
+	auto times_accessor = b.add_key_times(times);
+
+	std::vector<uint32_t> groups;
+	for (uint32_t g = 0; g != num_groups; ++g) {
+		std::vector<uint32_t> children;
+		for (uint32_t i = 0; i != group_size; ++i) {
+			auto x = float(i * mesh_size);
+			auto node = b.add_node(int(mesh), x, 0);
+			children.push_back(node);
+
+			std::vector<float> translations;
+			std::vector<float> rotations;
+			std::vector<float> scales;
+			for (uint32_t k = 0; k != num_keys; ++k) {
+				auto phase = float(node) + float(k) * key_phase_step;
+				auto s = std::sin(phase);
+				auto c = std::cos(phase);
+
+				translations.insert(translations.end(), {x + s, c, 0});
+
+				// rotation about z axis by the phase angle
+				rotations.insert(rotations.end(), {0, 0, std::sin(phase / 2), std::cos(phase / 2)});
+
+				// in-tangent, value and out-tangent
+				auto scale = 1 + scale_amplitude * s;
+				auto tangent = scale_amplitude * c * key_phase_step / key_interval;
+				scales.insert(scales.end(), {tangent, tangent, 0, scale, scale, 1, tangent, tangent, 0});
+			}
+
+			b.add_animation_channel(node, "translation", "LINEAR", times_accessor, translations, 3);
+			b.add_animation_channel(node, "rotation", "LINEAR", times_accessor, rotations, 4);
+			b.add_animation_channel(node, "scale", "CUBICSPLINE", times_accessor, scales, 3);
+		}
+		groups.push_back(b.add_node(-1, 0, float(g * mesh_size), children));
+	}
+
+	return {
+		.name = "synthetic_animated_nodes",
+		.glb = b.build(groups)
+	};
+}
+
+// many small meshes, each instantiated once
+synthetic_scene make_many_meshes_scene()
+{
+	constexpr uint32_t num_meshes = 1000;
+	constexpr uint32_t row_size = 32;
+	constexpr uint32_t mesh_size = 16;
+
+	glb_builder b;
+
+	std::vector<uint32_t> nodes;
+	for (uint32_t i = 0; i != num_meshes; ++i) {
+		auto mesh = b.add_grid_mesh(mesh_size);
+		nodes.push_back(b.add_node(int(mesh), float(i % row_size * mesh_size), float(i / row_size * mesh_size)));
+	}
+
+	return {
+		.name = "synthetic_many_meshes",
+		.glb = b.build(nodes)
+	};
+}
+
+// single mesh with 32-bit indices
+synthetic_scene make_big_mesh_scene()
+{
+	constexpr uint32_t mesh_size = 512;
+
+	glb_builder b;
+	auto mesh = b.add_grid_mesh(mesh_size);
+	auto node = b.add_node(int(mesh), 0, 0);
+
+	return {
+		.name = "synthetic_big_mesh",
+		.glb = b.build({node})
+	};
+}
+} // namespace
+
+std::vector<synthetic_scene> benchmark::make_synthetic_scenes()
+{
+	std::vector<synthetic_scene> ret;
+	ret.push_back(make_many_nodes_scene());
+	ret.push_back(make_many_meshes_scene());
+	ret.push_back(make_big_mesh_scene());
+	ret.push_back(make_animated_nodes_scene());
+	return ret;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+struct synthetic_scene {
+	std::string name;
+
+	// .glb file content
+	std::vector<uint8_t> glb;
+};
+
+/**
+ * @brief Make set of synthetic large scenes.
+ * The scenes stress different parts of the loader: many nodes, many small meshes
+ * and a single big mesh, and the animation playback: many animated nodes.
+ * The scenes have no textures.
+ * @return The synthetic scenes.
+ */
+std::vector<synthetic_scene> make_synthetic_scenes();
+
+} // namespace benchmark
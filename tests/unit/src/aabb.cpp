@@ -0,0 +1,77 @@
+#include <vector>
+
+#include <ruis/render/scene/aabb.hpp>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+const tst::set set("aabb", [](tst::suite& suite) {
+	suite.add("default_is_empty", []() {
+		ruis::render::aabb b;
+		tst::check(b.is_empty(), SL);
+
+		b.extend(ruis::render::aabb());
+		tst::check(b.is_empty(), SL);
+
+		b.extend(ruis::vec3(1, 2, 3));
+		tst::check(!b.is_empty(), SL);
+		tst::check_eq(b.min, ruis::vec3(1, 2, 3), SL);
+		tst::check_eq(b.max, ruis::vec3(1, 2, 3), SL);
+	});
+
+	suite.add("from_points", []() {
+		tst::check(ruis::render::aabb::from_points({}).is_empty(), SL);
+
+		// number of points is not a multiple of points processed per iteration,
+		// extreme values are placed in different lanes
+		const std::vector<ruis::vec3> points = {
+			{0, 0, 0},
+			{1, -5, 2},
+			{-3, 4, 0},
+			{2, 1, -7},
+			{0, 0, 9},
+			{8, 0, 0},
+			{0, 6, 0}
+		};
+
+		for (size_t n = 1; n <= points.size(); ++n) {
+			auto b = ruis::render::aabb::from_points(utki::make_span(points.data(), n));
+
+			ruis::render::aabb expected;
+			for (size_t i = 0; i != n; ++i) {
+				expected.extend(points[i]);
+			}
+
+			tst::check_eq(b.min, expected.min, SL);
+			tst::check_eq(b.max, expected.max, SL);
+		}
+	});
+
+	suite.add("transform", []() {
+		const ruis::render::aabb b{
+			.min = {0, 0, 0},
+			.max = {1, 2, 3}
+		};
+
+		auto m = ruis::mat4().set_identity();
+		m.translate(ruis::vec3(10, 0, 0));
+		m.scale(ruis::vec3(2, 1, 1));
+
+		auto t = b.transform(m);
+		tst::check_eq(t.min, ruis::vec3(10, 0, 0), SL);
+		tst::check_eq(t.max, ruis::vec3(12, 2, 3), SL);
+
+		// swap x and y axes, the box is mirrored
+		ruis::mat4 swap;
+		swap.set_identity();
+		swap[0] = ruis::vec4(0, 1, 0, 0);
+		swap[1] = ruis::vec4(1, 0, 0, 0);
+
+		t = b.transform(swap);
+		tst::check_eq(t.min, ruis::vec3(0, 0, 0), SL);
+		tst::check_eq(t.max, ruis::vec3(2, 1, 3), SL);
+
+		tst::check(ruis::render::aabb().transform(m).is_empty(), SL);
+	});
+});
+} // namespace
@@ -0,0 +1,207 @@
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <ruis/render/scene/animation.hpp>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+using path = ruis::render::animation::path;
+using interpolation = ruis::render::animation::interpolation;
+
+ruis::render::trs_transformation get_trs(
+	const ruis::render::transform_hierarchy& h, //
+	uint32_t index
+)
+{
+	return std::get<ruis::render::trs_transformation>(h.get_transformation(index));
+}
+
+bool is_near(
+	const ruis::vec3& a, //
+	const ruis::vec3& b,
+	float epsilon = 1e-5f
+)
+{
+	return (a - b).norm() < epsilon;
+}
+
+// angle of rotation about z axis
+float get_z_angle(const ruis::quat& q)
+{
+	return 2 * std::atan2(q.v.z(), q.s);
+}
+
+const tst::set set("animation", [](tst::suite& suite) {
+	suite.add("linear_and_step", []() {
+		ruis::render::transform_hierarchy h;
+		auto n = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+
+		const std::array<float, 3> times = {1, 2, 4};
+		const std::array<float, 9> translations = {0, 0, 0, 2, 0, 0, 2, 4, 0};
+		const std::array<float, 9> scales = {1, 1, 1, 2, 2, 2, 3, 3, 3};
+
+		ruis::render::animation a;
+		a.add_channel(n, path::translation, interpolation::linear, times, translations);
+		a.add_channel(n, path::scale, interpolation::step, times, scales);
+		tst::check_eq(a.get_duration(), 4.0f, SL);
+
+		// before the first key
+		a.apply(0, h);
+		tst::check(is_near(get_trs(h, n).translation, {0, 0, 0}), SL);
+		tst::check(is_near(get_trs(h, n).scale, {1, 1, 1}), SL);
+
+		a.apply(1.5f, h);
+		tst::check(is_near(get_trs(h, n).translation, {1, 0, 0}), SL);
+		tst::check(is_near(get_trs(h, n).scale, {1, 1, 1}), SL);
+
+		a.apply(3, h);
+		tst::check(is_near(get_trs(h, n).translation, {2, 2, 0}), SL);
+		tst::check(is_near(get_trs(h, n).scale, {2, 2, 2}), SL);
+
+		// after the last key
+		a.apply(5, h);
+		tst::check(is_near(get_trs(h, n).translation, {2, 4, 0}), SL);
+		tst::check(is_near(get_trs(h, n).scale, {3, 3, 3}), SL);
+
+		// going back in time
+		a.apply(1.5f, h);
+		tst::check(is_near(get_trs(h, n).translation, {1, 0, 0}), SL);
+
+		// applied values take effect on the hierarchy update
+		h.update();
+		tst::check(is_near(h.get_world_matrix(n) * ruis::vec3(0, 0, 0), {1, 0, 0}), SL);
+	});
+
+	suite.add("cubic_spline", []() {
+		ruis::render::transform_hierarchy h;
+		auto n = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+
+		const std::array<float, 2> times = {0, 2};
+
+		// in-tangent, value and out-tangent of each key
+		// clang-format off
+		const std::array<float, 18> values = {
+			0, 0, 0,  0, 0, 0,  1, 0, 0,
+			0, 0, 0,  2, 0, 0,  0, 0, 0
+		};
+		// clang-format on
+
+		ruis::render::animation a;
+		a.add_channel(n, path::translation, interpolation::cubic_spline, times, values);
+
+		auto hermite = [](float t) {
+			float dt = 2;
+			float t2 = t * t;
+			float t3 = t2 * t;
+			return (t3 - 2 * t2 + t) * dt * 1 + (-2 * t3 + 3 * t2) * 2;
+		};
+
+		for (float time : {0.0f, 0.5f, 1.0f, 1.5f, 2.0f}) {
+			a.apply(time, h);
+			tst::check(is_near(get_trs(h, n).translation, {hermite(time / 2), 0, 0}), SL);
+		}
+	});
+
+	suite.add("rotation", []() {
+		ruis::render::transform_hierarchy h;
+		auto n = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+		auto m = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+
+		const float pi = float(utki::pi);
+		const std::array<float, 2> times = {0, 1};
+
+		// rotation about z axis from 0 to 120 degrees
+		auto s = std::sin(pi / 3);
+		auto c = std::cos(pi / 3);
+		const std::array<float, 8> rotations = {0, 0, 0, 1, 0, 0, s, c};
+
+		// same rotation, but the second key quaternion is negated
+		const std::array<float, 8> negated_rotations = {0, 0, 0, 1, 0, 0, -s, -c};
+
+		ruis::render::animation a;
+		a.add_channel(n, path::rotation, interpolation::linear, times, rotations);
+		a.add_channel(m, path::rotation, interpolation::linear, times, negated_rotations);
+
+		for (float t : {0.0f, 0.1f, 0.25f, 0.5f, 0.75f, 0.9f, 1.0f}) {
+			a.apply(t, h);
+			for (auto i : {n, m}) {
+				auto q = get_trs(h, i).rotation;
+
+				// interpolated rotation is unit quaternion
+				tst::check(std::abs(q.dot(q) - 1) < 1e-5f, SL);
+
+				// rotation angle changes with constant speed along the shortest arc
+				auto angle = get_z_angle(q.s < 0 ? ruis::quat(-q.v.x(), -q.v.y(), -q.v.z(), -q.s) : q);
+				tst::check(std::abs(angle - t * 2 * pi / 3) < 1e-3f, SL);
+			}
+		}
+	});
+
+	suite.add("many_keys", []() {
+		ruis::render::transform_hierarchy h;
+		auto n = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+
+		constexpr size_t num_keys = 100;
+		std::vector<float> times;
+		std::vector<float> values;
+		for (size_t i = 0; i != num_keys; ++i) {
+			times.push_back(float(i));
+			values.insert(values.end(), {float(i * i), 0, 0});
+		}
+
+		ruis::render::animation a;
+		a.add_channel(n, path::translation, interpolation::linear, times, values);
+
+		// keys are found when time goes forward by small steps, jumps forward and backward
+		for (float t : {0.5f, 1.5f, 1.75f, 2.5f, 50.5f, 10.5f, 98.5f, 0.25f}) {
+			a.apply(t, h);
+			auto i = std::floor(t);
+			auto expected = i * i + (t - i) * (2 * i + 1);
+			tst::check(is_near(get_trs(h, n).translation, {expected, 0, 0}, 1e-3f), SL);
+		}
+	});
+
+	suite.add("channels_without_target_are_not_applied", []() {
+		ruis::render::transform_hierarchy h;
+		auto n = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+
+		const std::array<float, 1> times = {0};
+		const std::array<float, 3> translation = {1, 2, 3};
+
+		ruis::render::animation a;
+		a.add_channel(ruis::render::animation::no_node, path::translation, interpolation::linear, times, translation);
+		a.apply(0, h);
+		tst::check(is_near(get_trs(h, n).translation, {0, 0, 0}), SL);
+
+		a.set_target(0, n);
+		a.apply(0, h);
+		tst::check(is_near(get_trs(h, n).translation, {1, 2, 3}), SL);
+	});
+
+	suite.add("invalid_channels", []() {
+		ruis::render::animation a;
+
+		auto throws = [&](utki::span<const float> times, utki::span<const float> values, interpolation i) {
+			try {
+				a.add_channel(0, path::translation, i, times, values);
+			} catch (std::invalid_argument&) {
+				return true;
+			}
+			return false;
+		};
+
+		const std::array<float, 2> times = {0, 1};
+		const std::array<float, 2> unordered_times = {1, 1};
+		const std::array<float, 6> values = {};
+
+		tst::check(throws({}, {}, interpolation::linear), SL);
+		tst::check(throws(unordered_times, values, interpolation::linear), SL);
+		tst::check(throws(times, values, interpolation::cubic_spline), SL);
+		tst::check(!throws(times, values, interpolation::step), SL);
+		tst::check_eq(a.get_channels().size(), size_t(1), SL);
+	});
+});
+} // namespace
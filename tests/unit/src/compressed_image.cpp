@@ -0,0 +1,247 @@
+#include <array>
+#include <vector>
+
+#include <ruis/render/null/context.hpp>
+#include <ruis/render/scene/compressed_image.hxx>
+#include <ruis/render/scene/gpu_resource_cache.hxx>
+#include <ruis/render/scene/ktx2.hxx>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+// individual mode, base colors 0x88, modifier table 0, all pixel indices 0, i.e. +2 modifier
+const std::array<uint8_t, 8> etc2_individual_block = {0x88, 0x88, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+// differential mode, base colors 16 (5 bit), zero deltas, modifier table 0, all pixel indices 0
+const std::array<uint8_t, 8> etc2_differential_block = {0x80, 0x80, 0x80, 0x02, 0x00, 0x00, 0x00, 0x00};
+
+// base 100, multiplier 1, modifier table 0, all pixel indices 4, i.e. +2 modifier
+const std::array<uint8_t, 8> eac_alpha_block = {100, 0x10, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24};
+
+template <typename tp_type, size_t num_channels>
+const rasterimage::image<tp_type, num_channels>& get_image(const rasterimage::image_variant& imvar)
+{
+	return std::get<rasterimage::image<tp_type, num_channels>>(imvar.variant());
+}
+
+void write_uint32(std::vector<uint8_t>& buf, size_t offset, uint32_t value)
+{
+	for (size_t i = 0; i != sizeof(value); ++i) {
+		buf[offset + i] = uint8_t(value >> (i * 8));
+	}
+}
+
+std::vector<uint8_t> make_ktx2(
+	uint32_t vk_format, //
+	r4::vector2<uint32_t> dims,
+	utki::span<const uint8_t> level_data,
+	uint32_t supercompression_scheme = 0
+)
+{
+	constexpr size_t level_index_offset = 80;
+	constexpr size_t data_offset = level_index_offset + 24;
+
+	std::vector<uint8_t> ret(data_offset, 0);
+
+	const std::array<uint8_t, 12> identifier = {0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+	std::copy(identifier.begin(), identifier.end(), ret.begin());
+
+	write_uint32(ret, 12, vk_format);
+	write_uint32(ret, 16, 1); // type size
+	write_uint32(ret, 20, dims.x());
+	write_uint32(ret, 24, dims.y());
+	write_uint32(ret, 36, 1); // face count
+	write_uint32(ret, 40, 1); // level count
+	write_uint32(ret, 44, supercompression_scheme);
+
+	write_uint32(ret, level_index_offset, data_offset);
+	write_uint32(ret, level_index_offset + 8, uint32_t(level_data.size()));
+	write_uint32(ret, level_index_offset + 16, uint32_t(level_data.size()));
+
+	ret.insert(ret.end(), level_data.begin(), level_data.end());
+
+	return ret;
+}
+
+const tst::set set("compressed_image", [](tst::suite& suite) {
+	suite.add("decode_etc2_individual_mode", []() {
+		ruis::render::compressed_image ci{
+			.format_v = ruis::render::compressed_image::format::etc2_rgb8,
+			.dims = {4, 4},
+			.levels = {utki::make_span(etc2_individual_block)}
+		};
+
+		auto imvar = ci.decode();
+		const auto& im = get_image<uint8_t, 3>(imvar);
+
+		tst::check_eq(im.pixels().size(), size_t(16), SL);
+		for (const auto& px : im.pixels()) {
+			tst::check_eq(px[0], uint8_t(0x88 + 2), SL);
+			tst::check_eq(px[1], uint8_t(0x88 + 2), SL);
+			tst::check_eq(px[2], uint8_t(0x88 + 2), SL);
+		}
+	});
+
+	suite.add("decode_etc2_differential_mode", []() {
+		ruis::render::compressed_image ci{
+			.format_v = ruis::render::compressed_image::format::etc2_rgb8,
+			.dims = {4, 4},
+			.levels = {utki::make_span(etc2_differential_block)}
+		};
+
+		auto imvar = ci.decode();
+		const auto& im = get_image<uint8_t, 3>(imvar);
+
+		// 5 bit value 16 is extended to 8 bits as 132
+		for (const auto& px : im.pixels()) {
+			tst::check_eq(px[0], uint8_t(132 + 2), SL);
+		}
+	});
+
+	suite.add("decode_etc2_eac_alpha", []() {
+		std::vector<uint8_t> block(eac_alpha_block.begin(), eac_alpha_block.end());
+		block.insert(block.end(), etc2_individual_block.begin(), etc2_individual_block.end());
+
+		ruis::render::compressed_image ci{
+			.format_v = ruis::render::compressed_image::format::etc2_rgba8,
+			.dims = {4, 4},
+			.levels = {utki::make_span(block)}
+		};
+
+		auto imvar = ci.decode();
+		const auto& im = get_image<uint8_t, 4>(imvar);
+
+		for (const auto& px : im.pixels()) {
+			tst::check_eq(px[0], uint8_t(0x88 + 2), SL);
+			tst::check_eq(px[3], uint8_t(100 + 2), SL);
+		}
+	});
+
+	suite.add("decode_etc2_partial_blocks", []() {
+		// 5x3 image takes 2x1 blocks
+		std::vector<uint8_t> data(etc2_individual_block.begin(), etc2_individual_block.end());
+		data.insert(data.end(), etc2_differential_block.begin(), etc2_differential_block.end());
+
+		ruis::render::compressed_image ci{
+			.format_v = ruis::render::compressed_image::format::etc2_rgb8,
+			.dims = {5, 3},
+			.levels = {utki::make_span(data)}
+		};
+		tst::check_eq(ci.get_level_size(ci.dims), data.size(), SL);
+
+		auto imvar = ci.decode();
+		const auto& im = get_image<uint8_t, 3>(imvar);
+
+		tst::check_eq(im.pixels().size(), size_t(15), SL);
+		tst::check_eq(im.pixels()[3][0], uint8_t(0x88 + 2), SL);
+		tst::check_eq(im.pixels()[4][0], uint8_t(132 + 2), SL);
+		tst::check_eq(im.pixels()[2 * 5 + 4][0], uint8_t(132 + 2), SL);
+	});
+
+	suite.add("decode_throws_on_truncated_data", []() {
+		ruis::render::compressed_image ci{
+			.format_v = ruis::render::compressed_image::format::etc2_rgb8,
+			.dims = {8, 4},
+			.levels = {utki::make_span(etc2_individual_block)}
+		};
+
+		bool thrown = false;
+		try {
+			ci.decode();
+		} catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+
+	suite.add("read_ktx2_etc2", []() {
+		constexpr uint32_t vk_format_etc2_r8g8b8_unorm_block = 147;
+		auto ktx2 = make_ktx2(vk_format_etc2_r8g8b8_unorm_block, {4, 4}, etc2_individual_block);
+
+		tst::check(ruis::render::is_ktx2(ktx2), SL);
+		tst::check(ruis::render::is_supported_ktx2(ktx2), SL);
+
+		auto im = ruis::render::read_ktx2(ktx2);
+		tst::check(std::holds_alternative<ruis::render::compressed_image>(im), SL);
+
+		const auto& ci = std::get<ruis::render::compressed_image>(im);
+		tst::check(ci.format_v == ruis::render::compressed_image::format::etc2_rgb8, SL);
+		tst::check_eq(ci.dims, r4::vector2<uint32_t>(4, 4), SL);
+		tst::check_eq(ci.levels.size(), size_t(1), SL);
+
+		// the compressed data is not copied
+		tst::check(ci.levels.front().data() == ktx2.data() + ktx2.size() - etc2_individual_block.size(), SL);
+	});
+
+	suite.add("read_ktx2_uncompressed", []() {
+		constexpr uint32_t vk_format_r8g8b8a8_unorm = 37;
+		const std::array<uint8_t, 8> pixels = {1, 2, 3, 4, 5, 6, 7, 8};
+		auto ktx2 = make_ktx2(vk_format_r8g8b8a8_unorm, {2, 1}, pixels);
+
+		auto im = ruis::render::read_ktx2(ktx2);
+		tst::check(std::holds_alternative<rasterimage::image_variant>(im), SL);
+
+		const auto& rgba = get_image<uint8_t, 4>(std::get<rasterimage::image_variant>(im));
+		tst::check_eq(rgba.pixels()[1][0], uint8_t(5), SL);
+		tst::check_eq(rgba.pixels()[1][3], uint8_t(8), SL);
+	});
+
+	suite.add("read_ktx2_unsupported", []() {
+		// Basis Universal payload needs transcoding, which is not supported
+		constexpr uint32_t vk_format_undefined = 0;
+		constexpr uint32_t supercompression_scheme_basis_lz = 1;
+		auto basis = make_ktx2(vk_format_undefined, {4, 4}, etc2_individual_block, supercompression_scheme_basis_lz);
+
+		tst::check(ruis::render::is_ktx2(basis), SL);
+		tst::check(!ruis::render::is_supported_ktx2(basis), SL);
+
+		bool thrown = false;
+		try {
+			ruis::render::read_ktx2(basis);
+		} catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+
+		tst::check(!ruis::render::is_ktx2(etc2_individual_block), SL);
+	});
+
+	suite.add(
+		"gpu_resource_cache_compressed_texture", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gpu_resource_cache cache;
+
+				ruis::render::compressed_image ci{
+					.format_v = ruis::render::compressed_image::format::etc2_rgb8,
+					.dims = {4, 4},
+					.levels = {utki::make_span(etc2_individual_block)}
+				};
+
+				// factory does not support the format, the texture is decoded and uploaded uncompressed
+				unsigned num_factory_calls = 0;
+				auto factory = [&](const ruis::render::compressed_image&,
+								   const ruis::render::context::texture_2d_parameters&
+							   ) -> std::shared_ptr<ruis::render::texture_2d> {
+					++num_factory_calls;
+					return nullptr;
+				};
+
+				auto tex1 = cache.get_texture_2d(rc.get(), ci, {}, factory);
+				auto tex2 = cache.get_texture_2d(rc.get(), ci, {}, factory);
+
+				tst::check_eq(num_factory_calls, 1u, SL);
+				tst::check(&tex1.get() == &tex2.get(), SL);
+
+				auto stats = cache.get_statistics();
+				tst::check_eq(stats.textures.hits, size_t(1), SL);
+				tst::check_eq(stats.textures.live_bytes, etc2_individual_block.size(), SL);
+			}
+		}
+	);
+});
+} // namespace
@@ -0,0 +1,39 @@
+#include <ruis/render/scene/frustum.hpp>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+ruis::render::aabb make_box(const ruis::vec3& min, const ruis::vec3& max)
+{
+	return {.min = min, .max = max};
+}
+
+const tst::set set("frustum", [](tst::suite& suite) {
+	suite.add("classify", []() {
+		using intersection = ruis::render::frustum::intersection;
+
+		// identity matrix makes frustum out of the clip volume, i.e. the cube from -1 to 1
+		auto f = ruis::render::frustum::from_matrix(ruis::mat4().set_identity());
+
+		tst::check(f.classify(make_box({-0.5, -0.5, -0.5}, {0.5, 0.5, 0.5})) == intersection::inside, SL);
+		tst::check(f.classify(make_box({-3, -3, -3}, {3, 3, 3})) == intersection::intersects, SL);
+		tst::check(f.classify(make_box({0.5, 0, 0}, {1.5, 0.5, 0.5})) == intersection::intersects, SL);
+		tst::check(f.classify(make_box({1.5, 0, 0}, {2, 0.5, 0.5})) == intersection::outside, SL);
+		tst::check(f.classify(make_box({0, 0, -5}, {0, 0, -2})) == intersection::outside, SL);
+		tst::check(f.classify(ruis::render::aabb()) == intersection::outside, SL);
+	});
+
+	suite.add("from_matrix_transforms_planes", []() {
+		using intersection = ruis::render::frustum::intersection;
+
+		// the matrix maps the box from (9, 9, 9) to (11, 11, 11) to the clip volume
+		auto m = ruis::mat4().set_identity();
+		m.translate(ruis::vec3(-10, -10, -10));
+		auto f = ruis::render::frustum::from_matrix(m);
+
+		tst::check(f.classify(make_box({9.5, 9.5, 9.5}, {10.5, 10.5, 10.5})) == intersection::inside, SL);
+		tst::check(f.classify(make_box({-0.5, -0.5, -0.5}, {0.5, 0.5, 0.5})) == intersection::outside, SL);
+		tst::check(f.classify(make_box({10.5, 10, 10}, {11.5, 10.5, 10.5})) == intersection::intersects, SL);
+	});
+});
+} // namespace
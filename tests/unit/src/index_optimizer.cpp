@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <ruis/render/scene/index_optimizer.hxx>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+struct grid {
+	std::vector<ruis::vec3> positions;
+	std::vector<uint32_t> indices;
+};
+
+// flat grid of size x size quads in z = 0 plane, triangles are shuffled as exporters sometimes do
+grid make_shuffled_grid(uint32_t size)
+{
+	grid g;
+	for (uint32_t y = 0; y <= size; ++y) {
+		for (uint32_t x = 0; x <= size; ++x) {
+			g.positions.emplace_back(float(x), float(y), 0);
+		}
+	}
+
+	std::vector<std::array<uint32_t, 3>> triangles;
+	for (uint32_t y = 0; y != size; ++y) {
+		for (uint32_t x = 0; x != size; ++x) {
+			uint32_t v = y * (size + 1) + x;
+			triangles.push_back({v, v + 1, v + size + 1});
+			triangles.push_back({v + 1, v + size + 2, v + size + 1});
+		}
+	}
+
+	std::mt19937 rng(1);
+	std::shuffle(triangles.begin(), triangles.end(), rng);
+
+	for (const auto& t : triangles) {
+		g.indices.insert(g.indices.end(), t.begin(), t.end());
+	}
+	return g;
+}
+
+// triangles as sorted sets of vertex positions, to compare meshes regardless of triangle and vertex order
+std::vector<std::array<float, 9>> get_sorted_triangles(
+	const std::vector<uint32_t>& indices, //
+	const std::vector<ruis::vec3>& positions
+)
+{
+	std::vector<std::array<float, 9>> ret;
+	for (size_t i = 0; i != indices.size(); i += 3) {
+		std::array<std::array<float, 3>, 3> tri{};
+		for (size_t j = 0; j != 3; ++j) {
+			const auto& p = positions[indices[i + j]];
+			tri[j] = {p[0], p[1], p[2]};
+		}
+		// keep winding order, rotate so that the smallest vertex goes first
+		std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+
+		std::array<float, 9> t{};
+		for (size_t j = 0; j != 9; ++j) {
+			t[j] = tri[j / 3][j % 3];
+		}
+		ret.push_back(t);
+	}
+	std::sort(ret.begin(), ret.end());
+	return ret;
+}
+
+const tst::set set("index_optimizer", [](tst::suite& suite) {
+	suite.add("count_vertex_cache_misses", []() {
+		// second triangle shares two vertices with the first one
+		const std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+		tst::check_eq(ruis::render::count_vertex_cache_misses(indices, 4), size_t(4), SL);
+
+		// with cache of size 1 only the last vertex is remembered
+		tst::check_eq(ruis::render::count_vertex_cache_misses(indices, 4, 1), size_t(5), SL);
+	});
+
+	suite.add("optimize_vertex_cache_improves_acmr", []() {
+		auto g = make_shuffled_grid(32);
+		auto num_vertices = g.positions.size();
+		auto num_triangles = float(g.indices.size() / 3);
+
+		auto original = get_sorted_triangles(g.indices, g.positions);
+		float acmr_before = float(ruis::render::count_vertex_cache_misses(g.indices, num_vertices)) / num_triangles;
+
+		ruis::render::optimize_vertex_cache(g.indices, num_vertices);
+
+		float acmr_after = float(ruis::render::count_vertex_cache_misses(g.indices, num_vertices)) / num_triangles;
+
+		tst::check(get_sorted_triangles(g.indices, g.positions) == original, SL);
+		tst::check_gt(acmr_before, 2.0f, SL);
+		tst::check_lt(acmr_after, 1.0f, SL);
+	});
+
+	suite.add("optimize_overdraw_keeps_triangles", []() {
+		auto g = make_shuffled_grid(16);
+		auto num_vertices = g.positions.size();
+		auto num_triangles = float(g.indices.size() / 3);
+
+		ruis::render::optimize_vertex_cache(g.indices, num_vertices);
+		auto original = get_sorted_triangles(g.indices, g.positions);
+		float acmr_before = float(ruis::render::count_vertex_cache_misses(g.indices, num_vertices)) / num_triangles;
+
+		constexpr float threshold = 1.05f;
+		ruis::render::optimize_overdraw(g.indices, g.positions, threshold);
+
+		float acmr_after = float(ruis::render::count_vertex_cache_misses(g.indices, num_vertices)) / num_triangles;
+
+		tst::check(get_sorted_triangles(g.indices, g.positions) == original, SL);
+
+		// clusters start with cold cache, so a bit of ACMR degradation is expected
+		constexpr float tolerance = 1.25f;
+		tst::check_le(acmr_after, acmr_before * tolerance, SL);
+	});
+
+	suite.add("optimize_vertex_fetch", []() {
+		const std::vector<ruis::vec3> positions = {
+			{0, 0, 0},
+			{1, 0, 0},
+			{2, 0, 0},
+			{3, 0, 0},
+			{4, 0, 0}
+		};
+		std::vector<uint32_t> indices = {3, 1, 4, 4, 1, 0};
+
+		auto original = get_sorted_triangles(indices, positions);
+
+		auto remap = ruis::render::optimize_vertex_fetch(indices, positions.size());
+
+		// vertices are numbered in order of first use, unused vertex 2 goes last
+		tst::check(indices == std::vector<uint32_t>{0, 1, 2, 2, 1, 3}, SL);
+		tst::check(remap == std::vector<uint32_t>{3, 1, 4, 0, 2}, SL);
+
+		std::vector<ruis::vec3> new_positions;
+		for (auto i : remap) {
+			new_positions.push_back(positions[i]);
+		}
+		tst::check(get_sorted_triangles(indices, new_positions) == original, SL);
+	});
+
+	suite.add("invalid_indices", []() {
+		std::vector<uint32_t> indices = {0, 1, 5};
+
+		bool thrown = false;
+		try {
+			ruis::render::optimize_vertex_cache(indices, 3);
+		} catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+});
+} // namespace
@@ -0,0 +1,117 @@
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <ruis/render/scene/json_reader.hxx>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+#include <utki/span.hpp>
+
+using namespace std::string_view_literals;
+
+using ruis::render::json_document;
+using ruis::render::json_value;
+
+namespace {
+utki::span<const uint8_t> to_span(std::string_view text)
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	return utki::make_span(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+// the document refers to the text, so only pass string literals here
+json_document make_doc(std::string_view text)
+{
+	return json_document(to_span(text));
+}
+
+bool parse_throws(std::string_view text)
+{
+	try {
+		auto doc = make_doc(text);
+	} catch (std::invalid_argument&) {
+		return true;
+	}
+	return false;
+}
+
+const tst::set set("json_reader", [](tst::suite& suite) {
+	suite.add("scalars", []() {
+		auto doc = make_doc(R"({"t":true,"f":false,"n":null,"i":-42,"d":1.25E-1,"big":4294967295,"s":"abc"})");
+		auto root = doc.root();
+
+		tst::check(root.is_object(), SL);
+		tst::check(root.get("t"sv).boolean(), SL);
+		tst::check(root.get("f"sv).is_boolean(), SL);
+		tst::check(!root.get("f"sv).boolean(), SL);
+		tst::check(root.get("n"sv).get_type() == json_value::type::null, SL);
+		tst::check_eq(root.get("i"sv).to_int32(), -42, SL);
+		tst::check_eq(root.get("d"sv).number(), 0.125, SL);
+		tst::check_eq(root.get("big"sv).to_uint32(), uint32_t(4294967295), SL);
+		tst::check_eq(root.get("s"sv).string(), "abc"sv, SL);
+	});
+
+	suite.add("absent_members_are_undefined", []() {
+		auto doc = make_doc(R"({"a":{"b":[1,2]}})");
+		auto root = doc.root();
+
+		tst::check(root.get("x"sv).is_undefined(), SL);
+		tst::check(root.get("x"sv).get("y"sv).is_undefined(), SL);
+		tst::check(root.get("a"sv).get("b"sv)[5].is_undefined(), SL);
+		tst::check_eq(root.get("x"sv).to_int32(), 0, SL);
+		tst::check_eq(root.get("x"sv).size(), size_t(0), SL);
+		tst::check(root.get("x"sv).begin() == root.get("x"sv).end(), SL);
+	});
+
+	suite.add("nested_arrays_and_objects", []() {
+		auto doc = make_doc(R"( [ [], {}, [1, [2, 3], {"k": [4]}], 5 ] )");
+		auto root = doc.root();
+
+		tst::check(root.is_array(), SL);
+		tst::check_eq(root.size(), size_t(4), SL);
+		tst::check_eq(root[0].size(), size_t(0), SL);
+		tst::check(root[1].is_object(), SL);
+		tst::check_eq(root[2][1][1].to_int32(), 3, SL);
+		tst::check_eq(root[2][2].get("k"sv)[0].to_int32(), 4, SL);
+		tst::check_eq(root[3].to_int32(), 5, SL);
+
+		std::vector<int32_t> flat;
+		for (auto v : root[2][1]) {
+			flat.push_back(v.to_int32());
+		}
+		tst::check(flat == std::vector<int32_t>{2, 3}, SL);
+	});
+
+	suite.add("string_escapes", []() {
+		auto doc = make_doc(R"({"e":"a\"b\\c\/d\nAé😀","k1":1})");
+		auto root = doc.root();
+
+		tst::check_eq(root.get("e"sv).string(), "a\"b\\c/d\nA\xc3\xa9\xf0\x9f\x98\x80"sv, SL);
+		tst::check_eq(root.get("k1"sv).to_int32(), 1, SL);
+	});
+
+	suite.add("invalid_json_throws", []() {
+		tst::check(parse_throws(""), SL);
+		tst::check(parse_throws("{"), SL);
+		tst::check(parse_throws(R"({"a":1,})"), SL);
+		tst::check(parse_throws(R"({"a" 1})"), SL);
+		tst::check(parse_throws("[1 2]"), SL);
+		tst::check(parse_throws("[1] 2"), SL);
+		tst::check(parse_throws("tru"), SL);
+		tst::check(parse_throws(R"("abc)"), SL);
+		tst::check(parse_throws(R"("\x")"), SL);
+		tst::check(parse_throws("-"), SL);
+		tst::check(parse_throws("01"), SL);
+	});
+
+	suite.add("string_ending_with_backslash_throws", []() {
+		// the text is not null-terminated, the parser must not read past its end
+		std::string_view text = R"("abc\)";
+		std::vector<char> buffer(text.begin(), text.end());
+
+		tst::check(parse_throws(std::string_view(buffer.data(), buffer.size())), SL);
+		tst::check(parse_throws(R"(["abc\)"), SL);
+		tst::check(parse_throws(R"({"a":"\)"), SL);
+	});
+});
+} // namespace
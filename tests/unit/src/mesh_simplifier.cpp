@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <ruis/render/scene/mesh_simplifier.hxx>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+#include <utki/math.hpp>
+
+namespace {
+struct mesh {
+	std::vector<ruis::vec3> positions;
+	std::vector<uint32_t> indices;
+};
+
+// flat grid of size x size quads in z = 0 plane
+mesh make_grid(uint32_t size)
+{
+	mesh m;
+	for (uint32_t y = 0; y <= size; ++y) {
+		for (uint32_t x = 0; x <= size; ++x) {
+			m.positions.emplace_back(float(x), float(y), 0);
+		}
+	}
+	for (uint32_t y = 0; y != size; ++y) {
+		for (uint32_t x = 0; x != size; ++x) {
+			uint32_t v = y * (size + 1) + x;
+			m.indices.insert(m.indices.end(), {v, v + 1, v + size + 1, v + 1, v + size + 2, v + size + 1});
+		}
+	}
+	return m;
+}
+
+// grid bent into a part of unit sphere, curved in both directions
+mesh make_sphere_patch(uint32_t size)
+{
+	auto m = make_grid(size);
+	for (auto& p : m.positions) {
+		auto longitude = (p.x() / float(size) - 0.5f) * float(utki::pi) / 2;
+		auto latitude = (p.y() / float(size) - 0.5f) * float(utki::pi) / 2;
+		p = ruis::vec3(
+			std::cos(latitude) * std::sin(longitude), //
+			std::sin(latitude),
+			std::cos(latitude) * std::cos(longitude)
+		);
+	}
+	return m;
+}
+
+bool all_facing_z(const std::vector<uint32_t>& indices, const std::vector<ruis::vec3>& positions)
+{
+	for (size_t i = 0; i != indices.size(); i += 3) {
+		const auto& p0 = positions[indices[i]];
+		auto n = (positions[indices[i + 1]] - p0).cross(positions[indices[i + 2]] - p0);
+		if (n.z() <= 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const tst::set set("mesh_simplifier", [](tst::suite& suite) {
+	suite.add("flat_grid_is_simplified_without_error", []() {
+		auto m = make_grid(16);
+
+		float error = -1;
+		auto indices = ruis::render::simplify_mesh(m.indices, m.positions, 0, 0.01f, &error);
+
+		// inner vertices of a plane can be collapsed without any error, border vertices are kept
+		tst::check_lt(indices.size(), m.indices.size() / 4, SL);
+		tst::check_eq(indices.size() % 3, size_t(0), SL);
+		tst::check_eq(error, 0.0f, SL);
+		tst::check(all_facing_z(indices, m.positions), SL);
+
+		// border vertices are kept
+		for (uint32_t corner : {0u, 16u, 16u * 17u, 17u * 17u - 1u}) {
+			tst::check(std::find(indices.begin(), indices.end(), corner) != indices.end(), SL);
+		}
+	});
+
+	suite.add("target_index_count_is_respected", []() {
+		auto m = make_grid(16);
+
+		auto target = m.indices.size() / 2;
+		auto indices = ruis::render::simplify_mesh(m.indices, m.positions, target, 1.0f);
+
+		tst::check_le(indices.size(), target, SL);
+		// collapses are done in passes, but the simplification stops close to the target
+		tst::check_gt(indices.size(), target / 2, SL);
+	});
+
+	suite.add("curved_surface_error_is_limited", []() {
+		auto m = make_sphere_patch(32);
+
+		float error = -1;
+		auto indices = ruis::render::simplify_mesh(m.indices, m.positions, 0, 0.0f, &error);
+
+		// no collapse on a curved surface is free, so nothing is simplified with zero target error
+		tst::check_eq(indices.size(), m.indices.size(), SL);
+		tst::check_eq(error, 0.0f, SL);
+
+		constexpr float target_error = 0.05f;
+		indices = ruis::render::simplify_mesh(m.indices, m.positions, 0, target_error, &error);
+		tst::check_lt(indices.size(), m.indices.size(), SL);
+		tst::check_gt(error, 0.0f, SL);
+		tst::check_le(error, target_error, SL);
+	});
+
+	suite.add("invalid_input", []() {
+		const std::vector<ruis::vec3> positions = {
+			{0, 0, 0},
+			{1, 0, 0},
+			{0, 1, 0}
+		};
+
+		bool thrown = false;
+		try {
+			ruis::render::simplify_mesh(std::vector<uint32_t>{0, 1}, positions, 0, 1);
+		} catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+
+		thrown = false;
+		try {
+			ruis::render::simplify_mesh(std::vector<uint32_t>{0, 1, 3}, positions, 0, 1);
+		} catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+	});
+});
+} // namespace
@@ -0,0 +1,185 @@
+#include <array>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+#include <ruis/render/scene/meshopt_decoder.hxx>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+using ruis::render::meshopt_compression;
+
+namespace {
+// two triangles sharing an edge, followed by two triangles with new vertices, index codec version 0
+const std::vector<uint8_t> index_buffer_data = {
+	0xe0, 0xf0, 0x10, 0xfe, 0xff, 0xf0, 0x0c, 0xff, 0x02, 0x02, 0x02, 0x00, 0x76, 0x87,
+	0x56, 0x67, 0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00
+};
+
+std::vector<uint32_t> to_indices(const std::vector<uint8_t>& data, size_t index_size)
+{
+	std::vector<uint32_t> ret;
+	for (size_t i = 0; i + index_size <= data.size(); i += index_size) {
+		uint32_t index = 0;
+		for (size_t b = 0; b != index_size; ++b) {
+			index |= uint32_t(data[i + b]) << (b * 8);
+		}
+		ret.push_back(index);
+	}
+	return ret;
+}
+
+// vertex codec stream where every vertex equals the first vertex stored in the tail,
+// each vertex byte is a single byte group of zero deltas
+std::vector<uint8_t> make_constant_vertex_data(const std::vector<uint8_t>& vertex)
+{
+	constexpr size_t tail_size = 32;
+
+	std::vector<uint8_t> ret = {0xa0};
+	ret.insert(ret.end(), vertex.size(), 0);
+	ret.insert(ret.end(), tail_size - vertex.size(), 0);
+	ret.insert(ret.end(), vertex.begin(), vertex.end());
+	return ret;
+}
+
+std::vector<uint8_t> decode_constant_vertices(
+	const std::vector<uint8_t>& vertex, //
+	uint32_t count,
+	meshopt_compression::filter filter
+)
+{
+	return ruis::render::decode_meshopt(
+		make_constant_vertex_data(vertex), //
+		{.mode_v = meshopt_compression::mode::attributes,
+		 .filter_v = filter,
+		 .count = count,
+		 .byte_stride = uint32_t(vertex.size())}
+	);
+}
+
+bool decode_throws(const std::vector<uint8_t>& data, const meshopt_compression& params)
+{
+	try {
+		ruis::render::decode_meshopt(data, params);
+	} catch (std::invalid_argument&) {
+		return true;
+	}
+	return false;
+}
+
+const tst::set set("meshopt_decoder", [](tst::suite& suite) {
+	suite.add("decode_triangles", []() {
+		for (uint32_t index_size : {2, 4}) {
+			auto data = ruis::render::decode_meshopt(
+				index_buffer_data, //
+				{.mode_v = meshopt_compression::mode::triangles, .count = 12, .byte_stride = index_size}
+			);
+
+			const std::vector<uint32_t> expected = {0, 1, 2, 2, 1, 3, 4, 6, 5, 7, 8, 9};
+			tst::check(to_indices(data, index_size) == expected, SL);
+		}
+	});
+
+	suite.add("decode_triangles_malformed", []() {
+		meshopt_compression params{.mode_v = meshopt_compression::mode::triangles, .count = 12, .byte_stride = 2};
+
+		auto truncated = index_buffer_data;
+		truncated.pop_back();
+		tst::check(decode_throws(truncated, params), SL);
+
+		auto bad_header = index_buffer_data;
+		bad_header[0] = 0xe2;
+		tst::check(decode_throws(bad_header, params), SL);
+
+		params.count = 11;
+		tst::check(decode_throws(index_buffer_data, params), SL);
+	});
+
+	suite.add("decode_index_sequence", []() {
+		// indices 5, 6, 3 as zigzag deltas from baseline 0, followed by the tail
+		const std::vector<uint8_t> sequence_data = {0xd1, 20, 4, 10, 0, 0, 0, 0};
+
+		auto data = ruis::render::decode_meshopt(
+			sequence_data, //
+			{.mode_v = meshopt_compression::mode::indices, .count = 3, .byte_stride = 4}
+		);
+
+		const std::vector<uint32_t> expected = {5, 6, 3};
+		tst::check(to_indices(data, 4) == expected, SL);
+	});
+
+	suite.add("decode_vertices", []() {
+		const std::vector<uint8_t> vertex = {1, 2, 3, 4, 5, 6, 7, 8};
+
+		auto data = decode_constant_vertices(vertex, 3, meshopt_compression::filter::none);
+
+		tst::check_eq(data.size(), size_t(24), SL);
+		for (size_t i = 0; i != data.size(); ++i) {
+			tst::check_eq(data[i], vertex[i % vertex.size()], SL);
+		}
+	});
+
+	suite.add("decode_vertices_deltas", []() {
+		// stride 4, two vertices, first vertex byte has raw zigzag deltas of +1, the rest are zero
+		std::vector<uint8_t> stream = {0xa0, 0x03, 2, 2};
+		stream.insert(stream.end(), 14, 0);
+		stream.insert(stream.end(), {0x00, 0x00, 0x00});
+		stream.insert(stream.end(), 28, 0);
+		stream.insert(stream.end(), {10, 20, 30, 40});
+
+		auto data = ruis::render::decode_meshopt(
+			stream, //
+			{.mode_v = meshopt_compression::mode::attributes, .count = 2, .byte_stride = 4}
+		);
+
+		const std::vector<uint8_t> expected = {11, 20, 30, 40, 12, 20, 30, 40};
+		tst::check(data == expected, SL);
+
+		stream.pop_back();
+		tst::check(
+			decode_throws(stream, {.mode_v = meshopt_compression::mode::attributes, .count = 2, .byte_stride = 4}),
+			SL
+		);
+	});
+
+	suite.add("octahedral_filter", []() {
+		auto data = decode_constant_vertices({0, 0, 127, 5}, 1, meshopt_compression::filter::octahedral);
+		tst::check(data == std::vector<uint8_t>{0, 0, 127, 5}, SL);
+
+		// 16 bit components, the result is normalized
+		data = decode_constant_vertices(
+			{0x00, 0x40, 0x00, 0x00, 0xff, 0x7f, 0x00, 0x00}, //
+			1,
+			meshopt_compression::filter::octahedral
+		);
+		auto indices = to_indices(data, 2);
+		auto x = float(int16_t(indices[0]));
+		auto y = float(int16_t(indices[1]));
+		auto z = float(int16_t(indices[2]));
+		tst::check_lt(std::abs(std::sqrt(x * x + y * y + z * z) - 32767), 2.0f, SL);
+		tst::check_gt(x, 0.0f, SL);
+		tst::check_eq(y, 0.0f, SL);
+		tst::check_gt(z, 0.0f, SL);
+	});
+
+	suite.add("quaternion_filter", []() {
+		// all stored components are zero, so the omitted component is 1, its index is in the lowest 2 bits
+		auto data = decode_constant_vertices(
+			{0, 0, 0, 0, 0, 0, 0x05, 0x00}, //
+			1,
+			meshopt_compression::filter::quaternion
+		);
+		tst::check(to_indices(data, 2) == std::vector<uint32_t>{0, 32767, 0, 0}, SL);
+	});
+
+	suite.add("exponential_filter", []() {
+		// mantissa 3, exponent -1
+		auto data = decode_constant_vertices({0x03, 0x00, 0x00, 0xff}, 2, meshopt_compression::filter::exponential);
+		auto values = to_indices(data, 4);
+		tst::check_eq(values.size(), size_t(2), SL);
+		for (auto v : values) {
+			tst::check_eq(std::bit_cast<float>(v), 1.5f, SL);
+		}
+	});
+});
+} // namespace
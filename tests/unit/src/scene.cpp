@@ -1,11 +1,363 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <fsif/native_file.hpp>
+#include <fsif/span_file.hpp>
 #include <ruis/render/null/context.hpp>
+#include <ruis/render/scene/bvh.hpp>
+#include <ruis/render/scene/draw_list.hxx>
 #include <ruis/render/scene/gltf_loader.hxx>
+#include <ruis/render/scene/gpu_resource_cache.hxx>
 #include <ruis/render/scene/scene.hpp>
+#include <ruis/render/scene/scene_cache.hxx>
 #include <tst/check.hpp>
 #include <tst/set.hpp>
+#include <utki/string.hpp>
 
 namespace {
+// makes .glb file out of glTF JSON and binary buffer
+std::vector<uint8_t> make_glb(std::string_view json, utki::span<const uint8_t> bin)
+{
+	std::vector<uint8_t> ret;
+
+	auto write_uint32 = [&](uint32_t v) {
+		for (size_t i = 0; i != sizeof(v); ++i) {
+			ret.push_back(uint8_t(v >> (i * 8)));
+		}
+	};
+
+	auto write_chunk = [&](std::string_view type, utki::span<const uint8_t> data, uint8_t padding) {
+		constexpr auto chunk_alignment = 4;
+		auto padded_size = (data.size() + chunk_alignment - 1) / chunk_alignment * chunk_alignment;
+		write_uint32(uint32_t(padded_size));
+		ret.insert(ret.end(), type.begin(), type.end());
+		ret.insert(ret.end(), data.begin(), data.end());
+		ret.resize(ret.size() + padded_size - data.size(), padding);
+	};
+
+	ret.insert(ret.end(), {'g', 'l', 'T', 'F'});
+	write_uint32(2); // version
+	write_uint32(0); // length, set below
+
+	write_chunk(
+		"JSON",
+		utki::make_span(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<const uint8_t*>(json.data()),
+			json.size()
+		),
+		' '
+	);
+	// chunk type has trailing zero byte, so the string view is constructed with explicit size
+	write_chunk(std::string_view("BIN\0", 4), bin, 0);
+
+	auto length = uint32_t(ret.size());
+	for (size_t i = 0; i != sizeof(length); ++i) {
+		ret[8 + i] = uint8_t(length >> (i * 8));
+	}
+
+	return ret;
+}
+
+// single triangle with KHR_mesh_quantization vertex data:
+// normalized int16 positions, normalized int8 normals and normalized uint16 texture coordinates
+std::vector<uint8_t> make_quantized_triangle_bin()
+{
+	std::vector<uint8_t> bin(52, 0);
+
+	auto write_int16 = [&](size_t offset, int16_t v) {
+		bin[offset] = uint8_t(uint16_t(v));
+		bin[offset + 1] = uint8_t(uint16_t(v) >> 8);
+	};
+
+	// positions: (0, 0, 0), (1, 0, 0), (0, 1, 0)
+	write_int16(6, 32767);
+	write_int16(14, 32767);
+
+	// normals: (0, 0, 1)
+	for (size_t i = 0; i != 3; ++i) {
+		bin[20 + i * 3 + 2] = 127;
+	}
+
+	// texture coordinates: (0, 0), (1, 0), (0, 1)
+	write_int16(36, -1);
+	write_int16(42, -1);
+
+	// indices: 0, 1, 2
+	bin[46] = 1;
+	bin[48] = 2;
+
+	return bin;
+}
+
+// glTF JSON of the quantized triangle, the buffer JSON describes where the binary data is
+std::string make_quantized_triangle_json(std::string_view buffer_json)
+{
+	return utki::cat(
+		R"({
+		"asset": {"version": "2.0"},
+		"extensionsUsed": ["KHR_mesh_quantization"],
+		"extensionsRequired": ["KHR_mesh_quantization"],
+		"buffers": [)",
+		buffer_json,
+		R"(],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 18},
+			{"buffer": 0, "byteOffset": 20, "byteLength": 9},
+			{"buffer": 0, "byteOffset": 32, "byteLength": 12},
+			{"buffer": 0, "byteOffset": 44, "byteLength": 6}
+		],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5122, "normalized": true, "count": 3, "type": "VEC3"},
+			{"bufferView": 1, "componentType": 5120, "normalized": true, "count": 3, "type": "VEC3"},
+			{"bufferView": 2, "componentType": 5123, "normalized": true, "count": 3, "type": "VEC2"},
+			{"bufferView": 3, "componentType": 5123, "count": 3, "type": "SCALAR"}
+		],
+		"meshes": [{"name": "triangle", "primitives": [
+			{"attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2}, "indices": 3}
+		]}],
+		"nodes": [{"name": "triangle", "mesh": 0}],
+		"scenes": [{"nodes": [0]}],
+		"scene": 0
+	})"
+	);
+}
+
+std::vector<uint8_t> make_quantized_triangle_glb()
+{
+	return make_glb(make_quantized_triangle_json(R"({"byteLength": 52})"), make_quantized_triangle_bin());
+}
+
+// scene of nodes referring to the quantized triangle mesh,
+// the instance translations are appended to the binary buffer and are accessor 4, if any
+std::vector<uint8_t> make_quantized_triangle_nodes_glb(
+	std::string_view nodes_json, //
+	std::string_view scene_nodes_json,
+	const std::vector<ruis::vec3>& instance_translations = {}
+)
+{
+	auto bin = make_quantized_triangle_bin();
+	auto translations_offset = bin.size();
+	for (const auto& t : instance_translations) {
+		for (auto c : t) {
+			std::array<uint8_t, sizeof(c)> bytes{};
+			std::memcpy(bytes.data(), &c, sizeof(c));
+			bin.insert(bin.end(), bytes.begin(), bytes.end());
+		}
+	}
+	auto translations_size = bin.size() - translations_offset;
+
+	auto json = utki::cat(
+		R"({
+		"asset": {"version": "2.0"},
+		"extensionsUsed": ["KHR_mesh_quantization", "EXT_mesh_gpu_instancing"],
+		"buffers": [{"byteLength": )",
+		bin.size(),
+		R"(}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 18},
+			{"buffer": 0, "byteOffset": 20, "byteLength": 9},
+			{"buffer": 0, "byteOffset": 32, "byteLength": 12},
+			{"buffer": 0, "byteOffset": 44, "byteLength": 6},
+			{"buffer": 0, "byteOffset": )",
+		translations_offset,
+		R"(, "byteLength": )",
+		translations_size,
+		R"(}
+		],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5122, "normalized": true, "count": 3, "type": "VEC3"},
+			{"bufferView": 1, "componentType": 5120, "normalized": true, "count": 3, "type": "VEC3"},
+			{"bufferView": 2, "componentType": 5123, "normalized": true, "count": 3, "type": "VEC2"},
+			{"bufferView": 3, "componentType": 5123, "count": 3, "type": "SCALAR"},
+			{"bufferView": 4, "componentType": 5126, "count": )",
+		instance_translations.size(),
+		R"(, "type": "VEC3"}
+		],
+		"meshes": [{"name": "triangle", "primitives": [
+			{"attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2}, "indices": 3}
+		]}],
+		"nodes": )",
+		nodes_json,
+		R"(,
+		"scenes": [{"nodes": )",
+		scene_nodes_json,
+		R"(}],
+		"scene": 0
+	})"
+	);
+
+	return make_glb(json, bin);
+}
+
+// flat grid of size x size quads in z = 0 plane, 1 x 1 in size, with the node referring to it,
+// the position bounds JSON is the min and max of the position accessor
+std::vector<uint8_t> make_grid_glb(
+	uint32_t size, //
+	std::string_view nodes_json = R"([{"mesh": 0}])",
+	std::string_view position_bounds_json = R"(, "min": [0, 0, 0], "max": [1, 1, 0])"
+)
+{
+	std::vector<float> vertices;
+	for (uint32_t y = 0; y <= size; ++y) {
+		for (uint32_t x = 0; x <= size; ++x) {
+			auto u = float(x) / float(size);
+			auto v = float(y) / float(size);
+			// position, normal and texture coordinates
+			vertices.insert(vertices.end(), {u, v, 0, 0, 0, 1, u, v});
+		}
+	}
+
+	std::vector<uint16_t> indices;
+	for (uint32_t y = 0; y != size; ++y) {
+		for (uint32_t x = 0; x != size; ++x) {
+			auto i = uint16_t(y * (size + 1) + x);
+			auto row = uint16_t(size + 1);
+			indices.insert(indices.end(), {i, uint16_t(i + 1), uint16_t(i + row)});
+			indices.insert(indices.end(), {uint16_t(i + 1), uint16_t(i + row + 1), uint16_t(i + row)});
+		}
+	}
+
+	std::vector<uint8_t> bin(vertices.size() * sizeof(float) + indices.size() * sizeof(uint16_t));
+	std::memcpy(bin.data(), vertices.data(), vertices.size() * sizeof(float));
+	std::memcpy(bin.data() + vertices.size() * sizeof(float), indices.data(), indices.size() * sizeof(uint16_t));
+
+	constexpr auto stride = 8 * sizeof(float);
+	auto num_vertices = vertices.size() / 8;
+
+	auto json = utki::cat(
+		R"({
+		"asset": {"version": "2.0"},
+		"buffers": [{"byteLength": )",
+		bin.size(),
+		R"(}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": )",
+		vertices.size() * sizeof(float),
+		R"(, "byteStride": )",
+		stride,
+		R"(},
+			{"buffer": 0, "byteOffset": )",
+		vertices.size() * sizeof(float),
+		R"(, "byteLength": )",
+		indices.size() * sizeof(uint16_t),
+		R"(}
+		],
+		"accessors": [
+			{"bufferView": 0, "byteOffset": 0, "componentType": 5126, "count": )",
+		num_vertices,
+		R"(, "type": "VEC3")",
+		position_bounds_json,
+		R"(},
+			{"bufferView": 0, "byteOffset": 12, "componentType": 5126, "count": )",
+		num_vertices,
+		R"(, "type": "VEC3"},
+			{"bufferView": 0, "byteOffset": 24, "componentType": 5126, "count": )",
+		num_vertices,
+		R"(, "type": "VEC2"},
+			{"bufferView": 1, "componentType": 5123, "count": )",
+		indices.size(),
+		R"(, "type": "SCALAR"}
+		],
+		"meshes": [{"name": "grid", "primitives": [
+			{"attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2}, "indices": 3}
+		]}],
+		"nodes": )",
+		nodes_json,
+		R"(,
+		"scenes": [{"nodes": [0]}],
+		"scene": 0
+	})"
+	);
+
+	return make_glb(json, bin);
+}
+
+// three nodes without meshes, node 1 is a child of node 0, node 2 is not in the scene,
+// the animations JSON refers to accessors of
+// key times {0, 1}, key times {0, 0.5}, translations {(0, 0, 0), (2, 0, 0)}
+// and quantized rotations {identity, 90 degrees about z axis}
+std::vector<uint8_t> make_animated_glb(std::string_view animations_json)
+{
+	std::vector<uint8_t> bin;
+
+	auto write = [&](const auto& values) {
+		for (auto v : values) {
+			std::array<uint8_t, sizeof(v)> bytes{};
+			std::memcpy(bytes.data(), &v, sizeof(v));
+			bin.insert(bin.end(), bytes.begin(), bytes.end());
+		}
+	};
+
+	write(std::array<float, 2>{0, 1});
+	write(std::array<float, 2>{0, 0.5f});
+	write(std::array<float, 6>{0, 0, 0, 2, 0, 0});
+	write(std::array<int16_t, 8>{0, 0, 0, 32767, 0, 0, 23170, 23170});
+
+	auto json = utki::cat(
+		R"({
+		"asset": {"version": "2.0"},
+		"buffers": [{"byteLength": )",
+		bin.size(),
+		R"(}],
+		"bufferViews": [
+			{"buffer": 0, "byteOffset": 0, "byteLength": 8},
+			{"buffer": 0, "byteOffset": 8, "byteLength": 8},
+			{"buffer": 0, "byteOffset": 16, "byteLength": 24},
+			{"buffer": 0, "byteOffset": 40, "byteLength": 16}
+		],
+		"accessors": [
+			{"bufferView": 0, "componentType": 5126, "count": 2, "type": "SCALAR"},
+			{"bufferView": 1, "componentType": 5126, "count": 2, "type": "SCALAR"},
+			{"bufferView": 2, "componentType": 5126, "count": 2, "type": "VEC3"},
+			{"bufferView": 3, "componentType": 5122, "normalized": true, "count": 2, "type": "VEC4"}
+		],
+		"nodes": [{"children": [1]}, {}, {}],
+		"animations": )",
+		animations_json,
+		R"(,
+		"scenes": [{"nodes": [0]}],
+		"scene": 0
+	})"
+	);
+
+	return make_glb(json, bin);
+}
+
+std::string encode_base64(utki::span<const uint8_t> data)
+{
+	constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	std::string ret;
+	for (size_t i = 0; i < data.size(); i += 3) {
+		uint32_t v = uint32_t(data[i]) << 16;
+		if (i + 1 < data.size()) {
+			v |= uint32_t(data[i + 1]) << 8;
+		}
+		if (i + 2 < data.size()) {
+			v |= data[i + 2];
+		}
+		ret.push_back(alphabet[(v >> 18) & 0x3f]);
+		ret.push_back(alphabet[(v >> 12) & 0x3f]);
+		ret.push_back(i + 1 < data.size() ? alphabet[(v >> 6) & 0x3f] : '=');
+		ret.push_back(i + 2 < data.size() ? alphabet[v & 0x3f] : '=');
+	}
+	return ret;
+}
+
+void write_file(const std::filesystem::path& path, utki::span<const uint8_t> data)
+{
+	fsif::native_file fi(path.string());
+	fi.open(fsif::mode::create);
+	fi.write(data);
+	fi.close();
+}
+
 const tst::set set("scene", [](tst::suite& suite) {
 	suite.add(
 		"basic_read", //
@@ -37,6 +389,1378 @@ const tst::set set("scene", [](tst::suite& suite) {
 		}
 	);
 
+	suite.add(
+		"read_from_non_native_file", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto data = fsif::native_file("samples_gltf/kub.glb").load();
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::span_file(utki::make_span(data)));
+				tst::check(!scene.get().nodes.empty(), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"interleaved_vertex_attributes", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get(), {.interleave_vertex_attributes = true});
+				auto scene = l.load(fsif::native_file("samples_gltf/kub.glb"));
+
+				const auto& mesh = scene.get().nodes[0].get().mesh_v;
+				tst::check(mesh != nullptr, SL);
+
+				for (const auto& p : mesh->primitives) {
+					const auto& layout = p.get().interleaved_layout;
+					tst::check(layout.has_value(), SL);
+					tst::check_eq(p.get().vao.get().buffers.size(), size_t(1), SL);
+
+					// position, texture coordinate, normal, tangent, bitangent
+					tst::check_eq(layout->attributes.size(), size_t(5), SL);
+					tst::check_eq(layout->stride, uint32_t((3 + 2 + 3 + 3 + 3) * sizeof(float)), SL);
+				}
+			}
+		}
+	);
+
+	suite.add(
+		"mesh_quantization_interleaved", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_quantized_triangle_glb();
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get(), {.interleave_vertex_attributes = true});
+				auto data = l.read(fsif::span_file(utki::make_span(glb)));
+
+				tst::check_eq(data.meshes.size(), size_t(1), SL);
+				tst::check_eq(data.meshes[0].primitives.size(), size_t(1), SL);
+
+				const auto& p = data.meshes[0].primitives[0];
+				tst::check(p.interleaved_layout.has_value(), SL);
+
+				// quantized attributes are not expanded to floats, each attribute is padded to 4 bytes
+				using ct = ruis::render::vertex_layout::component_type;
+				const auto& attrs = p.interleaved_layout->attributes;
+				tst::check_eq(attrs.size(), size_t(5), SL);
+				tst::check(attrs[0].type == ct::int16, SL);
+				tst::check(attrs[0].normalized, SL);
+				tst::check(attrs[1].type == ct::uint16, SL);
+				tst::check(attrs[2].type == ct::int8, SL);
+				tst::check(attrs[3].type == ct::float32, SL);
+				tst::check_eq(attrs[1].offset, uint32_t(8), SL);
+				tst::check_eq(attrs[2].offset, uint32_t(12), SL);
+				tst::check_eq(p.interleaved_layout->stride, uint32_t(8 + 4 + 4 + 2 * 3 * sizeof(float)), SL);
+				tst::check_eq(
+					p.attributes[0].data.size_bytes(),
+					size_t(3 * p.interleaved_layout->stride),
+					SL
+				);
+
+				auto scene = ruis::render::make_scene(rc.get(), data);
+				tst::check(!scene.get().nodes.empty(), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"mesh_quantization_not_interleaved", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_quantized_triangle_glb();
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::span_file(utki::make_span(glb)));
+
+				// separate vertex buffers are float only, quantized data is converted
+				const auto& p = data.meshes[0].primitives[0];
+				tst::check_eq(p.attributes.size(), size_t(5), SL);
+
+				const auto& positions = p.attributes[0].data;
+				tst::check_eq(positions.size(), size_t(9), SL);
+				tst::check_eq(positions[3], 1.0f, SL);
+				tst::check_eq(positions[7], 1.0f, SL);
+
+				const auto& texcoords = p.attributes[1].data;
+				tst::check_eq(texcoords[2], 1.0f, SL);
+				tst::check_eq(texcoords[5], 1.0f, SL);
+
+				const auto& normals = p.attributes[2].data;
+				tst::check_eq(normals[2], 1.0f, SL);
+
+				// tangent is calculated from dequantized data
+				const auto& tangents = p.attributes[3].data;
+				tst::check_gt(tangents[0], 0.99f, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"draw_list_batches_repeated_mesh", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			constexpr size_t num_nodes = 1000;
+
+			std::vector<std::string> nodes;
+			std::vector<std::string> scene_nodes;
+			for (size_t i = 0; i != num_nodes; ++i) {
+				nodes.push_back(utki::cat(R"({"mesh": 0, "translation": [)", i, ", 0, 0]}"));
+				scene_nodes.push_back(utki::cat(i));
+			}
+
+			auto join = [](const std::vector<std::string>& items) {
+				std::string ret;
+				for (const auto& i : items) {
+					ret += ret.empty() ? "[" : ",";
+					ret += i;
+				}
+				return ret + "]";
+			};
+
+			auto glb = make_quantized_triangle_nodes_glb(join(nodes), join(scene_nodes));
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get(), {.interleave_vertex_attributes = true});
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+
+				ruis::render::draw_list dl;
+				dl.build(scene.get(), ruis::mat4().set_identity());
+
+				// all the nodes refer to the same mesh, so those are drawn with a single instanced draw call
+				tst::check_eq(dl.get_batches().size(), size_t(1), SL);
+				tst::check_eq(dl.get_num_instances(), num_nodes, SL);
+
+				const auto& b = dl.get_batches().front();
+				tst::check(b.primitive_v == &scene.get().nodes[0].get().mesh_v->primitives[0].get(), SL);
+
+				constexpr size_t node_index = 5;
+				auto pos = b.model_matrices[node_index] * ruis::vec4(0, 0, 0, 1);
+				tst::check_eq(pos, ruis::vec4(node_index, 0, 0, 1), SL);
+
+				// building again replaces the previous content
+				dl.build(scene.get(), ruis::mat4().set_identity());
+				tst::check_eq(dl.get_num_instances(), num_nodes, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"ext_mesh_gpu_instancing", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			const std::vector<ruis::vec3> translations = {
+				{0, 0, 0},
+				{2, 0, 0},
+				{4, 0, 0}
+			};
+
+			auto glb = make_quantized_triangle_nodes_glb(
+				R"([
+					{
+						"mesh": 0,
+						"translation": [0, 0, 10],
+						"children": [1],
+						"extensions": {"EXT_mesh_gpu_instancing": {"attributes": {"TRANSLATION": 4}}}
+					},
+					{"mesh": 0}
+				])",
+				"[0]",
+				translations
+			);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::span_file(utki::make_span(glb)));
+				tst::check_eq(data.nodes[0].instances.size(), translations.size(), SL);
+				tst::check(data.nodes[1].instances.empty(), SL);
+			}
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+
+				ruis::render::draw_list dl;
+				dl.build(scene.get(), ruis::mat4().set_identity());
+
+				// instanced node and its non-instanced child share the mesh
+				tst::check_eq(dl.get_batches().size(), size_t(1), SL);
+				tst::check_eq(dl.get_num_instances(), translations.size() + 1, SL);
+
+				const auto& matrices = dl.get_batches().front().model_matrices;
+				for (size_t i = 0; i != translations.size(); ++i) {
+					auto pos = matrices[i] * ruis::vec4(0, 0, 0, 1);
+					tst::check_eq(pos, ruis::vec4(translations[i].x(), 0, 10, 1), SL);
+				}
+
+				// children are not instanced, those only have the node's transformation applied
+				auto child_pos = matrices.back() * ruis::vec4(0, 0, 0, 1);
+				tst::check_eq(child_pos, ruis::vec4(0, 0, 10, 1), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"load_statistics", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_quantized_triangle_glb();
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				ruis::render::load_statistics stats;
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)), &stats);
+				tst::check(!scene.get().nodes.empty(), SL);
+
+				tst::check_eq(stats.num_primitives, size_t(1), SL);
+				tst::check_eq(stats.num_triangles, size_t(1), SL);
+				tst::check_eq(stats.num_vertices, size_t(3), SL);
+				tst::check_eq(stats.num_textures, size_t(0), SL);
+				tst::check_eq(stats.bytes_read, glb.size(), SL);
+
+				// quantized attributes, tangents and bitangents are converted to 3 floats per vertex,
+				// texture coordinates to 2 floats per vertex
+				constexpr size_t vertex_bytes = 3 * (4 * 3 + 2) * sizeof(float);
+				tst::check_eq(stats.bytes_decoded, vertex_bytes, SL);
+
+				// indices are uploaded directly from the file
+				tst::check_eq(stats.bytes_uploaded, vertex_bytes + 3 * sizeof(uint16_t), SL);
+
+				// budget: the retained memory is the decoded data plus the parsed JSON
+				tst::check_ge(stats.retained_memory, stats.bytes_decoded, SL);
+				tst::check_le(stats.retained_memory, size_t(4096), SL);
+
+				// quantized attributes are dequantized to short-lived buffers for tangent space calculation
+				tst::check_gt(stats.peak_temporary_memory, stats.retained_memory, SL);
+				tst::check_le(stats.peak_temporary_memory, size_t(4096), SL);
+
+				using stage = ruis::render::load_statistics::stage;
+				tst::check_eq(stats.get_time(stage::index_optimization).count(), 0, SL);
+				tst::check_gt(stats.get_time(stage::gpu_upload).count(), 0, SL);
+				tst::check_gt(stats.get_total_time().count(), 0, SL);
+
+				// the statistics are reset on each read
+				auto data = l.read(fsif::span_file(utki::make_span(glb)), nullptr, &stats);
+				tst::check_eq(stats.num_primitives, size_t(1), SL);
+				tst::check_eq(stats.bytes_uploaded, size_t(0), SL);
+				tst::check_eq(stats.get_time(stage::gpu_upload).count(), 0, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"load_statistics_with_textures", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get(), {.optimize_indices = true});
+				ruis::render::load_statistics stats;
+				auto scene = l.load(fsif::native_file("samples_gltf/kub.glb"), &stats);
+
+				tst::check_ne(stats.num_textures, size_t(0), SL);
+				tst::check_ne(stats.num_triangles, size_t(0), SL);
+				tst::check_ge(stats.num_vertices, size_t(3), SL);
+				tst::check_eq(stats.num_primitives, l.get_index_optimization_statistics().num_primitives, SL);
+
+				using stage = ruis::render::load_statistics::stage;
+				tst::check_gt(stats.get_time(stage::image_decode).count(), 0, SL);
+				tst::check_gt(stats.get_time(stage::index_optimization).count(), 0, SL);
+
+				// decoded images are uploaded as is, vertex and index data at most as decoded plus the file data
+				tst::check_ne(stats.bytes_uploaded, size_t(0), SL);
+				tst::check_le(stats.bytes_uploaded, stats.bytes_decoded + stats.bytes_read, SL);
+				tst::check_ge(stats.retained_memory, stats.bytes_decoded, SL);
+				tst::check_ge(stats.peak_temporary_memory, stats.retained_memory, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"optimize_indices", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader plain_loader(rc.get());
+				auto plain = plain_loader.read(fsif::native_file("samples_gltf/kub.glb"));
+				tst::check_eq(plain_loader.get_index_optimization_statistics().num_primitives, size_t(0), SL);
+
+				ruis::render::gltf_loader l(rc.get(), {.optimize_indices = true});
+				auto data = l.read(fsif::native_file("samples_gltf/kub.glb"));
+
+				const auto& stats = l.get_index_optimization_statistics();
+				tst::check_ne(stats.num_primitives, size_t(0), SL);
+				tst::check_ne(stats.num_triangles, size_t(0), SL);
+				tst::check_le(stats.get_acmr_after(), stats.get_acmr_before(), SL);
+
+				const auto& p = data.meshes[0].primitives[0];
+				const auto& plain_p = plain.meshes[0].primitives[0];
+
+				// the model is small, so indices fit into 16 bits
+				tst::check(std::holds_alternative<utki::span<const uint16_t>>(p.indices), SL);
+				tst::check_eq(
+					std::visit(
+						[](const auto& i) {
+							return i.size();
+						},
+						p.indices
+					),
+					std::visit(
+						[](const auto& i) {
+							return i.size();
+						},
+						plain_p.indices
+					),
+					SL
+				);
+				tst::check_eq(p.attributes[0].data.size(), plain_p.attributes[0].data.size(), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"gltf_data_uri_buffer", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto json = make_quantized_triangle_json(utki::cat(
+				R"({"byteLength": 52, "uri": "data:application/octet-stream;base64,)",
+				encode_base64(make_quantized_triangle_bin()),
+				R"("})"
+			));
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::span_file(utki::make_span(
+					// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+					reinterpret_cast<const uint8_t*>(json.data()),
+					json.size()
+				)));
+
+				const auto& positions = data.meshes[0].primitives[0].attributes[0].data;
+				tst::check_eq(positions.size(), size_t(9), SL);
+				tst::check_eq(positions[3], 1.0f, SL);
+				tst::check_eq(positions[7], 1.0f, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"gltf_shared_external_buffer", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto dir = std::filesystem::temp_directory_path() / "carcockpit_tests_external_buffer";
+			std::filesystem::remove_all(dir);
+			std::filesystem::create_directories(dir);
+
+			// two scene files referring to the same geometry buffer, URI is percent-encoded
+			write_file(dir / "shared geometry.bin", make_quantized_triangle_bin());
+			auto json = make_quantized_triangle_json(R"({"byteLength": 52, "uri": "shared%20geometry.bin"})");
+			auto json_span = utki::make_span(
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				reinterpret_cast<const uint8_t*>(json.data()),
+				json.size()
+			);
+			write_file(dir / "a.gltf", json_span);
+			write_file(dir / "b.gltf", json_span);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data_a = l.read(fsif::native_file((dir / "a.gltf").string()));
+				auto data_b = l.read(fsif::native_file((dir / "b.gltf").string()));
+
+				const auto& positions = data_b.meshes[0].primitives[0].attributes[0].data;
+				tst::check_eq(positions[3], 1.0f, SL);
+
+				// the buffer file is loaded once while the first scene data is alive
+				auto shared = std::find_first_of(
+					data_a.storage.begin(),
+					data_a.storage.end(),
+					data_b.storage.begin(),
+					data_b.storage.end()
+				);
+				tst::check(shared != data_a.storage.end(), SL);
+
+				auto files = ruis::render::gltf_loader::get_external_buffer_files(
+					fsif::native_file((dir / "a.gltf").string()),
+					json_span
+				);
+				tst::check_eq(files.size(), size_t(1), SL);
+				tst::check_eq(files.front()->path(), (dir / "shared geometry.bin").string(), SL);
+			}
+
+			std::filesystem::remove_all(dir);
+		}
+	);
+
+	suite.add(
+		"image_timings", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::native_file("samples_gltf/kub.glb"));
+
+				const auto& timings = l.get_image_timings();
+				tst::check_eq(timings.size(), size_t(1), SL);
+				tst::check_eq(timings[0].name, std::string("logo-volkswagen-256x256"), SL);
+				tst::check_ne(timings[0].encoded_size, size_t(0), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"texture_sampler", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::native_file("samples_gltf/kub.glb"));
+
+				// kub.glb sampler: magFilter = LINEAR, minFilter = LINEAR_MIPMAP_LINEAR, wrapping is not specified
+				tst::check_eq(data.textures.size(), size_t(1), SL);
+				const auto& t = data.textures.front();
+				tst::check(t.params.mag_filter == ruis::render::texture_2d::filter::linear, SL);
+				tst::check(t.params.min_filter == ruis::render::texture_2d::filter::linear, SL);
+				tst::check(t.params.mipmap == ruis::render::texture_2d::mipmap::linear, SL);
+				tst::check(t.wrapping.s == ruis::render::texture_wrapping::mode::repeat, SL);
+				tst::check(t.wrapping.t == ruis::render::texture_wrapping::mode::repeat, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"read_progress_and_cancellation", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+
+				ruis::render::load_progress progress;
+				auto data = l.read(fsif::native_file("samples_gltf/kub.glb"), &progress);
+				tst::check(!data.nodes.empty(), SL);
+				tst::check_eq(progress.get(), 1.0f, SL);
+
+				ruis::render::load_progress cancelled_progress;
+				cancelled_progress.cancel();
+				bool thrown = false;
+				try {
+					l.read(fsif::native_file("samples_gltf/kub.glb"), &cancelled_progress);
+				} catch (ruis::render::load_cancelled&) {
+					thrown = true;
+				}
+				tst::check(thrown, SL);
+			}
+		}
+	);
+
+	suite.add(
+		"scene_cache", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto cache_dir = std::filesystem::temp_directory_path() / "carcockpit_tests_scene_cache";
+			std::filesystem::remove_all(cache_dir);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get(), {.interleave_vertex_attributes = true});
+				ruis::render::scene_cache cache(cache_dir.string());
+				const fsif::native_file fi("samples_gltf/kub.glb");
+
+				ruis::render::scene_cache::statistics stats;
+
+				auto cold = cache.read(fi, l, &stats);
+				tst::check(!stats.hit, SL);
+
+				auto warm = cache.read(fi, l, &stats);
+				tst::check(stats.hit, SL);
+
+				tst::check_eq(warm.images.size(), cold.images.size(), SL);
+				tst::check_eq(warm.textures.size(), cold.textures.size(), SL);
+				tst::check_eq(warm.materials.size(), cold.materials.size(), SL);
+				tst::check_eq(warm.nodes.size(), cold.nodes.size(), SL);
+				tst::check_eq(warm.active_scene, cold.active_scene, SL);
+				tst::check_eq(warm.meshes.size(), cold.meshes.size(), SL);
+
+				for (size_t m = 0; m != warm.meshes.size(); ++m) {
+					const auto& wm = warm.meshes[m];
+					const auto& cm = cold.meshes[m];
+					tst::check_eq(wm.primitives.size(), cm.primitives.size(), SL);
+					for (size_t p = 0; p != wm.primitives.size(); ++p) {
+						const auto& wp = wm.primitives[p];
+						const auto& cp = cm.primitives[p];
+						tst::check(wp.interleaved_layout.has_value(), SL);
+						tst::check_eq(wp.interleaved_layout->stride, cp.interleaved_layout->stride, SL);
+						tst::check_eq(wp.attributes.size(), cp.attributes.size(), SL);
+						for (size_t a = 0; a != wp.attributes.size(); ++a) {
+							tst::check(
+								std::equal(
+									wp.attributes[a].data.begin(),
+									wp.attributes[a].data.end(),
+									cp.attributes[a].data.begin(),
+									cp.attributes[a].data.end()
+								),
+								SL
+							);
+						}
+					}
+				}
+
+				auto scene = ruis::render::make_scene(rc.get(), warm);
+				tst::check(!scene.get().nodes.empty(), SL);
+
+				// different loader parameters invalidate the cache entry
+				ruis::render::gltf_loader l2(rc.get());
+				cache.read(fi, l2, &stats);
+				tst::check(!stats.hit, SL);
+			}
+
+			std::filesystem::remove_all(cache_dir);
+		}
+	);
+
+	suite.add(
+		"lod_generation", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			constexpr uint32_t grid_size = 16;
+			auto glb = make_grid_glb(grid_size);
+
+			for (bool optimize_indices : {false, true}) {
+				auto rc = utki::make_shared<ruis::render::null::context>();
+				{
+					ruis::render::gltf_loader l(
+						rc.get(),
+						{
+							.interleave_vertex_attributes = true, //
+							.optimize_indices = optimize_indices,
+							.num_lods = 3
+						}
+					);
+
+					ruis::render::load_statistics stats;
+					auto data = l.read(fsif::span_file(utki::make_span(glb)), nullptr, &stats);
+
+					const auto& p = data.meshes[0].primitives[0];
+
+					// inner vertices of a flat grid are collapsed without error, so all the levels are generated
+					tst::check_eq(p.lods.size(), size_t(3), SL);
+
+					constexpr size_t num_vertices = (grid_size + 1) * (grid_size + 1);
+					size_t prev_size = grid_size * grid_size * 2 * 3;
+					size_t num_lod_indices = 0;
+					for (const auto& lod : p.lods) {
+						const auto& indices = std::get<utki::span<const uint16_t>>(lod);
+						tst::check_lt(indices.size(), prev_size, SL);
+						tst::check_eq(indices.size() % 3, size_t(0), SL);
+						for (auto i : indices) {
+							tst::check_lt(size_t(i), num_vertices, SL);
+						}
+						prev_size = indices.size();
+						num_lod_indices += indices.size();
+					}
+					tst::check_eq(stats.num_lod_triangles, num_lod_indices / 3, SL);
+
+					// the grid is 1 x 1 in size
+					auto scene = ruis::render::make_scene(rc.get(), data);
+					const auto& sp = scene.get().nodes[0].get().mesh_v->primitives[0].get();
+					tst::check_eq(sp.lods.size(), size_t(3), SL);
+
+					// levels share the vertex buffers
+					tst::check(&sp.lods[0].get().buffers[0].get() == &sp.vao.get().buffers[0].get(), SL);
+				}
+			}
+		}
+	);
+
+	suite.add(
+		"draw_list_lod_selection", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_grid_glb(16);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get(), {.num_lods = 2});
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+				const auto& p = scene.get().nodes[0].get().mesh_v->primitives[0].get();
+				tst::check_eq(p.lods.size(), size_t(2), SL);
+
+				const std::array<ruis::real, 2> thresholds = {0.5f, 0.1f};
+
+				auto select = [&](ruis::real distance) {
+					ruis::render::draw_list::lod_parameters params = {
+						.view_matrix = ruis::mat4().set_identity().translate(ruis::vec3(0, 0, -distance)),
+						.projection_scale = 1,
+						.thresholds = thresholds
+					};
+
+					ruis::render::draw_list dl;
+					dl.build(scene.get(), ruis::mat4().set_identity(), &params);
+					tst::check_eq(dl.get_batches().size(), size_t(1), SL);
+					const auto& b = dl.get_batches().front();
+					tst::check(b.primitive_v == &p, SL);
+					tst::check(b.vao == (b.lod == 0 ? &p.vao.get() : &p.lods[b.lod - 1].get()), SL);
+					return b.lod;
+				};
+
+				// bounding sphere radius is about 0.7
+				tst::check_eq(select(1), size_t(0), SL);
+				tst::check_eq(select(3), size_t(1), SL);
+				tst::check_eq(select(100), size_t(2), SL);
+
+				// without level of detail parameters the most detailed level is drawn
+				ruis::render::draw_list dl;
+				dl.build(scene.get(), ruis::mat4().set_identity());
+				tst::check_eq(dl.get_batches().front().lod, size_t(0), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"msft_lod", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_grid_glb(
+				4,
+				R"([
+					{
+						"mesh": 0,
+						"extensions": {"MSFT_lod": {"ids": [1]}},
+						"extras": {"MSFT_screencoverage": [0.5, 0.1]}
+					},
+					{"mesh": 0}
+				])"
+			);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::span_file(utki::make_span(glb)));
+				tst::check_eq(data.nodes[0].lods, std::vector<uint32_t>{1}, SL);
+				tst::check_eq(data.nodes[0].lod_screen_coverage, std::vector<float>{0.5f, 0.1f}, SL);
+
+				auto scene = ruis::render::make_scene(rc.get(), data);
+				const auto& n = scene.get().nodes[0].get();
+				tst::check_eq(n.lods.size(), size_t(1), SL);
+				tst::check(n.lods[0] == n.mesh_v, SL);
+
+				auto build = [&](ruis::real distance) {
+					ruis::render::draw_list::lod_parameters params = {
+						.view_matrix = ruis::mat4().set_identity().translate(ruis::vec3(0, 0, -distance)),
+						.projection_scale = 1,
+						.thresholds = {}
+					};
+
+					ruis::render::draw_list dl;
+					dl.build(scene.get(), ruis::mat4().set_identity(), &params);
+					return std::make_pair(dl.get_batches().size(), dl.get_culling_statistics().num_visible_meshes);
+				};
+
+				tst::check(build(1) == std::make_pair(size_t(1), size_t(1)), SL);
+
+				// node's own screen coverage thresholds cull the node when it is too small,
+				// the node is not counted as drawn then
+				tst::check(build(100) == std::make_pair(size_t(0), size_t(0)), SL);
+			}
+
+			// level of detail node index out of range
+			auto bad_glb = make_grid_glb(4, R"([{"mesh": 0, "extensions": {"MSFT_lod": {"ids": [5]}}}])");
+			bool thrown = false;
+			try {
+				ruis::render::gltf_loader l(rc.get());
+				l.read(fsif::span_file(utki::make_span(bad_glb)));
+			} catch (std::invalid_argument&) {
+				thrown = true;
+			}
+			tst::check(thrown, SL);
+		}
+	);
+
+	suite.add(
+		"primitive_bounds", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+
+				// position accessor has no min and max, the bounds are calculated from dequantized positions
+				auto data = l.read(fsif::span_file(utki::make_span(make_quantized_triangle_glb())));
+				const auto& triangle_bounds = data.meshes[0].primitives[0].bounds;
+				tst::check_eq(triangle_bounds.min, ruis::vec3(0, 0, 0), SL);
+				tst::check_eq(triangle_bounds.max, ruis::vec3(1, 1, 0), SL);
+				tst::check_eq(data.meshes[0].bounds.max, ruis::vec3(1, 1, 0), SL);
+
+				// min and max of the position accessor are used as is
+				auto grid_data = l.read(fsif::span_file(utki::make_span(
+					make_grid_glb(4, R"([{"mesh": 0}])", R"(, "min": [-1, -1, -1], "max": [2, 2, 1])")
+				)));
+				const auto& grid_bounds = grid_data.meshes[0].primitives[0].bounds;
+				tst::check_eq(grid_bounds.min, ruis::vec3(-1, -1, -1), SL);
+				tst::check_eq(grid_bounds.max, ruis::vec3(2, 2, 1), SL);
+
+				auto scene = ruis::render::make_scene(rc.get(), grid_data);
+				const auto& m = *scene.get().nodes[0].get().mesh_v;
+				tst::check_eq(m.bounds.min, ruis::vec3(-1, -1, -1), SL);
+				tst::check_eq(m.primitives[0].get().bounds.max, ruis::vec3(2, 2, 1), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"node_bounds", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			// the triangle spans (0, 0, 0) - (1, 1, 0), the last node rotates it 90 degrees around x axis
+			auto glb = make_quantized_triangle_nodes_glb(
+				R"([
+					{"mesh": 0, "translation": [10, 0, 0], "children": [1]},
+					{"translation": [0, 5, 0], "children": [2, 3]},
+					{"mesh": 0, "translation": [2, 0, 0]},
+					{"mesh": 0, "scale": [1, 3, 1], "rotation": [0.7071068, 0, 0, 0.7071068]}
+				])",
+				"[0]"
+			);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+
+				auto& root = scene.get().nodes[0].get();
+				auto& group = root.children[0].get();
+				auto& moved = group.children[0].get();
+
+				// rotation makes small rounding errors
+				auto is_near = [](const ruis::vec3& a, const ruis::vec3& b) {
+					constexpr auto epsilon = 1e-5f;
+					return (a - b).norm() < epsilon;
+				};
+
+				// node bounds are in the node's own coordinates and are up to date after loading
+				tst::check(!root.bounds_dirty, SL);
+				tst::check_eq(moved.bounds.min, ruis::vec3(0, 0, 0), SL);
+				tst::check_eq(moved.bounds.max, ruis::vec3(1, 1, 0), SL);
+				tst::check(is_near(group.bounds.min, ruis::vec3(0, 0, 0)), SL);
+				tst::check(is_near(group.bounds.max, ruis::vec3(3, 1, 3)), SL);
+				tst::check(is_near(root.bounds.min, ruis::vec3(0, 0, 0)), SL);
+				tst::check(is_near(root.bounds.max, ruis::vec3(3, 6, 3)), SL);
+
+				auto scene_bounds = scene.get().get_bounds();
+				tst::check(is_near(scene_bounds.min, ruis::vec3(10, 0, 0)), SL);
+				tst::check(is_near(scene_bounds.max, ruis::vec3(13, 6, 3)), SL);
+
+				// nothing has changed
+				tst::check(!root.update_bounds(), SL);
+
+				moved.set_transformation(ruis::render::trs_transformation{
+					.translation = {-4, 0, 0},
+					.rotation = {0, 0, 0, 1},
+					.scale = {1, 1, 1}
+				});
+				tst::check(moved.bounds_dirty, SL);
+
+				scene.get().update_bounds();
+				tst::check(!moved.bounds_dirty, SL);
+				tst::check(is_near(group.bounds.min, ruis::vec3(-4, 0, 0)), SL);
+				tst::check(is_near(root.bounds.min, ruis::vec3(-4, 0, 0)), SL);
+				tst::check(is_near(root.bounds.max, ruis::vec3(1, 6, 3)), SL);
+				tst::check(is_near(scene.get().get_bounds().min, ruis::vec3(6, 0, 0)), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"flattened_transform_hierarchy", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_quantized_triangle_nodes_glb(
+				R"([
+					{"mesh": 0, "translation": [10, 0, 0], "children": [1]},
+					{"translation": [0, 5, 0], "children": [2, 3]},
+					{"mesh": 0, "translation": [2, 0, 0]},
+					{"mesh": 0, "scale": [1, 3, 1]}
+				])",
+				"[0]"
+			);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+
+				auto& root = scene.get().nodes[0].get();
+				auto& group = root.children[0].get();
+				auto& moved = group.children[0].get();
+
+				// nodes are flattened in depth-first order, parents go before their children
+				const auto& h = scene.get().get_transform_hierarchy();
+				auto flat_nodes = scene.get().get_flat_nodes();
+				tst::check_eq(flat_nodes.size(), size_t(4), SL);
+				tst::check_eq(h.size(), size_t(4), SL);
+				tst::check(flat_nodes[0] == &root, SL);
+				tst::check(flat_nodes[1] == &group, SL);
+				tst::check(flat_nodes[2] == &moved, SL);
+				tst::check_eq(h.get_parent(0), ruis::render::transform_hierarchy::no_parent, SL);
+				tst::check_eq(h.get_parent(1), uint32_t(0), SL);
+				tst::check_eq(h.get_parent(2), uint32_t(1), SL);
+				tst::check_eq(h.get_parent(3), uint32_t(1), SL);
+
+				tst::check_eq(moved.get_world_matrix() * ruis::vec3(0, 0, 0), ruis::vec3(12, 5, 0), SL);
+
+				// the node is a view into the hierarchy
+				moved.set_transformation(ruis::render::trs_transformation{
+					.translation = {-4, 0, 0},
+					.rotation = {0, 0, 0, 1},
+					.scale = {1, 1, 1}
+				});
+				tst::check_eq(
+					std::get<ruis::render::trs_transformation>(h.get_transformation(2)).translation,
+					ruis::vec3(-4, 0, 0),
+					SL
+				);
+				tst::check_eq(moved.get_world_matrix() * ruis::vec3(0, 0, 0), ruis::vec3(12, 5, 0), SL);
+
+				scene.get().update_transforms();
+				tst::check_eq(moved.get_world_matrix() * ruis::vec3(0, 0, 0), ruis::vec3(6, 5, 0), SL);
+
+				ruis::render::draw_list dl;
+				dl.build(scene.get(), ruis::mat4().set_identity());
+				tst::check_eq(dl.get_batches().size(), size_t(1), SL);
+
+				const auto& matrices = dl.get_batches()[0].model_matrices;
+				tst::check_eq(matrices.size(), size_t(3), SL);
+				tst::check_eq(matrices[0] * ruis::vec3(0, 0, 0), ruis::vec3(10, 0, 0), SL);
+				tst::check_eq(matrices[1] * ruis::vec3(0, 0, 0), ruis::vec3(6, 5, 0), SL);
+				tst::check_eq(matrices[2] * ruis::vec3(0, 1, 0), ruis::vec3(10, 8, 0), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"draw_list_frustum_culling", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			// the triangle spans (0, 0, 0) - (1, 1, 0)
+			auto glb = make_quantized_triangle_nodes_glb(
+				R"([
+					{"mesh": 0, "translation": [10, 0, 0], "children": [1]},
+					{"translation": [0, 5, 0], "children": [2, 3]},
+					{"mesh": 0, "translation": [2, 0, 0]},
+					{"mesh": 0, "scale": [1, 3, 1]}
+				])",
+				"[0]"
+			);
+
+			// frustum of a cube with the center and half size
+			auto make_frustum = [](const ruis::vec3& center, ruis::real half_size) {
+				auto m = ruis::mat4().set_identity();
+				m.scale(ruis::vec3(1 / half_size, 1 / half_size, 1 / half_size));
+				m.translate(-center);
+				return ruis::render::frustum::from_matrix(m);
+			};
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+
+				auto subtree_ends = scene.get().get_flat_subtree_ends();
+				tst::check_eq(subtree_ends.size(), size_t(4), SL);
+				tst::check_eq(subtree_ends[0], uint32_t(4), SL);
+				tst::check_eq(subtree_ends[1], uint32_t(4), SL);
+				tst::check_eq(subtree_ends[2], uint32_t(3), SL);
+				tst::check_eq(subtree_ends[3], uint32_t(4), SL);
+
+				auto identity = ruis::mat4().set_identity();
+				ruis::render::draw_list dl;
+
+				// everything is inside, nothing is tested beyond the root
+				{
+					auto f = make_frustum({10, 3, 0}, 20);
+					dl.build(scene.get(), identity, nullptr, &f);
+					const auto& stats = dl.get_culling_statistics();
+					tst::check_eq(stats.num_culled_subtrees, size_t(0), SL);
+					tst::check_eq(stats.num_culled_meshes, size_t(0), SL);
+					tst::check_eq(stats.num_visible_meshes, size_t(3), SL);
+					tst::check_eq(dl.get_num_instances(), size_t(3), SL);
+				}
+
+				// only the root's triangle is visible, the group subtree is rejected as a whole
+				{
+					auto f = make_frustum({10.5, 0.5, 0}, 0.6f);
+					dl.build(scene.get(), identity, nullptr, &f);
+					const auto& stats = dl.get_culling_statistics();
+					tst::check_eq(stats.num_culled_subtrees, size_t(1), SL);
+					tst::check_eq(stats.num_culled_nodes, size_t(3), SL);
+					tst::check_eq(stats.num_culled_meshes, size_t(0), SL);
+					tst::check_eq(stats.num_visible_meshes, size_t(1), SL);
+					tst::check_eq(dl.get_num_instances(), size_t(1), SL);
+					tst::check_eq(
+						dl.get_batches()[0].model_matrices[0] * ruis::vec3(0, 0, 0),
+						ruis::vec3(10, 0, 0),
+						SL
+					);
+				}
+
+				// only the moved triangle is visible, the root's own mesh is tested individually
+				{
+					auto f = make_frustum({12.5, 5.5, 0}, 0.6f);
+					dl.build(scene.get(), identity, nullptr, &f);
+					const auto& stats = dl.get_culling_statistics();
+					tst::check_eq(stats.num_culled_subtrees, size_t(1), SL);
+					tst::check_eq(stats.num_culled_nodes, size_t(1), SL);
+					tst::check_eq(stats.num_culled_meshes, size_t(1), SL);
+					tst::check_eq(stats.num_visible_meshes, size_t(1), SL);
+					tst::check_eq(dl.get_num_instances(), size_t(1), SL);
+					tst::check_eq(
+						dl.get_batches()[0].model_matrices[0] * ruis::vec3(0, 0, 0),
+						ruis::vec3(12, 5, 0),
+						SL
+					);
+				}
+
+				// without frustum nothing is culled
+				dl.build(scene.get(), identity);
+				tst::check_eq(dl.get_culling_statistics().num_culled_nodes, size_t(0), SL);
+				tst::check_eq(dl.get_num_instances(), size_t(3), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"bvh_queries", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			// two rows of triangles spanning (0, 0, 0) - (1, 1, 0), the rows are at z = 0 and z = -3,
+			// node 2 * i is at x = 2 * i in the front row and node 2 * i + 1 is behind it
+			constexpr size_t num_columns = 10;
+
+			std::string nodes;
+			std::string scene_nodes;
+			for (size_t i = 0; i != num_columns * 2; ++i) {
+				nodes += utki::cat(
+					nodes.empty() ? "[" : ",",
+					R"({"mesh": 0, "translation": [)",
+					(i / 2) * 2,
+					", 0, ",
+					i % 2 == 0 ? "0" : "-3",
+					"]}"
+				);
+				scene_nodes += utki::cat(scene_nodes.empty() ? "[" : ",", i);
+			}
+			nodes += "]";
+			scene_nodes += "]";
+
+			auto glb = make_quantized_triangle_nodes_glb(nodes, scene_nodes);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto scene = l.load(fsif::span_file(utki::make_span(glb)));
+
+				ruis::render::bvh bvh;
+				bvh.build(scene.get());
+				tst::check_eq(bvh.get_items().size(), num_columns * 2, SL);
+
+				auto node_of = [&](uint32_t item_index) {
+					return bvh.get_items()[item_index].node_index;
+				};
+
+				const ruis::render::ray down_7{
+					.origin = {14.5, 0.5, 10},
+					.direction = {0, 0, -1}
+				};
+
+				auto closest = bvh.find_closest_hit(down_7);
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(14), SL);
+				tst::check_eq(closest->distance, ruis::real(10), SL);
+
+				std::vector<ruis::render::bvh::hit> hits;
+				bvh.cast_ray(down_7, hits);
+				tst::check_eq(hits.size(), size_t(2), SL);
+				tst::check_eq(node_of(hits[0].item_index), uint32_t(14), SL);
+				tst::check_eq(node_of(hits[1].item_index), uint32_t(15), SL);
+				tst::check_eq(hits[1].distance, ruis::real(13), SL);
+
+				// between the columns
+				tst::check(!bvh.find_closest_hit({.origin = {15.5, 0.5, 10}, .direction = {0, 0, -1}}), SL);
+
+				// pointing away
+				tst::check(!bvh.find_closest_hit({.origin = {14.5, 0.5, 10}, .direction = {0, 0, 1}}), SL);
+
+				std::vector<uint32_t> result;
+				bvh.query(ruis::render::aabb{.min = {3.5, 0, -1}, .max = {6.5, 1, 1}}, result);
+				std::vector<uint32_t> found;
+				for (auto i : result) {
+					found.push_back(node_of(i));
+				}
+				std::sort(found.begin(), found.end());
+				tst::check(found == std::vector<uint32_t>{4, 6}, SL);
+
+				// x from 7.8 to 10.2, both rows
+				auto m = ruis::mat4().set_identity();
+				m.scale(ruis::vec3(1 / 1.2f, 1, 0.5f));
+				m.translate(ruis::vec3(-9, -0.5f, 1.5f));
+				bvh.query(ruis::render::frustum::from_matrix(m), result);
+				found.clear();
+				for (auto i : result) {
+					found.push_back(node_of(i));
+				}
+				std::sort(found.begin(), found.end());
+				tst::check(found == std::vector<uint32_t>{8, 9, 10, 11}, SL);
+
+				// move the front node of column 7 up and refit
+				scene.get().nodes[14].get().set_transformation(ruis::render::trs_transformation{
+					.translation = {14, 5, 0},
+					.rotation = {0, 0, 0, 1},
+					.scale = {1, 1, 1}
+				});
+				scene.get().update_transforms();
+				bvh.refit(scene.get());
+
+				closest = bvh.find_closest_hit(down_7);
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(15), SL);
+
+				closest = bvh.find_closest_hit({.origin = {14.5, 5.5, 10}, .direction = {0, 0, -1}});
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(14), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"bvh_triangle_hits", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			// triangle (0, 0, 0), (1, 0, 0), (0, 1, 0) and the same triangle scaled twice behind it at z = -3,
+			// bounds of the front triangle enclose the point (0.9, 0.9), but only the back triangle covers it
+			auto glb = make_quantized_triangle_nodes_glb(
+				R"([{"mesh": 0}, {"mesh": 0, "translation": [0, 0, -3], "scale": [2, 2, 1]}])",
+				"[0, 1]"
+			);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+
+			// quantized positions are interleaved as is, otherwise those are converted to floats
+			for (bool interleave : {false, true}) {
+				ruis::render::gltf_loader l(rc.get(), {.interleave_vertex_attributes = interleave});
+				auto data = l.read(fsif::span_file(utki::make_span(glb)));
+
+				ruis::render::bvh::primitive_triangles triangles;
+				auto scene = ruis::render::make_scene(rc.get(), data, {}, nullptr, nullptr, &triangles);
+
+				tst::check_eq(triangles.size(), size_t(1), SL);
+				const auto& tm = triangles.begin()->second;
+				tst::check(tm.indices == std::vector<uint32_t>{0, 1, 2}, SL);
+				tst::check_eq(tm.positions.size(), size_t(3), SL);
+				tst::check_eq(tm.positions[1], ruis::vec3(1, 0, 0), SL);
+				tst::check_eq(tm.positions[2], ruis::vec3(0, 1, 0), SL);
+
+				ruis::render::bvh bvh;
+
+				auto node_of = [&](uint32_t item_index) {
+					return bvh.get_items()[item_index].node_index;
+				};
+
+				const ruis::render::ray through_corner{
+					.origin = {0.9, 0.9, 10},
+					.direction = {0, 0, -1}
+				};
+
+				// without triangles only the bounds are tested
+				bvh.build(scene.get());
+				auto closest = bvh.find_closest_hit(through_corner);
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(0), SL);
+				tst::check_eq(closest->distance, ruis::real(10), SL);
+
+				bvh.build(scene.get(), std::move(triangles));
+
+				closest = bvh.find_closest_hit(through_corner);
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(1), SL);
+				tst::check_eq(closest->distance, ruis::real(13), SL);
+
+				std::vector<ruis::render::bvh::hit> hits;
+				bvh.cast_ray(through_corner, hits);
+				tst::check_eq(hits.size(), size_t(1), SL);
+				tst::check_eq(node_of(hits[0].item_index), uint32_t(1), SL);
+
+				// distance is measured in lengths of the ray direction
+				closest = bvh.find_closest_hit({.origin = {0.2, 0.2, 10}, .direction = {0, 0, -2}});
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(0), SL);
+				tst::check_eq(closest->distance, ruis::real(5), SL);
+
+				// back sides of the triangles are hit as well
+				closest = bvh.find_closest_hit({.origin = {0.2, 0.2, -10}, .direction = {0, 0, 1}});
+				tst::check(closest.has_value(), SL);
+				tst::check_eq(node_of(closest->item_index), uint32_t(1), SL);
+				tst::check_eq(closest->distance, ruis::real(7), SL);
+
+				// outside of both triangles
+				tst::check(!bvh.find_closest_hit({.origin = {1.9, 1.9, 10}, .direction = {0, 0, -1}}), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"animation", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto glb = make_animated_glb(
+				R"([{
+					"name": "move",
+					"channels": [
+						{"sampler": 0, "target": {"node": 1, "path": "translation"}},
+						{"sampler": 1, "target": {"node": 0, "path": "rotation"}},
+						{"sampler": 0, "target": {"node": 2, "path": "translation"}},
+						{"sampler": 0, "target": {"path": "translation"}},
+						{"sampler": 0, "target": {"node": 1, "path": "weights"}}
+					],
+					"samplers": [
+						{"input": 0, "output": 2},
+						{"input": 1, "output": 3, "interpolation": "STEP"}
+					]
+				}])"
+			);
+
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::span_file(utki::make_span(glb)));
+
+				// channels without target node and morph target weights channels are skipped
+				tst::check_eq(data.animations.size(), size_t(1), SL);
+				const auto& channels = data.animations[0].channels;
+				tst::check_eq(channels.size(), size_t(3), SL);
+				tst::check(channels[1].path_v == ruis::render::animation::path::rotation, SL);
+				tst::check(channels[1].interpolation_v == ruis::render::animation::interpolation::step, SL);
+				tst::check_eq(channels[1].times.size(), size_t(2), SL);
+
+				// quantized rotations are converted to floats
+				tst::check_eq(channels[1].values.size(), size_t(8), SL);
+				tst::check_eq(channels[1].values[3], 1.0f, SL);
+
+				// channels of the nodes which are not in the scene are dropped
+				auto scene = ruis::render::make_scene(rc.get(), data);
+				tst::check_eq(scene.get().animations.size(), size_t(1), SL);
+
+				const auto& anim = scene.get().animations[0].get();
+				tst::check_eq(anim.name, std::string("move"), SL);
+				tst::check_eq(anim.get_channels().size(), size_t(2), SL);
+				tst::check_eq(anim.get_duration(), 1.0f, SL);
+
+				auto& child = scene.get().nodes[0].get().children[0].get();
+
+				auto get_child_position = [&]() {
+					scene.get().update_transforms();
+					scene.get().update_bounds();
+					return child.get_world_matrix() * ruis::vec3(0, 0, 0);
+				};
+
+				auto is_near = [](const ruis::vec3& a, const ruis::vec3& b) {
+					return (a - b).norm() < 1e-4f;
+				};
+
+				scene.get().update(250);
+				tst::check(is_near(get_child_position(), ruis::vec3(0.5f, 0, 0)), SL);
+
+				// the rotation key is reached
+				scene.get().update(500);
+				tst::check(is_near(get_child_position(), ruis::vec3(0, 1.5f, 0)), SL);
+
+				// animation is played in a loop
+				scene.get().update(500);
+				tst::check(is_near(get_child_position(), ruis::vec3(0.5f, 0, 0)), SL);
+
+				// the animation follows the nodes when the scene is flattened again
+				scene.get().nodes.push_back(utki::make_shared<ruis::render::node>());
+				std::swap(scene.get().nodes.front(), scene.get().nodes.back());
+				scene.get().flatten();
+				tst::check_eq(anim.get_channels()[0].node_index, uint32_t(2), SL);
+				tst::check_eq(anim.get_channels()[1].node_index, uint32_t(1), SL);
+
+				scene.get().update(250);
+				tst::check(is_near(get_child_position(), ruis::vec3(0, 1, 0)), SL);
+			}
+
+			// sampler index out of range
+			auto bad_glb = make_animated_glb(
+				R"([{"channels": [{"sampler": 1, "target": {"node": 1, "path": "translation"}}],
+					"samplers": [{"input": 0, "output": 2}]}])"
+			);
+			bool thrown = false;
+			try {
+				ruis::render::gltf_loader l(rc.get());
+				l.read(fsif::span_file(utki::make_span(bad_glb)));
+			} catch (std::invalid_argument&) {
+				thrown = true;
+			}
+			tst::check(thrown, SL);
+		}
+	);
+
+	suite.add(
+		"gpu_resource_cache", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gpu_resource_cache cache;
+
+				ruis::render::gltf_loader l(rc.get());
+				auto data = l.read(fsif::native_file("samples_gltf/kub.glb"));
+
+				auto scene1 = ruis::render::make_scene(rc.get(), data, {}, &cache);
+				auto stats1 = cache.get_statistics();
+				tst::check_eq(stats1.textures.hits, size_t(0), SL);
+				tst::check_ne(stats1.textures.misses, size_t(0), SL);
+				tst::check_ne(stats1.vertex_buffers.live_bytes, size_t(0), SL);
+
+				// same model loaded second time, all GPU resources are shared
+				auto data2 = l.read(fsif::native_file("samples_gltf/kub.glb"));
+				auto scene2 = ruis::render::make_scene(rc.get(), data2, {}, &cache);
+				auto stats2 = cache.get_statistics();
+				tst::check_eq(stats2.textures.misses, stats1.textures.misses, SL);
+				tst::check_eq(stats2.vertex_buffers.misses, stats1.vertex_buffers.misses, SL);
+				tst::check_eq(stats2.index_buffers.misses, stats1.index_buffers.misses, SL);
+				tst::check_eq(stats2.textures.hits, stats1.textures.misses, SL);
+				tst::check_eq(stats2.vertex_buffers.live_bytes, stats1.vertex_buffers.live_bytes, SL);
+
+				const auto& mesh1 = scene1.get().nodes[0].get().mesh_v;
+				const auto& mesh2 = scene2.get().nodes[0].get().mesh_v;
+				tst::check(
+					&mesh1->primitives[0].get().vao.get().buffers[0].get() ==
+						&mesh2->primitives[0].get().vao.get().buffers[0].get(),
+					SL
+				);
+			}
+		}
+	);
+
+	suite.add(
+		"gpu_resource_cache_weak_ownership", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gpu_resource_cache cache;
+
+				const std::array<float, 6> vertices = {0, 1, 2, 3, 4, 5};
+				{
+					auto vbo = cache.get_vertex_buffer(rc.get(), utki::make_span(vertices), 3);
+					tst::check_eq(cache.get_statistics().vertex_buffers.live_entries, size_t(1), SL);
+				}
+
+				// the vertex buffer is not used by anyone, the entry has expired
+				tst::check_eq(cache.get_statistics().vertex_buffers.live_entries, size_t(0), SL);
+			}
+		}
+	);
+
+	suite.add(
+		"gpu_resource_cache_distinguishes_content", //
+		// test cannot be run in parallel with other tests using ruis::render::context
+		// because of the global current context stack in ruis::render::context.
+		tst::flag::no_parallel,
+		[]() {
+			auto rc = utki::make_shared<ruis::render::null::context>();
+			{
+				ruis::render::gpu_resource_cache cache;
+
+				const std::array<float, 6> vertices = {0, 1, 2, 3, 4, 5};
+				const std::array<float, 6> same_vertices = vertices;
+				const std::array<float, 6> other_vertices = {0, 1, 2, 3, 4, 6};
+
+				auto vbo = cache.get_vertex_buffer(rc.get(), utki::make_span(vertices), 3);
+				auto same_vbo = cache.get_vertex_buffer(rc.get(), utki::make_span(same_vertices), 3);
+				auto other_vbo = cache.get_vertex_buffer(rc.get(), utki::make_span(other_vertices), 3);
+
+				tst::check(&vbo.get() == &same_vbo.get(), SL);
+				tst::check(&vbo.get() != &other_vbo.get(), SL);
+
+				auto stats = cache.get_statistics().vertex_buffers;
+				tst::check_eq(stats.hits, size_t(1), SL);
+				tst::check_eq(stats.misses, size_t(2), SL);
+				tst::check_eq(stats.live_bytes, sizeof(vertices) * 2, SL);
+			}
+		}
+	);
+
 	suite.add(
 		"spray_paint_model", //
 		// test cannot be run in parallel with other tests using ruis::render::context
@@ -0,0 +1,80 @@
+#include <ruis/render/scene/tangent_space.hxx>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+const tst::set set("tangent_space", [](tst::suite& suite) {
+	suite.add("generate_for_single_triangle", []() {
+		const std::array<uint16_t, 3> indices = {0, 1, 2};
+		const std::array<ruis::vec3, 3> positions = {
+			{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}}
+		};
+		const std::array<ruis::vec2, 3> texcoords = {
+			{{0, 0}, {1, 0}, {0, 1}}
+		};
+		const std::array<ruis::vec3, 3> normals = {
+			{{0, 0, 1}, {0, 0, 1}, {0, 0, 1}}
+		};
+
+		auto ts = ruis::render::make_tangent_space(
+			utki::make_span(indices), //
+			utki::make_span(positions),
+			utki::make_span(texcoords),
+			utki::make_span(normals)
+		);
+
+		tst::check_eq(ts.tangents.size(), size_t(3), SL);
+		tst::check_eq(ts.bitangents.size(), size_t(3), SL);
+
+		for (const auto& t : ts.tangents) {
+			tst::check_eq(t, ruis::vec3(1, 0, 0), SL);
+		}
+		for (const auto& b : ts.bitangents) {
+			tst::check_eq(b, ruis::vec3(0, 1, 0), SL);
+		}
+	});
+
+	suite.add("generate_for_degenerate_texture_coordinates", []() {
+		const std::array<uint32_t, 3> indices = {0, 1, 2};
+		const std::array<ruis::vec3, 3> positions = {
+			{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}
+		};
+		const std::array<ruis::vec2, 3> texcoords = {
+			{{0, 0}, {0, 0}, {0, 0}}
+		};
+		const std::array<ruis::vec3, 3> normals = {
+			{{0, 0, 1}, {0, 0, 1}, {0, 0, 1}}
+		};
+
+		auto ts = ruis::render::make_tangent_space(
+			utki::make_span(indices), //
+			utki::make_span(positions),
+			utki::make_span(texcoords),
+			utki::make_span(normals)
+		);
+
+		tst::check_eq(ts.tangents[0], ruis::vec3(1, 0, 0), SL);
+		tst::check_eq(ts.bitangents[0], ruis::vec3(0, 1, 0), SL);
+	});
+
+	suite.add("from_supplied_tangents", []() {
+		const std::array<ruis::vec4, 2> tangents = {
+			{{1, 0, 0, 1}, {1, 0, 0, -1}}
+		};
+		const std::array<ruis::vec3, 2> normals = {
+			{{0, 0, 1}, {0, 0, 1}}
+		};
+
+		auto ts = ruis::render::make_tangent_space(
+			utki::make_span(tangents), //
+			utki::make_span(normals)
+		);
+
+		tst::check_eq(ts.tangents[0], ruis::vec3(1, 0, 0), SL);
+		tst::check_eq(ts.bitangents[0], ruis::vec3(0, 1, 0), SL);
+
+		tst::check_eq(ts.tangents[1], ruis::vec3(1, 0, 0), SL);
+		tst::check_eq(ts.bitangents[1], ruis::vec3(0, -1, 0), SL);
+	});
+});
+} // namespace
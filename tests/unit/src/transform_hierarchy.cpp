@@ -0,0 +1,100 @@
+#include <stdexcept>
+
+#include <ruis/render/scene/transform_hierarchy.hpp>
+#include <tst/check.hpp>
+#include <tst/set.hpp>
+
+namespace {
+ruis::render::trs_transformation make_translation(const ruis::vec3& t)
+{
+	return {
+		.translation = t, //
+		.rotation = {0, 0, 0, 1},
+		.scale = {1, 1, 1}
+	};
+}
+
+const tst::set set("transform_hierarchy", [](tst::suite& suite) {
+	suite.add("parent_must_be_added_first", []() {
+		ruis::render::transform_hierarchy h;
+		auto root = h.add(ruis::render::transform_hierarchy::no_parent, ruis::render::identity_trs_transformation);
+		tst::check_eq(root, uint32_t(0), SL);
+		tst::check_eq(h.add(root, ruis::render::identity_trs_transformation), uint32_t(1), SL);
+
+		bool thrown = false;
+		try {
+			h.add(2, ruis::render::identity_trs_transformation);
+		} catch (std::invalid_argument&) {
+			thrown = true;
+		}
+		tst::check(thrown, SL);
+		tst::check_eq(h.size(), size_t(2), SL);
+	});
+
+	suite.add("world_matrices", []() {
+		ruis::render::transform_hierarchy h;
+
+		auto scaled = ruis::mat4().set_identity();
+		scaled.scale(ruis::vec3(2, 2, 2));
+
+		auto root = h.add(ruis::render::transform_hierarchy::no_parent, scaled);
+		auto child = h.add(root, make_translation({1, 0, 0}));
+		auto grandchild = h.add(child, make_translation({0, 1, 0}));
+		auto other_root = h.add(ruis::render::transform_hierarchy::no_parent, make_translation({0, 0, 5}));
+
+		// world matrices are calculated when nodes are added
+		tst::check_eq(h.get_world_matrix(grandchild) * ruis::vec3(0, 0, 0), ruis::vec3(2, 2, 0), SL);
+		tst::check_eq(h.get_world_matrix(other_root) * ruis::vec3(0, 0, 0), ruis::vec3(0, 0, 5), SL);
+
+		h.set_transformation(child, make_translation({3, 0, 0}));
+
+		// transformation is stored as given, but world matrices are not updated until update() call
+		tst::check(std::holds_alternative<ruis::render::trs_transformation>(h.get_transformation(child)), SL);
+		tst::check(std::holds_alternative<ruis::mat4>(h.get_transformation(root)), SL);
+		tst::check_eq(h.get_local_matrix(child) * ruis::vec3(0, 0, 0), ruis::vec3(3, 0, 0), SL);
+		tst::check_eq(h.get_world_matrix(grandchild) * ruis::vec3(0, 0, 0), ruis::vec3(2, 2, 0), SL);
+
+		h.update();
+		tst::check_eq(h.get_world_matrix(child) * ruis::vec3(0, 0, 0), ruis::vec3(6, 0, 0), SL);
+		tst::check_eq(h.get_world_matrix(grandchild) * ruis::vec3(0, 0, 0), ruis::vec3(6, 2, 0), SL);
+		tst::check_eq(h.get_world_matrix(other_root) * ruis::vec3(0, 0, 0), ruis::vec3(0, 0, 5), SL);
+	});
+
+	suite.add("only_changed_subtrees_are_updated", []() {
+		ruis::render::transform_hierarchy h;
+
+		auto root = h.add(ruis::render::transform_hierarchy::no_parent, make_translation({1, 0, 0}));
+		auto child = h.add(root, make_translation({1, 0, 0}));
+		auto grandchild = h.add(child, make_translation({1, 0, 0}));
+		auto sibling = h.add(root, make_translation({0, 1, 0}));
+
+		tst::check(h.is_world_matrix_changed(grandchild), SL);
+
+		h.update();
+		tst::check_eq(h.get_last_update_statistics().num_local_matrices, size_t(0), SL);
+		tst::check_eq(h.get_last_update_statistics().num_world_matrices, size_t(0), SL);
+		tst::check(!h.is_world_matrix_changed(grandchild), SL);
+
+		h.set_transformation(child, make_translation({2, 0, 0}));
+		h.set_transformation(child, make_translation({3, 0, 0}));
+
+		// the local matrix is calculated only once per update, the change is pushed down to the grandchild
+		h.update();
+		tst::check_eq(h.get_last_update_statistics().num_local_matrices, size_t(1), SL);
+		tst::check_eq(h.get_last_update_statistics().num_world_matrices, size_t(2), SL);
+		tst::check(!h.is_world_matrix_changed(root), SL);
+		tst::check(h.is_world_matrix_changed(child), SL);
+		tst::check(h.is_world_matrix_changed(grandchild), SL);
+		tst::check(!h.is_world_matrix_changed(sibling), SL);
+		tst::check_eq(h.get_world_matrix(grandchild) * ruis::vec3(0, 0, 0), ruis::vec3(5, 0, 0), SL);
+
+		// matrix transformation needs no local matrix calculation
+		h.set_transformation(root, ruis::mat4().set_identity());
+		h.update();
+		tst::check_eq(h.get_last_update_statistics().num_local_matrices, size_t(0), SL);
+		tst::check_eq(h.get_last_update_statistics().num_world_matrices, size_t(4), SL);
+		tst::check_eq(h.get_world_matrix(grandchild) * ruis::vec3(0, 0, 0), ruis::vec3(4, 0, 0), SL);
+		tst::check_eq(h.get_world_matrix(sibling) * ruis::vec3(0, 0, 0), ruis::vec3(0, 1, 0), SL);
+	});
+});
+} // namespace